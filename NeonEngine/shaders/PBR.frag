@@ -18,6 +18,7 @@ uniform sampler2D texture_ambient_occlusion;
 
 uniform int has_texture_albedo;
 uniform int has_texture_normal;
+uniform int is_two_channel_texture_normal;
 uniform int has_texture_metalness;
 uniform int has_texture_roughness;
 uniform int has_texture_emission;
@@ -33,9 +34,20 @@ uniform float emission_strength;
 
 // IBL
 uniform samplerCube irradianceMap;
+// Irradiance as spherical harmonics up to band 2, evaluated instead of sampling the irradiance map
+uniform int use_irradiance_sh;
+uniform vec3 irradiance_sh[9];
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
 
+// Local reflection probes (MAX_BLENDED_REFLECTION_PROBES in reflection_probe.h), their prefilter maps replace the one
+// of the environment inside their radius
+const int MAX_REFLECTION_PROBES = 4;
+uniform int num_reflection_probes;
+uniform samplerCube reflectionProbeMaps[MAX_REFLECTION_PROBES];
+uniform vec3 reflectionProbePositions[MAX_REFLECTION_PROBES];
+uniform float reflectionProbeRadii[MAX_REFLECTION_PROBES];
+
 const float PI = 3.14159265359;
 
 struct PointLight {
@@ -113,6 +125,7 @@ float GeometrySchlickGGX(float NdotV, float roughness);
 float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
+vec3 irradianceFromSH(vec3 N);
 
 void main() {		
     if (is_transform3d == 0) {
@@ -303,12 +316,31 @@ void main() {
         vec3 kD = 1.0 - kS;
         kD *= 1.0 - metallic;	  
     
-        vec3 irradiance = texture(irradianceMap, N).rgb;
+        vec3 irradiance;
+        if (use_irradiance_sh == 1) {
+            irradiance = max(irradianceFromSH(N), vec3(0.0));
+        }
+        else {
+            irradiance = texture(irradianceMap, N).rgb;
+        }
         vec3 diffuse      = irradiance * albedo;
     
         // sample both the pre-filter map and the BRDF lut and combine them together as per the Split-Sum approximation to get the IBL specular part.
         const float MAX_REFLECTION_LOD = 4.0;
         vec3 prefilteredColor = textureLod(prefilterMap, R,  roughness * MAX_REFLECTION_LOD).rgb;    
+        // blend of the reflection probes that reach the fragment, weighted by how far inside their radius it is
+        vec3 probeColor = vec3(0.0);
+        float probeWeight = 0.0;
+        for (int i = 0; i < num_reflection_probes; ++i) {
+            float weight = clamp(1.0 - length(FragPos - reflectionProbePositions[i]) / reflectionProbeRadii[i], 0.0, 1.0);
+            if (weight > 0.0) {
+                probeColor += textureLod(reflectionProbeMaps[i], R, roughness * MAX_REFLECTION_LOD).rgb * weight;
+                probeWeight += weight;
+            }
+        }
+        if (probeWeight > 0.0) {
+            prefilteredColor = mix(prefilteredColor, probeColor / probeWeight, min(probeWeight, 1.0));
+        }
         vec2 brdf  = texture(brdfLUT, vec2(max(dot(N, V), 0.0), roughness)).rg;
         vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
 
@@ -342,6 +374,10 @@ void main() {
 // technique somewhere later in the normal mapping tutorial.
 vec3 getNormalFromMap() {
     vec3 tangentNormal = texture(texture_normal, TexCoords).xyz * 2.0 - 1.0;
+    // z of the normal maps compressed to two channels
+    if (is_two_channel_texture_normal == 1) {
+        tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
+    }
 
     vec3 Q1  = dFdx(FragPos);
     vec3 Q2  = dFdy(FragPos);
@@ -394,4 +430,17 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
 
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-}
\ No newline at end of file
+}
+
+// Irradiance in the direction N from its spherical harmonics
+vec3 irradianceFromSH(vec3 N) {
+    return irradiance_sh[0] * 0.282095
+         + irradiance_sh[1] * 0.488603 * N.y
+         + irradiance_sh[2] * 0.488603 * N.z
+         + irradiance_sh[3] * 0.488603 * N.x
+         + irradiance_sh[4] * 1.092548 * N.x * N.y
+         + irradiance_sh[5] * 1.092548 * N.y * N.z
+         + irradiance_sh[6] * 0.315392 * (3.0 * N.z * N.z - 1.0)
+         + irradiance_sh[7] * 1.092548 * N.x * N.z
+         + irradiance_sh[8] * 0.546274 * (N.x * N.x - N.y * N.y);
+}
@@ -0,0 +1,128 @@
+#include "allocation_tracker.h"
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+static std::atomic<bool> tracking_enabled(false);
+static std::atomic<uint64_t> allocation_counts[AllocTagLast];
+static std::atomic<uint64_t> allocation_bytes[AllocTagLast];
+
+// Plain data, so they are ready before the first allocation of every thread
+static thread_local AllocationTag current_tag = AllocUntagged;
+static thread_local AllocationCounters thread_counters[AllocTagLast];
+
+std::string allocation_tag_to_string(AllocationTag tag) {
+    switch (tag) {
+    case AllocUntagged:
+        return "Untagged";
+    case AllocRendering:
+        return "Rendering";
+    case AllocLighting:
+        return "Lighting";
+    case AllocAnimation:
+        return "Animation";
+    case AllocUI:
+        return "UI";
+    case AllocAssets:
+        return "Assets";
+    case AllocProfiling:
+        return "Profiling";
+    default:
+        return "Unknown";
+    }
+}
+
+AllocationCounters& AllocationCounters::operator+=(const AllocationCounters& other) {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+}
+
+AllocationCounters operator-(const AllocationCounters& a, const AllocationCounters& b) {
+    AllocationCounters difference;
+    difference.count = a.count - b.count;
+    difference.bytes = a.bytes - b.bytes;
+    return difference;
+}
+
+void set_allocation_tracking(bool enabled) {
+    tracking_enabled = enabled;
+}
+
+bool is_allocation_tracking_enabled() {
+    return tracking_enabled;
+}
+
+AllocationCounters get_allocation_counters(AllocationTag tag) {
+    AllocationCounters counters;
+    counters.count = allocation_counts[tag].load(std::memory_order_relaxed);
+    counters.bytes = allocation_bytes[tag].load(std::memory_order_relaxed);
+    return counters;
+}
+
+AllocationCounters get_thread_allocation_counters(AllocationTag tag) {
+    return thread_counters[tag];
+}
+
+AllocationCounters get_thread_allocation_counters() {
+    AllocationCounters counters;
+    for (int i = 0; i < AllocTagLast; i++) {
+        if (i != AllocProfiling) {
+            counters += thread_counters[i];
+        }
+    }
+    return counters;
+}
+
+AllocationTag set_allocation_tag(AllocationTag tag) {
+    AllocationTag previous_tag = current_tag;
+    current_tag = tag;
+    return previous_tag;
+}
+
+static void* allocate(std::size_t size) {
+    if (tracking_enabled.load(std::memory_order_relaxed)) {
+        allocation_counts[current_tag].fetch_add(1, std::memory_order_relaxed);
+        allocation_bytes[current_tag].fetch_add(size, std::memory_order_relaxed);
+        thread_counters[current_tag].count++;
+        thread_counters[current_tag].bytes += size;
+    }
+    // like the default operator new, a zero-size allocation returns a unique pointer and a failure calls the new handler
+    while (true) {
+        void* pointer = std::malloc(size == 0 ? 1 : size);
+        if (pointer != nullptr) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+// The nothrow and sized variants of the standard library call these ones, the aligned variants keep their own allocator
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t size) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t size) noexcept {
+    std::free(pointer);
+}
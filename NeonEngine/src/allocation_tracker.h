@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+// Frames of a headless run that aren't checked by --fail-on-frame-allocations, while the caches fill up
+const int ALLOCATION_TEST_WARMUP_FRAMES = 10;
+
+// Subsystem that the allocations of a thread are attributed to, set with ALLOCATION_TAG()
+enum AllocationTag {
+    AllocUntagged,
+    AllocRendering,
+    AllocLighting,
+    AllocAnimation,
+    AllocUI,
+    AllocAssets,
+    AllocProfiling,     // bookkeeping of the profilers, left out of the frame allocations
+    AllocTagLast
+};
+
+std::string allocation_tag_to_string(AllocationTag tag);
+
+// Number of heap allocations and their bytes
+struct AllocationCounters {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    AllocationCounters& operator+=(const AllocationCounters& other);
+};
+
+AllocationCounters operator-(const AllocationCounters& a, const AllocationCounters& b);
+
+// Optional tracking of the heap allocations: the global operator new is replaced by one that, while the tracking is enabled,
+// counts every allocation under the current tag of its thread, both in the totals of the process and in the counters of the thread.
+// The frees aren't tracked, the counters measure the churn of the allocations and not the memory in use.
+// Any thread
+void set_allocation_tracking(bool enabled);
+bool is_allocation_tracking_enabled();
+
+// Totals of every thread since the tracking was enabled
+AllocationCounters get_allocation_counters(AllocationTag tag);
+// Totals of the calling thread, the profiler takes the difference around each pass and each frame
+AllocationCounters get_thread_allocation_counters(AllocationTag tag);
+// Sum of the tags of the calling thread except AllocProfiling
+AllocationCounters get_thread_allocation_counters();
+
+// Returns the previous tag of the calling thread
+AllocationTag set_allocation_tag(AllocationTag tag);
+
+struct AllocationTagScope {
+    AllocationTagScope(AllocationTag tag) {
+        previous_tag = set_allocation_tag(tag);
+    }
+    ~AllocationTagScope() {
+        set_allocation_tag(previous_tag);
+    }
+
+    AllocationTag previous_tag;
+};
+
+#define ALLOCATION_TAG_CONCATENATE_DETAIL(a, b) a##b
+#define ALLOCATION_TAG_CONCATENATE(a, b) ALLOCATION_TAG_CONCATENATE_DETAIL(a, b)
+// e.g. ALLOCATION_TAG(AllocUI); until the end of the block
+#define ALLOCATION_TAG(tag) AllocationTagScope ALLOCATION_TAG_CONCATENATE(allocation_tag_scope_, __LINE__)(tag)
@@ -0,0 +1,392 @@
+#include "asset_cooker.h"
+
+#include "cooked_assets.h"
+#include "model_cache.h"
+#include "model.h"
+#include "rendering.h"
+#include "cubemap.h"
+#include "opengl_utils.h"
+#include "task_graph.h"
+#include "texture_compression.h"
+#include "texture_cache.h"
+#include "ibl_cache.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+AssetCooker::AssetCooker(bool force_rebuild, int num_worker_threads, TextureCompression texture_compression) {
+    this->force_rebuild = force_rebuild;
+    this->num_worker_threads = num_worker_threads;
+    this->texture_compression = texture_compression;
+    window = nullptr;
+    rendering = nullptr;
+    num_cooked_assets = 0;
+    num_skipped_assets = 0;
+    num_failed_assets = 0;
+    // the cooker works on the pixels of every image, not on shared textures
+    TextureCache::get_instance()->enabled = false;
+}
+
+AssetCooker::~AssetCooker() {
+    destroy_gl_context();
+}
+
+bool AssetCooker::run() {
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+
+    load_manifest();
+
+    TaskGraph task_graph(num_worker_threads);
+    add_model_jobs(task_graph);
+    std::vector<int> normal_map_tasks = add_normal_map_jobs(task_graph);
+    add_texture_jobs(task_graph, normal_map_tasks);
+    add_hdri_jobs(task_graph);
+    task_graph.run();
+
+    save_manifest();
+
+    auto end_timer = std::chrono::high_resolution_clock::now();
+    double elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - begin_timer).count();
+    std::cout << "COOKED " << num_cooked_assets << " ASSETS, " << num_skipped_assets << " UP TO DATE, " << num_failed_assets << " FAILED IN: "
+        << elapsed_time_seconds << " seconds (" << task_graph.num_worker_threads << " worker threads)" << std::endl;
+
+    return num_failed_assets == 0;
+}
+
+// Hidden window, only used for its GL context
+bool AssetCooker::create_gl_context() {
+    if (!glfwInit()) {
+        std::cout << "ERROR::COOKER:: Failed to initialize GLFW" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(1, 1, "Neon Cooker", NULL, NULL);
+    if (window == nullptr) {
+        std::cout << "ERROR::COOKER:: Failed to create the GL context" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "ERROR::COOKER:: Failed to initialize GLAD" << std::endl;
+        destroy_gl_context();
+        return false;
+    }
+    return true;
+}
+
+void AssetCooker::destroy_gl_context() {
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        window = nullptr;
+    }
+}
+
+void AssetCooker::load_manifest() {
+    std::ifstream file(COOKER_MANIFEST_PATH);
+    std::string line;
+    while (std::getline(file, line)) {
+        // <hash in hex> <output path>
+        if (line.size() > 17 && line[16] == ' ') {
+            manifest[line.substr(17)] = std::stoull(line.substr(0, 16), nullptr, 16);
+        }
+    }
+}
+
+void AssetCooker::save_manifest() {
+    std::filesystem::create_directories(COOKED_ASSETS_DIRECTORY);
+    std::ofstream file(COOKER_MANIFEST_PATH, std::ios::trunc);
+    for (auto it = manifest.begin(); it != manifest.end(); it++) {
+        file << std::hex << std::setw(16) << std::setfill('0') << it->second << " " << it->first << "\n";
+    }
+}
+
+bool AssetCooker::is_up_to_date(const std::vector<std::string>& output_paths, uint64_t hash) {
+    if (force_rebuild) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(manifest_mutex);
+    for (int i = 0; i < output_paths.size(); i++) {
+        auto it = manifest.find(output_paths[i]);
+        if (it == manifest.end() || it->second != hash || !std::filesystem::exists(output_paths[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetCooker::set_cooked(const std::vector<std::string>& output_paths, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(manifest_mutex);
+    for (int i = 0; i < output_paths.size(); i++) {
+        manifest[output_paths[i]] = hash;
+    }
+}
+
+static bool has_extension(const std::filesystem::path& path, const std::vector<std::string>& extensions) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+static std::vector<std::string> find_files(const std::string& directory, const std::vector<std::string>& extensions) {
+    std::vector<std::string> paths;
+    if (!std::filesystem::exists(directory)) {
+        return paths;
+    }
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file() && has_extension(entry.path(), extensions)) {
+            paths.push_back(entry.path().generic_string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void AssetCooker::add_model_jobs(TaskGraph& task_graph) {
+    std::vector<std::string> paths = find_files("models", { ".gltf", ".glb", ".fbx", ".obj", ".dae" });
+    for (int i = 0; i < paths.size(); i++) {
+        std::string path = paths[i];
+        task_graph.add_task("Cook model " + path, WorkerTask, [this, path]() {
+            if (!cook_model(path)) {
+                std::cout << "ERROR::COOKER:: Failed to cook the model " << path << std::endl;
+                num_failed_assets++;
+            }
+        });
+    }
+}
+
+// The cooked model is a copy of the binary cache written by the assimp import (or reused when it's up to date)
+bool AssetCooker::cook_model(const std::string& path) {
+    std::string output_path = get_cooked_asset_path(path, COOKED_MODEL_EXTENSION);
+    uint64_t hash = compute_model_cache_key(path, MODEL_IMPORT_FLAGS);
+    hash = hash_bytes(&COOKER_VERSION, sizeof(COOKER_VERSION), hash);
+    if (is_up_to_date({ output_path }, hash)) {
+        num_skipped_assets++;
+        return true;
+    }
+
+    Model* model = new Model(std::filesystem::path(path).stem().string(), path, false, false, true, false);
+    bool cooked = !model->meshes.empty() && std::filesystem::exists(model->cache_path);
+    if (cooked) {
+        std::error_code error;
+        std::string temporary_path = output_path + ".tmp";
+        std::filesystem::create_directories(std::filesystem::path(output_path).parent_path(), error);
+        std::filesystem::copy_file(model->cache_path, temporary_path, std::filesystem::copy_options::overwrite_existing, error);
+        if (!error) {
+            std::filesystem::rename(temporary_path, output_path, error);
+        }
+        cooked = !error;
+    }
+    delete model;
+
+    if (cooked) {
+        set_cooked({ output_path }, hash);
+        num_cooked_assets++;
+    }
+    return cooked;
+}
+
+// The normal maps are found from the slots of the materials, not from the names of the images: the images of the normal
+// slot of the materials of the models (aiTextureType_NORMALS, also the normalTexture of glTF) and the MATERIAL_TEXTURE_FILES
+// of the normal slot of the material directories. Returns the ids of the tasks that read the materials of the models.
+std::vector<int> AssetCooker::add_normal_map_jobs(TaskGraph& task_graph) {
+    std::vector<std::string> material_paths = find_files("materials", { ".png" });
+    for (int i = 0; i < material_paths.size(); i++) {
+        std::string file_name = std::filesystem::path(material_paths[i]).filename().string();
+        for (int j = 0; j < MATERIAL_TEXTURE_FILES.size(); j++) {
+            if (MATERIAL_TEXTURE_FILES[j].first == TexNormal && MATERIAL_TEXTURE_FILES[j].second == file_name) {
+                normal_map_paths.insert(material_paths[i]);
+            }
+        }
+    }
+
+    std::vector<int> normal_map_tasks;
+    std::vector<std::string> model_paths = find_files("models", { ".gltf", ".glb", ".fbx", ".obj", ".dae" });
+    for (int i = 0; i < model_paths.size(); i++) {
+        std::string path = model_paths[i];
+        normal_map_tasks.push_back(task_graph.add_task("Find normal maps " + path, WorkerTask, [this, path]() {
+            // only the materials are read, without post-processing of the meshes
+            Assimp::Importer importer;
+            const aiScene* scene = importer.ReadFile(path, 0);
+            if (scene == nullptr) {
+                return;
+            }
+            std::filesystem::path directory = std::filesystem::path(path).parent_path();
+            for (unsigned int j = 0; j < scene->mNumMaterials; j++) {
+                for (unsigned int k = 0; k < scene->mMaterials[j]->GetTextureCount(aiTextureType_NORMALS); k++) {
+                    aiString texture_path;
+                    scene->mMaterials[j]->GetTexture(aiTextureType_NORMALS, k, &texture_path);
+                    // the embedded textures (*<index>) aren't cooked
+                    if (texture_path.length == 0 || texture_path.C_Str()[0] == '*') {
+                        continue;
+                    }
+                    std::string normal_map_path = (directory / texture_path.C_Str()).lexically_normal().generic_string();
+                    std::lock_guard<std::mutex> lock(normal_map_paths_mutex);
+                    normal_map_paths.insert(normal_map_path);
+                }
+            }
+        }));
+    }
+    return normal_map_tasks;
+}
+
+bool AssetCooker::is_normal_map(const std::string& path) {
+    std::lock_guard<std::mutex> lock(normal_map_paths_mutex);
+    return normal_map_paths.find(std::filesystem::path(path).lexically_normal().generic_string()) != normal_map_paths.end();
+}
+
+// Images of the models are loaded without vertical flip and the images of the materials with it, like Rendering does.
+// The textures are cooked once the normal maps are known
+void AssetCooker::add_texture_jobs(TaskGraph& task_graph, const std::vector<int>& normal_map_tasks) {
+    std::vector<std::pair<std::string, bool>> directories = { { "models", false }, { "materials", true } };
+    for (int i = 0; i < directories.size(); i++) {
+        bool flip_vertically = directories[i].second;
+        std::vector<std::string> paths = find_files(directories[i].first, { ".png", ".jpg", ".jpeg", ".tga", ".bmp" });
+        for (int j = 0; j < paths.size(); j++) {
+            std::string path = paths[j];
+            task_graph.add_task("Cook texture " + path, WorkerTask, [this, path, flip_vertically]() {
+                if (!cook_texture(path, flip_vertically, is_normal_map(path))) {
+                    std::cout << "ERROR::COOKER:: Failed to cook the texture " << path << std::endl;
+                    num_failed_assets++;
+                }
+            }, normal_map_tasks);
+        }
+    }
+}
+
+bool AssetCooker::cook_texture(const std::string& path, bool flip_vertically, bool is_normal_map) {
+    std::string output_path = get_cooked_asset_path(path, COOKED_TEXTURE_EXTENSION);
+    uint64_t hash = hash_file(path);
+    hash = hash_bytes(&flip_vertically, sizeof(flip_vertically), hash);
+    hash = hash_bytes(&texture_compression, sizeof(texture_compression), hash);
+    hash = hash_bytes(&is_normal_map, sizeof(is_normal_map), hash);
+    hash = hash_bytes(&COOKER_VERSION, sizeof(COOKER_VERSION), hash);
+    if (is_up_to_date({ output_path }, hash)) {
+        num_skipped_assets++;
+        return true;
+    }
+
+    ImageData image;
+    if (!load_image_data(path, image, flip_vertically)) {
+        return false;
+    }
+    Ktx2Texture texture;
+    texture.format = get_ktx2_format_of_channels(image.num_channels);
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.key_values[COOKED_TEXTURE_FLIP_KEY] = flip_vertically ? "1" : "0";
+    generate_mip_chain(image.data, image.width, image.height, image.num_channels, texture.levels);
+
+    // the mip chain is generated from the uncompressed levels, then every level is compressed
+    if (texture_compression != CompressNone) {
+        texture.format = choose_compressed_format(image.data, image.width, image.height, image.num_channels, is_normal_map, texture_compression == CompressBC1);
+        for (int level = 0; level < texture.levels.size(); level++) {
+            std::vector<unsigned char> compressed_level;
+            compress_image(texture.levels[level].data(), std::max(image.width >> level, 1), std::max(image.height >> level, 1), image.num_channels, texture.format, compressed_level);
+            texture.levels[level] = std::move(compressed_level);
+        }
+    }
+    free_image_data(image);
+
+    if (!write_ktx2_file(output_path, texture)) {
+        return false;
+    }
+    set_cooked({ output_path }, hash);
+    num_cooked_assets++;
+    return true;
+}
+
+// Decoding (worker) -> IBL baking and read back (main thread, GL) -> writing of the KTX2 files (worker)
+void AssetCooker::add_hdri_jobs(TaskGraph& task_graph) {
+    std::vector<std::string> paths = find_files("HDRIs", { ".hdr" });
+    if (paths.empty()) {
+        return;
+    }
+    if (!create_gl_context()) {
+        num_failed_assets += (int)paths.size();
+        return;
+    }
+
+    rendering = Rendering::get_instance();
+    int capture_task = task_graph.add_task("IBL capture data", MainThreadTask, [this]() {
+        rendering->set_opengl_state();
+        rendering->set_viewport_shaders();
+        rendering->create_ibl_capture_data();
+    });
+
+    for (int i = 0; i < paths.size(); i++) {
+        std::string path = paths[i];
+        std::string cubemap_name = std::filesystem::path(path).stem().string();
+        std::vector<std::string> output_paths = {
+            get_cooked_asset_path(path, COOKED_ENVIRONMENT_MAP_EXTENSION),
+            get_cooked_asset_path(path, COOKED_IRRADIANCE_MAP_EXTENSION),
+            get_cooked_asset_path(path, COOKED_PREFILTER_MAP_EXTENSION)
+        };
+        std::shared_ptr<uint64_t> hash = std::make_shared<uint64_t>(0);
+        std::shared_ptr<bool> needs_cooking = std::make_shared<bool>(false);
+        std::shared_ptr<ImageData> equirectangular_image = std::make_shared<ImageData>();
+        std::shared_ptr<CookedCubemapData> cubemap_data = std::make_shared<CookedCubemapData>();
+
+        int decode_task = task_graph.add_task("Decode HDRI " + cubemap_name, WorkerTask, [this, path, output_paths, hash, needs_cooking, equirectangular_image]() {
+            int map_sizes[3] = { rendering->ENVIRONMENT_MAP_WIDTH, rendering->IRRADIANCE_MAP_WIDTH, rendering->PREFILTER_MAP_WIDTH };
+            *hash = hash_file(path);
+            *hash = hash_bytes(map_sizes, sizeof(map_sizes), *hash);
+            *hash = hash_bytes(&COOKER_VERSION, sizeof(COOKER_VERSION), *hash);
+            if (is_up_to_date(output_paths, *hash)) {
+                num_skipped_assets++;
+                return;
+            }
+            *needs_cooking = load_hdr_image_data(path, *equirectangular_image, true);
+            if (!*needs_cooking) {
+                num_failed_assets++;
+            }
+        });
+
+        int bake_task = task_graph.add_task("Bake IBL " + cubemap_name, MainThreadTask, [this, cubemap_name, needs_cooking, equirectangular_image, cubemap_data]() {
+            if (!*needs_cooking) {
+                return;
+            }
+            rendering->load_hdri_cubemap(cubemap_name, *equirectangular_image);
+            CubemapData textures = rendering->cubemap->umap_name_to_cubemap_data[cubemap_name];
+            // the mipmaps of the environment map are generated when it's loaded
+            read_cubemap_texture(textures.environment_texture, rendering->ENVIRONMENT_MAP_WIDTH, 1, cubemap_data->environment_map);
+            read_cubemap_texture(textures.irradiance_texture, rendering->IRRADIANCE_MAP_WIDTH, 1, cubemap_data->irradiance_map);
+            read_cubemap_texture(textures.prefilter_texture, rendering->PREFILTER_MAP_WIDTH, PREFILTER_MAP_MIP_LEVELS, cubemap_data->prefilter_map);
+            unsigned int texture_ids[3] = { textures.environment_texture, textures.irradiance_texture, textures.prefilter_texture };
+            glDeleteTextures(3, texture_ids);
+            rendering->cubemap->umap_name_to_cubemap_data.erase(cubemap_name);
+        }, { decode_task, capture_task });
+
+        task_graph.add_task("Write IBL " + cubemap_name, WorkerTask, [this, path, output_paths, hash, needs_cooking, cubemap_data]() {
+            if (!*needs_cooking) {
+                return;
+            }
+            if (write_ktx2_file(output_paths[0], cubemap_data->environment_map) &&
+                write_ktx2_file(output_paths[1], cubemap_data->irradiance_map) &&
+                write_ktx2_file(output_paths[2], cubemap_data->prefilter_map)) {
+                set_cooked(output_paths, *hash);
+                num_cooked_assets++;
+            }
+            else {
+                std::cout << "ERROR::COOKER:: Failed to cook the HDRI " << path << std::endl;
+                num_failed_assets++;
+            }
+            *cubemap_data = CookedCubemapData();
+        }, { bake_task });
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+class TaskGraph;
+class Rendering;
+struct GLFWwindow;
+
+// Version of the cooked formats written by the cooker, part of the hash of every asset
+const uint32_t COOKER_VERSION = 2;
+// Manifest of the cooked files: output path and hash of the sources and settings it was cooked from
+const std::string COOKER_MANIFEST_PATH = "cooked/manifest.txt";
+
+// Block compression of the cooked textures. Normal maps are always BC5 and single channel (or grayscale) maps BC4,
+// the color textures are BC7 or BC1/BC3 (half the size of BC7, lower quality).
+enum TextureCompression {
+    CompressBC7,
+    CompressBC1,
+    CompressNone
+};
+
+// Offline conversion of the source assets to the runtime formats of cooked_assets.h:
+// models/ -> binary meshes (.nmdl), images of models/ and materials/ -> mip-chained BCn KTX2 textures, HDRIs/ -> prebaked IBL cubemaps.
+// Every asset is a job of a TaskGraph: importing, decoding and mip generation run in the worker threads while the IBL
+// baking runs in the main thread, which owns a hidden GL context. Assets whose hash matches the manifest are skipped.
+class AssetCooker {
+public:
+    AssetCooker(bool force_rebuild, int num_worker_threads, TextureCompression texture_compression);
+    ~AssetCooker();
+
+    // Returns false when an asset failed to cook
+    bool run();
+
+private:
+    bool create_gl_context();
+    void destroy_gl_context();
+    void load_manifest();
+    void save_manifest();
+    bool is_up_to_date(const std::vector<std::string>& output_paths, uint64_t hash);
+    void set_cooked(const std::vector<std::string>& output_paths, uint64_t hash);
+
+    void add_model_jobs(TaskGraph& task_graph);
+    std::vector<int> add_normal_map_jobs(TaskGraph& task_graph);
+    void add_texture_jobs(TaskGraph& task_graph, const std::vector<int>& normal_map_tasks);
+    void add_hdri_jobs(TaskGraph& task_graph);
+    bool cook_model(const std::string& path);
+    bool is_normal_map(const std::string& path);
+    bool cook_texture(const std::string& path, bool flip_vertically, bool is_normal_map);
+
+    bool force_rebuild;
+    int num_worker_threads;
+    TextureCompression texture_compression;
+    GLFWwindow* window;
+    Rendering* rendering;
+    std::map<std::string, uint64_t> manifest;
+    std::mutex manifest_mutex;
+    // Images bound to the normal slot of a material of a model or of a material directory
+    std::set<std::string> normal_map_paths;
+    std::mutex normal_map_paths_mutex;
+    std::atomic<int> num_cooked_assets;
+    std::atomic<int> num_skipped_assets;
+    std::atomic<int> num_failed_assets;
+};
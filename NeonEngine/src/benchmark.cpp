@@ -0,0 +1,232 @@
+#include "benchmark.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <iterator>
+
+bool load_camera_path(const std::string& path, std::vector<CameraKeyframe>& keyframes) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::BENCHMARK:: Couldn't open the camera path " << path << std::endl;
+        return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream line_stream(line);
+        CameraKeyframe keyframe;
+        if (!(line_stream >> keyframe.frame >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch)) {
+            std::cout << "ERROR::BENCHMARK:: Invalid keyframe in line " << line_number << " of " << path << std::endl;
+            return false;
+        }
+        if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+            std::cout << "ERROR::BENCHMARK:: The keyframes of " << path << " aren't sorted by frame (line " << line_number << ")" << std::endl;
+            return false;
+        }
+        keyframes.push_back(keyframe);
+    }
+
+    if (keyframes.empty()) {
+        std::cout << "ERROR::BENCHMARK:: The camera path " << path << " has no keyframes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool save_camera_path(const std::string& path, const std::vector<CameraKeyframe>& keyframes) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::BENCHMARK:: Couldn't write the camera path " << path << std::endl;
+        return false;
+    }
+
+    file << "# frame x y z yaw pitch" << std::endl;
+    file << std::setprecision(9);
+    for (int i = 0; i < keyframes.size(); i++) {
+        const CameraKeyframe& keyframe = keyframes[i];
+        file << keyframe.frame << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+            << keyframe.yaw << " " << keyframe.pitch << std::endl;
+    }
+    return true;
+}
+
+CameraKeyframe interpolate_camera_path(const std::vector<CameraKeyframe>& keyframes, int frame) {
+    if (frame <= keyframes.front().frame) {
+        return keyframes.front();
+    }
+    if (frame >= keyframes.back().frame) {
+        return keyframes.back();
+    }
+
+    // last keyframe at or before the frame
+    int i = 0;
+    while (keyframes[i + 1].frame <= frame) {
+        i++;
+    }
+    const CameraKeyframe& previous = keyframes[i];
+    const CameraKeyframe& next = keyframes[i + 1];
+    float t = (float)(frame - previous.frame) / (float)(next.frame - previous.frame);
+
+    CameraKeyframe keyframe;
+    keyframe.frame = frame;
+    keyframe.position = glm::mix(previous.position, next.position, t);
+    keyframe.yaw = glm::mix(previous.yaw, next.yaw, t);
+    keyframe.pitch = glm::mix(previous.pitch, next.pitch, t);
+    return keyframe;
+}
+
+// Nearest rank percentile of sorted times
+static double get_percentile(const std::vector<double>& sorted_times, double percentile) {
+    int rank = (int)std::ceil(percentile / 100.0 * sorted_times.size());
+    rank = std::clamp(rank, 1, (int)sorted_times.size());
+    return sorted_times[rank - 1];
+}
+
+FrameTimeStatistics compute_frame_time_statistics(std::vector<double> times_ms) {
+    FrameTimeStatistics statistics;
+    if (times_ms.empty()) {
+        return statistics;
+    }
+
+    std::sort(times_ms.begin(), times_ms.end());
+    double sum = 0.0;
+    for (int i = 0; i < times_ms.size(); i++) {
+        sum += times_ms[i];
+    }
+    statistics.min = times_ms.front();
+    statistics.max = times_ms.back();
+    statistics.mean = sum / times_ms.size();
+    statistics.p50 = get_percentile(times_ms, 50.0);
+    statistics.p95 = get_percentile(times_ms, 95.0);
+    statistics.p99 = get_percentile(times_ms, 99.0);
+    return statistics;
+}
+
+static void write_statistics_json(std::ofstream& file, const std::string& name, const FrameTimeStatistics& statistics, bool last) {
+    file << "    \"" << name << "\": { \"min\": " << statistics.min << ", \"mean\": " << statistics.mean << ", \"p50\": " << statistics.p50
+        << ", \"p95\": " << statistics.p95 << ", \"p99\": " << statistics.p99 << ", \"max\": " << statistics.max << " }" << (last ? "" : ",") << std::endl;
+}
+
+static void write_gl_counters_json(std::ofstream& file, const std::string& name, const GLCounters& counters, int num_frames, bool last) {
+    file << "    \"" << name << "\": { \"draw_calls\": " << (double)counters.draw_calls / num_frames << ", \"triangles\": " << (double)counters.triangles / num_frames
+        << ", \"dispatches\": " << (double)counters.dispatches / num_frames << ", \"program_binds\": " << (double)counters.program_binds / num_frames
+        << ", \"texture_binds\": " << (double)counters.texture_binds / num_frames << ", \"vertex_array_binds\": " << (double)counters.vertex_array_binds / num_frames
+        << ", \"framebuffer_binds\": " << (double)counters.framebuffer_binds / num_frames << ", \"uniform_uploads\": " << (double)counters.uniform_uploads / num_frames
+        << ", \"buffer_uploads\": " << (double)counters.buffer_uploads / num_frames << ", \"buffer_upload_bytes\": " << (double)counters.buffer_upload_bytes / num_frames
+        << ", \"texture_uploads\": " << (double)counters.texture_uploads / num_frames << " }" << (last ? "" : ",") << std::endl;
+}
+
+bool write_benchmark_report(const std::string& prefix, const BenchmarkResults& results) {
+    std::ofstream csv_file(prefix + ".csv");
+    if (!csv_file.is_open()) {
+        std::cout << "ERROR::BENCHMARK:: Couldn't write " << prefix << ".csv" << std::endl;
+        return false;
+    }
+    // a pass that isn't rendered in a frame (e.g. bloom when it's disabled) takes 0 ms
+    std::set<std::string> pass_names;
+    for (int i = 0; i < results.pass_gpu_times_ms.size(); i++) {
+        for (auto it = results.pass_gpu_times_ms[i].begin(); it != results.pass_gpu_times_ms[i].end(); it++) {
+            pass_names.insert(it->first);
+        }
+    }
+    csv_file << std::fixed << std::setprecision(4);
+    csv_file << "frame,cpu_ms,gpu_ms,frame_ms";
+    for (auto it = pass_names.begin(); it != pass_names.end(); it++) {
+        csv_file << "," << *it << "_gpu_ms";
+    }
+    if (results.has_gl_counters) {
+        csv_file << ",draw_calls,triangles,dispatches,program_binds,texture_binds,vertex_array_binds,framebuffer_binds,uniform_uploads,buffer_uploads,buffer_upload_bytes,texture_uploads";
+    }
+    csv_file << std::endl;
+    for (int i = 0; i < results.frame_times_ms.size(); i++) {
+        csv_file << i << "," << results.cpu_times_ms[i] << "," << results.gpu_times_ms[i] << "," << results.frame_times_ms[i];
+        for (auto it = pass_names.begin(); it != pass_names.end(); it++) {
+            double pass_time_ms = 0.0;
+            if (i < results.pass_gpu_times_ms.size() && results.pass_gpu_times_ms[i].count(*it) > 0) {
+                pass_time_ms = results.pass_gpu_times_ms[i].at(*it);
+            }
+            csv_file << "," << pass_time_ms;
+        }
+        if (results.has_gl_counters) {
+            const GLCounters& counters = results.frame_gl_counters[i];
+            csv_file << "," << counters.draw_calls << "," << counters.triangles << "," << counters.dispatches << "," << counters.program_binds
+                << "," << counters.texture_binds << "," << counters.vertex_array_binds << "," << counters.framebuffer_binds << "," << counters.uniform_uploads
+                << "," << counters.buffer_uploads << "," << counters.buffer_upload_bytes << "," << counters.texture_uploads;
+        }
+        csv_file << std::endl;
+    }
+
+    std::ofstream json_file(prefix + ".json");
+    if (!json_file.is_open()) {
+        std::cout << "ERROR::BENCHMARK:: Couldn't write " << prefix << ".json" << std::endl;
+        return false;
+    }
+    FrameTimeStatistics cpu_statistics = compute_frame_time_statistics(results.cpu_times_ms);
+    FrameTimeStatistics gpu_statistics = compute_frame_time_statistics(results.gpu_times_ms);
+    FrameTimeStatistics frame_statistics = compute_frame_time_statistics(results.frame_times_ms);
+    json_file << std::fixed << std::setprecision(4);
+    json_file << "{" << std::endl;
+    json_file << "  \"scene\": \"" << results.scene_name << "\"," << std::endl;
+    json_file << "  \"camera_path\": \"" << results.camera_path << "\"," << std::endl;
+    json_file << "  \"width\": " << results.width << "," << std::endl;
+    json_file << "  \"height\": " << results.height << "," << std::endl;
+    json_file << "  \"frames\": " << results.frame_times_ms.size() << "," << std::endl;
+    json_file << "  \"frame_time_step_seconds\": " << BENCHMARK_FRAME_TIME_SECONDS << "," << std::endl;
+    json_file << "  \"gpu_memory_bytes\": " << results.gpu_memory_bytes << "," << std::endl;
+    json_file << "  \"cpu_memory_bytes\": " << results.cpu_memory_bytes << "," << std::endl;
+    json_file << "  \"statistics_ms\": {" << std::endl;
+    write_statistics_json(json_file, "cpu", cpu_statistics, false);
+    write_statistics_json(json_file, "gpu", gpu_statistics, false);
+    write_statistics_json(json_file, "frame", frame_statistics, true);
+    json_file << "  }," << std::endl;
+    json_file << "  \"pass_gpu_statistics_ms\": {" << std::endl;
+    for (auto it = pass_names.begin(); it != pass_names.end(); it++) {
+        std::vector<double> pass_times_ms;
+        for (int i = 0; i < results.pass_gpu_times_ms.size(); i++) {
+            if (results.pass_gpu_times_ms[i].count(*it) > 0) {
+                pass_times_ms.push_back(results.pass_gpu_times_ms[i].at(*it));
+            }
+        }
+        write_statistics_json(json_file, *it, compute_frame_time_statistics(pass_times_ms), std::next(it) == pass_names.end());
+    }
+    if (results.has_gl_counters) {
+        json_file << "  }," << std::endl;
+        // means per frame of the counters, of the whole frame and of every pass
+        int num_frames = std::max((int)results.frame_gl_counters.size(), 1);
+        GLCounters frame_counters;
+        std::map<std::string, GLCounters> pass_counters;
+        for (int i = 0; i < results.frame_gl_counters.size(); i++) {
+            frame_counters += results.frame_gl_counters[i];
+        }
+        for (int i = 0; i < results.pass_gl_counters.size(); i++) {
+            for (auto it = results.pass_gl_counters[i].begin(); it != results.pass_gl_counters[i].end(); it++) {
+                pass_counters[it->first] += it->second;
+            }
+        }
+        json_file << "  \"gl_counters_per_frame\": {" << std::endl;
+        write_gl_counters_json(json_file, "frame", frame_counters, num_frames, pass_counters.empty());
+        for (auto it = pass_counters.begin(); it != pass_counters.end(); it++) {
+            write_gl_counters_json(json_file, it->first, it->second, num_frames, std::next(it) == pass_counters.end());
+        }
+    }
+    json_file << "  }" << std::endl;
+    json_file << "}" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCHMARK: " << results.frame_times_ms.size() << " FRAMES, CPU p50 " << cpu_statistics.p50 << " ms p99 " << cpu_statistics.p99
+        << " ms, GPU p50 " << gpu_statistics.p50 << " ms p99 " << gpu_statistics.p99 << " ms, FRAME p50 " << frame_statistics.p50
+        << " ms p99 " << frame_statistics.p99 << " ms" << std::endl;
+    std::cout << std::defaultfloat;
+    return true;
+}
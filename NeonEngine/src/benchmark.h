@@ -0,0 +1,63 @@
+#pragma once
+
+#include "gl_counters.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+
+// Time step of the animations in a benchmark, the same frames are rendered whatever the speed of the machine
+const float BENCHMARK_FRAME_TIME_SECONDS = 1.0f / 60.0f;
+// Frames rendered at the first keyframe before the measured ones, so that the first uses of the shaders aren't measured
+const int BENCHMARK_WARMUP_FRAMES = 10;
+// Frames between two keyframes of a recorded camera path
+const int CAMERA_PATH_RECORD_INTERVAL = 10;
+
+struct CameraKeyframe {
+    int frame;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// Camera path file: one keyframe per line, "frame x y z yaw pitch" sorted by frame, the lines starting with # are comments.
+// Between two keyframes the position, yaw and pitch are interpolated linearly.
+bool load_camera_path(const std::string& path, std::vector<CameraKeyframe>& keyframes);
+bool save_camera_path(const std::string& path, const std::vector<CameraKeyframe>& keyframes);
+CameraKeyframe interpolate_camera_path(const std::vector<CameraKeyframe>& keyframes, int frame);
+
+struct FrameTimeStatistics {
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+FrameTimeStatistics compute_frame_time_statistics(std::vector<double> times_ms);
+
+// Times in milliseconds of every measured frame: CPU time to submit it, GPU time to execute it, and total time until it's finished
+struct BenchmarkResults {
+    std::string scene_name;
+    std::string camera_path;
+    int width = 0;
+    int height = 0;
+    std::vector<double> cpu_times_ms;
+    std::vector<double> gpu_times_ms;
+    std::vector<double> frame_times_ms;
+    // GPU times of the profiler scopes of every frame, by scope name
+    std::vector<std::map<std::string, double>> pass_gpu_times_ms;
+    // GL calls of every frame and of its passes, when the GL counters are installed
+    bool has_gl_counters = false;
+    std::vector<GLCounters> frame_gl_counters;
+    std::vector<std::map<std::string, GLCounters>> pass_gl_counters;
+    // Memory of the resources after the last frame, see resource_registry.h
+    size_t gpu_memory_bytes = 0;
+    size_t cpu_memory_bytes = 0;
+};
+
+// <prefix>.csv has a row per frame (with a column per pass) and <prefix>.json the statistics
+bool write_benchmark_report(const std::string& prefix, const BenchmarkResults& results);
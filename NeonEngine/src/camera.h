@@ -111,6 +111,15 @@ public:
             Zoom = 45.0f;
     }
 
+    // places the camera at a position with the given Euler angles, e.g. a keyframe of a camera path
+    void SetPose(glm::vec3 position, float yaw, float pitch)
+    {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
 private:
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
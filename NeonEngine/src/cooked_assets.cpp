@@ -0,0 +1,55 @@
+#include "cooked_assets.h"
+
+#include "opengl_utils.h"
+
+#include <filesystem>
+#include <iostream>
+
+static bool cooked_assets_enabled = false;
+
+void set_use_cooked_assets(bool use_cooked_assets) {
+    cooked_assets_enabled = use_cooked_assets;
+}
+
+bool get_use_cooked_assets() {
+    return cooked_assets_enabled;
+}
+
+std::string get_cooked_asset_path(const std::string& source_path, const std::string& extension) {
+    std::filesystem::path path = std::filesystem::path(source_path).lexically_normal();
+    if (path.is_absolute()) {
+        path = path.lexically_relative(std::filesystem::current_path());
+    }
+    return COOKED_ASSETS_DIRECTORY + "/" + path.generic_string() + extension;
+}
+
+bool load_cooked_image_data(const std::string& source_path, ImageData& image, bool flip_vertically) {
+    std::string cooked_path = get_cooked_asset_path(source_path, COOKED_TEXTURE_EXTENSION);
+    if (!std::filesystem::exists(cooked_path)) {
+        std::cout << "WARNING::COOKED_ASSETS:: No cooked texture for " << source_path << std::endl;
+        return false;
+    }
+    Ktx2Texture* texture = new Ktx2Texture();
+    auto flip_entry = texture->key_values.end();
+    if (read_ktx2_file(cooked_path, *texture)) {
+        flip_entry = texture->key_values.find(COOKED_TEXTURE_FLIP_KEY);
+    }
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture->format);
+    if (flip_entry == texture->key_values.end() || (flip_entry->second == "1") != flip_vertically || format_info == nullptr || texture->num_faces != 1) {
+        std::cout << "WARNING::COOKED_ASSETS:: The cooked texture " << cooked_path << " can't be used" << std::endl;
+        delete texture;
+        return false;
+    }
+    image.width = texture->width;
+    image.height = texture->height;
+    image.num_channels = format_info->num_channels;
+    image.cooked_texture = texture;
+    return true;
+}
+
+bool load_cooked_hdri(const std::string& source_path, CookedCubemapData& cubemap_data) {
+    return read_ktx2_file(get_cooked_asset_path(source_path, COOKED_ENVIRONMENT_MAP_EXTENSION), cubemap_data.environment_map) &&
+        read_ktx2_file(get_cooked_asset_path(source_path, COOKED_IRRADIANCE_MAP_EXTENSION), cubemap_data.irradiance_map) &&
+        read_ktx2_file(get_cooked_asset_path(source_path, COOKED_PREFILTER_MAP_EXTENSION), cubemap_data.prefilter_map) &&
+        cubemap_data.environment_map.num_faces == 6 && cubemap_data.irradiance_map.num_faces == 6 && cubemap_data.prefilter_map.num_faces == 6;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ktx2.h"
+
+#include <string>
+
+struct ImageData;
+
+// Runtime-ready assets written by the NeonCooker executable (see asset_cooker.h). The cooked files mirror the paths of their sources:
+// models/mutant/mutant.gltf -> cooked/models/mutant/mutant.gltf.nmdl, materials/gold/albedo.png -> cooked/materials/gold/albedo.png.ktx2
+const std::string COOKED_ASSETS_DIRECTORY = "cooked";
+const std::string COOKED_MODEL_EXTENSION = ".nmdl";
+const std::string COOKED_TEXTURE_EXTENSION = ".ktx2";
+const std::string COOKED_ENVIRONMENT_MAP_EXTENSION = ".environment.ktx2";
+const std::string COOKED_IRRADIANCE_MAP_EXTENSION = ".irradiance.ktx2";
+const std::string COOKED_PREFILTER_MAP_EXTENSION = ".prefilter.ktx2";
+// Key/value entry of the cooked textures, "1" when the image was flipped vertically while cooking
+const std::string COOKED_TEXTURE_FLIP_KEY = "NEONflipVertically";
+
+// Precomputed IBL cubemaps of an HDRI
+struct CookedCubemapData {
+    Ktx2Texture environment_map;
+    Ktx2Texture irradiance_map;
+    Ktx2Texture prefilter_map;
+};
+
+// With the --cooked command line option the engine loads the cooked assets instead of the sources,
+// the sources are only used (with a warning) for the assets that weren't cooked
+void set_use_cooked_assets(bool use_cooked_assets);
+bool get_use_cooked_assets();
+
+std::string get_cooked_asset_path(const std::string& source_path, const std::string& extension);
+// Reads the cooked texture of an image, fails when it doesn't exist or it was cooked with a different vertical flip
+bool load_cooked_image_data(const std::string& source_path, ImageData& image, bool flip_vertically);
+bool load_cooked_hdri(const std::string& source_path, CookedCubemapData& cubemap_data);
@@ -0,0 +1,39 @@
+#include "asset_cooker.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+// NeonCooker: converts the assets of the working directory (models/, materials/ and HDRIs/) to cooked/
+// Usage: NeonCooker [--force] [--threads N] [--bc1 | --uncompressed]
+int main(int argc, char** argv) {
+    bool force_rebuild = false;
+    int num_worker_threads = 0;
+    TextureCompression texture_compression = CompressBC7;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--force") {
+            force_rebuild = true;
+        }
+        else if (argument == "--threads" && i + 1 < argc) {
+            num_worker_threads = std::atoi(argv[++i]);
+        }
+        else if (argument == "--bc1") {
+            texture_compression = CompressBC1;
+        }
+        else if (argument == "--uncompressed") {
+            texture_compression = CompressNone;
+        }
+        else {
+            std::cout << "Usage: NeonCooker [--force] [--threads N] [--bc1 | --uncompressed]" << std::endl;
+            std::cout << "  --force         cook all the assets, even the ones that are up to date" << std::endl;
+            std::cout << "  --threads N     number of worker threads (default: hardware threads - 1)" << std::endl;
+            std::cout << "  --bc1           color textures in BC1/BC3 instead of BC7" << std::endl;
+            std::cout << "  --uncompressed  textures without block compression" << std::endl;
+            return 1;
+        }
+    }
+
+    AssetCooker asset_cooker(force_rebuild, num_worker_threads, texture_compression);
+    return asset_cooker.run() ? 0 : 1;
+}
@@ -1,14 +1,19 @@
 #pragma once
 
+#include "spherical_harmonics.h"
+
 #include <unordered_map>
 #include <string>
 #include <vector>
 
 class Shader;
 
+// Mip levels of the prefilter maps, one per roughness step
+const unsigned int PREFILTER_MAP_MIP_LEVELS = 5;
+
 unsigned int load_cubemap_textures(const std::vector<std::string>& cubemap_textures);
 
-enum CubemapTextureType {
+enum CubemapTextureType : int {
     EnvironmentMap,
     IrradianceMap,
     PrefilterMap
@@ -17,10 +22,12 @@ enum CubemapTextureType {
 std::string cubemap_texture_type_to_string(CubemapTextureType type);
 
 struct CubemapData {
-    unsigned int environment_texture;
-    unsigned int irradiance_texture;
-    unsigned int prefilter_texture;
-    bool is_hdri;
+    unsigned int environment_texture = 0;
+    unsigned int irradiance_texture = 0;
+    unsigned int prefilter_texture = 0;
+    bool is_hdri = false;
+    // Diffuse irradiance of the environment map, an alternative to the irradiance map
+    glm::vec3 irradiance_sh[NUM_SH_COEFFICIENTS] = {};
 };
 
 class Cubemap {
@@ -0,0 +1,187 @@
+#include "entity_store.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+EntityStore* EntityStore::instance = nullptr;
+std::mutex EntityStore::entity_store_mutex;
+
+EntityStore* EntityStore::get_instance()
+{
+    std::lock_guard<std::mutex> lock(entity_store_mutex);
+    if (instance == nullptr) {
+        instance = new EntityStore();
+    }
+    return instance;
+}
+
+// Removes the component at index, moving the last one into it
+template<typename T>
+static void remove_swapping_last(std::vector<T>& components, int index) {
+    components[index] = components.back();
+    components.pop_back();
+}
+
+Entity EntityStore::create() {
+    Entity entity;
+    if (!free_ids.empty()) {
+        entity.id = free_ids.back();
+        free_ids.pop_back();
+    }
+    else {
+        entity.id = (uint32_t)generations.size();
+        generations.push_back(1);
+        entity_indices.push_back(-1);
+    }
+    entity.generation = generations[entity.id];
+    entity_indices[entity.id] = (int)entity_ids.size();
+    entity_ids.push_back(entity.id);
+
+    positions.push_back(glm::vec3(0.0f));
+    rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    scales.push_back(glm::vec3(1.0f));
+    models.push_back(glm::mat4(1.0f));
+    model_invs.push_back(glm::mat4(1.0f));
+    model_normals.push_back(glm::mat3(1.0f));
+    dirty_transforms.push_back(1);
+    render_models.push_back(nullptr);
+    materials.push_back(nullptr);
+    albedos.push_back(glm::vec3(1.0f));
+    metalnesses.push_back(0.9f);
+    roughnesses.push_back(0.1f);
+    emissions.push_back(glm::vec3(0.0f));
+    id_colors.push_back(glm::u8vec3(0));
+    render_only_ambient.push_back(0);
+    render_one_color.push_back(0);
+    rendered_in_scene.push_back(1);
+    light_indices.push_back(-1);
+    animation_ids.push_back(-1);
+    selected.push_back(0);
+    return entity;
+}
+
+void EntityStore::destroy(Entity entity) {
+    if (!is_alive(entity)) {
+        return;
+    }
+    int index = entity_indices[entity.id];
+    if (light_indices[index] != -1) {
+        remove_light(light_indices[index]);
+        light_indices[index] = -1;
+    }
+    int last_index = (int)entity_ids.size() - 1;
+    if (index != last_index) {
+        entity_indices[entity_ids[last_index]] = index;
+        if (light_indices[last_index] != -1) {
+            light_entity_indices[light_indices[last_index]] = index;
+        }
+    }
+    remove_swapping_last(entity_ids, index);
+    remove_swapping_last(positions, index);
+    remove_swapping_last(rotations, index);
+    remove_swapping_last(scales, index);
+    remove_swapping_last(models, index);
+    remove_swapping_last(model_invs, index);
+    remove_swapping_last(model_normals, index);
+    remove_swapping_last(dirty_transforms, index);
+    remove_swapping_last(render_models, index);
+    remove_swapping_last(materials, index);
+    remove_swapping_last(albedos, index);
+    remove_swapping_last(metalnesses, index);
+    remove_swapping_last(roughnesses, index);
+    remove_swapping_last(emissions, index);
+    remove_swapping_last(id_colors, index);
+    remove_swapping_last(render_only_ambient, index);
+    remove_swapping_last(render_one_color, index);
+    remove_swapping_last(rendered_in_scene, index);
+    remove_swapping_last(light_indices, index);
+    remove_swapping_last(animation_ids, index);
+    remove_swapping_last(selected, index);
+
+    // the generation 0 is kept for the null entity
+    generations[entity.id]++;
+    if (generations[entity.id] == 0) {
+        generations[entity.id] = 1;
+    }
+    entity_indices[entity.id] = -1;
+    free_ids.push_back(entity.id);
+}
+
+bool EntityStore::is_alive(Entity entity) {
+    return entity.generation != 0 && entity.id < generations.size() && generations[entity.id] == entity.generation;
+}
+
+int EntityStore::get_num_entities() {
+    return (int)entity_ids.size();
+}
+
+void EntityStore::add_light(Entity entity, LightType type) {
+    int index = entity_indices[entity.id];
+    if (light_indices[index] != -1) {
+        remove_light(light_indices[index]);
+    }
+    light_indices[index] = (int)light_types.size();
+    light_entity_indices.push_back(index);
+    light_types.push_back(type);
+    light_colors.push_back(albedos[index]);
+    light_intensities.push_back(1.0f);
+    light_ambients.push_back(glm::vec3(0.05f));
+    light_diffuses.push_back(glm::vec3(0.8f));
+    light_speculars.push_back(glm::vec3(1.0f));
+    if (type == LightDirectional) {
+        light_directions.push_back(glm::vec3(-1.0f));
+    }
+    else {
+        light_directions.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
+    }
+    if (type == LightSpot) {
+        light_constants.push_back(1.0f);
+        light_linears.push_back(0.09f);
+        light_quadratics.push_back(0.032f);
+    }
+    else {
+        light_constants.push_back(1.0f);
+        light_linears.push_back(0.045f);
+        light_quadratics.push_back(0.0075f);
+    }
+    light_inner_cut_off_angles.push_back(12.5f);
+    light_outer_cut_off_angles.push_back(15.0f);
+}
+
+int EntityStore::get_num_lights() {
+    return (int)light_types.size();
+}
+
+void EntityStore::remove_light(int light_index) {
+    int last_light_index = (int)light_types.size() - 1;
+    if (light_index != last_light_index) {
+        light_indices[light_entity_indices[last_light_index]] = light_index;
+    }
+    remove_swapping_last(light_entity_indices, light_index);
+    remove_swapping_last(light_types, light_index);
+    remove_swapping_last(light_colors, light_index);
+    remove_swapping_last(light_intensities, light_index);
+    remove_swapping_last(light_ambients, light_index);
+    remove_swapping_last(light_diffuses, light_index);
+    remove_swapping_last(light_speculars, light_index);
+    remove_swapping_last(light_directions, light_index);
+    remove_swapping_last(light_constants, light_index);
+    remove_swapping_last(light_linears, light_index);
+    remove_swapping_last(light_quadratics, light_index);
+    remove_swapping_last(light_inner_cut_off_angles, light_index);
+    remove_swapping_last(light_outer_cut_off_angles, light_index);
+}
+
+void EntityStore::update_transforms() {
+    for (int i = 0; i < dirty_transforms.size(); i++) {
+        if (!dirty_transforms[i]) {
+            continue;
+        }
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+        model *= glm::mat4_cast(rotations[i]);
+        model = glm::scale(model, scales[i]);
+        models[i] = model;
+        model_invs[i] = glm::inverse(model);
+        model_normals[i] = glm::mat3(glm::transpose(model_invs[i]));
+        dirty_transforms[i] = 0;
+    }
+}
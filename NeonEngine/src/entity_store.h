@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+class BaseModel;
+struct Material;
+
+// Entities of a scene, also the number of id colors of the color picking
+const int MAX_NUM_ENTITIES = 262144;
+
+enum LightType {
+    LightPoint,
+    LightDirectional,
+    LightSpot
+};
+
+// Identifier of an entity of the store, stale once the entity is destroyed. The default entity is null
+struct Entity {
+    uint32_t id = 0;
+    uint32_t generation = 0;
+};
+
+// Data-oriented storage of the components of the game objects: every component is a set of arrays (SoA) indexed by the
+// index of the entity, packed so the entities are always [0, get_num_entities()) and the loops over the scene (drawing,
+// light gathering, matrix updates) stream through contiguous memory. Destroying an entity moves the last one into its index,
+// so the indices change and the entities are kept by their identifiers. The light components are packed in their own arrays,
+// since few entities are lights; light_indices links an entity to its light and light_entity_indices a light to its entity.
+// The render components have everything the drawing needs, the loops over the scene don't go through the game objects.
+// GameObject keeps the cold data of the editor (names, type) and reaches its components through its entity.
+// GL thread only
+class EntityStore {
+public:
+    static EntityStore* get_instance();
+
+    EntityStore(EntityStore& other) = delete;
+    void operator=(const EntityStore&) = delete;
+
+    Entity create();
+    void destroy(Entity entity);
+    bool is_alive(Entity entity);
+    // Index in the component arrays, valid until an entity is destroyed
+    int get_index(Entity entity) {
+        return entity_indices[entity.id];
+    }
+    int get_num_entities();
+
+    // The light color is initialized with the albedo of the entity
+    void add_light(Entity entity, LightType type);
+    int get_num_lights();
+    // The lights are drawn with their light color
+    glm::vec3& get_albedo(int index) {
+        return light_indices[index] != -1 ? light_colors[light_indices[index]] : albedos[index];
+    }
+
+    void mark_transform_dirty(int index) {
+        dirty_transforms[index] = 1;
+    }
+    // Once per frame before the drawing: model matrix, its inverse and the matrix of the normals of the dirty transforms
+    // from their position, rotation and scale, in one pass over the transform arrays
+    void update_transforms();
+
+    // Transform components
+    std::vector<glm::vec3> positions;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> models;
+    std::vector<glm::mat4> model_invs;
+    std::vector<glm::mat3> model_normals;
+    std::vector<uint8_t> dirty_transforms;
+    // Render components, the objects of the gizmo and the skybox (drawn by the cubemap) aren't drawn with the scene
+    std::vector<BaseModel*> render_models;   // nullptr for the entities without model
+    std::vector<Material*> materials;
+    std::vector<glm::vec3> albedos;
+    std::vector<float> metalnesses;
+    std::vector<float> roughnesses;
+    std::vector<glm::vec3> emissions;
+    std::vector<glm::u8vec3> id_colors;
+    std::vector<uint8_t> render_only_ambient;
+    std::vector<uint8_t> render_one_color;
+    std::vector<uint8_t> rendered_in_scene;
+    std::vector<int> light_indices;      // -1 for the entities without light
+    // Animation components, -1 without animation
+    std::vector<int> animation_ids;
+    // Selection components
+    std::vector<uint8_t> selected;
+
+    // Light components
+    std::vector<int> light_entity_indices;
+    std::vector<LightType> light_types;
+    std::vector<glm::vec3> light_colors;
+    std::vector<float> light_intensities;
+    std::vector<glm::vec3> light_ambients;
+    std::vector<glm::vec3> light_diffuses;
+    std::vector<glm::vec3> light_speculars;
+    std::vector<glm::vec3> light_directions;     // directional and spot lights
+    std::vector<float> light_constants;          // attenuation of point and spot lights
+    std::vector<float> light_linears;
+    std::vector<float> light_quadratics;
+    std::vector<float> light_inner_cut_off_angles;   // spot lights, in degrees
+    std::vector<float> light_outer_cut_off_angles;
+
+private:
+    EntityStore() {}
+
+    void remove_light(int light_index);
+
+    static EntityStore* instance;
+    static std::mutex entity_store_mutex;
+
+    // Indexed by the identifiers of the entities
+    std::vector<int> entity_indices;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> free_ids;
+    // Identifier of the entity at each index
+    std::vector<uint32_t> entity_ids;
+};
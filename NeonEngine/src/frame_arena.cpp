@@ -0,0 +1,82 @@
+#include "frame_arena.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+FrameArena* FrameArena::instance = nullptr;
+std::mutex FrameArena::frame_arena_mutex;
+
+FrameArena* FrameArena::get_instance()
+{
+    std::lock_guard<std::mutex> lock(frame_arena_mutex);
+    if (instance == nullptr) {
+        instance = new FrameArena();
+    }
+    return instance;
+}
+
+FrameArena::FrameArena() {
+    memory = new unsigned char[FRAME_ARENA_SIZE];
+    capacity = FRAME_ARENA_SIZE;
+    offset = 0;
+    peak_size = 0;
+    overflow_size = 0;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    size_t aligned_offset = (offset + alignment - 1) / alignment * alignment;
+    if (aligned_offset + size <= capacity) {
+        offset = aligned_offset + size;
+        peak_size = std::max(peak_size, offset + overflow_size);
+        return memory + aligned_offset;
+    }
+    // the new[] blocks are aligned for any fundamental type
+    unsigned char* block = new unsigned char[size];
+    overflow_blocks.push_back(block);
+    overflow_size += size;
+    peak_size = std::max(peak_size, offset + overflow_size);
+    return block;
+}
+
+void FrameArena::reset() {
+    if (!overflow_blocks.empty()) {
+        for (int i = 0; i < overflow_blocks.size(); i++) {
+            delete[] overflow_blocks[i];
+        }
+        overflow_blocks.clear();
+        size_t new_capacity = std::max(capacity * 2, offset + overflow_size);
+        std::cout << "FRAME ARENA: GROWN FROM " << capacity << " TO " << new_capacity << " BYTES" << std::endl;
+        delete[] memory;
+        memory = new unsigned char[new_capacity];
+        capacity = new_capacity;
+        overflow_size = 0;
+    }
+    offset = 0;
+}
+
+const char* FrameArena::format(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    va_list arguments_copy;
+    va_copy(arguments_copy, arguments);
+    int length = std::vsnprintf(nullptr, 0, format, arguments);
+    va_end(arguments);
+    char* string = (char*)allocate(length + 1, 1);
+    std::vsnprintf(string, length + 1, format, arguments_copy);
+    va_end(arguments_copy);
+    return string;
+}
+
+size_t FrameArena::get_used_size() {
+    return offset + overflow_size;
+}
+
+size_t FrameArena::get_peak_size() {
+    return peak_size;
+}
+
+size_t FrameArena::get_capacity() {
+    return capacity;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+// Initial size of the arena, it grows at the start of a frame when the previous one didn't fit
+const size_t FRAME_ARENA_SIZE = 1024 * 1024;
+
+// Bump allocator for the transient data of a frame in the GL thread (names of uniforms, draw lists, sorted arrays...):
+// an allocation only advances an offset and everything is freed at once by reset() at the start of the next frame,
+// so the steady-state frames don't use the general heap. Nothing allocated in it can be kept after the frame.
+// A frame that doesn't fit gets extra blocks from the heap, and the arena is grown to the size of that frame on the next reset.
+// GL thread only
+class FrameArena {
+public:
+    static FrameArena* get_instance();
+
+    FrameArena(FrameArena& other) = delete;
+    void operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();
+    // printf-style string in the arena, e.g. frame_arena->format("pointLights[%d].position", i)
+    const char* format(const char* format, ...);
+
+    size_t get_used_size();
+    size_t get_peak_size();
+    size_t get_capacity();
+
+private:
+    FrameArena();
+
+    static FrameArena* instance;
+    static std::mutex frame_arena_mutex;
+
+    unsigned char* memory;
+    size_t capacity;
+    size_t offset;
+    size_t peak_size;
+    std::vector<unsigned char*> overflow_blocks;
+    size_t overflow_size;
+};
+
+// STL allocator on the frame arena, deallocating does nothing
+template<typename T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameAllocator() {}
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>& other) {}
+
+    T* allocate(size_t n) {
+        return (T*)FrameArena::get_instance()->allocate(n * sizeof(T), alignof(T));
+    }
+    void deallocate(T* pointer, size_t n) {}
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return false;
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
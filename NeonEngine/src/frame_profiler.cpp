@@ -0,0 +1,216 @@
+#include "frame_profiler.h"
+
+#include "trace_recorder.h"
+
+#include <iostream>
+
+FrameProfiler* FrameProfiler::instance = nullptr;
+std::mutex FrameProfiler::frame_profiler_mutex;
+
+FrameProfiler* FrameProfiler::get_instance()
+{
+    std::lock_guard<std::mutex> lock(frame_profiler_mutex);
+    if (instance == nullptr) {
+        instance = new FrameProfiler();
+    }
+    return instance;
+}
+
+void FrameProfiler::begin_frame() {
+    if (!enabled) {
+        return;
+    }
+    ALLOCATION_TAG(AllocProfiling);
+    ProfilerFrame& frame = frames[current_frame];
+    // its queries are reused, the GPU has usually finished them by now
+    if (frame.pending) {
+        resolve_frame(frame);
+    }
+    frame.scopes.clear();
+    frame.num_used_queries = 0;
+    frame_begin_time = std::chrono::high_resolution_clock::now();
+    frame_begin_gl_counters = gl_counters;
+    for (int i = 0; i < AllocTagLast; i++) {
+        frame_begin_allocations[i] = get_thread_allocation_counters((AllocationTag)i);
+    }
+    in_frame = true;
+
+    frame.traced = TraceRecorder::enabled;
+    if (frame.traced) {
+        // the GPU timestamps are converted to the clock of the trace with the GPU time of now
+        GLint64 gpu_time_ns = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_time_ns);
+        frame.trace_begin_us = TraceRecorder::now_us();
+        frame.gpu_to_trace_offset_us = frame.trace_begin_us - gpu_time_ns / 1000;
+    }
+}
+
+void FrameProfiler::end_frame() {
+    if (!in_frame) {
+        return;
+    }
+    ALLOCATION_TAG(AllocProfiling);
+    if (!open_scopes.empty()) {
+        std::cout << "ERROR::FRAME_PROFILER:: " << open_scopes.size() << " scopes weren't ended in the frame" << std::endl;
+        while (!open_scopes.empty()) {
+            end_scope();
+        }
+    }
+    frame_gl_counters = gl_counters - frame_begin_gl_counters;
+    for (int i = 0; i < AllocTagLast; i++) {
+        frame_allocations[i] = get_thread_allocation_counters((AllocationTag)i) - frame_begin_allocations[i];
+    }
+    frames[current_frame].pending = true;
+    current_frame = (current_frame + 1) % PROFILER_QUERY_BUFFERS;
+    in_frame = false;
+}
+
+void FrameProfiler::begin_scope(const char* name) {
+    if (!in_frame) {
+        return;
+    }
+    ALLOCATION_TAG(AllocProfiling);
+    ProfilerFrame& frame = frames[current_frame];
+    ProfileScopeQueries scope;
+    scope.name = name;
+    scope.depth = open_scopes.size();
+    scope.begin_query = allocate_query(frame);
+    scope.end_query = allocate_query(frame);
+    scope.cpu_begin_ms = get_cpu_time_ms();
+    scope.cpu_end_ms = scope.cpu_begin_ms;
+    scope.begin_gl_counters = gl_counters;
+    scope.begin_allocations = get_thread_allocation_counters();
+    glQueryCounter(scope.begin_query, GL_TIMESTAMP);
+    open_scopes.push_back(frame.scopes.size());
+    frame.scopes.push_back(scope);
+}
+
+void FrameProfiler::end_scope() {
+    if (!in_frame || open_scopes.empty()) {
+        return;
+    }
+    ALLOCATION_TAG(AllocProfiling);
+    ProfilerFrame& frame = frames[current_frame];
+    ProfileScopeQueries& scope = frame.scopes[open_scopes.back()];
+    open_scopes.pop_back();
+    glQueryCounter(scope.end_query, GL_TIMESTAMP);
+    scope.cpu_end_ms = get_cpu_time_ms();
+    scope.gl_counters = gl_counters - scope.begin_gl_counters;
+    scope.allocations = get_thread_allocation_counters() - scope.begin_allocations;
+    if (frame.traced) {
+        TraceRecorder::record(TraceRecorder::get_instance()->intern(scope.name), "render_pass", frame.trace_begin_us + (int64_t)(scope.cpu_begin_ms * 1000.0),
+            (int64_t)((scope.cpu_end_ms - scope.cpu_begin_ms) * 1000.0));
+    }
+}
+
+void FrameProfiler::resolve_pending_frames() {
+    // from the oldest frame in flight
+    for (int i = 0; i < PROFILER_QUERY_BUFFERS; i++) {
+        ProfilerFrame& frame = frames[(current_frame + i) % PROFILER_QUERY_BUFFERS];
+        if (frame.pending) {
+            resolve_frame(frame);
+        }
+    }
+}
+
+void FrameProfiler::clean() {
+    for (int i = 0; i < PROFILER_QUERY_BUFFERS; i++) {
+        if (!frames[i].queries.empty()) {
+            glDeleteQueries(frames[i].queries.size(), frames[i].queries.data());
+        }
+        frames[i] = ProfilerFrame();
+    }
+    open_scopes.clear();
+    in_frame = false;
+}
+
+const std::vector<PassTiming>& FrameProfiler::get_pass_timings() {
+    return pass_timings;
+}
+
+const GLCounters& FrameProfiler::get_frame_gl_counters() {
+    return frame_gl_counters;
+}
+
+const AllocationCounters& FrameProfiler::get_frame_allocations(AllocationTag tag) {
+    return frame_allocations[tag];
+}
+
+AllocationCounters FrameProfiler::get_frame_allocations() {
+    AllocationCounters allocations;
+    for (int i = 0; i < AllocTagLast; i++) {
+        if (i != AllocProfiling) {
+            allocations += frame_allocations[i];
+        }
+    }
+    return allocations;
+}
+
+unsigned int FrameProfiler::allocate_query(ProfilerFrame& frame) {
+    if (frame.num_used_queries == frame.queries.size()) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    return frame.queries[frame.num_used_queries++];
+}
+
+double FrameProfiler::get_cpu_time_ms() {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(std::chrono::high_resolution_clock::now() - frame_begin_time).count();
+}
+
+void FrameProfiler::resolve_frame(ProfilerFrame& frame) {
+    ALLOCATION_TAG(AllocProfiling);
+    frame.pending = false;
+    pass_timings.clear();
+    if (frame.scopes.empty()) {
+        return;
+    }
+
+    GLuint64 frame_begin_timestamp = 0;
+    glGetQueryObjectui64v(frame.scopes[0].begin_query, GL_QUERY_RESULT, &frame_begin_timestamp);
+    double frame_cpu_begin_ms = frame.scopes[0].cpu_begin_ms;
+    // a name used by several scopes of the frame gets the sum of their times in the history
+    std::map<std::string, float> cpu_frame_times;
+    std::map<std::string, float> gpu_frame_times;
+    for (int i = 0; i < frame.scopes.size(); i++) {
+        const ProfileScopeQueries& scope = frame.scopes[i];
+        GLuint64 begin_timestamp = 0;
+        GLuint64 end_timestamp = 0;
+        glGetQueryObjectui64v(scope.begin_query, GL_QUERY_RESULT, &begin_timestamp);
+        glGetQueryObjectui64v(scope.end_query, GL_QUERY_RESULT, &end_timestamp);
+
+        PassTiming timing;
+        timing.name = scope.name;
+        timing.depth = scope.depth;
+        timing.cpu_begin_ms = scope.cpu_begin_ms - frame_cpu_begin_ms;
+        timing.cpu_ms = scope.cpu_end_ms - scope.cpu_begin_ms;
+        timing.gpu_begin_ms = (begin_timestamp - frame_begin_timestamp) / 1000000.0;
+        timing.gpu_ms = (end_timestamp - begin_timestamp) / 1000000.0;
+        timing.gl_counters = scope.gl_counters;
+        timing.allocations = scope.allocations;
+        pass_timings.push_back(timing);
+
+        cpu_frame_times[scope.name] += timing.cpu_ms;
+        gpu_frame_times[scope.name] += timing.gpu_ms;
+
+        if (frame.traced) {
+            if (gpu_trace_track == nullptr) {
+                gpu_trace_track = TraceRecorder::get_instance()->create_track("GPU");
+            }
+            TraceRecorder::record(gpu_trace_track, TraceRecorder::get_instance()->intern(scope.name), "gpu",
+                (int64_t)(begin_timestamp / 1000) + frame.gpu_to_trace_offset_us, (int64_t)((end_timestamp - begin_timestamp) / 1000));
+        }
+    }
+
+    for (auto it = cpu_frame_times.begin(); it != cpu_frame_times.end(); it++) {
+        std::deque<float>& cpu_times = cpu_history[it->first];
+        std::deque<float>& gpu_times = gpu_history[it->first];
+        cpu_times.push_back(it->second);
+        gpu_times.push_back(gpu_frame_times[it->first]);
+        if (cpu_times.size() > PROFILER_HISTORY_FRAMES) {
+            cpu_times.pop_front();
+            gpu_times.pop_front();
+        }
+    }
+}
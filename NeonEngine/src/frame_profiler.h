@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+#include "gl_counters.h"
+#include "allocation_tracker.h"
+
+struct TraceBuffer;
+
+// Frames whose queries are in flight: the timings of a frame are read when its queries are reused, two frames later
+const int PROFILER_QUERY_BUFFERS = 2;
+// Frames kept in the history of every scope
+const int PROFILER_HISTORY_FRAMES = 240;
+
+// Timing of a scope in a frame, the begins are relative to the begin of the first scope of the frame (in milliseconds)
+struct PassTiming {
+    std::string name;
+    int depth;
+    double cpu_begin_ms;
+    double cpu_ms;
+    double gpu_begin_ms;
+    double gpu_ms;
+    // GL calls of the scope, counted while the GL counters are installed
+    GLCounters gl_counters;
+    // Heap allocations of the GL thread in the scope, counted while the allocation tracking is enabled
+    AllocationCounters allocations;
+};
+
+struct ProfileScopeQueries {
+    const char* name;
+    int depth;
+    unsigned int begin_query;
+    unsigned int end_query;
+    double cpu_begin_ms;
+    double cpu_end_ms;
+    GLCounters begin_gl_counters;
+    GLCounters gl_counters;
+    AllocationCounters begin_allocations;
+    AllocationCounters allocations;
+};
+
+struct ProfilerFrame {
+    std::vector<ProfileScopeQueries> scopes;
+    // Pool of timestamp queries, reused every time the frame is
+    std::vector<unsigned int> queries;
+    int num_used_queries = 0;
+    bool pending = false;
+    // With the trace recorder enabled the scopes are also recorded as trace events, the GPU ones on their own track
+    bool traced = false;
+    int64_t trace_begin_us = 0;
+    int64_t gpu_to_trace_offset_us = 0;
+};
+
+// Named nested timing scopes of the frames in the GL thread. Every scope measures the CPU time between its begin and
+// its end, and the GPU time between two timestamp queries (GL_TIME_ELAPSED queries can't be nested).
+// The queries are multi-buffered so reading them doesn't stall: the timings of a frame are resolved PROFILER_QUERY_BUFFERS
+// frames later, and get_pass_timings() returns those of the last resolved frame.
+class FrameProfiler {
+public:
+    static FrameProfiler* get_instance();
+
+    FrameProfiler(FrameProfiler& other) = delete;
+    void operator=(const FrameProfiler&) = delete;
+
+    // GL thread only
+    void begin_frame();
+    void end_frame();
+    // The name must be a literal, so the scopes don't allocate
+    void begin_scope(const char* name);
+    void end_scope();
+    // Resolves every frame in flight, waiting for their queries (the benchmark calls it after glFinish)
+    void resolve_pending_frames();
+    void clean();
+
+    const std::vector<PassTiming>& get_pass_timings();
+    // GL calls of the last ended frame (not delayed like the timings)
+    const GLCounters& get_frame_gl_counters();
+    // Heap allocations of the GL thread in the last ended frame, by tag
+    const AllocationCounters& get_frame_allocations(AllocationTag tag);
+    AllocationCounters get_frame_allocations();
+
+    bool enabled = true;
+    // Last PROFILER_HISTORY_FRAMES times of every scope name, in milliseconds
+    std::map<std::string, std::deque<float>> cpu_history;
+    std::map<std::string, std::deque<float>> gpu_history;
+
+private:
+    FrameProfiler() {}
+
+    unsigned int allocate_query(ProfilerFrame& frame);
+    double get_cpu_time_ms();
+    void resolve_frame(ProfilerFrame& frame);
+
+    static FrameProfiler* instance;
+    static std::mutex frame_profiler_mutex;
+
+    ProfilerFrame frames[PROFILER_QUERY_BUFFERS];
+    int current_frame = 0;
+    bool in_frame = false;
+    std::vector<int> open_scopes;
+    std::chrono::time_point<std::chrono::high_resolution_clock> frame_begin_time;
+    std::vector<PassTiming> pass_timings;
+    GLCounters frame_begin_gl_counters;
+    GLCounters frame_gl_counters;
+    AllocationCounters frame_begin_allocations[AllocTagLast];
+    AllocationCounters frame_allocations[AllocTagLast];
+    TraceBuffer* gpu_trace_track = nullptr;
+};
+
+// Times a block of the frame, e.g. { ProfileScope scope("bloom"); ... }
+struct ProfileScope {
+    ProfileScope(const char* name) {
+        FrameProfiler::get_instance()->begin_scope(name);
+    }
+    ~ProfileScope() {
+        FrameProfiler::get_instance()->end_scope();
+    }
+};
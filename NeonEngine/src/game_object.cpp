@@ -4,6 +4,8 @@
 #include "rendering.h"
 #include "base_model.h"
 #include "transform3d.h"
+#include "allocation_tracker.h"
+#include "frame_arena.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -14,160 +16,143 @@ const int MAX_NUMBER_BONES = 200;
 
 //////////////////////////////// GAME_OBJECT_TYPE //////////////////////////////////////
 
-std::string game_object_type_to_string(GameObjectType type) {
-    std::string game_object_type;
+// A string literal, the outliner calls it for every row of every frame
+const char* game_object_type_to_string(GameObjectType type) {
     if (type == TypeBaseModel) {
-        game_object_type = "BaseModel";
+        return "BaseModel";
     }
     else if (type == TypePointLight) {
-        game_object_type = "PointLight";
+        return "PointLight";
     }
     else if (type == TypeDirectionalLight) {
-        game_object_type = "DirectionalLight";
+        return "DirectionalLight";
     }
     else if (type == TypeSpotLight) {
-        game_object_type = "SpotLight";
+        return "SpotLight";
     }
     else if (type == TypeSkybox) {
-        game_object_type = "Skybox";
+        return "Skybox";
     }
-    else {
-        game_object_type = "UnrecognizedType";
-    }
-    return game_object_type;
+    return "UnrecognizedType";
 }
 
 //////////////////////////////// GAME_OBJECT //////////////////////////////////////
 
-ColorGenerator* GameObject::color_generator = new ColorGenerator(100000);
+ColorGenerator* GameObject::color_generator = new ColorGenerator(MAX_NUM_ENTITIES);
+EntityStore* GameObject::entity_store = EntityStore::get_instance();
+ObjectPool<GameObject> GameObject::pool;
 
 GameObject::GameObject(const std::string& name, const std::string& model_name) {
     this->name = name;
-    this->model_name = model_name;
     type = TypeBaseModel;
-    position = glm::vec3(0.0f);
-    rotation = glm::angleAxis(glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    scale = glm::vec3(1.0f);
-    albedo = glm::vec3(1.0f);
-    metalness = 0.9f;
-    roughness = 0.1f;
-    emission = glm::vec3(0.0f);
-    animation_id = -1;
-    is_selected = false;
-    render_only_ambient = false;
-    render_one_color = false;
-    material = nullptr;
-    id_color = color_generator->generate_color();
-
-    set_model_matrices_standard();
+    cubemap_name = "";
+    entity = entity_store->create();
+    id_color() = color_generator->generate_color();
+    set_model(model_name);
 }
 
 GameObject::~GameObject() {
 
 }
 
-void GameObject::set_model_matrices_standard() {
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    model *= glm::mat4_cast(rotation);
-    model = glm::scale(model, scale);
-
-    model_inv = glm::inverse(model);
+void GameObject::set_model(const std::string& model_name) {
+    Rendering* rendering = Rendering::get_instance();
+    this->model_name = model_name;
+    BaseModel* render_model = nullptr;
+    if (model_name != "") {
+        auto it = rendering->loaded_models.find(model_name);
+        if (it != rendering->loaded_models.end()) {
+            render_model = it->second;
+        }
+        else {
+            std::cout << "ERROR::GAME_OBJECT::MODEL_NOT_LOADED: " << model_name << std::endl;
+        }
+    }
+    entity_store->render_models[entity_store->get_index(entity)] = render_model;
+}
 
-    model_normals = glm::mat3(glm::transpose(model_inv));
+void GameObject::set_model_matrices_standard() {
+    entity_store->mark_transform_dirty(entity_store->get_index(entity));
 }
 
 void GameObject::draw(Shader* shader, bool disable_depth_test) {
+    draw_entity(entity_store->get_index(entity), shader, disable_depth_test);
+}
+
+void GameObject::draw_entity(int index, Shader* shader, bool disable_depth_test) {
     Rendering* rendering = Rendering::get_instance();
+    glm::u8vec3 id_color = entity_store->id_colors[index];
 
-    shader->setVec3("albedo_model", albedo);
-    shader->setFloat("metalness_model", metalness);
-    shader->setFloat("roughness_model", roughness);
-    shader->setVec3("emission_model", emission);
+    shader->setVec3("albedo_model", entity_store->get_albedo(index));
+    shader->setFloat("metalness_model", entity_store->metalnesses[index]);
+    shader->setFloat("roughness_model", entity_store->roughnesses[index]);
+    shader->setVec3("emission_model", entity_store->emissions[index]);
 
-    shader->setMat4("model", model);
-    shader->setMat3("model_normals", model_normals);
+    shader->setMat4("model", entity_store->models[index]);
+    shader->setMat3("model_normals", entity_store->model_normals[index]);
 
     glUniform3ui(glGetUniformLocation(shader->ID, "id_color_game_object"), id_color.r, id_color.g, id_color.b);
 
-    if (model_name != "") {
-        if (this->animation_id != -1) { // There is an animation specified for the model of this game object
-            auto current_time = std::chrono::system_clock::now();
-            std::chrono::duration<float> elapsed_seconds = current_time - rendering->time_before_rendering;
-            rendering->loaded_models[model_name]->update_bone_transformations(elapsed_seconds.count(), this->animation_id);
+    BaseModel* render_model = entity_store->render_models[index];
+    if (render_model != nullptr) {
+        int animation_id = entity_store->animation_ids[index];
+        if (animation_id != -1) { // There is an animation specified for the model of this game object
+            ALLOCATION_TAG(AllocAnimation);
+            FrameArena* frame_arena = FrameArena::get_instance();
+            render_model->update_bone_transformations(rendering->get_animation_time_seconds(), animation_id);
             shader->setInt("is_animated", true);
-            assert(rendering->loaded_models[model_name]->bones.size() <= MAX_NUMBER_BONES);
-            for (int i = 0; i < rendering->loaded_models[model_name]->bones.size(); i++) {
+            assert(render_model->bones.size() <= MAX_NUMBER_BONES);
+            for (int i = 0; i < render_model->bones.size(); i++) {
                 glm::mat4 glm_matrix;
-                std::memcpy(glm::value_ptr(glm_matrix), &(rendering->loaded_models[model_name]->bones[i].final_transformation), sizeof(aiMatrix4x4));
+                std::memcpy(glm::value_ptr(glm_matrix), &(render_model->bones[i].final_transformation), sizeof(aiMatrix4x4));
                 glm_matrix = glm::transpose(glm_matrix);
-                shader->setMat4("bone_transforms[" + std::to_string(i) + "]", glm_matrix);
+                shader->setMat4(frame_arena->format("bone_transforms[%d]", i), glm_matrix);
             }
         }
         else {
             shader->setInt("is_animated", false);
         }
-        rendering->loaded_models[model_name]->draw(shader, material, is_selected, disable_depth_test, render_only_ambient, render_one_color);
+        render_model->draw(shader, entity_store->materials[index], entity_store->selected[index], disable_depth_test,
+                           entity_store->render_only_ambient[index], entity_store->render_one_color[index]);
     }
 }
 
 bool GameObject::intersected_ray(const glm::vec3& ray_dir, const glm::vec3& camera_position, float& t) {
-    Rendering* rendering = Rendering::get_instance();
-    glm::vec3 ray_dir_model = model_inv * glm::vec4(ray_dir, 0.0f);
-    glm::vec3 ray_origin_model = model_inv * glm::vec4(camera_position, 1.0f);
-    if (model_name != "" && rendering->loaded_models[model_name]->intersected_ray(ray_origin_model, ray_dir_model, t)) {
+    BaseModel* render_model = entity_store->render_models[entity_store->get_index(entity)];
+    glm::vec3 ray_dir_model = model_inv() * glm::vec4(ray_dir, 0.0f);
+    glm::vec3 ray_origin_model = model_inv() * glm::vec4(camera_position, 1.0f);
+    if (render_model != nullptr && render_model->intersected_ray(ray_origin_model, ray_dir_model, t)) {
         return true;
     }
     return false;
 }
 
 void GameObject::set_select_state(bool is_game_obj_selected) {
-    is_selected = is_game_obj_selected;
-}
-
-void GameObject::clean() {
-    delete color_generator;
-}
-
-//////////////////////////////// SKYBOX ////////////////////////////////
-
-Skybox::Skybox(const std::string& name) : GameObject(name, "") {
-    cubemap_name = "";
-}
-
-//////////////////////////////// LIGHTS ////////////////////////////////
-
-Light::Light(const std::string& name, const std::string& model_name) : GameObject(name, model_name) {
-    ambient = glm::vec3(0.05f);
-    diffuse = glm::vec3(0.8f);
-    specular = glm::vec3(1.0f);
-}
-
-PointLight::PointLight(const std::string& name, const std::string& model_name) : Light(name, model_name) {
-    constant = 1.0f;
-    linear = 0.045f;
-    quadratic = 0.0075f;
+    entity_store->selected[entity_store->get_index(entity)] = is_game_obj_selected;
 }
 
-DirectionalLight::DirectionalLight(const std::string& name, const std::string& model_name) : Light(name, model_name) {
-    direction = glm::vec3(-1.0f);
+GameObject* GameObject::create_light(const std::string& name, const std::string& model_name, GameObjectType type) {
+    assert((type == TypePointLight || type == TypeDirectionalLight || type == TypeSpotLight) && "create_light needs a light type");
+    GameObject* light = pool.create(name, model_name);
+    light->type = type;
+    if (type == TypePointLight) {
+        entity_store->add_light(light->entity, LightPoint);
+    }
+    else if (type == TypeDirectionalLight) {
+        entity_store->add_light(light->entity, LightDirectional);
+    }
+    else {
+        entity_store->add_light(light->entity, LightSpot);
+    }
+    return light;
 }
 
-SpotLight::SpotLight(const std::string& name, const std::string& model_name) : Light(name, model_name) {
-    direction = glm::vec3(0.0f, 0.0f, -1.0f);
-
-    inner_cut_off_angle = 12.5f;
-    outer_cut_off_angle = 15.0f;
-
-    constant = 1.0f;
-    linear = 0.09f;
-    quadratic = 0.032f;
+void GameObject::destroy(GameObject* game_object) {
+    color_generator->return_color(game_object->id_color());
+    entity_store->destroy(game_object->entity);
+    pool.destroy(game_object);
 }
 
-float SpotLight::get_inner_cut_off() {
-    return glm::cos(glm::radians(inner_cut_off_angle));
+void GameObject::clean() {
+    delete color_generator;
 }
-
-float SpotLight::get_outer_cut_off() {
-    return glm::cos(glm::radians(outer_cut_off_angle));
-}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "mesh.h"
+#include "object_pool.h"
+#include "entity_store.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -9,6 +11,7 @@
 #include <string>
 #include <random>
 #include <iostream>
+#include <cassert>
 
 class Rendering;
 class Shader;
@@ -24,89 +27,83 @@ enum GameObjectType {
     TypeSkybox
 };
 
-std::string game_object_type_to_string(GameObjectType type);
+const char* game_object_type_to_string(GameObjectType type);
 
 class GameObject {
 public:
     std::string name;
+    // Set with set_model(), which also sets the model of the render component
     std::string model_name;
     GameObjectType type;
-    glm::vec3 position;
-    glm::vec3 scale;
-    glm::quat rotation;
-    glm::mat4 model;
-    glm::mat4 model_inv;
-    glm::mat3 model_normals;
-    glm::vec3 albedo;
-    float metalness;
-    float roughness;
-    glm::vec3 emission;
-    glm::u8vec3 id_color;
-    bool is_selected;
-    bool render_only_ambient;
-    bool render_one_color;
-    int animation_id;
-    Material* material;
+    // Skybox only
+    std::string cubemap_name;
+    // Transform, render, light, animation and selection components of the game object
+    Entity entity;
 
     static ColorGenerator* color_generator;
+    static EntityStore* entity_store;
+    // The game objects are created with pool.create(...) (or create_light()) and destroyed with destroy()
+    static ObjectPool<GameObject> pool;
 
     GameObject(const std::string& name, const std::string& model_name);
     ~GameObject();
+
+    // The references to the components are valid until a game object is destroyed
+    glm::vec3& position() { return entity_store->positions[entity_store->get_index(entity)]; }
+    glm::quat& rotation() { return entity_store->rotations[entity_store->get_index(entity)]; }
+    glm::vec3& scale() { return entity_store->scales[entity_store->get_index(entity)]; }
+    glm::mat4& model() { return entity_store->models[entity_store->get_index(entity)]; }
+    glm::mat4& model_inv() { return entity_store->model_invs[entity_store->get_index(entity)]; }
+    glm::mat3& model_normals() { return entity_store->model_normals[entity_store->get_index(entity)]; }
+    int& animation_id() { return entity_store->animation_ids[entity_store->get_index(entity)]; }
+    bool is_selected() { return entity_store->selected[entity_store->get_index(entity)]; }
+
+    // Render components, the albedo of a light is its light color
+    Material*& material() { return entity_store->materials[entity_store->get_index(entity)]; }
+    glm::vec3& albedo() { return entity_store->get_albedo(entity_store->get_index(entity)); }
+    float& metalness() { return entity_store->metalnesses[entity_store->get_index(entity)]; }
+    float& roughness() { return entity_store->roughnesses[entity_store->get_index(entity)]; }
+    glm::vec3& emission() { return entity_store->emissions[entity_store->get_index(entity)]; }
+    glm::u8vec3& id_color() { return entity_store->id_colors[entity_store->get_index(entity)]; }
+    uint8_t& render_only_ambient() { return entity_store->render_only_ambient[entity_store->get_index(entity)]; }
+    uint8_t& render_one_color() { return entity_store->render_one_color[entity_store->get_index(entity)]; }
+    uint8_t& rendered_in_scene() { return entity_store->rendered_in_scene[entity_store->get_index(entity)]; }
+
+    // Light components, only for the game objects created by create_light(). light_index() is -1 for the other ones
+    int light_index() { return entity_store->light_indices[entity_store->get_index(entity)]; }
+    float& intensity() { return entity_store->light_intensities[get_light_index()]; }
+    glm::vec3& ambient() { return entity_store->light_ambients[get_light_index()]; }
+    glm::vec3& diffuse() { return entity_store->light_diffuses[get_light_index()]; }
+    glm::vec3& specular() { return entity_store->light_speculars[get_light_index()]; }
+    glm::vec3& direction() { return entity_store->light_directions[get_light_index()]; }
+    float& constant() { return entity_store->light_constants[get_light_index()]; }
+    float& linear() { return entity_store->light_linears[get_light_index()]; }
+    float& quadratic() { return entity_store->light_quadratics[get_light_index()]; }
+    float& inner_cut_off_angle() { return entity_store->light_inner_cut_off_angles[get_light_index()]; }
+    float& outer_cut_off_angle() { return entity_store->light_outer_cut_off_angles[get_light_index()]; }
+
+    // The model must be loaded, "" for no model
+    void set_model(const std::string& model_name);
+    // The matrices are updated by EntityStore::update_transforms() before the next frame is drawn
     void set_model_matrices_standard();
     void draw(Shader* shader, bool disable_depth_test);
+    // Draws an entity from its components only, the loops over the scene draw by index without the game objects
+    static void draw_entity(int index, Shader* shader, bool disable_depth_test);
     bool intersected_ray(const glm::vec3& ray_dir, const glm::vec3& camera_position, float& t);
     void set_select_state(bool is_game_obj_selected);
 
+    // type is TypePointLight, TypeDirectionalLight or TypeSpotLight
+    static GameObject* create_light(const std::string& name, const std::string& model_name, GameObjectType type);
+    // Returns the id color, destroys the entity and the game object
+    static void destroy(GameObject* game_object);
     static void clean();
-};
-
-class Skybox : public GameObject {
-public:
-    std::string cubemap_name;
-
-    Skybox(const std::string& name);
-};
-
-class Light : public GameObject {
-public:
-    float intensity;
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-
-    Light(const std::string& name, const std::string& model_name);
-};
-
-class PointLight : public Light {
-public:
-    float constant;
-    float linear;
-    float quadratic;
-
-    PointLight(const std::string& name, const std::string& model_name);
-};
-
-class DirectionalLight : public Light {
-public:
-    glm::vec3 direction;
-
-    DirectionalLight(const std::string& name, const std::string& model_name);
-};
 
-class SpotLight : public Light {
-public:
-    glm::vec3 direction;
-
-    float inner_cut_off_angle;
-    float outer_cut_off_angle;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    SpotLight(const std::string& name, const std::string& model_name);
-    float get_inner_cut_off();
-    float get_outer_cut_off();
+private:
+    int get_light_index() {
+        int index = light_index();
+        assert(index != -1 && "the game object isn't a light");
+        return index;
+    }
 };
 
 class KeyGenerator {
@@ -0,0 +1,227 @@
+#include "gl_counters.h"
+
+#include <glad/glad.h>
+
+GLCounters gl_counters;
+
+static bool installed = false;
+
+GLCounters& GLCounters::operator+=(const GLCounters& other) {
+    draw_calls += other.draw_calls;
+    triangles += other.triangles;
+    dispatches += other.dispatches;
+    program_binds += other.program_binds;
+    texture_binds += other.texture_binds;
+    vertex_array_binds += other.vertex_array_binds;
+    framebuffer_binds += other.framebuffer_binds;
+    uniform_uploads += other.uniform_uploads;
+    buffer_uploads += other.buffer_uploads;
+    buffer_upload_bytes += other.buffer_upload_bytes;
+    texture_uploads += other.texture_uploads;
+    return *this;
+}
+
+GLCounters operator-(const GLCounters& a, const GLCounters& b) {
+    GLCounters difference;
+    difference.draw_calls = a.draw_calls - b.draw_calls;
+    difference.triangles = a.triangles - b.triangles;
+    difference.dispatches = a.dispatches - b.dispatches;
+    difference.program_binds = a.program_binds - b.program_binds;
+    difference.texture_binds = a.texture_binds - b.texture_binds;
+    difference.vertex_array_binds = a.vertex_array_binds - b.vertex_array_binds;
+    difference.framebuffer_binds = a.framebuffer_binds - b.framebuffer_binds;
+    difference.uniform_uploads = a.uniform_uploads - b.uniform_uploads;
+    difference.buffer_uploads = a.buffer_uploads - b.buffer_uploads;
+    difference.buffer_upload_bytes = a.buffer_upload_bytes - b.buffer_upload_bytes;
+    difference.texture_uploads = a.texture_uploads - b.texture_uploads;
+    return difference;
+}
+
+static uint64_t count_triangles(GLenum mode, GLsizei count, GLsizei instance_count) {
+    uint64_t triangles = 0;
+    if (mode == GL_TRIANGLES) {
+        triangles = count / 3;
+    }
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count >= 3) {
+        triangles = count - 2;
+    }
+    return triangles * instance_count;
+}
+
+// Function pointers loaded by glad, called by the wrappers
+static PFNGLDRAWELEMENTSPROC original_glDrawElements = nullptr;
+static PFNGLDRAWARRAYSPROC original_glDrawArrays = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDPROC original_glDrawElementsInstanced = nullptr;
+static PFNGLDRAWARRAYSINSTANCEDPROC original_glDrawArraysInstanced = nullptr;
+static PFNGLDISPATCHCOMPUTEPROC original_glDispatchCompute = nullptr;
+static PFNGLUSEPROGRAMPROC original_glUseProgram = nullptr;
+static PFNGLBINDTEXTUREPROC original_glBindTexture = nullptr;
+static PFNGLBINDVERTEXARRAYPROC original_glBindVertexArray = nullptr;
+static PFNGLBINDFRAMEBUFFERPROC original_glBindFramebuffer = nullptr;
+static PFNGLBUFFERDATAPROC original_glBufferData = nullptr;
+static PFNGLBUFFERSUBDATAPROC original_glBufferSubData = nullptr;
+static PFNGLTEXIMAGE2DPROC original_glTexImage2D = nullptr;
+static PFNGLTEXSUBIMAGE2DPROC original_glTexSubImage2D = nullptr;
+static PFNGLCOMPRESSEDTEXIMAGE2DPROC original_glCompressedTexImage2D = nullptr;
+
+static void APIENTRY counted_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    gl_counters.draw_calls++;
+    gl_counters.triangles += count_triangles(mode, count, 1);
+    original_glDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY counted_glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    gl_counters.draw_calls++;
+    gl_counters.triangles += count_triangles(mode, count, 1);
+    original_glDrawArrays(mode, first, count);
+}
+
+static void APIENTRY counted_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount) {
+    gl_counters.draw_calls++;
+    gl_counters.triangles += count_triangles(mode, count, instancecount);
+    original_glDrawElementsInstanced(mode, count, type, indices, instancecount);
+}
+
+static void APIENTRY counted_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount) {
+    gl_counters.draw_calls++;
+    gl_counters.triangles += count_triangles(mode, count, instancecount);
+    original_glDrawArraysInstanced(mode, first, count, instancecount);
+}
+
+static void APIENTRY counted_glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) {
+    gl_counters.dispatches++;
+    original_glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+}
+
+static void APIENTRY counted_glUseProgram(GLuint program) {
+    gl_counters.program_binds++;
+    original_glUseProgram(program);
+}
+
+static void APIENTRY counted_glBindTexture(GLenum target, GLuint texture) {
+    gl_counters.texture_binds++;
+    original_glBindTexture(target, texture);
+}
+
+static void APIENTRY counted_glBindVertexArray(GLuint array) {
+    gl_counters.vertex_array_binds++;
+    original_glBindVertexArray(array);
+}
+
+static void APIENTRY counted_glBindFramebuffer(GLenum target, GLuint framebuffer) {
+    gl_counters.framebuffer_binds++;
+    original_glBindFramebuffer(target, framebuffer);
+}
+
+static void APIENTRY counted_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    gl_counters.buffer_uploads++;
+    gl_counters.buffer_upload_bytes += size;
+    original_glBufferData(target, size, data, usage);
+}
+
+static void APIENTRY counted_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    gl_counters.buffer_uploads++;
+    gl_counters.buffer_upload_bytes += size;
+    original_glBufferSubData(target, offset, size, data);
+}
+
+static void APIENTRY counted_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) {
+    gl_counters.texture_uploads++;
+    original_glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+static void APIENTRY counted_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
+    gl_counters.texture_uploads++;
+    original_glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+static void APIENTRY counted_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data) {
+    gl_counters.texture_uploads++;
+    original_glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+}
+
+// The uniform setters only differ in their parameters, every call counts as one upload
+#define COUNTED_UNIFORM(function, function_type, parameters, arguments) \
+    static function_type original_##function = nullptr; \
+    static void APIENTRY counted_##function parameters { \
+        gl_counters.uniform_uploads++; \
+        original_##function arguments; \
+    }
+
+COUNTED_UNIFORM(glUniform1i, PFNGLUNIFORM1IPROC, (GLint location, GLint v0), (location, v0))
+COUNTED_UNIFORM(glUniform1ui, PFNGLUNIFORM1UIPROC, (GLint location, GLuint v0), (location, v0))
+COUNTED_UNIFORM(glUniform1f, PFNGLUNIFORM1FPROC, (GLint location, GLfloat v0), (location, v0))
+COUNTED_UNIFORM(glUniform2f, PFNGLUNIFORM2FPROC, (GLint location, GLfloat v0, GLfloat v1), (location, v0, v1))
+COUNTED_UNIFORM(glUniform2fv, PFNGLUNIFORM2FVPROC, (GLint location, GLsizei count, const GLfloat* value), (location, count, value))
+COUNTED_UNIFORM(glUniform3f, PFNGLUNIFORM3FPROC, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2), (location, v0, v1, v2))
+COUNTED_UNIFORM(glUniform3fv, PFNGLUNIFORM3FVPROC, (GLint location, GLsizei count, const GLfloat* value), (location, count, value))
+COUNTED_UNIFORM(glUniform3ui, PFNGLUNIFORM3UIPROC, (GLint location, GLuint v0, GLuint v1, GLuint v2), (location, v0, v1, v2))
+COUNTED_UNIFORM(glUniform4f, PFNGLUNIFORM4FPROC, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (location, v0, v1, v2, v3))
+COUNTED_UNIFORM(glUniform4fv, PFNGLUNIFORM4FVPROC, (GLint location, GLsizei count, const GLfloat* value), (location, count, value))
+COUNTED_UNIFORM(glUniformMatrix2fv, PFNGLUNIFORMMATRIX2FVPROC, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value))
+COUNTED_UNIFORM(glUniformMatrix3fv, PFNGLUNIFORMMATRIX3FVPROC, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value))
+COUNTED_UNIFORM(glUniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value))
+
+#undef COUNTED_UNIFORM
+
+// Swaps the glad pointer of a function with its wrapper (install) or back (uninstall)
+#define SWAP_GL_FUNCTION(function) \
+    if (install) { \
+        original_##function = glad_##function; \
+        glad_##function = counted_##function; \
+    } \
+    else { \
+        glad_##function = original_##function; \
+    }
+
+static void swap_gl_functions(bool install) {
+    SWAP_GL_FUNCTION(glDrawElements)
+    SWAP_GL_FUNCTION(glDrawArrays)
+    SWAP_GL_FUNCTION(glDrawElementsInstanced)
+    SWAP_GL_FUNCTION(glDrawArraysInstanced)
+    SWAP_GL_FUNCTION(glDispatchCompute)
+    SWAP_GL_FUNCTION(glUseProgram)
+    SWAP_GL_FUNCTION(glBindTexture)
+    SWAP_GL_FUNCTION(glBindVertexArray)
+    SWAP_GL_FUNCTION(glBindFramebuffer)
+    SWAP_GL_FUNCTION(glBufferData)
+    SWAP_GL_FUNCTION(glBufferSubData)
+    SWAP_GL_FUNCTION(glTexImage2D)
+    SWAP_GL_FUNCTION(glTexSubImage2D)
+    SWAP_GL_FUNCTION(glCompressedTexImage2D)
+    SWAP_GL_FUNCTION(glUniform1i)
+    SWAP_GL_FUNCTION(glUniform1ui)
+    SWAP_GL_FUNCTION(glUniform1f)
+    SWAP_GL_FUNCTION(glUniform2f)
+    SWAP_GL_FUNCTION(glUniform2fv)
+    SWAP_GL_FUNCTION(glUniform3f)
+    SWAP_GL_FUNCTION(glUniform3fv)
+    SWAP_GL_FUNCTION(glUniform3ui)
+    SWAP_GL_FUNCTION(glUniform4f)
+    SWAP_GL_FUNCTION(glUniform4fv)
+    SWAP_GL_FUNCTION(glUniformMatrix2fv)
+    SWAP_GL_FUNCTION(glUniformMatrix3fv)
+    SWAP_GL_FUNCTION(glUniformMatrix4fv)
+}
+
+#undef SWAP_GL_FUNCTION
+
+void install_gl_counters() {
+    if (installed) {
+        return;
+    }
+    swap_gl_functions(true);
+    installed = true;
+}
+
+void uninstall_gl_counters() {
+    if (!installed) {
+        return;
+    }
+    swap_gl_functions(false);
+    installed = false;
+}
+
+bool are_gl_counters_installed() {
+    return installed;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+// Number of GL calls of each kind, and of the triangles they submit
+struct GLCounters {
+    uint64_t draw_calls = 0;
+    uint64_t triangles = 0;
+    uint64_t dispatches = 0;
+    uint64_t program_binds = 0;
+    uint64_t texture_binds = 0;
+    uint64_t vertex_array_binds = 0;
+    uint64_t framebuffer_binds = 0;
+    uint64_t uniform_uploads = 0;
+    uint64_t buffer_uploads = 0;
+    uint64_t buffer_upload_bytes = 0;
+    uint64_t texture_uploads = 0;
+
+    GLCounters& operator+=(const GLCounters& other);
+};
+
+GLCounters operator-(const GLCounters& a, const GLCounters& b);
+
+// Optional instrumentation of the GL entry points used by the engine (draws, dispatches, program/texture/vertex array/framebuffer
+// binds, uniform setters, buffer and texture uploads): install_gl_counters() replaces their glad function pointers with
+// wrappers that count the calls in gl_counters and forward them, uninstall_gl_counters() restores them.
+// Only the calls of the GL thread that go through glad are counted (not the ones of the ImGui backend, which has its own loader).
+// GL thread only, after the GL functions are loaded
+void install_gl_counters();
+void uninstall_gl_counters();
+bool are_gl_counters_installed();
+
+// Totals since the counters were installed, the profiler takes the difference around each pass and each frame
+extern GLCounters gl_counters;
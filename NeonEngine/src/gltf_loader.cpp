@@ -0,0 +1,754 @@
+#include "gltf_loader.h"
+
+#include "model.h"
+#include "model_cache.h"
+#include "mapped_file.h"
+#include "json.h"
+#include "texture_cache.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+// Component types of the glTF accessors, they have the same values as the GL enums
+const int GLTF_BYTE = 5120;
+const int GLTF_UNSIGNED_BYTE = 5121;
+const int GLTF_SHORT = 5122;
+const int GLTF_UNSIGNED_SHORT = 5123;
+const int GLTF_UNSIGNED_INT = 5125;
+const int GLTF_FLOAT = 5126;
+
+// Primitive modes
+const int GLTF_TRIANGLES = 4;
+const int GLTF_TRIANGLE_STRIP = 5;
+const int GLTF_TRIANGLE_FAN = 6;
+
+struct GltfAccessor {
+    int buffer;
+    size_t offset; // offset in bytes of the first element inside the buffer
+    int component_type;
+    int num_components;
+    bool normalized;
+    size_t count;
+    int stride;
+};
+
+static int get_component_size(int component_type) {
+    if (component_type == GLTF_BYTE || component_type == GLTF_UNSIGNED_BYTE) {
+        return 1;
+    }
+    else if (component_type == GLTF_SHORT || component_type == GLTF_UNSIGNED_SHORT) {
+        return 2;
+    }
+    else if (component_type == GLTF_UNSIGNED_INT || component_type == GLTF_FLOAT) {
+        return 4;
+    }
+    return 0;
+}
+
+static int get_num_components(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+// URIs of the glTF files can have percent-encoded characters (e.g. spaces)
+static std::string decode_uri(const std::string& uri) {
+    std::string decoded;
+    for (size_t i = 0; i < uri.size(); i++) {
+        if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2])) {
+            decoded += (char)std::stoi(uri.substr(i + 1, 2), nullptr, 16);
+            i += 2;
+        }
+        else {
+            decoded += uri[i];
+        }
+    }
+    return decoded;
+}
+
+// glTF matrices are column-major, assimp matrices are row-major
+static aiMatrix4x4 matrix_from_column_major(const float* m) {
+    return aiMatrix4x4(m[0], m[4], m[8], m[12],
+                       m[1], m[5], m[9], m[13],
+                       m[2], m[6], m[10], m[14],
+                       m[3], m[7], m[11], m[15]);
+}
+
+class GltfLoader {
+public:
+    Model& model;
+    JsonValue document;
+    std::vector<MappedFile*> buffer_files;
+    std::vector<SharedVertexBuffer*> shared_buffers;
+
+    // Static transformation of every node, used for the channels missing in the animations
+    std::vector<std::string> node_names;
+    std::vector<aiVector3D> node_translations;
+    std::vector<aiQuaternion> node_rotations;
+    std::vector<aiVector3D> node_scalings;
+    std::vector<aiMatrix4x4> node_transformations;
+
+    bool has_bounds;
+
+    GltfLoader(Model& model) : model(model), has_bounds(false) {}
+
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::stringstream file_stream;
+        file_stream << file.rdbuf();
+        std::string text = file_stream.str();
+
+        std::string error;
+        if (!parse_json(text.c_str(), text.size(), document, error)) {
+            std::cout << "ERROR::GLTF:: Invalid JSON in " << path << ": " << error << std::endl;
+            return false;
+        }
+        if (!is_supported()) {
+            return false;
+        }
+
+        // Map the buffers
+        const JsonValue& buffers = document["buffers"];
+        for (size_t i = 0; i < buffers.size(); i++) {
+            MappedFile* buffer_file = new MappedFile();
+            buffer_files.push_back(buffer_file);
+            if (!buffer_file->open(model.directory + '/' + decode_uri(buffers[i]["uri"].get_string()))) {
+                std::cout << "ERROR::GLTF:: Failed to map the buffer: " << buffers[i]["uri"].get_string() << std::endl;
+                return fail();
+            }
+            SharedVertexBuffer* shared_buffer = new SharedVertexBuffer();
+            shared_buffer->data = buffer_file->data;
+            shared_buffer->size = buffer_file->size;
+            shared_buffer->id = 0;
+            shared_buffers.push_back(shared_buffer);
+        }
+
+        load_node_transformations();
+        if (!load_skin() || !load_scene() || !load_animations()) {
+            return fail();
+        }
+
+        // The vertex data stays in the mapped buffers, the model owns them from now on
+        model.buffer_files = buffer_files;
+        model.shared_buffers = shared_buffers;
+        return true;
+    }
+
+private:
+    // Features that are handled by the assimp importer instead
+    bool is_supported() {
+        if (document["extensionsRequired"].size() > 0) {
+            return false;
+        }
+        if (document["skins"].size() > 1) {
+            return false;
+        }
+        if (document["scenes"].size() == 0) {
+            return false;
+        }
+        const JsonValue& buffers = document["buffers"];
+        for (size_t i = 0; i < buffers.size(); i++) {
+            if (!buffers[i].has("uri") || buffers[i]["uri"].get_string().rfind("data:", 0) == 0) {
+                return false;
+            }
+        }
+        const JsonValue& images = document["images"];
+        for (size_t i = 0; i < images.size(); i++) {
+            if (images[i]["uri"].get_string().rfind("data:", 0) == 0) {
+                return false;
+            }
+        }
+        const JsonValue& accessors = document["accessors"];
+        for (size_t i = 0; i < accessors.size(); i++) {
+            if (accessors[i].has("sparse") || !accessors[i].has("bufferView")) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Releases everything loaded so far, the model is left as it was before the load
+    bool fail() {
+        clear_model_data(model);
+        for (int i = 0; i < shared_buffers.size(); i++) {
+            delete shared_buffers[i];
+        }
+        for (int i = 0; i < buffer_files.size(); i++) {
+            delete buffer_files[i];
+        }
+        shared_buffers.clear();
+        buffer_files.clear();
+        model.aabb_min = glm::vec3(0.0f);
+        model.aabb_max = glm::vec3(0.0f);
+        return false;
+    }
+
+    bool resolve_accessor(int accessor_index, GltfAccessor& accessor) {
+        const JsonValue& json_accessor = document["accessors"][accessor_index];
+        if (json_accessor.type != JsonObject) {
+            return false;
+        }
+        const JsonValue& view = document["bufferViews"][json_accessor["bufferView"].get_int(-1)];
+        if (view.type != JsonObject) {
+            return false;
+        }
+        accessor.buffer = view["buffer"].get_int(-1);
+        if (accessor.buffer < 0 || accessor.buffer >= shared_buffers.size()) {
+            return false;
+        }
+        accessor.component_type = json_accessor["componentType"].get_int();
+        accessor.num_components = get_num_components(json_accessor["type"].get_string());
+        accessor.normalized = json_accessor["normalized"].get_bool();
+        accessor.count = (size_t)json_accessor["count"].get_number();
+        int element_size = get_component_size(accessor.component_type) * accessor.num_components;
+        if (element_size == 0) {
+            return false;
+        }
+        accessor.stride = view["byteStride"].get_int(element_size);
+        size_t view_offset = (size_t)view["byteOffset"].get_number();
+        size_t view_end = view_offset + (size_t)view["byteLength"].get_number();
+        accessor.offset = view_offset + (size_t)json_accessor["byteOffset"].get_number();
+        if (view_end > shared_buffers[accessor.buffer]->size) {
+            return false;
+        }
+        if (accessor.count > 0 && accessor.offset + (accessor.count - 1) * accessor.stride + element_size > view_end) {
+            return false;
+        }
+        return true;
+    }
+
+    const unsigned char* get_element(const GltfAccessor& accessor, size_t index) {
+        return shared_buffers[accessor.buffer]->data + accessor.offset + index * accessor.stride;
+    }
+
+    // Reads an element as floats, applying the normalization of integer components
+    void read_float(const GltfAccessor& accessor, size_t index, float* output, int num_output) {
+        const unsigned char* element = get_element(accessor, index);
+        for (int i = 0; i < num_output && i < accessor.num_components; i++) {
+            if (accessor.component_type == GLTF_FLOAT) {
+                memcpy(&output[i], element + i * 4, 4);
+            }
+            else if (accessor.component_type == GLTF_UNSIGNED_BYTE) {
+                output[i] = accessor.normalized ? element[i] / 255.0f : element[i];
+            }
+            else if (accessor.component_type == GLTF_BYTE) {
+                signed char value = (signed char)element[i];
+                output[i] = accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            else if (accessor.component_type == GLTF_UNSIGNED_SHORT) {
+                unsigned short value;
+                memcpy(&value, element + i * 2, 2);
+                output[i] = accessor.normalized ? value / 65535.0f : value;
+            }
+            else if (accessor.component_type == GLTF_SHORT) {
+                short value;
+                memcpy(&value, element + i * 2, 2);
+                output[i] = accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            else {
+                unsigned int value;
+                memcpy(&value, element + i * 4, 4);
+                output[i] = (float)value;
+            }
+        }
+    }
+
+    unsigned int read_uint(const GltfAccessor& accessor, size_t index, int component) {
+        const unsigned char* element = get_element(accessor, index);
+        if (accessor.component_type == GLTF_UNSIGNED_BYTE || accessor.component_type == GLTF_BYTE) {
+            return element[component];
+        }
+        else if (accessor.component_type == GLTF_UNSIGNED_SHORT || accessor.component_type == GLTF_SHORT) {
+            unsigned short value;
+            memcpy(&value, element + component * 2, 2);
+            return value;
+        }
+        unsigned int value;
+        memcpy(&value, element + component * 4, 4);
+        return value;
+    }
+
+    void load_node_transformations() {
+        const JsonValue& nodes = document["nodes"];
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const JsonValue& node = nodes[i];
+            std::string name = node["name"].get_string();
+            if (name == "") {
+                name = "node_" + std::to_string(i);
+            }
+            node_names.push_back(name);
+
+            aiVector3D translation(0.0f, 0.0f, 0.0f);
+            aiQuaternion rotation;
+            aiVector3D scaling(1.0f, 1.0f, 1.0f);
+            aiMatrix4x4 transformation;
+            if (node.has("matrix")) {
+                float m[16];
+                for (int j = 0; j < 16; j++) {
+                    m[j] = (float)node["matrix"][j].get_number(j % 5 == 0 ? 1.0 : 0.0);
+                }
+                transformation = matrix_from_column_major(m);
+                transformation.Decompose(scaling, rotation, translation);
+            }
+            else {
+                const JsonValue& t = node["translation"];
+                const JsonValue& r = node["rotation"];
+                const JsonValue& s = node["scale"];
+                if (t.size() == 3) {
+                    translation = aiVector3D((float)t[0].get_number(), (float)t[1].get_number(), (float)t[2].get_number());
+                }
+                if (r.size() == 4) {
+                    rotation = aiQuaternion((float)r[3].get_number(), (float)r[0].get_number(), (float)r[1].get_number(), (float)r[2].get_number());
+                }
+                if (s.size() == 3) {
+                    scaling = aiVector3D((float)s[0].get_number(), (float)s[1].get_number(), (float)s[2].get_number());
+                }
+                transformation = aiMatrix4x4(scaling, rotation, translation);
+            }
+            node_translations.push_back(translation);
+            node_rotations.push_back(rotation);
+            node_scalings.push_back(scaling);
+            node_transformations.push_back(transformation);
+        }
+    }
+
+    // The bone ids are the joint indices of the skin, so the JOINTS_0 attribute can be used without remapping
+    bool load_skin() {
+        if (document["skins"].size() == 0) {
+            return true;
+        }
+        const JsonValue& skin = document["skins"][0];
+        const JsonValue& joints = skin["joints"];
+        GltfAccessor inverse_bind_matrices;
+        bool has_inverse_bind_matrices = skin.has("inverseBindMatrices");
+        if (has_inverse_bind_matrices) {
+            if (!resolve_accessor(skin["inverseBindMatrices"].get_int(-1), inverse_bind_matrices) ||
+                inverse_bind_matrices.num_components != 16 || inverse_bind_matrices.component_type != GLTF_FLOAT ||
+                inverse_bind_matrices.count < joints.size()) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < joints.size(); i++) {
+            int node_index = joints[i].get_int(-1);
+            if (node_index < 0 || node_index >= node_names.size()) {
+                return false;
+            }
+            Bone bone;
+            if (has_inverse_bind_matrices) {
+                float m[16];
+                read_float(inverse_bind_matrices, i, m, 16);
+                bone.offset_matrix = matrix_from_column_major(m);
+            }
+            model.umap_bone_name_to_id[node_names[node_index]] = (int)i;
+            model.bones.push_back(bone);
+        }
+        return true;
+    }
+
+    bool load_scene() {
+        const JsonValue& scene = document["scenes"][document["scene"].get_int(0)];
+        const JsonValue& root_nodes = scene["nodes"];
+
+        // Like assimp, a scene with several root nodes gets an extra root node
+        model.root_node = new ModelNode();
+        if (root_nodes.size() == 1) {
+            if (!load_node(root_nodes[0].get_int(-1), model.root_node, 0)) {
+                return false;
+            }
+        }
+        else {
+            model.root_node->name = "ROOT";
+            for (size_t i = 0; i < root_nodes.size(); i++) {
+                ModelNode* child = new ModelNode();
+                model.root_node->children.push_back(child);
+                if (!load_node(root_nodes[i].get_int(-1), child, 0)) {
+                    return false;
+                }
+            }
+        }
+        model.global_inverse_transform = model.root_node->transformation;
+        model.global_inverse_transform.Inverse();
+        return true;
+    }
+
+    bool load_node(int node_index, ModelNode* model_node, int depth) {
+        const JsonValue& node = document["nodes"][node_index];
+        if (node.type != JsonObject || depth > 1024) {
+            return false;
+        }
+        model_node->name = node_names[node_index];
+        model_node->transformation = node_transformations[node_index];
+        if (node.has("mesh") && !load_mesh(node["mesh"].get_int(-1))) {
+            return false;
+        }
+        const JsonValue& children = node["children"];
+        for (size_t i = 0; i < children.size(); i++) {
+            ModelNode* child = new ModelNode();
+            model_node->children.push_back(child);
+            if (!load_node(children[i].get_int(-1), child, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool load_mesh(int mesh_index) {
+        const JsonValue& json_mesh = document["meshes"][mesh_index];
+        const JsonValue& primitives = json_mesh["primitives"];
+        if (json_mesh.type != JsonObject) {
+            return false;
+        }
+        for (size_t i = 0; i < primitives.size(); i++) {
+            // Mesh name, following the naming of processMesh()
+            std::string mesh_name = json_mesh["name"].get_string();
+            if (mesh_name == "") {
+                std::ostringstream ss;
+                ss << std::setw(3) << std::setfill('0') << model.meshes.size();
+                mesh_name = "mesh" + ss.str();
+            }
+            if (primitives.size() > 1) {
+                mesh_name += "-" + std::to_string(i);
+            }
+            if (!load_primitive(primitives[i], mesh_name)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void update_bounds(const glm::vec3& position) {
+        if (!has_bounds) {
+            model.aabb_min = position;
+            model.aabb_max = position;
+            has_bounds = true;
+        }
+        else {
+            model.aabb_min = glm::min(model.aabb_min, position);
+            model.aabb_max = glm::max(model.aabb_max, position);
+        }
+    }
+
+    bool load_primitive(const JsonValue& primitive, const std::string& mesh_name) {
+        const JsonValue& attributes = primitive["attributes"];
+        int mode = primitive["mode"].get_int(GLTF_TRIANGLES);
+        if (mode != GLTF_TRIANGLES && mode != GLTF_TRIANGLE_STRIP && mode != GLTF_TRIANGLE_FAN) {
+            // Points and lines are not rendered by the engine
+            return true;
+        }
+
+        GltfAccessor position, normal, texcoord, joints, weights, indices;
+        if (!attributes.has("POSITION") || !resolve_accessor(attributes["POSITION"].get_int(-1), position) ||
+            position.component_type != GLTF_FLOAT || position.num_components != 3) {
+            return false;
+        }
+        bool has_normal = attributes.has("NORMAL");
+        bool has_texcoord = attributes.has("TEXCOORD_0");
+        bool has_bones = attributes.has("JOINTS_0") && attributes.has("WEIGHTS_0");
+        bool has_indices = primitive.has("indices");
+        if ((has_normal && !resolve_accessor(attributes["NORMAL"].get_int(-1), normal)) ||
+            (has_texcoord && !resolve_accessor(attributes["TEXCOORD_0"].get_int(-1), texcoord)) ||
+            (has_bones && (!resolve_accessor(attributes["JOINTS_0"].get_int(-1), joints) || !resolve_accessor(attributes["WEIGHTS_0"].get_int(-1), weights))) ||
+            (has_indices && !resolve_accessor(primitive["indices"].get_int(-1), indices))) {
+            return false;
+        }
+
+        Material* material = get_material(primitive["material"].get_int(-1));
+        if (material == nullptr) {
+            return false;
+        }
+
+        // Bounds from the min and max values of the positions, which are required by the glTF spec
+        const JsonValue& json_position = document["accessors"][attributes["POSITION"].get_int(-1)];
+        if (json_position["min"].size() == 3 && json_position["max"].size() == 3) {
+            update_bounds(glm::vec3(json_position["min"][0].get_number(), json_position["min"][1].get_number(), json_position["min"][2].get_number()));
+            update_bounds(glm::vec3(json_position["max"][0].get_number(), json_position["max"][1].get_number(), json_position["max"][2].get_number()));
+        }
+        else {
+            for (size_t i = 0; i < position.count; i++) {
+                float p[3];
+                read_float(position, i, p, 3);
+                update_bounds(glm::vec3(p[0], p[1], p[2]));
+            }
+        }
+
+        // Use the buffer as it is when all the streams have a layout the vertex shader can read
+        bool direct_upload = mode == GLTF_TRIANGLES && has_indices && has_normal &&
+            normal.component_type == GLTF_FLOAT && normal.num_components == 3 &&
+            (!has_texcoord || texcoord.num_components == 2) &&
+            (!has_bones || (joints.num_components == 4 && weights.num_components == 4 && joints.component_type != GLTF_FLOAT)) &&
+            indices.num_components == 1 && indices.stride == get_component_size(indices.component_type) &&
+            (indices.component_type == GLTF_UNSIGNED_BYTE || indices.component_type == GLTF_UNSIGNED_SHORT || indices.component_type == GLTF_UNSIGNED_INT) &&
+            normal.buffer == position.buffer && indices.buffer == position.buffer &&
+            (!has_texcoord || texcoord.buffer == position.buffer) &&
+            (!has_bones || (joints.buffer == position.buffer && weights.buffer == position.buffer));
+
+        if (direct_upload) {
+            std::vector<VertexStream> streams;
+            streams.push_back({ 0, 3, GL_FLOAT, false, false, position.offset, position.stride });
+            streams.push_back({ 1, 3, GL_FLOAT, false, false, normal.offset, normal.stride });
+            if (has_texcoord) {
+                streams.push_back({ 2, 2, (GLenum)texcoord.component_type, texcoord.normalized, false, texcoord.offset, texcoord.stride });
+            }
+            if (has_bones) {
+                streams.push_back({ 5, 4, (GLenum)joints.component_type, false, true, joints.offset, joints.stride });
+                streams.push_back({ 6, 4, (GLenum)weights.component_type, weights.component_type != GLTF_FLOAT, false, weights.offset, weights.stride });
+            }
+            model.meshes.push_back(Mesh(mesh_name, shared_buffers[position.buffer], streams, (GLenum)indices.component_type, indices.offset, (unsigned int)indices.count, material));
+            return true;
+        }
+
+        // Conversion to the Vertex struct
+        std::vector<Vertex> vertices(position.count);
+        for (size_t i = 0; i < position.count; i++) {
+            Vertex& vertex = vertices[i];
+            read_float(position, i, &vertex.Position.x, 3);
+            vertex.Normal = glm::vec3(0.0f);
+            vertex.TexCoords = glm::vec2(0.0f);
+            if (has_normal) {
+                read_float(normal, i, &vertex.Normal.x, 3);
+            }
+            if (has_texcoord) {
+                read_float(texcoord, i, &vertex.TexCoords.x, 2);
+            }
+            if (has_bones) {
+                for (int j = 0; j < MAX_BONE_INFLUENCE && j < joints.num_components; j++) {
+                    vertex.BoneIds[j] = (int)read_uint(joints, i, j);
+                }
+                read_float(weights, i, vertex.BoneWeights, MAX_BONE_INFLUENCE);
+            }
+        }
+
+        std::vector<unsigned int> source_indices;
+        if (has_indices) {
+            source_indices.resize(indices.count);
+            for (size_t i = 0; i < indices.count; i++) {
+                source_indices[i] = read_uint(indices, i, 0);
+                if (source_indices[i] >= vertices.size()) {
+                    return false;
+                }
+            }
+        }
+        else {
+            source_indices.resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++) {
+                source_indices[i] = (unsigned int)i;
+            }
+        }
+
+        std::vector<unsigned int> triangle_indices;
+        if (mode == GLTF_TRIANGLES) {
+            triangle_indices = source_indices;
+            triangle_indices.resize(triangle_indices.size() - triangle_indices.size() % 3);
+        }
+        else {
+            for (size_t i = 2; i < source_indices.size(); i++) {
+                if (mode == GLTF_TRIANGLE_FAN) {
+                    triangle_indices.insert(triangle_indices.end(), { source_indices[0], source_indices[i - 1], source_indices[i] });
+                }
+                else if (i % 2 == 0) {
+                    triangle_indices.insert(triangle_indices.end(), { source_indices[i - 2], source_indices[i - 1], source_indices[i] });
+                }
+                else {
+                    triangle_indices.insert(triangle_indices.end(), { source_indices[i - 1], source_indices[i - 2], source_indices[i] });
+                }
+            }
+        }
+
+        // Smooth normals, like aiProcess_GenSmoothNormals
+        if (!has_normal) {
+            for (size_t i = 0; i < triangle_indices.size(); i += 3) {
+                Vertex& v0 = vertices[triangle_indices[i]];
+                Vertex& v1 = vertices[triangle_indices[i + 1]];
+                Vertex& v2 = vertices[triangle_indices[i + 2]];
+                glm::vec3 face_normal = glm::cross(v1.Position - v0.Position, v2.Position - v0.Position);
+                v0.Normal += face_normal;
+                v1.Normal += face_normal;
+                v2.Normal += face_normal;
+            }
+            for (size_t i = 0; i < vertices.size(); i++) {
+                if (glm::length(vertices[i].Normal) > 0.0f) {
+                    vertices[i].Normal = glm::normalize(vertices[i].Normal);
+                }
+            }
+        }
+
+        model.meshes.push_back(Mesh(mesh_name, vertices, triangle_indices, material));
+        return true;
+    }
+
+    Material* get_material(int material_index) {
+        const JsonValue& materials = document["materials"];
+        unsigned int material_key = material_index >= 0 ? material_index : (unsigned int)materials.size();
+        if (model.loaded_materials.find(material_key) != model.loaded_materials.end()) {
+            return model.loaded_materials[material_key];
+        }
+        const JsonValue& json_material = materials[material_index];
+        if (material_index >= 0 && json_material.type != JsonObject) {
+            return nullptr;
+        }
+
+        // Material name, following the naming of processMesh()
+        std::string material_name = "mat_" + model.name + "_";
+        if (material_index < 0) {
+            material_name += "DefaultMaterial";
+        }
+        else if (json_material["name"].get_string() == "") {
+            std::ostringstream ss;
+            ss << std::setw(3) << std::setfill('0') << model.loaded_materials.size();
+            material_name += ss.str();
+        }
+        else {
+            material_name += json_material["name"].get_string();
+        }
+
+        Material* material = Material::pool.create(material_name);
+        material->format = model.format;
+        model.loaded_materials[material_key] = material;
+
+        // Same texture types as the ones assimp reports for glTF materials
+        const JsonValue& pbr = json_material["pbrMetallicRoughness"];
+        add_texture(material, pbr["baseColorTexture"], { TexAlbedo });
+        add_texture(material, json_material["normalTexture"], { TexNormal });
+        add_texture(material, pbr["metallicRoughnessTexture"], { TexMetalness, TexRoughness });
+        add_texture(material, json_material["emissiveTexture"], { TexEmission });
+        add_texture(material, json_material["occlusionTexture"], { TexAmbientOcclusion });
+        add_texture(material, json_material["extensions"]["KHR_materials_specular"]["specularTexture"], { TexSpecular });
+        return material;
+    }
+
+    void add_texture(Material* material, const JsonValue& texture_info, std::initializer_list<TextureType> texture_types) {
+        if (texture_info.type != JsonObject) {
+            return;
+        }
+        const JsonValue& json_texture = document["textures"][texture_info["index"].get_int(-1)];
+        int image_index = json_texture["source"].get_int(-1);
+        const JsonValue& json_image = document["images"][image_index];
+        if (json_image.type != JsonObject) {
+            return;
+        }
+
+        // Embedded images are named like in assimp
+        std::string texture_path = json_image.has("uri") ? json_image["uri"].get_string() : "*" + std::to_string(image_index);
+        Texture* texture;
+        if (model.loaded_textures.find(texture_path) != model.loaded_textures.end()) {
+            texture = model.loaded_textures[texture_path];
+        }
+        else {
+            texture = Texture::pool.create("tex_" + material->name.substr(4));
+            texture->id = 0;
+            texture->path = texture_path;
+            // only decode the image here, it's uploaded in upload_to_gpu()
+            ImageData image;
+            if (json_image.has("uri")) {
+                ImageFromFile(decode_uri(texture_path).c_str(), model.directory, image, model.flip_vertically);
+            }
+            else {
+                const JsonValue& view = document["bufferViews"][json_image["bufferView"].get_int(-1)];
+                int buffer = view["buffer"].get_int(-1);
+                size_t offset = (size_t)view["byteOffset"].get_number();
+                size_t length = (size_t)view["byteLength"].get_number();
+                if (buffer >= 0 && buffer < shared_buffers.size() && offset + length <= shared_buffers[buffer]->size) {
+                    TextureCache::get_instance()->load_image_from_memory(shared_buffers[buffer]->data + offset, (int)length, model.directory + "/" + texture_path, image, model.flip_vertically);
+                }
+            }
+            texture->num_channels = image.num_channels;
+            model.pending_texture_images.push_back(std::make_pair(texture, image));
+            model.loaded_textures[texture_path] = texture;
+        }
+        for (TextureType texture_type : texture_types) {
+            texture->types.insert(texture_type);
+            material->textures[texture_type] = texture;
+        }
+    }
+
+    // Times are converted to ticks of 1 millisecond, like the assimp glTF importer
+    bool load_animations() {
+        const JsonValue& animations = document["animations"];
+        for (size_t i = 0; i < animations.size(); i++) {
+            const JsonValue& json_animation = animations[i];
+            const JsonValue& samplers = json_animation["samplers"];
+            const JsonValue& channels = json_animation["channels"];
+
+            Animation animation;
+            animation.name = json_animation["name"].get_string();
+            animation.ticks_per_second = 1000.0;
+            animation.duration = 0.0;
+            std::vector<int> animated_nodes;
+
+            for (size_t j = 0; j < channels.size(); j++) {
+                const JsonValue& target = channels[j]["target"];
+                const JsonValue& sampler = samplers[channels[j]["sampler"].get_int(-1)];
+                int node_index = target["node"].get_int(-1);
+                std::string target_path = target["path"].get_string();
+                if (node_index < 0 || node_index >= node_names.size() || target_path == "weights") {
+                    continue;
+                }
+                GltfAccessor input, output;
+                if (!resolve_accessor(sampler["input"].get_int(-1), input) || !resolve_accessor(sampler["output"].get_int(-1), output)) {
+                    return false;
+                }
+                // Cubic spline outputs store an in-tangent, the value and an out-tangent per key, only the value is used.
+                // Step interpolation is approximated by the linear interpolation of the engine.
+                bool cubic_spline = sampler["interpolation"].get_string() == "CUBICSPLINE";
+                size_t num_keys = std::min(input.count, cubic_spline ? output.count / 3 : output.count);
+
+                NodeAnimation& node_animation = animation.umap_node_name_to_channels[node_names[node_index]];
+                animated_nodes.push_back(node_index);
+                for (size_t k = 0; k < num_keys; k++) {
+                    float time;
+                    read_float(input, k, &time, 1);
+                    double time_in_ticks = time * 1000.0;
+                    animation.duration = std::max(animation.duration, time_in_ticks);
+                    size_t output_index = cubic_spline ? 3 * k + 1 : k;
+                    float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                    read_float(output, output_index, value, 4);
+                    if (target_path == "translation") {
+                        node_animation.map_time_to_position[time_in_ticks] = aiVector3D(value[0], value[1], value[2]);
+                    }
+                    else if (target_path == "rotation") {
+                        node_animation.map_time_to_rotation[time_in_ticks] = aiQuaternion(value[3], value[0], value[1], value[2]);
+                    }
+                    else if (target_path == "scale") {
+                        node_animation.map_time_to_scaling[time_in_ticks] = aiVector3D(value[0], value[1], value[2]);
+                    }
+                }
+            }
+
+            // The channels not animated keep the static transformation of the node
+            for (int j = 0; j < animated_nodes.size(); j++) {
+                int node_index = animated_nodes[j];
+                NodeAnimation& node_animation = animation.umap_node_name_to_channels[node_names[node_index]];
+                if (node_animation.map_time_to_position.empty()) {
+                    node_animation.map_time_to_position[0.0] = node_translations[node_index];
+                }
+                if (node_animation.map_time_to_rotation.empty()) {
+                    node_animation.map_time_to_rotation[0.0] = node_rotations[node_index];
+                }
+                if (node_animation.map_time_to_scaling.empty()) {
+                    node_animation.map_time_to_scaling[0.0] = node_scalings[node_index];
+                }
+            }
+            model.animations.push_back(animation);
+        }
+        return true;
+    }
+};
+
+bool load_gltf_model(Model& model, const std::string& path) {
+    GltfLoader loader(model);
+    return loader.load(path);
+}
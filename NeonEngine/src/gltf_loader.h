@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+class Model;
+
+// Native loader of .gltf files. The .bin buffers are memory-mapped and uploaded once to GL buffers shared by all the meshes,
+// the vertex attributes and indices of the primitives point directly into them. Primitives whose layout can't be used as it is
+// (no normals, no indices, strips or fans) are converted to the Vertex struct.
+// Returns false without modifying the model when the file uses features not supported here (e.g. embedded buffers,
+// sparse accessors, required extensions or more than one skin), the model must then be loaded with assimp.
+bool load_gltf_model(Model& model, const std::string& path);
@@ -0,0 +1,178 @@
+#include "hdri_loader.h"
+#include "rendering.h"
+#include "cubemap.h"
+#include "resource_registry.h"
+
+#include <glad/glad.h>
+#include <iostream>
+
+HdriLoader::HdriLoader(Rendering* rendering) {
+    this->rendering = rendering;
+}
+
+void HdriLoader::register_hdri(const std::string& name, const std::string& path) {
+    hdri_paths[name] = path;
+    hdri_states[name] = HdriUnloaded;
+    // the entry lets the user interface list the HDRI before it's loaded
+    rendering->cubemap->add_cubemap_texture(name, 0, true);
+}
+
+bool HdriLoader::is_registered(const std::string& name) {
+    return hdri_paths.find(name) != hdri_paths.end();
+}
+
+HdriState HdriLoader::get_state(const std::string& name) {
+    auto it = hdri_states.find(name);
+    return it != hdri_states.end() ? it->second : HdriUnloaded;
+}
+
+void HdriLoader::request(const std::string& name) {
+    if (!is_registered(name) || hdri_states[name] != HdriUnloaded) {
+        return;
+    }
+    std::shared_ptr<HdriLoadJob> job = std::make_shared<HdriLoadJob>();
+    job->name = name;
+    job->path = hdri_paths[name];
+    job->map_sizes = { rendering->ENVIRONMENT_MAP_WIDTH, rendering->IRRADIANCE_MAP_WIDTH, rendering->PREFILTER_MAP_WIDTH };
+    job->prefilter_sample_count = rendering->prefilter_sample_count;
+    hdri_states[name] = HdriLoading;
+
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    read_jobs.push_back(job);
+    if (!loader_thread.joinable()) {
+        loader_thread = std::thread(&HdriLoader::process_jobs, this);
+    }
+    jobs_available.notify_one();
+}
+
+// Prefetch of every HDRI in the background
+void HdriLoader::request_all() {
+    for (auto it = hdri_paths.begin(); it != hdri_paths.end(); it++) {
+        request(it->first);
+    }
+}
+
+// The maps baked by the asset cooker and the IBL cache skip the decoding and the precomputation
+void HdriLoader::read(HdriLoadJob& job) {
+    if (get_use_cooked_assets() && load_cooked_hdri(job.path, job.cubemap_data)) {
+        job.has_precomputed_maps = true;
+        return;
+    }
+    job.cubemap_data = CookedCubemapData();
+    job.cache_key = compute_ibl_cache_key(job.path, job.map_sizes, job.prefilter_sample_count);
+    job.has_precomputed_maps = read_ibl_cache(job.name, job.cache_key, job.map_sizes, job.cubemap_data);
+    if (!job.has_precomputed_maps) {
+        load_hdr_image_data(job.path, job.equirectangular_image, true);
+    }
+}
+
+// Uploads the precomputed maps, or computes them and reads them back for the IBL cache
+void HdriLoader::finish(HdriLoadJob& job) {
+    if (job.has_precomputed_maps) {
+        rendering->load_cooked_hdri_cubemap(job.name, job.cubemap_data);
+        job.cubemap_data = CookedCubemapData();
+    }
+    else {
+        job.write_cache = job.equirectangular_image.data_hdr != nullptr;
+        rendering->load_hdri_cubemap(job.name, job.equirectangular_image);
+        if (job.write_cache) {
+            CubemapData textures = rendering->cubemap->umap_name_to_cubemap_data[job.name];
+            // the mipmaps of the environment map are generated when it's loaded
+            read_cubemap_texture(textures.environment_texture, job.map_sizes.environment_map_width, 1, job.cubemap_data.environment_map);
+            read_cubemap_texture(textures.irradiance_texture, job.map_sizes.irradiance_map_width, 1, job.cubemap_data.irradiance_map);
+            read_cubemap_texture(textures.prefilter_texture, job.map_sizes.prefilter_map_width, PREFILTER_MAP_MIP_LEVELS, job.cubemap_data.prefilter_map);
+        }
+    }
+    hdri_states[job.name] = HdriLoaded;
+}
+
+void HdriLoader::write(HdriLoadJob& job) {
+    if (job.write_cache && !write_ibl_cache(job.name, job.cache_key, job.cubemap_data)) {
+        std::cout << "ERROR::IBL_CACHE:: Failed to write the IBL maps of " << job.name << std::endl;
+    }
+    job.cubemap_data = CookedCubemapData();
+}
+
+// Background thread: reads the requested HDRIs and writes the IBL cache of the computed ones
+void HdriLoader::process_jobs() {
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    while (true) {
+        jobs_available.wait(lock, [this]() { return stop_loader_thread || !read_jobs.empty() || !write_jobs.empty(); });
+        if (stop_loader_thread) {
+            return;
+        }
+        if (!write_jobs.empty()) {
+            std::shared_ptr<HdriLoadJob> job = write_jobs.front();
+            write_jobs.pop_front();
+            lock.unlock();
+            write(*job);
+            lock.lock();
+        }
+        else {
+            std::shared_ptr<HdriLoadJob> job = read_jobs.front();
+            read_jobs.pop_front();
+            lock.unlock();
+            read(*job);
+            lock.lock();
+            finished_read_jobs.push_back(job);
+        }
+    }
+}
+
+// Finishes at most one HDRI per frame, the computation of the maps of a new HDRI takes a while
+void HdriLoader::update() {
+    std::shared_ptr<HdriLoadJob> job;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        if (finished_read_jobs.empty()) {
+            return;
+        }
+        job = finished_read_jobs.front();
+        finished_read_jobs.erase(finished_read_jobs.begin());
+    }
+    finish(*job);
+    if (job->write_cache) {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        write_jobs.push_back(job);
+        jobs_available.notify_one();
+    }
+}
+
+void HdriLoader::unload(const std::string& name) {
+    if (!is_registered(name) || hdri_states[name] != HdriLoaded) {
+        return;
+    }
+    CubemapData& textures = rendering->cubemap->umap_name_to_cubemap_data[name];
+    unsigned int texture_ids[3] = { textures.environment_texture, textures.irradiance_texture, textures.prefilter_texture };
+    for (int i = 0; i < 3; i++) {
+        ResourceRegistry::get_instance()->release(ResourceCubemap, texture_ids[i]);
+    }
+    glDeleteTextures(3, texture_ids);
+    textures.environment_texture = 0;
+    textures.irradiance_texture = 0;
+    textures.prefilter_texture = 0;
+    hdri_states[name] = HdriUnloaded;
+}
+
+void HdriLoader::unload_all_except(const std::string& name) {
+    for (auto it = hdri_states.begin(); it != hdri_states.end(); it++) {
+        if (it->first != name) {
+            unload(it->first);
+        }
+    }
+}
+
+void HdriLoader::clean() {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        stop_loader_thread = true;
+        jobs_available.notify_one();
+    }
+    if (loader_thread.joinable()) {
+        loader_thread.join();
+    }
+    for (int i = 0; i < finished_read_jobs.size(); i++) {
+        free_image_data(finished_read_jobs[i]->equirectangular_image);
+    }
+    finished_read_jobs.clear();
+}
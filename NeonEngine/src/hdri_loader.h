@@ -0,0 +1,76 @@
+#pragma once
+
+#include "opengl_utils.h"
+#include "cooked_assets.h"
+#include "ibl_cache.h"
+
+#include <string>
+#include <map>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+class Rendering;
+
+enum HdriState {
+    HdriUnloaded,
+    HdriLoading,
+    HdriLoaded
+};
+
+// Loading of the IBL maps of one HDRI: read (worker) -> finish (GL thread) -> write of the IBL cache (worker)
+struct HdriLoadJob {
+    std::string name;
+    std::string path;
+    IblMapSizes map_sizes;
+    int prefilter_sample_count = 0;
+    uint64_t cache_key = 0;
+    // the maps come from the cooked files or from the IBL cache, otherwise they are computed from the decoded image
+    bool has_precomputed_maps = false;
+    bool write_cache = false;
+    ImageData equirectangular_image;
+    CookedCubemapData cubemap_data;
+};
+
+// The HDRIs are registered as metadata only (an entry of the cubemaps without textures) and their IBL maps are
+// created the first time they are requested, usually when the skybox switches to them. The reading and decoding
+// run in a background thread and the GL work in update(), once per frame. Unloaded HDRIs use no VRAM.
+class HdriLoader {
+public:
+    HdriLoader(Rendering* rendering);
+
+    // GL thread only
+    void register_hdri(const std::string& name, const std::string& path);
+    bool is_registered(const std::string& name);
+    HdriState get_state(const std::string& name);
+    void request(const std::string& name);
+    void request_all();
+    void update();
+    void unload(const std::string& name);
+    // Unloads every HDRI but one, the others use no VRAM
+    void unload_all_except(const std::string& name);
+    void clean();
+
+    // The steps of a job, also used by the startup tasks of the default skybox
+    static void read(HdriLoadJob& job);
+    void finish(HdriLoadJob& job);
+    static void write(HdriLoadJob& job);
+
+private:
+    void process_jobs();
+
+    Rendering* rendering;
+    std::map<std::string, std::string> hdri_paths;
+    std::map<std::string, HdriState> hdri_states;
+
+    std::thread loader_thread;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_available;
+    std::deque<std::shared_ptr<HdriLoadJob>> read_jobs;
+    std::deque<std::shared_ptr<HdriLoadJob>> write_jobs;
+    std::vector<std::shared_ptr<HdriLoadJob>> finished_read_jobs;
+    bool stop_loader_thread = false;
+};
@@ -0,0 +1,131 @@
+#include "headless_context.h"
+
+#include <glad/glad.h>
+#include <iostream>
+
+#ifdef NEON_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+HeadlessContext::HeadlessContext() {
+#ifdef NEON_HEADLESS_EGL
+    display = nullptr;
+    context = nullptr;
+#else
+    window = nullptr;
+#endif
+}
+
+#ifdef NEON_HEADLESS_EGL
+
+bool HeadlessContext::create(int major_version, int minor_version) {
+    // the surfaceless platform of Mesa doesn't need a display server
+    EGLDisplay egl_display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display != nullptr) {
+        egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (egl_display == EGL_NO_DISPLAY) {
+        egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, nullptr, nullptr)) {
+        std::cout << "ERROR::HEADLESS:: Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    display = egl_display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "ERROR::HEADLESS:: EGL doesn't support desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+    EGLint config_attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(egl_display, config_attributes, &config, 1, &num_configs) || num_configs == 0) {
+        std::cout << "ERROR::HEADLESS:: No EGL config for desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major_version,
+        EGL_CONTEXT_MINOR_VERSION, minor_version,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cout << "ERROR::HEADLESS:: Failed to create an OpenGL " << major_version << "." << minor_version << " context" << std::endl;
+        context = nullptr;
+        destroy();
+        return false;
+    }
+    // without surfaces, all the rendering goes to framebuffer objects
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cout << "ERROR::HEADLESS:: Failed to make the context current (EGL_KHR_surfaceless_context)" << std::endl;
+        destroy();
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cout << "ERROR::HEADLESS:: Failed to initialize GLAD" << std::endl;
+        destroy();
+        return false;
+    }
+    std::cout << "HEADLESS CONTEXT: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+    return true;
+}
+
+void HeadlessContext::destroy() {
+    if (display != nullptr) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != nullptr) {
+            eglDestroyContext(display, context);
+            context = nullptr;
+        }
+        eglTerminate(display);
+        display = nullptr;
+    }
+}
+
+#else
+
+bool HeadlessContext::create(int major_version, int minor_version) {
+    if (!glfwInit()) {
+        std::cout << "ERROR::HEADLESS:: Failed to initialize GLFW" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major_version);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor_version);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(1, 1, "Neon Engine (headless)", NULL, NULL);
+    if (window == nullptr) {
+        std::cout << "ERROR::HEADLESS:: Failed to create the GL context" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "ERROR::HEADLESS:: Failed to initialize GLAD" << std::endl;
+        destroy();
+        return false;
+    }
+    std::cout << "HEADLESS CONTEXT: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+    return true;
+}
+
+void HeadlessContext::destroy() {
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        window = nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+struct GLFWwindow;
+
+// GL context without a window for the headless mode. Built with NEON_HEADLESS_EGL (and linked with libEGL) it's a
+// surfaceless EGL context, which on machines without a GPU runs on Mesa's software rasterizer (llvmpipe); otherwise
+// it's the context of a hidden GLFW window, which still needs a display. Everything is rendered into framebuffers.
+class HeadlessContext {
+public:
+    HeadlessContext();
+
+    // Creates the context, makes it current and loads the GL functions
+    bool create(int major_version, int minor_version);
+    void destroy();
+
+private:
+#ifdef NEON_HEADLESS_EGL
+    void* display;
+    void* context;
+#else
+    GLFWwindow* window;
+#endif
+};
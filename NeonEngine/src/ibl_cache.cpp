@@ -0,0 +1,127 @@
+#include "ibl_cache.h"
+#include "model_cache.h"
+#include "cubemap.h"
+
+#include <glad/glad.h>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+const std::string IBL_ENVIRONMENT_MAP_EXTENSION = ".environment.ktx2";
+const std::string IBL_IRRADIANCE_MAP_EXTENSION = ".irradiance.ktx2";
+const std::string IBL_PREFILTER_MAP_EXTENSION = ".prefilter.ktx2";
+const std::string IBL_BRDF_LUT_EXTENSION = ".ktx2";
+
+// Shaders of the environment, irradiance and prefilter maps
+const std::string IBL_SHADER_PATHS[] = {
+    "shaders/cubemap.vert", "shaders/equirectangular_to_cubemap.frag", "shaders/irradiance_convolution.frag", "shaders/prefilter.comp"
+};
+
+uint64_t compute_ibl_cache_key(const std::string& hdri_path, const IblMapSizes& map_sizes, int prefilter_sample_count) {
+    // the HDRIs are large, an unchanged one isn't read again to check its cache
+    uint64_t hdri_hash = get_file_content_hash(hdri_path);
+    uint64_t cache_key = hash_bytes(&hdri_hash, sizeof(hdri_hash));
+    for (int i = 0; i < std::size(IBL_SHADER_PATHS); i++) {
+        cache_key = hash_file(IBL_SHADER_PATHS[i], cache_key);
+    }
+    cache_key = hash_bytes(&map_sizes, sizeof(map_sizes), cache_key);
+    cache_key = hash_bytes(&prefilter_sample_count, sizeof(prefilter_sample_count), cache_key);
+    cache_key = hash_bytes(&PREFILTER_MAP_MIP_LEVELS, sizeof(PREFILTER_MAP_MIP_LEVELS), cache_key);
+    cache_key = hash_bytes(&IBL_CACHE_VERSION, sizeof(IBL_CACHE_VERSION), cache_key);
+    return cache_key;
+}
+
+std::string get_ibl_cache_path(const std::string& name, uint64_t cache_key, const std::string& extension) {
+    std::stringstream ss;
+    ss << IBL_CACHE_DIRECTORY << "/" << name << "_" << std::hex << std::setw(16) << std::setfill('0') << cache_key << extension;
+    return ss.str();
+}
+
+bool read_ibl_cache(const std::string& name, uint64_t cache_key, const IblMapSizes& map_sizes, CookedCubemapData& cubemap_data) {
+    std::string prefilter_map_path = get_ibl_cache_path(name, cache_key, IBL_PREFILTER_MAP_EXTENSION);
+    if (!std::filesystem::exists(prefilter_map_path)) {
+        return false;
+    }
+    bool valid = read_ktx2_file(get_ibl_cache_path(name, cache_key, IBL_ENVIRONMENT_MAP_EXTENSION), cubemap_data.environment_map) &&
+        read_ktx2_file(get_ibl_cache_path(name, cache_key, IBL_IRRADIANCE_MAP_EXTENSION), cubemap_data.irradiance_map) &&
+        read_ktx2_file(prefilter_map_path, cubemap_data.prefilter_map);
+    valid = valid && cubemap_data.environment_map.num_faces == 6 && cubemap_data.environment_map.width == map_sizes.environment_map_width &&
+        cubemap_data.irradiance_map.num_faces == 6 && cubemap_data.irradiance_map.width == map_sizes.irradiance_map_width &&
+        cubemap_data.prefilter_map.num_faces == 6 && cubemap_data.prefilter_map.width == map_sizes.prefilter_map_width &&
+        cubemap_data.prefilter_map.levels.size() == PREFILTER_MAP_MIP_LEVELS;
+    if (!valid) {
+        std::cout << "WARNING::IBL_CACHE:: The cached IBL maps of " << name << " can't be used" << std::endl;
+        cubemap_data = CookedCubemapData();
+    }
+    return valid;
+}
+
+bool write_ibl_cache(const std::string& name, uint64_t cache_key, const CookedCubemapData& cubemap_data) {
+    std::error_code error;
+    std::filesystem::create_directories(IBL_CACHE_DIRECTORY, error);
+    // the prefilter map is written last, it marks the entry as complete
+    return write_ktx2_file(get_ibl_cache_path(name, cache_key, IBL_ENVIRONMENT_MAP_EXTENSION), cubemap_data.environment_map) &&
+        write_ktx2_file(get_ibl_cache_path(name, cache_key, IBL_IRRADIANCE_MAP_EXTENSION), cubemap_data.irradiance_map) &&
+        write_ktx2_file(get_ibl_cache_path(name, cache_key, IBL_PREFILTER_MAP_EXTENSION), cubemap_data.prefilter_map);
+}
+
+// The LUT only depends on the BRDF shaders and its size
+uint64_t compute_brdf_lut_cache_key(int width, int height) {
+    uint64_t cache_key = hash_file("shaders/brdf.vert");
+    cache_key = hash_file("shaders/brdf.frag", cache_key);
+    cache_key = hash_bytes(&width, sizeof(width), cache_key);
+    cache_key = hash_bytes(&height, sizeof(height), cache_key);
+    cache_key = hash_bytes(&IBL_CACHE_VERSION, sizeof(IBL_CACHE_VERSION), cache_key);
+    return cache_key;
+}
+
+bool read_brdf_lut_cache(uint64_t cache_key, int width, int height, Ktx2Texture& texture) {
+    std::string path = get_ibl_cache_path("brdf_lut", cache_key, IBL_BRDF_LUT_EXTENSION);
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    return read_ktx2_file(path, texture) && texture.width == width && texture.height == height && texture.num_faces == 1;
+}
+
+bool write_brdf_lut_cache(uint64_t cache_key, const Ktx2Texture& texture) {
+    std::error_code error;
+    std::filesystem::create_directories(IBL_CACHE_DIRECTORY, error);
+    return write_ktx2_file(get_ibl_cache_path("brdf_lut", cache_key, IBL_BRDF_LUT_EXTENSION), texture);
+}
+
+// Reads back all the levels of a RGB16F cubemap
+void read_cubemap_texture(unsigned int texture_id, int width, int num_levels, Ktx2Texture& texture) {
+    texture.format = KTX2_FORMAT_R16G16B16_SFLOAT;
+    texture.width = width;
+    texture.height = width;
+    texture.num_faces = 6;
+    texture.levels.resize(num_levels);
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture.format);
+
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    for (int level = 0; level < num_levels; level++) {
+        uint32_t level_width = std::max(width >> level, 1);
+        size_t face_size = get_ktx2_level_face_size(format_info, level_width, level_width);
+        texture.levels[level].resize(face_size * 6);
+        for (int face = 0; face < 6; face++) {
+            glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_RGB, GL_HALF_FLOAT, texture.levels[level].data() + face * face_size);
+        }
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+void read_brdf_lut_texture(unsigned int texture_id, int width, int height, Ktx2Texture& texture) {
+    texture.format = KTX2_FORMAT_R16G16B16A16_SFLOAT;
+    texture.width = width;
+    texture.height = height;
+    texture.num_faces = 1;
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture.format);
+    texture.levels.resize(1);
+    texture.levels[0].resize(get_ktx2_level_face_size(format_info, width, height));
+
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_HALF_FLOAT, texture.levels[0].data());
+}
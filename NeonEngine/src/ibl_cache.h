@@ -0,0 +1,35 @@
+#pragma once
+
+#include "cooked_assets.h"
+
+#include <string>
+#include <cstdint>
+
+const uint32_t IBL_CACHE_VERSION = 1;
+const std::string IBL_CACHE_DIRECTORY = "cache/ibl";
+
+// Sizes of the maps computed from an HDRI, part of the key of its cache entry
+struct IblMapSizes {
+    int environment_map_width;
+    int irradiance_map_width;
+    int prefilter_map_width;
+};
+
+// Disk cache of the IBL precomputation of the HDRIs (environment, irradiance and prefilter maps as RGB16F KTX2 cubemaps)
+// and of the BRDF LUT, so the convolutions only run the first time an HDRI is seen. The key covers the contents of the
+// HDRI and of the shaders of the maps (or of the BRDF shaders), the sizes of the maps, the samples of the prefilter map
+// and the cache version:
+// cache/ibl/<name>_<key>.<map>.ktx2
+uint64_t compute_ibl_cache_key(const std::string& hdri_path, const IblMapSizes& map_sizes, int prefilter_sample_count);
+std::string get_ibl_cache_path(const std::string& name, uint64_t cache_key, const std::string& extension);
+// Worker threads. Reading fails when an entry doesn't exist or doesn't match the sizes
+bool read_ibl_cache(const std::string& name, uint64_t cache_key, const IblMapSizes& map_sizes, CookedCubemapData& cubemap_data);
+bool write_ibl_cache(const std::string& name, uint64_t cache_key, const CookedCubemapData& cubemap_data);
+
+uint64_t compute_brdf_lut_cache_key(int width, int height);
+bool read_brdf_lut_cache(uint64_t cache_key, int width, int height, Ktx2Texture& texture);
+bool write_brdf_lut_cache(uint64_t cache_key, const Ktx2Texture& texture);
+
+// GL thread. Reads back the levels of the IBL textures in the format of the cache
+void read_cubemap_texture(unsigned int texture_id, int width, int num_levels, Ktx2Texture& texture);
+void read_brdf_lut_texture(unsigned int texture_id, int width, int height, Ktx2Texture& texture);
@@ -0,0 +1,296 @@
+#include "json.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static const JsonValue null_json_value;
+
+JsonValue::JsonValue() : type(JsonNull), boolean(false), number(0.0) {}
+
+bool JsonValue::has(const std::string& key) const {
+    return type == JsonObject && object.find(key) != object.end();
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    if (type != JsonObject) {
+        return null_json_value;
+    }
+    auto it = object.find(key);
+    if (it == object.end()) {
+        return null_json_value;
+    }
+    return it->second;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (type != JsonArray || index >= array.size()) {
+        return null_json_value;
+    }
+    return array[index];
+}
+
+size_t JsonValue::size() const {
+    if (type == JsonArray) {
+        return array.size();
+    }
+    else if (type == JsonObject) {
+        return object.size();
+    }
+    return 0;
+}
+
+int JsonValue::get_int(int default_value) const {
+    return type == JsonNumber ? (int)number : default_value;
+}
+
+double JsonValue::get_number(double default_value) const {
+    return type == JsonNumber ? number : default_value;
+}
+
+bool JsonValue::get_bool(bool default_value) const {
+    return type == JsonBool ? boolean : default_value;
+}
+
+const std::string& JsonValue::get_string() const {
+    return string;
+}
+
+// Recursive descent parser
+class JsonParser {
+public:
+    const char* text;
+    size_t length;
+    size_t position;
+    std::string error;
+
+    JsonParser(const char* text, size_t length) : text(text), length(length), position(0) {}
+
+    void skip_whitespace() {
+        while (position < length && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r')) {
+            position++;
+        }
+    }
+
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message + " at offset " + std::to_string(position);
+        }
+        return false;
+    }
+
+    bool match(const char* literal) {
+        size_t literal_length = strlen(literal);
+        if (position + literal_length > length || strncmp(text + position, literal, literal_length) != 0) {
+            return false;
+        }
+        position += literal_length;
+        return true;
+    }
+
+    static void append_utf8(std::string& output, unsigned int code_point) {
+        if (code_point < 0x80) {
+            output += (char)code_point;
+        }
+        else if (code_point < 0x800) {
+            output += (char)(0xC0 | (code_point >> 6));
+            output += (char)(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000) {
+            output += (char)(0xE0 | (code_point >> 12));
+            output += (char)(0x80 | ((code_point >> 6) & 0x3F));
+            output += (char)(0x80 | (code_point & 0x3F));
+        }
+        else {
+            output += (char)(0xF0 | (code_point >> 18));
+            output += (char)(0x80 | ((code_point >> 12) & 0x3F));
+            output += (char)(0x80 | ((code_point >> 6) & 0x3F));
+            output += (char)(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    bool parse_hex4(unsigned int& code_point) {
+        if (position + 4 > length) {
+            return fail("Truncated unicode escape");
+        }
+        code_point = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[position++];
+            code_point <<= 4;
+            if (c >= '0' && c <= '9') code_point |= c - '0';
+            else if (c >= 'a' && c <= 'f') code_point |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code_point |= c - 'A' + 10;
+            else return fail("Invalid unicode escape");
+        }
+        return true;
+    }
+
+    bool parse_string(std::string& output) {
+        position++; // opening quote
+        while (position < length && text[position] != '"') {
+            char c = text[position++];
+            if (c != '\\') {
+                output += c;
+                continue;
+            }
+            if (position >= length) {
+                return fail("Truncated escape sequence");
+            }
+            char escaped = text[position++];
+            switch (escaped) {
+            case '"': output += '"'; break;
+            case '\\': output += '\\'; break;
+            case '/': output += '/'; break;
+            case 'b': output += '\b'; break;
+            case 'f': output += '\f'; break;
+            case 'n': output += '\n'; break;
+            case 'r': output += '\r'; break;
+            case 't': output += '\t'; break;
+            case 'u': {
+                unsigned int code_point;
+                if (!parse_hex4(code_point)) {
+                    return false;
+                }
+                // Surrogate pair
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && match("\\u")) {
+                    unsigned int low_surrogate;
+                    if (!parse_hex4(low_surrogate)) {
+                        return false;
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                }
+                append_utf8(output, code_point);
+                break;
+            }
+            default:
+                return fail("Invalid escape sequence");
+            }
+        }
+        if (position >= length) {
+            return fail("Unterminated string");
+        }
+        position++; // closing quote
+        return true;
+    }
+
+    bool parse_value(JsonValue& value, int depth) {
+        if (depth > 256) {
+            return fail("Maximum nesting depth exceeded");
+        }
+        skip_whitespace();
+        if (position >= length) {
+            return fail("Unexpected end of input");
+        }
+
+        char c = text[position];
+        if (c == '{') {
+            value.type = JsonObject;
+            position++;
+            skip_whitespace();
+            if (position < length && text[position] == '}') {
+                position++;
+                return true;
+            }
+            while (true) {
+                skip_whitespace();
+                if (position >= length || text[position] != '"') {
+                    return fail("Expected a key");
+                }
+                std::string key;
+                if (!parse_string(key)) {
+                    return false;
+                }
+                skip_whitespace();
+                if (position >= length || text[position] != ':') {
+                    return fail("Expected ':'");
+                }
+                position++;
+                if (!parse_value(value.object[key], depth + 1)) {
+                    return false;
+                }
+                skip_whitespace();
+                if (position < length && text[position] == ',') {
+                    position++;
+                }
+                else if (position < length && text[position] == '}') {
+                    position++;
+                    return true;
+                }
+                else {
+                    return fail("Expected ',' or '}'");
+                }
+            }
+        }
+        else if (c == '[') {
+            value.type = JsonArray;
+            position++;
+            skip_whitespace();
+            if (position < length && text[position] == ']') {
+                position++;
+                return true;
+            }
+            while (true) {
+                value.array.push_back(JsonValue());
+                if (!parse_value(value.array.back(), depth + 1)) {
+                    return false;
+                }
+                skip_whitespace();
+                if (position < length && text[position] == ',') {
+                    position++;
+                }
+                else if (position < length && text[position] == ']') {
+                    position++;
+                    return true;
+                }
+                else {
+                    return fail("Expected ',' or ']'");
+                }
+            }
+        }
+        else if (c == '"') {
+            value.type = JsonString;
+            return parse_string(value.string);
+        }
+        else if (match("true")) {
+            value.type = JsonBool;
+            value.boolean = true;
+            return true;
+        }
+        else if (match("false")) {
+            value.type = JsonBool;
+            value.boolean = false;
+            return true;
+        }
+        else if (match("null")) {
+            value.type = JsonNull;
+            return true;
+        }
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            // strtod stops at the end of the number, the text doesn't need to be null terminated after it
+            // because a JSON document always ends with '}' or ']'
+            char* end;
+            value.type = JsonNumber;
+            value.number = strtod(text + position, &end);
+            if (end == text + position) {
+                return fail("Invalid number");
+            }
+            position = end - text;
+            return true;
+        }
+        return fail("Unexpected character");
+    }
+};
+
+bool parse_json(const char* text, size_t length, JsonValue& value, std::string& error) {
+    JsonParser parser(text, length);
+    value = JsonValue();
+    if (!parser.parse_value(value, 0)) {
+        error = parser.error;
+        return false;
+    }
+    parser.skip_whitespace();
+    if (parser.position != length) {
+        error = "Unexpected data after the end of the document";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+enum JsonType {
+    JsonNull, JsonBool, JsonNumber, JsonString, JsonArray, JsonObject
+};
+
+// Minimal JSON document, enough to read glTF files
+class JsonValue {
+public:
+    JsonType type;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    JsonValue();
+
+    bool has(const std::string& key) const;
+    // Returns a null value when the key doesn't exist or this is not an object
+    const JsonValue& operator[](const std::string& key) const;
+    // Returns a null value when the index is out of range or this is not an array
+    const JsonValue& operator[](size_t index) const;
+    size_t size() const;
+
+    int get_int(int default_value = 0) const;
+    double get_number(double default_value = 0.0) const;
+    bool get_bool(bool default_value = false) const;
+    const std::string& get_string() const;
+};
+
+// Returns false and fills error when the text is not valid JSON
+bool parse_json(const char* text, size_t length, JsonValue& value, std::string& error);
@@ -0,0 +1,346 @@
+#include "ktx2.h"
+
+#include "mapped_file.h"
+
+#include <glad/glad.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// S3TC isn't part of core GL, the formats are always available on desktop GPUs
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Color models and transfer functions of the data format descriptor
+const uint32_t KHR_DF_MODEL_RGBSDA = 1;
+const uint32_t KHR_DF_MODEL_BC1A = 128;
+const uint32_t KHR_DF_MODEL_BC3 = 130;
+const uint32_t KHR_DF_MODEL_BC4 = 131;
+const uint32_t KHR_DF_MODEL_BC5 = 132;
+const uint32_t KHR_DF_MODEL_BC7 = 134;
+const uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+const uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+
+static const Ktx2FormatInfo ktx2_formats[] = {
+    { KTX2_FORMAT_R8_UNORM, KHR_DF_MODEL_RGBSDA, 1, 1, 1, 1, false, GL_R8, GL_RED, GL_UNSIGNED_BYTE },
+    { KTX2_FORMAT_R8G8_UNORM, KHR_DF_MODEL_RGBSDA, 2, 2, 1, 1, false, GL_RG8, GL_RG, GL_UNSIGNED_BYTE },
+    { KTX2_FORMAT_R8G8B8_UNORM, KHR_DF_MODEL_RGBSDA, 3, 3, 1, 1, false, GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE },
+    { KTX2_FORMAT_R8G8B8A8_UNORM, KHR_DF_MODEL_RGBSDA, 4, 4, 1, 1, false, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE },
+    { KTX2_FORMAT_R16G16B16_SFLOAT, KHR_DF_MODEL_RGBSDA, 3, 6, 1, 2, true, GL_RGB16F, GL_RGB, GL_HALF_FLOAT },
+    { KTX2_FORMAT_R16G16B16A16_SFLOAT, KHR_DF_MODEL_RGBSDA, 4, 8, 1, 2, true, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT },
+    { KTX2_FORMAT_R32G32B32_SFLOAT, KHR_DF_MODEL_RGBSDA, 3, 12, 1, 4, true, GL_RGB32F, GL_RGB, GL_FLOAT },
+    { KTX2_FORMAT_R32G32B32A32_SFLOAT, KHR_DF_MODEL_RGBSDA, 4, 16, 1, 4, true, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+    { KTX2_FORMAT_BC1_RGB_UNORM_BLOCK, KHR_DF_MODEL_BC1A, 3, 8, 4, 1, false, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, 0 },
+    { KTX2_FORMAT_BC3_UNORM_BLOCK, KHR_DF_MODEL_BC3, 4, 16, 4, 1, false, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0 },
+    { KTX2_FORMAT_BC4_UNORM_BLOCK, KHR_DF_MODEL_BC4, 1, 8, 4, 1, false, GL_COMPRESSED_RED_RGTC1, 0, 0 },
+    { KTX2_FORMAT_BC5_UNORM_BLOCK, KHR_DF_MODEL_BC5, 2, 16, 4, 1, false, GL_COMPRESSED_RG_RGTC2, 0, 0 },
+    { KTX2_FORMAT_BC7_UNORM_BLOCK, KHR_DF_MODEL_BC7, 4, 16, 4, 1, false, GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0 },
+};
+
+const Ktx2FormatInfo* get_ktx2_format_info(uint32_t format) {
+    for (int i = 0; i < sizeof(ktx2_formats) / sizeof(ktx2_formats[0]); i++) {
+        if (ktx2_formats[i].format == format) {
+            return &ktx2_formats[i];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t get_ktx2_format_of_channels(int num_channels) {
+    if (num_channels == 1) {
+        return KTX2_FORMAT_R8_UNORM;
+    }
+    else if (num_channels == 2) {
+        return KTX2_FORMAT_R8G8_UNORM;
+    }
+    else if (num_channels == 3) {
+        return KTX2_FORMAT_R8G8B8_UNORM;
+    }
+    return KTX2_FORMAT_R8G8B8A8_UNORM;
+}
+
+size_t get_ktx2_level_face_size(const Ktx2FormatInfo* format_info, uint32_t width, uint32_t height) {
+    size_t num_blocks_x = (width + format_info->block_size - 1) / format_info->block_size;
+    size_t num_blocks_y = (height + format_info->block_size - 1) / format_info->block_size;
+    return num_blocks_x * num_blocks_y * format_info->bytes_per_block;
+}
+
+// Basic data format descriptor: one sample per channel, the compressed formats have one sample per block part
+// (BC3: alpha and color, BC5: red and green, BC1, BC4 and BC7: the whole block)
+static std::vector<uint32_t> create_data_format_descriptor(const Ktx2FormatInfo* format_info) {
+    const uint32_t channel_ids[4] = { 0, 1, 2, 15 }; // R, G, B, A
+    bool is_compressed = format_info->block_size > 1;
+    uint32_t num_samples = format_info->num_channels;
+    if (is_compressed) {
+        num_samples = (format_info->format == KTX2_FORMAT_BC3_UNORM_BLOCK || format_info->format == KTX2_FORMAT_BC5_UNORM_BLOCK) ? 2 : 1;
+    }
+    uint32_t block_size_in_bytes = 24 + 16 * num_samples;
+
+    std::vector<uint32_t> descriptor;
+    descriptor.push_back(4 + block_size_in_bytes);
+    descriptor.push_back(0); // vendor Khronos, basic descriptor type
+    descriptor.push_back(2 | (block_size_in_bytes << 16)); // version 2
+    descriptor.push_back(format_info->color_model | (KHR_DF_PRIMARIES_BT709 << 8) | (KHR_DF_TRANSFER_LINEAR << 16));
+    uint32_t block_dimension = format_info->block_size - 1;
+    descriptor.push_back(block_dimension | (block_dimension << 8));
+    descriptor.push_back(format_info->bytes_per_block);
+    descriptor.push_back(0);
+    for (uint32_t i = 0; i < num_samples; i++) {
+        uint32_t bit_length = is_compressed ? format_info->bytes_per_block * 8 / num_samples : format_info->bytes_per_channel * 8;
+        uint32_t channel_type = channel_ids[num_samples == 1 ? 0 : (i == 3 ? 3 : i)];
+        if (format_info->format == KTX2_FORMAT_BC3_UNORM_BLOCK) {
+            channel_type = i == 0 ? 15 : 0;
+        }
+        uint32_t qualifiers = format_info->is_float ? 0xC : 0x0; // float and signed
+        descriptor.push_back((i * bit_length) | ((bit_length - 1) << 16) | (channel_type << 24) | (qualifiers << 28));
+        descriptor.push_back(0);
+        if (format_info->is_float) {
+            descriptor.push_back(0xBF800000); // -1.0f
+            descriptor.push_back(0x3F800000); // 1.0f
+        }
+        else {
+            descriptor.push_back(0);
+            descriptor.push_back(bit_length >= 32 ? 0xFFFFFFFF : (1u << bit_length) - 1);
+        }
+    }
+    return descriptor;
+}
+
+template <typename T>
+static void append_value(std::vector<unsigned char>& buffer, const T& value) {
+    const unsigned char* bytes = (const unsigned char*)&value;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void align_buffer(std::vector<unsigned char>& buffer, size_t alignment) {
+    while (buffer.size() % alignment != 0) {
+        buffer.push_back(0);
+    }
+}
+
+bool write_ktx2_file(const std::string& path, const Ktx2Texture& texture) {
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture.format);
+    if (format_info == nullptr || texture.levels.empty()) {
+        std::cout << "ERROR::KTX2:: Unsupported texture for " << path << std::endl;
+        return false;
+    }
+    uint32_t num_levels = (uint32_t)texture.levels.size();
+
+    // Header, the index and level index are filled at the end
+    std::vector<unsigned char> buffer(KTX2_IDENTIFIER, KTX2_IDENTIFIER + 12);
+    append_value(buffer, texture.format);
+    append_value(buffer, (uint32_t)(format_info->block_size == 1 ? format_info->bytes_per_channel : 1)); // type size
+    append_value(buffer, texture.width);
+    append_value(buffer, texture.height);
+    append_value(buffer, (uint32_t)0); // depth
+    append_value(buffer, (uint32_t)0); // layers
+    append_value(buffer, texture.num_faces);
+    append_value(buffer, num_levels);
+    append_value(buffer, (uint32_t)0); // no supercompression
+    size_t index_offset = buffer.size();
+    buffer.resize(buffer.size() + 32 + 24 * num_levels);
+
+    // Data format descriptor
+    std::vector<uint32_t> descriptor = create_data_format_descriptor(format_info);
+    uint32_t dfd_offset = (uint32_t)buffer.size();
+    for (int i = 0; i < descriptor.size(); i++) {
+        append_value(buffer, descriptor[i]);
+    }
+    uint32_t dfd_length = (uint32_t)buffer.size() - dfd_offset;
+
+    // Key/value data, sorted by key
+    uint32_t kvd_offset = (uint32_t)buffer.size();
+    for (auto it = texture.key_values.begin(); it != texture.key_values.end(); it++) {
+        uint32_t length = (uint32_t)(it->first.size() + 1 + it->second.size() + 1);
+        append_value(buffer, length);
+        buffer.insert(buffer.end(), it->first.begin(), it->first.end());
+        buffer.push_back(0);
+        buffer.insert(buffer.end(), it->second.begin(), it->second.end());
+        buffer.push_back(0);
+        align_buffer(buffer, 4);
+    }
+    uint32_t kvd_length = (uint32_t)buffer.size() - kvd_offset;
+    if (kvd_length == 0) {
+        kvd_offset = 0;
+    }
+
+    uint32_t index[4] = { dfd_offset, dfd_length, kvd_offset, kvd_length };
+    memcpy(buffer.data() + index_offset, index, sizeof(index));
+
+    // The levels are stored from the smallest to the largest, each one aligned to lcm(block size, 4)
+    size_t level_alignment = std::lcm((size_t)format_info->bytes_per_block, (size_t)4);
+    std::vector<uint64_t> level_index(3 * num_levels);
+    for (int level = num_levels - 1; level >= 0; level--) {
+        align_buffer(buffer, level_alignment);
+        level_index[3 * level] = buffer.size();
+        level_index[3 * level + 1] = texture.levels[level].size();
+        level_index[3 * level + 2] = texture.levels[level].size();
+        buffer.insert(buffer.end(), texture.levels[level].begin(), texture.levels[level].end());
+    }
+    memcpy(buffer.data() + index_offset + 32, level_index.data(), level_index.size() * sizeof(uint64_t));
+
+    // Written to a temporary file first so a reader never sees a partial file
+    std::error_code error;
+    std::filesystem::path file_path(path);
+    if (file_path.has_parent_path()) {
+        std::filesystem::create_directories(file_path.parent_path(), error);
+    }
+    std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cout << "ERROR::KTX2:: Failed to write the file: " << path << std::endl;
+            return false;
+        }
+        file.write((const char*)buffer.data(), buffer.size());
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
+
+bool read_ktx2_file(const std::string& path, Ktx2Texture& texture) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    const size_t HEADER_SIZE = 12 + 9 * 4 + 32;
+    if (file.size < HEADER_SIZE || memcmp(file.data, KTX2_IDENTIFIER, 12) != 0) {
+        std::cout << "ERROR::KTX2:: Invalid file: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t header[9];
+    memcpy(header, file.data + 12, sizeof(header));
+    texture.format = header[0];
+    texture.width = header[2];
+    texture.height = header[3];
+    texture.num_faces = header[6];
+    uint32_t num_levels = std::max(header[7], 1u);
+    uint32_t supercompression = header[8];
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture.format);
+    if (format_info == nullptr || supercompression != 0 || header[4] > 1 || header[5] > 1 ||
+        (texture.num_faces != 1 && texture.num_faces != 6) || HEADER_SIZE + 24 * (size_t)num_levels > file.size) {
+        std::cout << "ERROR::KTX2:: Unsupported file: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t index[4];
+    memcpy(index, file.data + 48, sizeof(index));
+    uint32_t kvd_offset = index[2];
+    uint32_t kvd_length = index[3];
+    if ((size_t)kvd_offset + kvd_length > file.size) {
+        return false;
+    }
+    size_t kvd_position = kvd_offset;
+    while (kvd_length > 0 && kvd_position + 4 <= (size_t)kvd_offset + kvd_length) {
+        uint32_t length;
+        memcpy(&length, file.data + kvd_position, 4);
+        kvd_position += 4;
+        if (kvd_position + length > (size_t)kvd_offset + kvd_length) {
+            break;
+        }
+        std::string key_value((const char*)file.data + kvd_position, length);
+        size_t separator = key_value.find('\0');
+        if (separator != std::string::npos) {
+            std::string value = key_value.substr(separator + 1);
+            if (!value.empty() && value.back() == '\0') {
+                value.pop_back();
+            }
+            texture.key_values[key_value.substr(0, separator)] = value;
+        }
+        kvd_position += (length + 3) & ~3u;
+    }
+
+    texture.levels.resize(num_levels);
+    for (uint32_t level = 0; level < num_levels; level++) {
+        uint64_t level_index[3];
+        memcpy(level_index, file.data + HEADER_SIZE + 24 * level, sizeof(level_index));
+        uint32_t level_width = std::max(texture.width >> level, 1u);
+        uint32_t level_height = std::max(texture.height >> level, 1u);
+        size_t expected_size = get_ktx2_level_face_size(format_info, level_width, level_height) * texture.num_faces;
+        if (level_index[0] + level_index[1] > file.size || level_index[1] != expected_size) {
+            std::cout << "ERROR::KTX2:: Invalid level " << level << " in " << path << std::endl;
+            texture.levels.clear();
+            return false;
+        }
+        texture.levels[level].assign(file.data + level_index[0], file.data + level_index[0] + level_index[1]);
+    }
+    return true;
+}
+
+unsigned int upload_ktx2_texture(const Ktx2Texture& texture, bool generate_mipmaps, unsigned int texture_id) {
+    const Ktx2FormatInfo* format_info = get_ktx2_format_info(texture.format);
+    if (format_info == nullptr || texture.levels.empty()) {
+        return 0;
+    }
+    bool is_cubemap = texture.num_faces == 6;
+    GLenum target = is_cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    bool is_compressed = format_info->block_size > 1;
+
+    // an existing texture is specified again with all its levels
+    bool is_new_texture = texture_id == 0;
+    if (is_new_texture) {
+        glGenTextures(1, &texture_id);
+    }
+    glBindTexture(target, texture_id);
+    if (!is_new_texture) {
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 1000);
+    }
+    // rows of RGB8 and RGB16F levels are not always 4 bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < texture.levels.size(); level++) {
+        uint32_t level_width = std::max(texture.width >> level, 1u);
+        uint32_t level_height = std::max(texture.height >> level, 1u);
+        size_t face_size = texture.levels[level].size() / texture.num_faces;
+        for (uint32_t face = 0; face < texture.num_faces; face++) {
+            GLenum face_target = is_cubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+            const unsigned char* face_data = texture.levels[level].data() + face * face_size;
+            if (is_compressed) {
+                glCompressedTexImage2D(face_target, level, format_info->gl_internal_format, level_width, level_height, 0, (GLsizei)face_size, face_data);
+            }
+            else {
+                glTexImage2D(face_target, level, format_info->gl_internal_format, level_width, level_height, 0, format_info->gl_format, format_info->gl_type, face_data);
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    bool has_mipmaps = texture.levels.size() > 1;
+    if (!has_mipmaps && generate_mipmaps && !is_compressed) {
+        glGenerateMipmap(target);
+        has_mipmaps = true;
+    }
+    else {
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+    }
+
+    GLint wrap = is_cubemap ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+    if (is_cubemap) {
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+    }
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, has_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    // single channel textures (R8 and BC4) are sampled as grayscale, like a RGB image with equal channels
+    if (format_info->num_channels == 1) {
+        glTexParameteri(target, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(target, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return texture_id;
+}
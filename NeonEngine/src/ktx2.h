@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Vulkan format ids, used by the KTX2 container to identify the pixel format
+const uint32_t KTX2_FORMAT_UNDEFINED = 0;
+const uint32_t KTX2_FORMAT_R8_UNORM = 9;
+const uint32_t KTX2_FORMAT_R8G8_UNORM = 16;
+const uint32_t KTX2_FORMAT_R8G8B8_UNORM = 23;
+const uint32_t KTX2_FORMAT_R8G8B8A8_UNORM = 37;
+const uint32_t KTX2_FORMAT_R16G16B16_SFLOAT = 90;
+const uint32_t KTX2_FORMAT_R16G16B16A16_SFLOAT = 97;
+const uint32_t KTX2_FORMAT_R32G32B32_SFLOAT = 106;
+const uint32_t KTX2_FORMAT_R32G32B32A32_SFLOAT = 109;
+const uint32_t KTX2_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+const uint32_t KTX2_FORMAT_BC3_UNORM_BLOCK = 137;
+const uint32_t KTX2_FORMAT_BC4_UNORM_BLOCK = 139;
+const uint32_t KTX2_FORMAT_BC5_UNORM_BLOCK = 141;
+const uint32_t KTX2_FORMAT_BC7_UNORM_BLOCK = 145;
+
+// Texture stored in a KTX2 file: a 2D texture or a cubemap (6 faces) with its mip levels
+struct Ktx2Texture {
+    uint32_t format = KTX2_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t num_faces = 1;
+    std::map<std::string, std::string> key_values;
+    // Data of every mip level, starting from the base level. The faces of a cubemap are consecutive inside a level.
+    std::vector<std::vector<unsigned char>> levels;
+};
+
+// Pixel layout of a format, block_size is 1 for the uncompressed formats and 4 for the BCn formats
+struct Ktx2FormatInfo {
+    uint32_t format;
+    uint32_t color_model;
+    int num_channels;
+    int bytes_per_block;
+    int block_size;
+    int bytes_per_channel;
+    bool is_float;
+    unsigned int gl_internal_format;
+    unsigned int gl_format;
+    unsigned int gl_type;
+};
+
+// Returns nullptr for the formats not supported by the engine
+const Ktx2FormatInfo* get_ktx2_format_info(uint32_t format);
+uint32_t get_ktx2_format_of_channels(int num_channels);
+size_t get_ktx2_level_face_size(const Ktx2FormatInfo* format_info, uint32_t width, uint32_t height);
+
+bool write_ktx2_file(const std::string& path, const Ktx2Texture& texture);
+bool read_ktx2_file(const std::string& path, Ktx2Texture& texture);
+
+// Creates a GL texture (2D or cubemap) with all the levels of the texture, must be called from the thread with the GL context.
+// When generate_mipmaps is true and the texture only has its base level, the rest of the mipmaps are generated by GL.
+unsigned int upload_ktx2_texture(const Ktx2Texture& texture, bool generate_mipmaps, unsigned int texture_id = 0);
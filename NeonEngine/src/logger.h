@@ -3,6 +3,9 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <mutex>
+#include <string>
+#include <ctime>
 
 class Logger {
 public:
@@ -17,21 +20,32 @@ public:
 
     // Log a message with the current timestamp
     void log(const std::string& message) {
+        // The logger is also used from the worker threads of the startup task graph
+        std::lock_guard<std::mutex> lock(logger_mutex);
         auto now = std::chrono::system_clock::now();
         std::time_t now_c = std::chrono::system_clock::to_time_t(now);
 
         std::tm timeinfo = {};
+#ifdef _WIN32
         localtime_s(&timeinfo, &now_c);
-
-        log_file << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S") << " " << message << std::endl;
-        log_string << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S") << " " << message << std::endl;
+#else
+        localtime_r(&now_c, &timeinfo);
+#endif
+
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        log_file << timestamp << " " << message << std::endl;
+        log_data.append(timestamp).append(" ").append(message).append("\n");
     }
 
-    std::string get_data() {
-        return log_string.str();
+    // Copies the log into data, reusing its capacity so the UI doesn't allocate every frame
+    void copy_data(std::string& data) {
+        std::lock_guard<std::mutex> lock(logger_mutex);
+        data.assign(log_data);
     }
 
 private:
     std::ofstream log_file;
-    std::ostringstream log_string;
+    std::string log_data;
+    std::mutex logger_mutex;
 };
\ No newline at end of file
@@ -1,8 +1,101 @@
 #include "neon_engine.h"
+#include "cooked_assets.h"
+#include "texture_cache.h"
+#include "rendering.h"
+#include "resource_registry.h"
+#include "allocation_tracker.h"
+
+#include <string>
+#include <cstdlib>
 
 // Main code
-int main(int, char**) {
+int main(int argc, char** argv) {
+    // --cooked: load the assets written by NeonCooker instead of the sources
+    // --texture-budget MB: memory budget of the textures of models and materials
+    // --no-texture-streaming: decode the whole textures while loading, before the first frame
+    // --prefetch-hdris: create the IBL maps of every HDRI in the background instead of when the skybox switches to it
+    // --headless [--width N] [--height N] [--frames N] [--output PREFIX]: render offscreen without window or UI
+    // --benchmark CAMERA_PATH: headless run that plays a camera path and writes the frame times to PREFIX.csv and PREFIX.json
+    // --record-camera-path FILE: record the camera of the viewport as a camera path for the benchmarks
+    // --trace FILE: record a Chrome trace of the engine from the start and write it to FILE on exit
+    // --gl-counters: count the draw calls, binds and uploads of every frame and pass (shown by the profiler and written by the benchmarks)
+    // --memory-report: print the GPU and CPU memory of the resources by category and their top consumers after loading and on exit
+    // --gpu-memory-budget MB: budget of the GPU memory of the resources, a headless run that goes over it fails
+    // --track-allocations: count the heap allocations by subsystem from the start (shown by the profiler)
+    // --fail-on-frame-allocations: headless run that fails when a frame after the warmup allocates on the heap
+    // --sample-profile FILE [--sample-rate HZ]: sample the call stacks of the engine (Linux only) and write them as folded stacks to FILE on exit
+    bool headless = false;
+    HeadlessOptions headless_options;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--cooked") {
+            set_use_cooked_assets(true);
+        }
+        else if (std::string(argv[i]) == "--texture-budget" && i + 1 < argc) {
+            TextureCache::get_instance()->memory_budget = (size_t)std::atoll(argv[++i]) * 1024 * 1024;
+        }
+        else if (std::string(argv[i]) == "--no-texture-streaming") {
+            TextureCache::get_instance()->streaming = false;
+        }
+        else if (std::string(argv[i]) == "--prefetch-hdris") {
+            Rendering::get_instance()->prefetch_hdris = true;
+        }
+        else if (std::string(argv[i]) == "--headless") {
+            headless = true;
+        }
+        else if (std::string(argv[i]) == "--width" && i + 1 < argc) {
+            headless_options.width = std::atoi(argv[++i]);
+        }
+        else if (std::string(argv[i]) == "--height" && i + 1 < argc) {
+            headless_options.height = std::atoi(argv[++i]);
+        }
+        else if (std::string(argv[i]) == "--frames" && i + 1 < argc) {
+            headless_options.num_frames = std::atoi(argv[++i]);
+        }
+        else if (std::string(argv[i]) == "--output" && i + 1 < argc) {
+            headless_options.output_prefix = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--benchmark" && i + 1 < argc) {
+            headless = true;
+            headless_options.camera_path = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--record-camera-path" && i + 1 < argc) {
+            NeonEngine::get_instance()->record_camera_path = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            NeonEngine::get_instance()->trace_path = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--gl-counters") {
+            NeonEngine::get_instance()->count_gl_calls = true;
+        }
+        else if (std::string(argv[i]) == "--memory-report") {
+            NeonEngine::get_instance()->print_memory_report = true;
+        }
+        else if (std::string(argv[i]) == "--gpu-memory-budget" && i + 1 < argc) {
+            ResourceRegistry::get_instance()->gpu_memory_budget = (size_t)std::atoll(argv[++i]) * 1024 * 1024;
+        }
+        else if (std::string(argv[i]) == "--track-allocations") {
+            set_allocation_tracking(true);
+        }
+        else if (std::string(argv[i]) == "--fail-on-frame-allocations") {
+            NeonEngine::get_instance()->fail_on_frame_allocations = true;
+        }
+        else if (std::string(argv[i]) == "--sample-profile" && i + 1 < argc) {
+            NeonEngine::get_instance()->sample_profile_path = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--sample-rate" && i + 1 < argc) {
+            NeonEngine::get_instance()->sample_rate_hz = std::atoi(argv[++i]);
+        }
+    }
+
+    // the textures of a benchmark are fully loaded before the first frame, the same on every run
+    if (!headless_options.camera_path.empty()) {
+        TextureCache::get_instance()->streaming = false;
+    }
+
     NeonEngine* neon_engine = NeonEngine::get_instance();
+    if (headless) {
+        return neon_engine->run_headless(headless_options) == 0 ? 0 : 1;
+    }
     neon_engine->run();
 
     return 0;
@@ -0,0 +1,114 @@
+#include "mapped_file.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+#ifdef _WIN32
+    file_handle = INVALID_HANDLE_VALUE;
+    mapping_handle = nullptr;
+#else
+    file_descriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::is_open() const {
+    return data != nullptr;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        std::cout << "ERROR::MAPPED_FILE:: Failed to create the file mapping of: " << path << std::endl;
+        close();
+        return false;
+    }
+    data = (const unsigned char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        std::cout << "ERROR::MAPPED_FILE:: Failed to map the file: " << path << std::endl;
+        close();
+        return false;
+    }
+    size = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+    }
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_handle);
+        file_handle = INVALID_HANDLE_VALUE;
+    }
+    size = 0;
+}
+#else
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    file_descriptor = ::open(path.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(file_descriptor, &file_stat) != 0 || file_stat.st_size == 0) {
+        close();
+        return false;
+    }
+    void* mapping = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        std::cout << "ERROR::MAPPED_FILE:: Failed to map the file: " << path << std::endl;
+        close();
+        return false;
+    }
+    data = (const unsigned char*)mapping;
+    size = (size_t)file_stat.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        munmap((void*)data, size);
+        data = nullptr;
+    }
+    if (file_descriptor >= 0) {
+        ::close(file_descriptor);
+        file_descriptor = -1;
+    }
+    size = 0;
+}
+#endif
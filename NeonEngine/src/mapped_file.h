@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(MappedFile& other) = delete;
+    void operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const;
+
+    const unsigned char* data;
+    size_t size;
+
+private:
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int file_descriptor;
+#endif
+};
@@ -2,6 +2,8 @@
 
 #include "geometry.h"
 #include "shader.h"
+#include "texture_cache.h"
+#include "object_pool.h"
 
 #include <glad/glad.h> // holds all OpenGL type declarations
 #include <glm/glm.hpp>
@@ -10,6 +12,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <utility>
 
 const int MAX_BONE_INFLUENCE = 4;
 
@@ -27,6 +30,15 @@ enum TextureType {
     TexAlbedo, TexNormal, TexMetalness, TexRoughness, TexEmission, TexAmbientOcclusion, TexSpecular, TexLast
 };
 
+// Files of the textures of the material directories (materials/<name>/) and the slots they are bound to
+const std::vector<std::pair<TextureType, std::string>> MATERIAL_TEXTURE_FILES = {
+    { TexAlbedo, "albedo.png" },
+    { TexNormal, "normal.png" },
+    { TexMetalness, "metallic.png" },
+    { TexRoughness, "roughness.png" },
+    { TexAmbientOcclusion, "ao.png" }
+};
+
 struct Texture {
 public:
     unsigned int id;
@@ -34,6 +46,9 @@ public:
     std::string path;
     int num_channels;
 
+    // Textures are created with Texture::pool.create(...), by the loaders of the models in the workers too
+    static ObjectPool<Texture> pool;
+
     Texture(const std::string& base_name) {
         this->base_name = base_name;
     }
@@ -62,7 +77,7 @@ public:
         }
     }
 
-    static std::string get_long_name_of_texture_type(TextureType texture_type) {
+    static const char* get_long_name_of_texture_type(TextureType texture_type) {
         if (texture_type == TexAlbedo) {
             return "texture_albedo";
         }
@@ -86,6 +101,31 @@ public:
         }
     }
 
+    // name of the uniform that tells the shaders if the material has the texture
+    static const char* get_has_name_of_texture_type(TextureType texture_type) {
+        if (texture_type == TexAlbedo) {
+            return "has_texture_albedo";
+        }
+        else if (texture_type == TexNormal) {
+            return "has_texture_normal";
+        }
+        else if (texture_type == TexMetalness) {
+            return "has_texture_metalness";
+        }
+        else if (texture_type == TexRoughness) {
+            return "has_texture_roughness";
+        }
+        else if (texture_type == TexEmission) {
+            return "has_texture_emission";
+        }
+        else if (texture_type == TexAmbientOcclusion) {
+            return "has_texture_ambient_occlusion";
+        }
+        else {
+            return "has_texture_specular";
+        }
+    }
+
     std::string get_name() {
         std::string output_name = base_name;
         for (auto it = types.begin(); it != types.end(); it++) {
@@ -94,10 +134,16 @@ public:
         return output_name;
     }
 
+    std::string get_base_name() {
+        return base_name;
+    }
+
 private:
     std::string base_name;
 };
 
+inline ObjectPool<Texture> Texture::pool;
+
 enum FileFormat {
     Default, glTF, FBX
 };
@@ -107,11 +153,35 @@ struct Material {
     std::map<TextureType, Texture*> textures;
     FileFormat format;
 
+    // Materials are created with Material::pool.create(...)
+    static ObjectPool<Material> pool;
+
     Material(const std::string& name) {
         this->name = name;
     }
 };
 
+inline ObjectPool<Material> Material::pool;
+
+// GL buffer with the contents of a whole source buffer (e.g. a glTF .bin file), shared by the meshes that read their vertex streams from it.
+// data must stay valid while the meshes are alive, it's used for the ray picking.
+struct SharedVertexBuffer {
+    const unsigned char* data;
+    size_t size;
+    unsigned int id;
+};
+
+// Vertex attribute read directly from a SharedVertexBuffer
+struct VertexStream {
+    int location;
+    int num_components;
+    GLenum type;
+    bool normalized;
+    bool integer;
+    size_t offset;
+    int stride;
+};
+
 class Mesh {
 public:
     // mesh Data
@@ -120,6 +190,7 @@ public:
     std::vector<unsigned int> indices;
     Material* material;
     unsigned int VAO;
+    unsigned int num_indices;
 
     // constructor
     Mesh(const std::string& name, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, Material* material)
@@ -128,9 +199,48 @@ public:
         this->vertices = vertices;
         this->indices = indices;
         this->material = material;
+        this->VAO = 0;
+        this->num_indices = static_cast<unsigned int>(this->indices.size());
+        this->external_vertex_data = nullptr;
+        this->external_index_data = nullptr;
+        this->num_external_vertices = 0;
+        this->shared_buffer = nullptr;
+        this->index_type = GL_UNSIGNED_INT;
+        this->index_offset = 0;
+        // the vertex buffers and its attribute pointers are set later in setupMesh(), in the thread with the GL context,
+        // so the mesh data can be built in a worker thread
+    }
 
-        // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+    // constructor for vertex and index data not owned by the mesh (e.g. memory-mapped from the model cache),
+    // the data must stay valid until setupMesh() uploads it
+    Mesh(const std::string& name, const Vertex* vertex_data, unsigned int num_vertices, const unsigned int* index_data, unsigned int num_indices, Material* material)
+    {
+        this->name = name;
+        this->material = material;
+        this->VAO = 0;
+        this->num_indices = num_indices;
+        this->external_vertex_data = vertex_data;
+        this->external_index_data = index_data;
+        this->num_external_vertices = num_vertices;
+        this->shared_buffer = nullptr;
+        this->index_type = GL_UNSIGNED_INT;
+        this->index_offset = 0;
+    }
+
+    // constructor for vertex streams and indices stored in a shared buffer, only the vertex array object is created per mesh
+    Mesh(const std::string& name, SharedVertexBuffer* shared_buffer, const std::vector<VertexStream>& vertex_streams, GLenum index_type, size_t index_offset, unsigned int num_indices, Material* material)
+    {
+        this->name = name;
+        this->material = material;
+        this->VAO = 0;
+        this->num_indices = num_indices;
+        this->external_vertex_data = nullptr;
+        this->external_index_data = nullptr;
+        this->num_external_vertices = 0;
+        this->shared_buffer = shared_buffer;
+        this->vertex_streams = vertex_streams;
+        this->index_type = index_type;
+        this->index_offset = index_offset;
     }
 
     // render the mesh
@@ -148,20 +258,26 @@ public:
 
         shader->setInt("material_format", draw_material->format);
 
+        // streamed textures without levels yet are left out, the material uses the values of the game object instead
+        TextureCache* texture_cache = TextureCache::get_instance();
         int num_active_textures = 0;
         for (int type = TexAlbedo; type < TexLast; type++) {
             TextureType texture_type = (TextureType) type;
-            std::string str_texture_type = Texture::get_long_name_of_texture_type(texture_type);
-            if (draw_material->textures.find(texture_type) != draw_material->textures.end()) {
+            const char* str_texture_type = Texture::get_long_name_of_texture_type(texture_type);
+            if (draw_material->textures.find(texture_type) != draw_material->textures.end() && texture_cache->is_ready(draw_material->textures[texture_type]->id)) {
                 Texture* texture = draw_material->textures[texture_type];
                 glActiveTexture(GL_TEXTURE0 + OFFSET_TEXTURES + num_active_textures);
                 shader->setInt(str_texture_type, OFFSET_TEXTURES + num_active_textures);
-                shader->setInt("has_" + str_texture_type, true);
+                shader->setInt(Texture::get_has_name_of_texture_type(texture_type), true);
                 glBindTexture(GL_TEXTURE_2D, texture->id);
                 num_active_textures++;
+                // BC5 normal maps only store x and y
+                if (texture_type == TexNormal) {
+                    shader->setInt("is_two_channel_texture_normal", texture->num_channels == 2);
+                }
             }
             else {
-                shader->setInt("has_" + str_texture_type, false);
+                shader->setInt(Texture::get_has_name_of_texture_type(texture_type), false);
             }
         }
 
@@ -171,7 +287,7 @@ public:
 
         // draw mesh
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, num_indices, index_type, (void*)index_offset);
         glBindVertexArray(0);
 
         // always good practice to set everything back to defaults once configured.
@@ -185,10 +301,10 @@ public:
     bool intersected_ray(const glm::vec3& orig, const glm::vec3& dir, float& t) {
         float min_t = std::numeric_limits<float>::max();
         float t_aux;
-        for (int i = 0; i < indices.size(); i += 3) {
-            glm::vec3 v0 = vertices[i].Position;
-            glm::vec3 v1 = vertices[i+1].Position;
-            glm::vec3 v2 = vertices[i+2].Position;
+        for (unsigned int i = 0; i + 2 < num_indices; i += 3) {
+            glm::vec3 v0 = get_position(get_index(i));
+            glm::vec3 v1 = get_position(get_index(i+1));
+            glm::vec3 v2 = get_position(get_index(i+2));
             if (ray_triangle_intersection(orig, dir, v0, v1, v2, t_aux)) {
                 if (t_aux < min_t) {
                     min_t = t_aux;
@@ -205,13 +321,23 @@ public:
         }
     }
 
-private:
-    // render data 
-    unsigned int VBO, EBO;
-
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
+        if (shared_buffer != nullptr) {
+            setup_mesh_from_shared_buffer();
+            return;
+        }
+
+        const Vertex* vertex_data = external_vertex_data;
+        const unsigned int* index_data = external_index_data;
+        size_t num_vertices = num_external_vertices;
+        if (vertex_data == nullptr) {
+            vertex_data = vertices.data();
+            index_data = indices.data();
+            num_vertices = vertices.size();
+        }
+
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -223,10 +349,10 @@ private:
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+        glBufferData(GL_ARRAY_BUFFER, num_vertices * sizeof(Vertex), vertex_data, GL_STATIC_DRAW);  
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices * sizeof(unsigned int), index_data, GL_STATIC_DRAW);
 
         // set the vertex attribute pointers
         // vertex positions
@@ -252,5 +378,85 @@ private:
 		glVertexAttribPointer(6, MAX_BONE_INFLUENCE, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, BoneWeights));
 
         glBindVertexArray(0);
+
+        // the external data is not accessed anymore after the upload, CPU copies are kept for the ray picking
+        if (external_vertex_data != nullptr) {
+            vertices.assign(external_vertex_data, external_vertex_data + num_external_vertices);
+            indices.assign(external_index_data, external_index_data + num_indices);
+        }
+        external_vertex_data = nullptr;
+        external_index_data = nullptr;
     }
+
+    // the vertex attributes point directly into the shared buffer, which is uploaded once for all the meshes using it
+    void setup_mesh_from_shared_buffer()
+    {
+        if (shared_buffer->id == 0) {
+            glGenBuffers(1, &shared_buffer->id);
+            glBindBuffer(GL_ARRAY_BUFFER, shared_buffer->id);
+            glBufferData(GL_ARRAY_BUFFER, shared_buffer->size, shared_buffer->data, GL_STATIC_DRAW);
+        }
+        VBO = 0;
+        EBO = 0;
+
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, shared_buffer->id);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shared_buffer->id);
+
+        bool has_bones = false;
+        for (int i = 0; i < vertex_streams.size(); i++) {
+            const VertexStream& stream = vertex_streams[i];
+            glEnableVertexAttribArray(stream.location);
+            if (stream.integer) {
+                glVertexAttribIPointer(stream.location, stream.num_components, stream.type, stream.stride, (void*)stream.offset);
+            }
+            else {
+                glVertexAttribPointer(stream.location, stream.num_components, stream.type, stream.normalized, stream.stride, (void*)stream.offset);
+            }
+            has_bones = has_bones || stream.location == 5;
+        }
+        glBindVertexArray(0);
+
+        if (!has_bones) {
+            // disabled attributes read the current values, the bone data must be zero like in the Vertex struct
+            glVertexAttribI4i(5, 0, 0, 0, 0);
+            glVertexAttrib4f(6, 0.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    unsigned int get_index(unsigned int i) {
+        if (shared_buffer == nullptr) {
+            return indices[i];
+        }
+        const unsigned char* index_data = shared_buffer->data + index_offset;
+        if (index_type == GL_UNSIGNED_BYTE) {
+            return index_data[i];
+        }
+        else if (index_type == GL_UNSIGNED_SHORT) {
+            return ((const unsigned short*)index_data)[i];
+        }
+        return ((const unsigned int*)index_data)[i];
+    }
+
+    glm::vec3 get_position(unsigned int i) {
+        if (shared_buffer == nullptr) {
+            return vertices[i].Position;
+        }
+        // the position stream is always the first one and it's made of floats
+        const VertexStream& stream = vertex_streams[0];
+        const float* position = (const float*)(shared_buffer->data + stream.offset + (size_t)i * stream.stride);
+        return glm::vec3(position[0], position[1], position[2]);
+    }
+
+private:
+    // render data 
+    unsigned int VBO, EBO;
+    SharedVertexBuffer* shared_buffer;
+    std::vector<VertexStream> vertex_streams;
+    GLenum index_type;
+    size_t index_offset;
+    const Vertex* external_vertex_data;
+    const unsigned int* external_index_data;
+    size_t num_external_vertices;
 };
\ No newline at end of file
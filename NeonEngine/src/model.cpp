@@ -5,6 +5,13 @@
 #include "shader.h"
 #include "neon_engine.h"
 #include "logger.h"
+#include "model_cache.h"
+#include "gltf_loader.h"
+#include "cooked_assets.h"
+#include "texture_cache.h"
+#include "trace_recorder.h"
+#include "resource_registry.h"
+#include "allocation_tracker.h"
 
 #include <glad/glad.h> 
 #include <glm/glm.hpp>
@@ -21,27 +28,116 @@
 #include <filesystem>
 
 // constructor, expects a filepath to a 3D model.
-Model::Model(const std::string& name, std::string const& path, bool gamma, bool set_flip_vertically) : gammaCorrection(gamma)
+Model::Model(const std::string& name, std::string const& path, bool gamma, bool set_flip_vertically, bool defer_gpu_upload, bool use_native_loaders) : gammaCorrection(gamma)
 {
+    TRACE_SCOPE("load_model");
+    ALLOCATION_TAG(AllocAssets);
     NeonEngine* neon_engine = NeonEngine::get_instance();
 
     neon_engine->logger->log("Loading model: " + name);
     auto start_time = std::chrono::system_clock::now();
 
-    stbi_set_flip_vertically_on_load(set_flip_vertically);
     this->name = name;
     this->format = get_format_from_path(path);
-    loadModel(path);
+    this->flip_vertically = set_flip_vertically;
+    this->uploaded_to_gpu = false;
+    this->root_node = nullptr;
+    this->cache_file = nullptr;
+    this->cache_key = 0;
+    this->aabb_min = glm::vec3(0.0f);
+    this->aabb_max = glm::vec3(0.0f);
+    // retrieve the directory path of the filepath
+    this->directory = path.substr(0, path.find_last_of('/'));
 
-    print_loaded_textures(loaded_textures);
+    // the cooked model is used when the engine runs with cooked assets, its sources may not be shipped so the key isn't checked.
+    // Otherwise glTF files are loaded natively, then the binary cache is tried and assimp is the last option.
+    std::string cooked_path = get_cooked_asset_path(path, COOKED_MODEL_EXTENSION);
+    if (get_use_cooked_assets() && std::filesystem::exists(cooked_path) && read_model_cache(*this, cooked_path, 0)) {
+        neon_engine->logger->log("Model " + name + " loaded from cooked file: " + cooked_path);
+    }
+    else if (use_native_loaders && format == glTF && load_gltf_model(*this, path)) {
+        neon_engine->logger->log("Model " + name + " loaded with the native glTF loader");
+    }
+    else {
+        // the assimp import is skipped when there is an up to date binary cache of the model
+        this->cache_key = compute_model_cache_key(path, MODEL_IMPORT_FLAGS);
+        this->cache_path = get_model_cache_path(name, cache_key);
+        if (read_model_cache(*this, cache_path, cache_key)) {
+            neon_engine->logger->log("Model " + name + " loaded from cache: " + cache_path);
+        }
+        else {
+            loadModel(path);
+        }
+    }
 
     auto end_time = std::chrono::system_clock::now();
     std::chrono::duration<double> elapsed_seconds = end_time - start_time;
-    neon_engine->logger->log("Model loaded in " + std::to_string(elapsed_seconds.count()) + " seconds");
+    neon_engine->logger->log("Model " + name + " loaded in " + std::to_string(elapsed_seconds.count()) + " seconds");
+
+    if (!defer_gpu_upload) {
+        upload_to_gpu();
+    }
 }
 
 Model::~Model() {
+    ResourceRegistry::get_instance()->release(ResourceMeshBuffer, (uint64_t)this);
+    ResourceRegistry::get_instance()->release(ResourceCpuVertexData, (uint64_t)this);
+    for (int i = 0; i < pending_texture_images.size(); i++) {
+        free_image_data(pending_texture_images[i].second);
+    }
     delete root_node;
+    delete cache_file;
+    for (int i = 0; i < shared_buffers.size(); i++) {
+        delete shared_buffers[i];
+    }
+    for (int i = 0; i < buffer_files.size(); i++) {
+        delete buffer_files[i];
+    }
+}
+
+// uploads the decoded textures and the vertex data of all the meshes, must be called from the thread with the GL context
+void Model::upload_to_gpu() {
+    if (uploaded_to_gpu) {
+        return;
+    }
+    NeonEngine* neon_engine = NeonEngine::get_instance();
+    auto start_time = std::chrono::system_clock::now();
+
+    for (int i = 0; i < pending_texture_images.size(); i++) {
+        Texture* texture = pending_texture_images[i].first;
+        texture->id = upload_image_data_to_texture(pending_texture_images[i].second);
+    }
+    pending_texture_images.clear();
+
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        meshes[i].setupMesh();
+    }
+    uploaded_to_gpu = true;
+    record_vertex_data_memory();
+
+    // the meshes don't reference the mapped cache file anymore
+    delete cache_file;
+    cache_file = nullptr;
+
+    print_loaded_textures(loaded_textures);
+
+    auto end_time = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end_time - start_time;
+    neon_engine->logger->log("Model " + name + " uploaded to the GPU in " + std::to_string(elapsed_seconds.count()) + " seconds");
+}
+
+// the vertex and index buffers of the meshes, and the CPU copies kept for the ray picking
+void Model::record_vertex_data_memory() {
+    size_t vertex_data_size = 0;
+    for (int i = 0; i < meshes.size(); i++) {
+        vertex_data_size += meshes[i].vertices.size() * sizeof(Vertex) + meshes[i].indices.size() * sizeof(unsigned int);
+    }
+    // the meshes with shared buffers have no copies of their own, the whole buffer is uploaded once
+    for (int i = 0; i < shared_buffers.size(); i++) {
+        vertex_data_size += shared_buffers[i]->size;
+    }
+    ResourceRegistry::get_instance()->record(ResourceMeshBuffer, (uint64_t)this, name, vertex_data_size);
+    ResourceRegistry::get_instance()->record(ResourceCpuVertexData, (uint64_t)this, name, vertex_data_size);
 }
 
 // draws the model, and thus all its meshes
@@ -98,6 +194,8 @@ void Model::update_bones_recursively(float animation_time_in_ticks, Animation& a
 }
 
 void Model::update_bone_transformations(float animation_time_in_seconds, int animation_id) {
+    TRACE_SCOPE("animation_update");
+    ALLOCATION_TAG(AllocAnimation);
     aiMatrix4x4 identity;
     assert(animation_id < animations.size());
     float ticks_per_second = (float)(animations[animation_id].ticks_per_second != 0 ? animations[animation_id].ticks_per_second : 25.0f);
@@ -195,10 +293,11 @@ bool Model::intersected_ray(const glm::vec3& orig, const glm::vec3& dir, float&
 
 // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
 void Model::loadModel(std::string const& path) {
+    TRACE_SCOPE("assimp_import");
     Assimp::Importer importer;
 
     // read file via ASSIMP
-    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices);
+    const aiScene* scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
     // check for errors
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
     {
@@ -206,9 +305,6 @@ void Model::loadModel(std::string const& path) {
         return;
     }
 
-    // retrieve the directory path of the filepath
-    this->directory = path.substr(0, path.find_last_of('/'));
-
     // get global inverse transform out of the root node, for processing of bone animations
     this->global_inverse_transform = scene->mRootNode->mTransformation;
     this->global_inverse_transform = this->global_inverse_transform.Inverse();
@@ -244,6 +340,32 @@ void Model::loadModel(std::string const& path) {
         }
         animations.push_back(animation);
     }
+
+    compute_bounds();
+
+    // the next runs map this file instead of importing the model again
+    if (!write_model_cache(*this, cache_path, cache_key, MODEL_IMPORT_FLAGS, scene)) {
+        std::cout << "ERROR::MODEL_CACHE:: Could not write the cache of the model: " << name << std::endl;
+    }
+}
+
+// axis aligned bounding box of the vertices of all the meshes, in model space
+void Model::compute_bounds() {
+    bool first_vertex = true;
+    for (int i = 0; i < meshes.size(); i++) {
+        for (int j = 0; j < meshes[i].vertices.size(); j++) {
+            const glm::vec3& position = meshes[i].vertices[j].Position;
+            if (first_vertex) {
+                aabb_min = position;
+                aabb_max = position;
+                first_vertex = false;
+            }
+            else {
+                aabb_min = glm::min(aabb_min, position);
+                aabb_max = glm::max(aabb_max, position);
+            }
+        }
+    }
 }
 
 // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -360,7 +482,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
         std::vector<Texture*> specularMaps = loadMaterialTextures(ai_material, aiTextureType_SPECULAR, TexSpecular, scene, material_name);
 
         // Create material of the mesh
-        material = new Material(material_name);
+        material = Material::pool.create(material_name);
         material->format = this->format;
         if (albedoMaps.size() != 0) {
             material->textures[TexAlbedo] = albedoMaps[0];
@@ -474,13 +596,18 @@ std::vector<Texture*> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType
         else {
             // if texture hasn't been loaded already, load it
             const aiTexture* ai_texture = scene->GetEmbeddedTexture(str.C_Str());
-            Texture* texture = new Texture("tex_" + material_name.substr(4));
+            Texture* texture = Texture::pool.create("tex_" + material_name.substr(4));
+            texture->id = 0;
+            // only decode the image here, it's uploaded in upload_to_gpu()
+            ImageData image;
             if (ai_texture) {
-                texture->id = EmbeddedTextureFromFile(ai_texture, texture->num_channels);
+                EmbeddedImageFromFile(ai_texture, this->directory + "/" + str.C_Str(), image, this->flip_vertically);
             }
             else {
-                texture->id = TextureFromFile(str.C_Str(), this->directory, texture->num_channels);
+                ImageFromFile(str.C_Str(), this->directory, image, this->flip_vertically);
             }
+            texture->num_channels = image.num_channels;
+            pending_texture_images.push_back(std::make_pair(texture, image));
             texture->types.insert(texture_type);
             texture->path = str.C_Str();
             textures.push_back(texture);
@@ -504,11 +631,8 @@ FileFormat get_format_from_path(const std::string& path) {
     }
 }
 
-unsigned int EmbeddedTextureFromFile(const aiTexture* texture, int& num_channels)
+bool EmbeddedImageFromFile(const aiTexture* texture, const std::string& name, ImageData& image, bool flip_vertically)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
     int length_data;
     if (texture->mHeight == 0) {
         length_data = texture->mWidth;
@@ -516,37 +640,10 @@ unsigned int EmbeddedTextureFromFile(const aiTexture* texture, int& num_channels
     else {
         length_data = texture->mWidth * texture->mHeight;
     }
-    int width, height;
-    unsigned char* data = stbi_load_from_memory((unsigned char*)(texture->pcData), length_data, &width, &height, &num_channels, 0);
-    if (data) {
-        GLenum format = GL_RGB;
-        if (num_channels == 1)
-            format = GL_RED;
-        else if (num_channels == 3)
-            format = GL_RGB;
-        else if (num_channels == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else {
-        std::cout << "Embedded texture failed to load" << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    return TextureCache::get_instance()->load_image_from_memory((unsigned char*)(texture->pcData), length_data, name, image, flip_vertically);
 }
 
-unsigned int TextureFromFile(const char* path, const std::string& directory, int& num_channels, bool gamma)
+bool ImageFromFile(const char* path, const std::string& directory, ImageData& image, bool flip_vertically)
 {
     std::string filename = std::string(path);
     std::filesystem::path filename_path(filename);
@@ -555,37 +652,5 @@ unsigned int TextureFromFile(const char* path, const std::string& directory, int
         filename = directory + '/' + filename;
     }
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &num_channels, 0);
-    if (data)
-    {
-        GLenum format = GL_RGB;
-        if (num_channels == 1)
-            format = GL_RED;
-        else if (num_channels == 3)
-            format = GL_RGB;
-        else if (num_channels == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    return TextureCache::get_instance()->load_image(filename, image, flip_vertically);
 }
\ No newline at end of file
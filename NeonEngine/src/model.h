@@ -2,16 +2,23 @@
 
 #include "mesh.h"
 #include "base_model.h"
+#include "opengl_utils.h"
+#include "mapped_file.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <string>
+#include <cstdint>
 #include <unordered_map>
 
+// Post-processing steps of the assimp import, part of the model cache key
+const unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices;
+
 FileFormat get_format_from_path(const std::string& path);
-unsigned int TextureFromFile(const char* path, const std::string& directory, int& num_channels, bool gamma = false);
-unsigned int EmbeddedTextureFromFile(const aiTexture* texture, int& num_channels);
+bool ImageFromFile(const char* path, const std::string& directory, ImageData& image, bool flip_vertically);
+// the images are decoded through the TextureCache, name identifies an embedded image in its report
+bool EmbeddedImageFromFile(const aiTexture* texture, const std::string& name, ImageData& image, bool flip_vertically);
 
 struct ModelNode {
     std::string name;
@@ -48,6 +55,10 @@ public:
     std::string directory;
     FileFormat format;
     bool gammaCorrection;
+    bool flip_vertically;
+    bool uploaded_to_gpu;
+    glm::vec3 aabb_min;
+    glm::vec3 aabb_max;
 
     // Data for bones
     aiMatrix4x4 global_inverse_transform;
@@ -55,8 +66,12 @@ public:
     std::vector<Animation> animations;
     ModelNode* root_node;
 
-    Model(const std::string& name, std::string const& path, bool gamma = false, bool set_flip_vertically = true);
+    // With defer_gpu_upload the constructor only does CPU work (importing and image decoding) and can run in a worker thread,
+    // upload_to_gpu() must then be called from the thread with the GL context before drawing the model.
+    // Without use_native_loaders the model is always imported with assimp (or read from its binary cache).
+    Model(const std::string& name, std::string const& path, bool gamma = false, bool set_flip_vertically = true, bool defer_gpu_upload = false, bool use_native_loaders = true);
     ~Model();
+    void upload_to_gpu();
     void draw(Shader* shader, Material* draw_material, bool is_selected, bool disable_depth_test, bool render_only_ambient, bool render_one_color);
     NodeAnimation* find_node_animation(Animation& animation, const std::string& node_name);
     void update_bones_recursively(float animation_time_in_ticks, Animation& animation, ModelNode* node, const aiMatrix4x4& parent_transform);
@@ -68,8 +83,27 @@ public:
 
 private:
     void loadModel(std::string const& path);
+    void compute_bounds();
     void processNode(aiNode* node, const aiScene* scene, ModelNode* model_node);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
     void print_loaded_textures(const std::map<std::string, Texture*>& loaded_textures);
+    void record_vertex_data_memory();
     std::vector<Texture*> loadMaterialTextures(aiMaterial* mat, aiTextureType type, TextureType texture_type, const aiScene* scene, const std::string& material_name);
+
+    // Decoded images waiting for upload_to_gpu()
+    std::vector<std::pair<Texture*, ImageData>> pending_texture_images;
+
+    // Binary cache of the imported model, see model_cache.h
+    std::string cache_path;
+    uint64_t cache_key;
+    MappedFile* cache_file;
+
+    // Buffers of a model loaded with the native glTF loader, the meshes read their vertex streams from them
+    std::vector<MappedFile*> buffer_files;
+    std::vector<SharedVertexBuffer*> shared_buffers;
+
+    friend class GltfLoader;
+    friend class AssetCooker;
+    friend bool read_model_cache(Model& model, const std::string& cache_path, uint64_t cache_key);
+    friend void clear_model_data(Model& model);
 };
\ No newline at end of file
@@ -0,0 +1,569 @@
+#include "model_cache.h"
+
+#include "model.h"
+#include "mapped_file.h"
+#include "texture_cache.h"
+
+#include <assimp/scene.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t hash_file(const std::string& path, uint64_t hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return hash;
+    }
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = hash_bytes(buffer.data(), (size_t)file.gcount(), hash);
+    }
+    return hash;
+}
+
+struct FileHashRecord {
+    uint64_t size;
+    int64_t modification_time;
+    uint64_t hash;
+};
+
+static std::map<std::string, FileHashRecord> file_hashes;
+static bool file_hashes_loaded = false;
+static std::mutex file_hashes_mutex;
+
+// The records are appended when a file is hashed, the last record of a path is the current one
+static void load_file_hashes() {
+    std::ifstream file(FILE_HASHES_PATH);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string hash;
+        FileHashRecord record;
+        std::string path;
+        if (ss >> hash >> record.size >> record.modification_time && std::getline(ss >> std::ws, path) && hash.size() == 16) {
+            record.hash = std::stoull(hash, nullptr, 16);
+            file_hashes[path] = record;
+        }
+    }
+    file_hashes_loaded = true;
+}
+
+uint64_t get_file_content_hash(const std::string& path) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error) {
+        return 0;
+    }
+    int64_t modification_time = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    {
+        std::lock_guard<std::mutex> lock(file_hashes_mutex);
+        if (!file_hashes_loaded) {
+            load_file_hashes();
+        }
+        auto it = file_hashes.find(path);
+        if (it != file_hashes.end() && it->second.size == size && it->second.modification_time == modification_time) {
+            return it->second.hash;
+        }
+    }
+
+    FileHashRecord record = { size, modification_time, hash_file(path) };
+    std::lock_guard<std::mutex> lock(file_hashes_mutex);
+    file_hashes[path] = record;
+    std::filesystem::create_directories(std::filesystem::path(FILE_HASHES_PATH).parent_path(), error);
+    std::ofstream file(FILE_HASHES_PATH, std::ios::app);
+    file << std::hex << std::setw(16) << std::setfill('0') << record.hash << std::dec << " " << record.size << " " << record.modification_time << " " << path << "\n";
+    return record.hash;
+}
+
+uint64_t compute_model_cache_key(const std::string& source_path, unsigned int import_flags) {
+    uint64_t key = get_file_content_hash(source_path);
+
+    // A .gltf file keeps its geometry in external buffers
+    std::filesystem::path path(source_path);
+    if (path.extension() == ".gltf" && std::filesystem::exists(path.parent_path())) {
+        std::vector<std::string> buffer_paths;
+        for (const auto& entry : std::filesystem::directory_iterator(path.parent_path())) {
+            if (entry.is_regular_file() && entry.path().extension() == ".bin") {
+                buffer_paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(buffer_paths.begin(), buffer_paths.end());
+        for (int i = 0; i < buffer_paths.size(); i++) {
+            uint64_t buffer_hash = get_file_content_hash(buffer_paths[i]);
+            key = hash_bytes(&buffer_hash, sizeof(buffer_hash), key);
+        }
+    }
+
+    key = hash_bytes(&import_flags, sizeof(import_flags), key);
+    key = hash_bytes(&MODEL_CACHE_VERSION, sizeof(MODEL_CACHE_VERSION), key);
+    return key;
+}
+
+std::string get_model_cache_path(const std::string& model_name, uint64_t cache_key) {
+    std::ostringstream ss;
+    ss << MODEL_CACHE_DIRECTORY << "/" << model_name << "_" << std::hex << std::setw(16) << std::setfill('0') << cache_key << ".nmdl";
+    return ss.str();
+}
+
+// Writing and reading helpers of the cache format
+class CacheWriter {
+public:
+    std::vector<unsigned char> buffer;
+
+    template <typename T>
+    void write(const T& value) {
+        const unsigned char* bytes = (const unsigned char*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void write_string(const std::string& value) {
+        write((uint32_t)value.size());
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    // Blobs are 16 bytes aligned so they can be used in place from the mapped file
+    void write_blob(const void* data, uint64_t size) {
+        write(size);
+        while (buffer.size() % 16 != 0) {
+            buffer.push_back(0);
+        }
+        const unsigned char* bytes = (const unsigned char*)data;
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+};
+
+class CacheReader {
+public:
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+    bool valid;
+
+    CacheReader(const unsigned char* data, size_t size) : data(data), size(size), offset(0), valid(true) {}
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!valid || offset + sizeof(T) > size) {
+            valid = false;
+            return value;
+        }
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string read_string() {
+        uint32_t length = read<uint32_t>();
+        if (!valid || offset + length > size) {
+            valid = false;
+            return "";
+        }
+        std::string value((const char*)(data + offset), length);
+        offset += length;
+        return value;
+    }
+
+    const unsigned char* read_blob(uint64_t& blob_size) {
+        blob_size = read<uint64_t>();
+        offset = (offset + 15) & ~(size_t)15;
+        if (!valid || offset + blob_size > size) {
+            valid = false;
+            blob_size = 0;
+            return nullptr;
+        }
+        const unsigned char* blob = data + offset;
+        offset += (size_t)blob_size;
+        return blob;
+    }
+};
+
+static void write_node(CacheWriter& writer, ModelNode* node) {
+    writer.write_string(node->name);
+    writer.write(node->transformation);
+    writer.write((uint32_t)node->children.size());
+    for (int i = 0; i < node->children.size(); i++) {
+        write_node(writer, node->children[i]);
+    }
+}
+
+static ModelNode* read_node(CacheReader& reader, uint32_t& num_nodes_left) {
+    if (num_nodes_left == 0) {
+        reader.valid = false;
+        return nullptr;
+    }
+    num_nodes_left--;
+    ModelNode* node = new ModelNode();
+    node->name = reader.read_string();
+    node->transformation = reader.read<aiMatrix4x4>();
+    uint32_t num_children = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < num_children && reader.valid; i++) {
+        ModelNode* child = read_node(reader, num_nodes_left);
+        if (child) {
+            node->children.push_back(child);
+        }
+    }
+    return node;
+}
+
+static uint32_t count_nodes(ModelNode* node) {
+    uint32_t num_nodes = 1;
+    for (int i = 0; i < node->children.size(); i++) {
+        num_nodes += count_nodes(node->children[i]);
+    }
+    return num_nodes;
+}
+
+// Animation compression: times are stored as floats, rotations are quantized to 16 bits per component
+// and tracks whose keys are all the same are collapsed to a single key
+template <typename T>
+static bool is_constant_track(const std::map<double, T>& keys) {
+    for (auto it = keys.begin(); it != keys.end(); it++) {
+        if (memcmp(&(it->second), &(keys.begin()->second), sizeof(T)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void write_vector_track(CacheWriter& writer, const std::map<double, aiVector3D>& keys) {
+    uint32_t num_keys = is_constant_track(keys) ? std::min((uint32_t)keys.size(), 1u) : (uint32_t)keys.size();
+    writer.write(num_keys);
+    auto it = keys.begin();
+    for (uint32_t i = 0; i < num_keys; i++, it++) {
+        writer.write((float)it->first);
+        writer.write(it->second);
+    }
+}
+
+static void read_vector_track(CacheReader& reader, std::map<double, aiVector3D>& keys) {
+    uint32_t num_keys = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < num_keys && reader.valid; i++) {
+        float time = reader.read<float>();
+        keys[time] = reader.read<aiVector3D>();
+    }
+}
+
+static int16_t quantize_unit_float(float value) {
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return (int16_t)std::lround(value * 32767.0f);
+}
+
+static void write_rotation_track(CacheWriter& writer, const std::map<double, aiQuaternion>& keys) {
+    uint32_t num_keys = is_constant_track(keys) ? std::min((uint32_t)keys.size(), 1u) : (uint32_t)keys.size();
+    writer.write(num_keys);
+    auto it = keys.begin();
+    for (uint32_t i = 0; i < num_keys; i++, it++) {
+        writer.write((float)it->first);
+        writer.write(quantize_unit_float(it->second.w));
+        writer.write(quantize_unit_float(it->second.x));
+        writer.write(quantize_unit_float(it->second.y));
+        writer.write(quantize_unit_float(it->second.z));
+    }
+}
+
+static void read_rotation_track(CacheReader& reader, std::map<double, aiQuaternion>& keys) {
+    uint32_t num_keys = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < num_keys && reader.valid; i++) {
+        float time = reader.read<float>();
+        float w = reader.read<int16_t>() / 32767.0f;
+        float x = reader.read<int16_t>() / 32767.0f;
+        float y = reader.read<int16_t>() / 32767.0f;
+        float z = reader.read<int16_t>() / 32767.0f;
+        aiQuaternion rotation(w, x, y, z);
+        rotation.Normalize();
+        keys[time] = rotation;
+    }
+}
+
+bool write_model_cache(Model& model, const std::string& cache_path, uint64_t cache_key, unsigned int import_flags, const aiScene* scene) {
+    if (model.root_node == nullptr) {
+        return false;
+    }
+
+    CacheWriter writer;
+
+    ModelCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MODEL_CACHE_VERSION;
+    header.vertex_size = sizeof(Vertex);
+    header.cache_key = cache_key;
+    header.import_flags = import_flags;
+    header.format = model.format;
+    for (int i = 0; i < 3; i++) {
+        header.aabb_min[i] = model.aabb_min[i];
+        header.aabb_max[i] = model.aabb_max[i];
+    }
+    memcpy(header.global_inverse_transform, &model.global_inverse_transform, sizeof(header.global_inverse_transform));
+    header.num_textures = (uint32_t)model.loaded_textures.size();
+    header.num_materials = (uint32_t)model.loaded_materials.size();
+    header.num_meshes = (uint32_t)model.meshes.size();
+    header.num_bones = (uint32_t)model.bones.size();
+    header.num_nodes = count_nodes(model.root_node);
+    header.num_animations = (uint32_t)model.animations.size();
+    writer.write(header);
+
+    // Textures, referenced by index from the materials
+    std::map<Texture*, int32_t> texture_to_index;
+    for (auto it = model.loaded_textures.begin(); it != model.loaded_textures.end(); it++) {
+        Texture* texture = it->second;
+        texture_to_index[texture] = (int32_t)texture_to_index.size();
+        writer.write_string(it->first);
+        writer.write_string(texture->get_base_name());
+        uint32_t types = 0;
+        for (auto it_type = texture->types.begin(); it_type != texture->types.end(); it_type++) {
+            types |= 1u << *it_type;
+        }
+        writer.write(types);
+        // The compressed data of embedded textures is stored as well
+        const aiTexture* ai_texture = scene ? scene->GetEmbeddedTexture(it->first.c_str()) : nullptr;
+        if (ai_texture) {
+            uint64_t length_data = ai_texture->mHeight == 0 ? ai_texture->mWidth : ai_texture->mWidth * ai_texture->mHeight;
+            writer.write_blob(ai_texture->pcData, length_data);
+        }
+        else {
+            writer.write_blob(nullptr, 0);
+        }
+    }
+
+    // Materials
+    for (auto it = model.loaded_materials.begin(); it != model.loaded_materials.end(); it++) {
+        Material* material = it->second;
+        writer.write(it->first);
+        writer.write_string(material->name);
+        writer.write((uint32_t)material->format);
+        for (int type = TexAlbedo; type < TexLast; type++) {
+            auto it_texture = material->textures.find((TextureType)type);
+            writer.write(it_texture != material->textures.end() ? texture_to_index[it_texture->second] : (int32_t)-1);
+        }
+    }
+
+    // Meshes
+    for (int i = 0; i < model.meshes.size(); i++) {
+        Mesh& mesh = model.meshes[i];
+        uint32_t material_key = 0;
+        for (auto it = model.loaded_materials.begin(); it != model.loaded_materials.end(); it++) {
+            if (it->second == mesh.material) {
+                material_key = it->first;
+            }
+        }
+        writer.write_string(mesh.name);
+        writer.write(material_key);
+        writer.write((uint32_t)mesh.vertices.size());
+        writer.write((uint32_t)mesh.indices.size());
+        writer.write_blob(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+        writer.write_blob(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+    }
+
+    // Skeleton
+    std::vector<std::string> bone_names(model.bones.size());
+    for (auto it = model.umap_bone_name_to_id.begin(); it != model.umap_bone_name_to_id.end(); it++) {
+        bone_names[it->second] = it->first;
+    }
+    for (int i = 0; i < model.bones.size(); i++) {
+        writer.write_string(bone_names[i]);
+        writer.write(model.bones[i].offset_matrix);
+    }
+    write_node(writer, model.root_node);
+
+    // Animations
+    for (int i = 0; i < model.animations.size(); i++) {
+        Animation& animation = model.animations[i];
+        writer.write_string(animation.name);
+        writer.write(animation.ticks_per_second);
+        writer.write(animation.duration);
+        writer.write((uint32_t)animation.umap_node_name_to_channels.size());
+        for (auto it = animation.umap_node_name_to_channels.begin(); it != animation.umap_node_name_to_channels.end(); it++) {
+            writer.write_string(it->first);
+            write_vector_track(writer, it->second.map_time_to_position);
+            write_rotation_track(writer, it->second.map_time_to_rotation);
+            write_vector_track(writer, it->second.map_time_to_scaling);
+        }
+    }
+
+    // Write to a temporary file first, so a model being loaded concurrently never sees a partial file
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cache_path).parent_path(), error);
+    std::string temporary_path = cache_path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cout << "ERROR::MODEL_CACHE:: Failed to write the model cache: " << cache_path << std::endl;
+            return false;
+        }
+        file.write((const char*)writer.buffer.data(), writer.buffer.size());
+    }
+    std::filesystem::rename(temporary_path, cache_path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
+
+void clear_model_data(Model& model) {
+    for (auto it = model.loaded_textures.begin(); it != model.loaded_textures.end(); it++) {
+        Texture::pool.destroy(it->second);
+    }
+    for (auto it = model.loaded_materials.begin(); it != model.loaded_materials.end(); it++) {
+        Material::pool.destroy(it->second);
+    }
+    for (int i = 0; i < model.pending_texture_images.size(); i++) {
+        free_image_data(model.pending_texture_images[i].second);
+    }
+    model.pending_texture_images.clear();
+    model.loaded_textures.clear();
+    model.loaded_materials.clear();
+    model.meshes.clear();
+    model.bones.clear();
+    model.umap_bone_name_to_id.clear();
+    model.animations.clear();
+    delete model.root_node;
+    model.root_node = nullptr;
+}
+
+bool read_model_cache(Model& model, const std::string& cache_path, uint64_t cache_key) {
+    MappedFile* cache_file = new MappedFile();
+    if (!cache_file->open(cache_path)) {
+        delete cache_file;
+        return false;
+    }
+
+    CacheReader reader(cache_file->data, cache_file->size);
+    ModelCacheHeader header = reader.read<ModelCacheHeader>();
+    if (!reader.valid || memcmp(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != MODEL_CACHE_VERSION || header.vertex_size != sizeof(Vertex) || (cache_key != 0 && header.cache_key != cache_key)) {
+        std::cout << "Model cache is outdated: " << cache_path << std::endl;
+        delete cache_file;
+        return false;
+    }
+
+    model.format = (FileFormat)header.format;
+    model.aabb_min = glm::vec3(header.aabb_min[0], header.aabb_min[1], header.aabb_min[2]);
+    model.aabb_max = glm::vec3(header.aabb_max[0], header.aabb_max[1], header.aabb_max[2]);
+    memcpy(&model.global_inverse_transform, header.global_inverse_transform, sizeof(header.global_inverse_transform));
+
+    // Textures: decoded now, uploaded in upload_to_gpu()
+    std::vector<Texture*> textures;
+    for (uint32_t i = 0; i < header.num_textures && reader.valid; i++) {
+        std::string path = reader.read_string();
+        Texture* texture = Texture::pool.create(reader.read_string());
+        uint32_t types = reader.read<uint32_t>();
+        uint64_t embedded_size;
+        const unsigned char* embedded_data = reader.read_blob(embedded_size);
+        for (int type = TexAlbedo; type < TexLast; type++) {
+            if (types & (1u << type)) {
+                texture->types.insert((TextureType)type);
+            }
+        }
+        texture->id = 0;
+        texture->path = path;
+        model.loaded_textures[path] = texture;
+        textures.push_back(texture);
+        if (!reader.valid) {
+            break;
+        }
+
+        ImageData image;
+        if (embedded_size > 0) {
+            TextureCache::get_instance()->load_image_from_memory(embedded_data, (int)embedded_size, model.directory + "/" + path, image, model.flip_vertically);
+        }
+        else {
+            ImageFromFile(path.c_str(), model.directory, image, model.flip_vertically);
+        }
+        texture->num_channels = image.num_channels;
+        model.pending_texture_images.push_back(std::make_pair(texture, image));
+    }
+
+    // Materials
+    for (uint32_t i = 0; i < header.num_materials && reader.valid; i++) {
+        unsigned int material_key = reader.read<unsigned int>();
+        Material* material = Material::pool.create(reader.read_string());
+        material->format = (FileFormat)reader.read<uint32_t>();
+        for (int type = TexAlbedo; type < TexLast; type++) {
+            int32_t texture_index = reader.read<int32_t>();
+            if (texture_index >= 0 && texture_index < textures.size()) {
+                material->textures[(TextureType)type] = textures[texture_index];
+            }
+        }
+        model.loaded_materials[material_key] = material;
+    }
+
+    // Meshes: the vertex and index data is used in place from the mapped file
+    for (uint32_t i = 0; i < header.num_meshes && reader.valid; i++) {
+        std::string mesh_name = reader.read_string();
+        unsigned int material_key = reader.read<unsigned int>();
+        uint32_t num_vertices = reader.read<uint32_t>();
+        uint32_t num_indices = reader.read<uint32_t>();
+        uint64_t vertex_data_size, index_data_size;
+        const Vertex* vertex_data = (const Vertex*)reader.read_blob(vertex_data_size);
+        const unsigned int* index_data = (const unsigned int*)reader.read_blob(index_data_size);
+        if (!reader.valid || vertex_data_size != num_vertices * sizeof(Vertex) || index_data_size != num_indices * sizeof(unsigned int) ||
+            model.loaded_materials.find(material_key) == model.loaded_materials.end()) {
+            reader.valid = false;
+            break;
+        }
+        model.meshes.push_back(Mesh(mesh_name, vertex_data, num_vertices, index_data, num_indices, model.loaded_materials[material_key]));
+    }
+
+    // Skeleton
+    for (uint32_t i = 0; i < header.num_bones && reader.valid; i++) {
+        std::string bone_name = reader.read_string();
+        Bone bone;
+        bone.offset_matrix = reader.read<aiMatrix4x4>();
+        model.umap_bone_name_to_id[bone_name] = (int)i;
+        model.bones.push_back(bone);
+    }
+    uint32_t num_nodes_left = header.num_nodes;
+    if (reader.valid) {
+        model.root_node = read_node(reader, num_nodes_left);
+    }
+
+    // Animations
+    for (uint32_t i = 0; i < header.num_animations && reader.valid; i++) {
+        Animation animation;
+        animation.name = reader.read_string();
+        animation.ticks_per_second = reader.read<double>();
+        animation.duration = reader.read<double>();
+        uint32_t num_channels = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < num_channels && reader.valid; j++) {
+            std::string node_name = reader.read_string();
+            NodeAnimation node_animation;
+            read_vector_track(reader, node_animation.map_time_to_position);
+            read_rotation_track(reader, node_animation.map_time_to_rotation);
+            read_vector_track(reader, node_animation.map_time_to_scaling);
+            animation.umap_node_name_to_channels[node_name] = node_animation;
+        }
+        model.animations.push_back(animation);
+    }
+
+    if (!reader.valid) {
+        std::cout << "ERROR::MODEL_CACHE:: Corrupted model cache: " << cache_path << std::endl;
+        clear_model_data(model);
+        delete cache_file;
+        return false;
+    }
+
+    // The mapping is released after the upload of the meshes
+    model.cache_file = cache_file;
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+class Model;
+struct aiScene;
+
+// Engine-native binary model format, written after the first import of a model and memory-mapped on the next runs.
+// Layout: ModelCacheHeader, textures, materials, meshes (16 bytes aligned vertex/index blobs), bones, nodes, animations.
+const char MODEL_CACHE_MAGIC[8] = { 'N', 'E', 'O', 'N', 'M', 'D', 'L', '\0' };
+const uint32_t MODEL_CACHE_VERSION = 1;
+const std::string MODEL_CACHE_DIRECTORY = "cache/models";
+// Hashes of the contents of the source files with the size and modification time they had: <hash in hex> <size> <time> <path>
+const std::string FILE_HASHES_PATH = "cache/file_hashes.txt";
+
+struct ModelCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertex_size;
+    uint64_t cache_key;
+    uint32_t import_flags;
+    uint32_t format;
+    float aabb_min[3];
+    float aabb_max[3];
+    float global_inverse_transform[16];
+    uint32_t num_textures;
+    uint32_t num_materials;
+    uint32_t num_meshes;
+    uint32_t num_bones;
+    uint32_t num_nodes;
+    uint32_t num_animations;
+};
+
+// FNV-1a 64 bits
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+uint64_t hash_bytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS);
+uint64_t hash_file(const std::string& path, uint64_t hash = FNV_OFFSET_BASIS);
+// Any thread. Hash of the contents of a file, only read again when its size or modification time changed since it was
+// last hashed, so checking the caches of unchanged assets doesn't read their sources. 0 when the file doesn't exist
+uint64_t get_file_content_hash(const std::string& path);
+
+// The key covers the contents of the source file (and the .bin buffers next to a glTF file), the import flags and the cache version.
+// The contents are hashed by get_file_content_hash(), an unchanged model isn't read to check its cache
+uint64_t compute_model_cache_key(const std::string& source_path, unsigned int import_flags);
+std::string get_model_cache_path(const std::string& model_name, uint64_t cache_key);
+
+// scene is used to store the embedded textures of the model, it can be nullptr
+bool write_model_cache(Model& model, const std::string& cache_path, uint64_t cache_key, unsigned int import_flags, const aiScene* scene);
+// The vertex and index data of the meshes stays in the mapped file until Model::upload_to_gpu().
+// A cache_key of 0 accepts the file whatever its key is (cooked models).
+bool read_model_cache(Model& model, const std::string& cache_path, uint64_t cache_key);
+// Frees the partially loaded data of a model after a failed read of its cache
+void clear_model_data(Model& model);
@@ -5,8 +5,21 @@
 #include "camera.h"
 #include "rendering.h"
 #include "logger.h"
+#include "task_graph.h"
+#include "staging_ring.h"
+#include "headless_context.h"
+#include "opengl_utils.h"
+#include "benchmark.h"
+#include "frame_profiler.h"
+#include "trace_recorder.h"
+#include "gl_counters.h"
+#include "resource_registry.h"
+#include "sampling_profiler.h"
+#include "allocation_tracker.h"
+#include "frame_arena.h"
 
 #include <stb_image.h>
+#include <stb_image_write.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -18,6 +31,8 @@
 #include <GLFW/glfw3.h>
 #include <mutex>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 
 NeonEngine* NeonEngine::instance = nullptr;
 std::mutex NeonEngine::neon_engine_mutex;
@@ -28,6 +43,10 @@ NeonEngine::NeonEngine() {
     input = nullptr;
     rendering = nullptr;
     logger = new Logger("log.txt");
+    count_gl_calls = false;
+    print_memory_report = false;
+    sample_rate_hz = SAMPLING_PROFILER_DEFAULT_RATE_HZ;
+    fail_on_frame_allocations = false;
     glfw_major_version = 4;
     glfw_minor_version = 6;
     glsl_version = "#version 460 core";
@@ -49,6 +68,12 @@ NeonEngine::~NeonEngine() {
 }
 
 void NeonEngine::initialize_all_components() {
+    // the trace can also be started from the profiler window, the thread is named anyway
+    TraceRecorder::set_thread_name("main");
+    if (!trace_path.empty()) {
+        TraceRecorder::enabled = true;
+    }
+
     user_interface = UserInterface::get_instance();
     input = Input::get_instance();
     rendering = Rendering::get_instance();
@@ -109,6 +134,30 @@ void NeonEngine::clean_gflw() {
     glfwTerminate();
 }
 
+void NeonEngine::load_scene() {
+    ALLOCATION_TAG(AllocAssets);
+    if (count_gl_calls) {
+        install_gl_counters();
+    }
+
+    // configure global opengl state
+    rendering->set_opengl_state();
+
+    // the worker threads write the decoded textures into the staging ring, ready to be uploaded
+    StagingRing::get_instance()->initialize(STAGING_RING_SIZE);
+
+    // load shaders, HDRIs, materials and models as a graph of tasks: the CPU work runs in parallel
+    // in worker threads while the GL work runs in this thread, which owns the GL context
+    TaskGraph startup_task_graph;
+    rendering->add_startup_tasks(startup_task_graph);
+    startup_task_graph.run();
+    startup_task_graph.print_timing_report();
+
+    if (print_memory_report) {
+        ResourceRegistry::get_instance()->print_report(MEMORY_REPORT_TOP_CONSUMERS);
+    }
+}
+
 int NeonEngine::run() {
     initialize_all_components();
     if (setup_glfw() != 0) {
@@ -124,19 +173,20 @@ int NeonEngine::run() {
     // Our state
     ImGuiIO& io = ImGui::GetIO();
 
-    // configure global opengl state
-    rendering->set_opengl_state();
-
-    rendering->set_viewport_shaders();
-
-    rendering->set_viewport_data();
+    if (!sample_profile_path.empty()) {
+        SamplingProfiler::get_instance()->start(sample_rate_hz);
+    }
 
-    rendering->initialize_game_objects();
+    load_scene();
 
     rendering->set_time_before_rendering_loop();
+
+    std::vector<CameraKeyframe> recorded_keyframes;
+    int frame = 0;
     
     while (!glfwWindowShouldClose(window))
     {
+        TRACE_SCOPE("frame");
         float current_time_seconds = static_cast<float>(glfwGetTime());
         delta_time_seconds = current_time_seconds - last_time_seconds;
         last_time_seconds = current_time_seconds;
@@ -144,6 +194,9 @@ int NeonEngine::run() {
 
         glfwPollEvents();
 
+        // the transient data of the previous frame is freed at once
+        FrameArena::get_instance()->reset();
+
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -155,9 +208,13 @@ int NeonEngine::run() {
         user_interface->update_displayed_texture();
 
         // ImGui rendering
-        ImGui::Render();
+        {
+            TRACE_SCOPE("imgui_render");
+            ALLOCATION_TAG(AllocUI);
+            ImGui::Render();
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
@@ -167,15 +224,227 @@ int NeonEngine::run() {
             glfwMakeContextCurrent(backup_current_context);
         }
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_SCOPE("swap_buffers");
+            glfwSwapBuffers(window);
+        }
+
+        if (!record_camera_path.empty() && frame % CAMERA_PATH_RECORD_INTERVAL == 0) {
+            Camera* camera = rendering->camera_viewport;
+            recorded_keyframes.push_back({ frame, camera->Position, camera->Yaw, camera->Pitch });
+        }
+        frame++;
+    }
+
+    if (!record_camera_path.empty() && save_camera_path(record_camera_path, recorded_keyframes)) {
+        std::cout << "RECORDED CAMERA PATH OF " << frame << " FRAMES IN: " << record_camera_path << std::endl;
+    }
+    if (!trace_path.empty()) {
+        TraceRecorder::get_instance()->write_trace(trace_path);
+    }
+    if (print_memory_report) {
+        ResourceRegistry::get_instance()->print_report(MEMORY_REPORT_TOP_CONSUMERS);
+    }
+    if (!sample_profile_path.empty()) {
+        SamplingProfiler::get_instance()->write_folded_stacks(sample_profile_path);
     }
 
     // Cleanup
     rendering->clean();
     rendering->clean_viewport_framebuffer();
+    StagingRing::get_instance()->clean();
     user_interface->clean_imgui();
 
     clean_gflw();
 
     return 0;
-}
\ No newline at end of file
+}
+
+// Reports the allocations of the first frame that allocates, by tag, the allocations of the profilers don't count
+void NeonEngine::check_frame_allocations(int frame, const AllocationCounters* frame_begin_allocations, int& num_allocating_frames) {
+    AllocationCounters frame_allocations[AllocTagLast];
+    uint64_t num_allocations = 0;
+    for (int i = 0; i < AllocTagLast; i++) {
+        frame_allocations[i] = get_thread_allocation_counters((AllocationTag)i) - frame_begin_allocations[i];
+        if (i != AllocProfiling) {
+            num_allocations += frame_allocations[i].count;
+        }
+    }
+    if (num_allocations == 0) {
+        return;
+    }
+    if (num_allocating_frames == 0) {
+        std::cout << "ERROR::NEON_ENGINE:: Frame " << frame << " allocated " << num_allocations << " times:";
+        for (int i = 0; i < AllocTagLast; i++) {
+            if (i != AllocProfiling && frame_allocations[i].count > 0) {
+                std::cout << " " << allocation_tag_to_string((AllocationTag)i) << " " << frame_allocations[i].count << " (" << frame_allocations[i].bytes << " bytes)";
+            }
+        }
+        std::cout << std::endl;
+    }
+    num_allocating_frames++;
+}
+
+// The full rendering pipeline without window, ImGui or input, for the machines without display (or GPU)
+int NeonEngine::run_headless(const HeadlessOptions& options) {
+    initialize_all_components();
+    HeadlessContext headless_context;
+    if (!headless_context.create(glfw_major_version, glfw_minor_version)) {
+        return -1;
+    }
+
+    std::vector<CameraKeyframe> camera_path;
+    bool is_benchmark = !options.camera_path.empty();
+    if (is_benchmark && !load_camera_path(options.camera_path, camera_path)) {
+        headless_context.destroy();
+        return -1;
+    }
+
+    load_scene();
+
+    // the framebuffer of the viewport has the size of the output instead of the size of the viewport window
+    user_interface->texture_viewport_width = options.width;
+    user_interface->texture_viewport_height = options.height;
+    rendering->setup_framebuffer_and_textures();
+
+    rendering->set_time_before_rendering_loop();
+
+    // a benchmark renders the same frames on every run: the animations advance a fixed time step per frame,
+    // and the warmup frames (not measured) are rendered at the first keyframe
+    BenchmarkResults benchmark_results;
+    std::vector<unsigned int> gpu_timer_queries;
+    int num_warmup_frames = 0;
+    if (is_benchmark) {
+        rendering->use_fixed_animation_time = true;
+        num_warmup_frames = BENCHMARK_WARMUP_FRAMES;
+        gpu_timer_queries.resize(options.num_frames);
+        glGenQueries(options.num_frames, gpu_timer_queries.data());
+        for (int i = 0; i < num_warmup_frames; i++) {
+            CameraKeyframe keyframe = interpolate_camera_path(camera_path, 0);
+            rendering->camera_viewport->SetPose(keyframe.position, keyframe.yaw, keyframe.pitch);
+            rendering->fixed_animation_time_seconds = 0.0f;
+            FrameArena::get_instance()->reset();
+            rendering->render_viewport();
+            glFinish();
+        }
+    }
+
+    if (!sample_profile_path.empty()) {
+        SamplingProfiler::get_instance()->start(sample_rate_hz);
+    }
+    // the steady-state frames must not allocate, the first frames of a run without warmup fill the caches
+    int num_allocating_frames = 0;
+    int first_checked_frame = is_benchmark ? 0 : ALLOCATION_TEST_WARMUP_FRAMES;
+    if (fail_on_frame_allocations) {
+        set_allocation_tracking(true);
+    }
+    AllocationCounters frame_begin_allocations[AllocTagLast];
+
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+    auto last_frame_timer = begin_timer;
+    for (int frame = 0; frame < options.num_frames; frame++) {
+        TRACE_SCOPE("frame");
+        if (is_benchmark) {
+            CameraKeyframe keyframe = interpolate_camera_path(camera_path, frame);
+            rendering->camera_viewport->SetPose(keyframe.position, keyframe.yaw, keyframe.pitch);
+            rendering->fixed_animation_time_seconds = frame * BENCHMARK_FRAME_TIME_SECONDS;
+            glBeginQuery(GL_TIME_ELAPSED, gpu_timer_queries[frame]);
+        }
+        FrameArena::get_instance()->reset();
+        for (int i = 0; i < AllocTagLast; i++) {
+            frame_begin_allocations[i] = get_thread_allocation_counters((AllocationTag)i);
+        }
+        rendering->render_viewport();
+        if (is_benchmark) {
+            glEndQuery(GL_TIME_ELAPSED);
+        }
+        if (fail_on_frame_allocations && frame >= first_checked_frame) {
+            check_frame_allocations(frame, frame_begin_allocations, num_allocating_frames);
+        }
+        auto submitted_timer = std::chrono::high_resolution_clock::now();
+        // without swap buffers nothing waits for the GPU, the frame times include its work
+        glFinish();
+
+        auto frame_timer = std::chrono::high_resolution_clock::now();
+        delta_time_seconds = std::chrono::duration_cast<std::chrono::duration<float>>(frame_timer - last_frame_timer).count();
+        frames_per_second = 1.0f / delta_time_seconds;
+        if (is_benchmark) {
+            // the queries of the profiler are finished too, the times of the passes of this frame are read right away
+            FrameProfiler::get_instance()->resolve_pending_frames();
+            const std::vector<PassTiming>& pass_timings = FrameProfiler::get_instance()->get_pass_timings();
+            std::map<std::string, double> pass_gpu_times_ms;
+            std::map<std::string, GLCounters> pass_gl_counters;
+            for (int i = 0; i < pass_timings.size(); i++) {
+                pass_gpu_times_ms[pass_timings[i].name] += pass_timings[i].gpu_ms;
+                pass_gl_counters[pass_timings[i].name] += pass_timings[i].gl_counters;
+            }
+            benchmark_results.pass_gpu_times_ms.push_back(pass_gpu_times_ms);
+            if (are_gl_counters_installed()) {
+                benchmark_results.has_gl_counters = true;
+                benchmark_results.frame_gl_counters.push_back(FrameProfiler::get_instance()->get_frame_gl_counters());
+                benchmark_results.pass_gl_counters.push_back(pass_gl_counters);
+            }
+            benchmark_results.cpu_times_ms.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(submitted_timer - last_frame_timer).count());
+            benchmark_results.frame_times_ms.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(frame_timer - last_frame_timer).count());
+        }
+        last_frame_timer = frame_timer;
+    }
+    if (!sample_profile_path.empty()) {
+        SamplingProfiler::get_instance()->write_folded_stacks(sample_profile_path);
+    }
+    if (!trace_path.empty()) {
+        FrameProfiler::get_instance()->resolve_pending_frames();
+        TraceRecorder::get_instance()->write_trace(trace_path);
+    }
+    double elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(last_frame_timer - begin_timer).count();
+    std::cout << "HEADLESS: RENDERED " << options.num_frames << " FRAMES OF " << options.width << "x" << options.height << " IN: " << elapsed_time_seconds
+        << " seconds (" << elapsed_time_seconds * 1000.0 / std::max(options.num_frames, 1) << " ms per frame)" << std::endl;
+
+    // with a GPU memory budget the run fails when the resources of the scene don't fit in it, the outputs are written anyway
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    if (print_memory_report) {
+        resource_registry->print_report(MEMORY_REPORT_TOP_CONSUMERS);
+    }
+    int result = 0;
+    if (num_allocating_frames > 0) {
+        std::cout << "ERROR::NEON_ENGINE:: " << num_allocating_frames << " of " << std::max(options.num_frames - first_checked_frame, 0)
+            << " steady-state frames allocated on the heap" << std::endl;
+        result = -1;
+    }
+    if (resource_registry->is_over_gpu_budget()) {
+        std::cout << "ERROR::NEON_ENGINE:: The resources of the scene use " << resource_registry->get_gpu_total() / (1024 * 1024)
+            << " MB of GPU memory, over the budget of " << resource_registry->gpu_memory_budget / (1024 * 1024) << " MB" << std::endl;
+        result = -1;
+    }
+
+    if (is_benchmark) {
+        // every query has finished after the last glFinish
+        for (int frame = 0; frame < options.num_frames; frame++) {
+            GLuint64 gpu_time_ns = 0;
+            glGetQueryObjectui64v(gpu_timer_queries[frame], GL_QUERY_RESULT, &gpu_time_ns);
+            benchmark_results.gpu_times_ms.push_back(gpu_time_ns / 1000000.0);
+        }
+        glDeleteQueries(options.num_frames, gpu_timer_queries.data());
+
+        benchmark_results.scene_name = DEFAULT_SCENE_NAME;
+        benchmark_results.camera_path = options.camera_path;
+        benchmark_results.width = options.width;
+        benchmark_results.height = options.height;
+        benchmark_results.gpu_memory_bytes = resource_registry->get_gpu_total();
+        benchmark_results.cpu_memory_bytes = resource_registry->get_cpu_total();
+        write_benchmark_report(options.output_prefix, benchmark_results);
+    }
+
+    // the rows of the GL textures go from the bottom to the top
+    stbi_flip_vertically_on_write(true);
+    save_texture_to_png_file(rendering->textureLDRColorbuffer, 4, options.width, options.height, options.output_prefix + "_ldr.png");
+    save_texture_to_hdr_file(rendering->textureHDRColorbuffer, 3, options.width, options.height, options.output_prefix + "_hdr.hdr");
+    stbi_flip_vertically_on_write(false);
+
+    rendering->clean();
+    rendering->clean_viewport_framebuffer();
+    StagingRing::get_instance()->clean();
+    headless_context.destroy();
+
+    return result;
+}
@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 #include <mutex>
+#include <string>
 
 class UserInterface;
 class Input;
@@ -10,6 +11,19 @@ struct GLFWwindow;
 class Shader;
 class Model;
 class Logger;
+struct AllocationCounters;
+
+// Headless mode: the frames are rendered into the offscreen framebuffer of the viewport, without window or UI,
+// and the last one is saved as <output_prefix>_ldr.png and <output_prefix>_hdr.hdr.
+// With a camera path it's a benchmark: the camera plays the path with a fixed time step and the CPU and GPU times
+// of every frame are written to <output_prefix>.csv with their statistics in <output_prefix>.json
+struct HeadlessOptions {
+    int width = 1920;
+    int height = 1080;
+    int num_frames = 60;
+    std::string output_prefix = "headless";
+    std::string camera_path;
+};
 
 class NeonEngine {
 public:
@@ -18,6 +32,7 @@ public:
     void operator=(const NeonEngine&) = delete;
 
     int run();
+    int run_headless(const HeadlessOptions& options);
 
     GLFWwindow* window;
     const char* glsl_version;
@@ -37,11 +52,28 @@ public:
 
     Logger* logger;
 
+    // When set, the camera of the viewport is recorded as a camera path for the benchmarks and saved to this file on exit
+    std::string record_camera_path;
+    // When set, the trace recorder is enabled from the start and every recorded event is written to this file on exit
+    std::string trace_path;
+    // Counts the GL calls of every frame and pass from the start, see gl_counters.h
+    bool count_gl_calls;
+    // Prints the memory of the resources (see resource_registry.h) after loading the scene and on exit
+    bool print_memory_report;
+    // When set, the sampling profiler (see sampling_profiler.h) runs at sample_rate_hz and writes its folded stacks to this file on exit.
+    // A headless run only samples its frames, after the warmup of the benchmarks
+    std::string sample_profile_path;
+    int sample_rate_hz;
+    // A headless run fails when a frame after the warmup allocates on the heap (see allocation_tracker.h)
+    bool fail_on_frame_allocations;
+
 private:
     NeonEngine();
     ~NeonEngine();
 
     void initialize_all_components();
+    void load_scene();
+    void check_frame_allocations(int frame, const AllocationCounters* frame_begin_allocations, int& num_allocating_frames);
     int setup_glfw();
     int setup_glad();
     void clean_gflw();
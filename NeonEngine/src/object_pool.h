@@ -0,0 +1,195 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+#include <new>
+#include <iostream>
+
+// Slots of each slab of a pool, the pools grow one slab at a time
+const int OBJECT_POOL_SLAB_SIZE = 256;
+
+// Reference to an object of a pool that detects when the object was destroyed, the default handle is null
+struct PoolHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+};
+
+inline bool operator==(const PoolHandle& a, const PoolHandle& b) {
+    return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator!=(const PoolHandle& a, const PoolHandle& b) {
+    return !(a == b);
+}
+
+// Slab allocator of the objects of one type: the objects are constructed in the slots of slabs that are never moved or freed
+// until the pool is destroyed, so their addresses are stable and the pointers held within a model or a frame stay valid.
+// The longer-lived references (the materials and textures of the scene) are handles.
+// A destroyed object's slot is the first one reused, so creating and destroying objects doesn't fragment the heap,
+// and for_each() visits the live objects in the order of their slots, close to each other in memory.
+// Each slot has a generation that changes when its object is destroyed, get() returns nullptr for a handle to a destroyed object.
+// Any thread, the materials and textures of the models are created by the workers of the task graph.
+// The function of for_each() can't create or destroy objects of the same pool
+template<typename T>
+class ObjectPool {
+public:
+    ObjectPool() {}
+
+    ~ObjectPool() {
+        clear();
+        for (int i = 0; i < slabs.size(); i++) {
+            delete[] slabs[i];
+        }
+    }
+
+    ObjectPool(ObjectPool& other) = delete;
+    void operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (first_free_slot == -1) {
+            add_slab();
+        }
+        Slot& slot = get_slot(first_free_slot);
+        T* object = new (slot.storage) T(std::forward<Args>(args)...);
+        first_free_slot = slot.next_free_slot;
+        slot.alive = true;
+        num_objects++;
+        return object;
+    }
+
+    // The object must have been created by this pool, destroying it twice is ignored
+    void destroy(T* object) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        Slot& slot = *reinterpret_cast<Slot*>(object);
+        if (!slot.alive) {
+            std::cout << "ERROR::OBJECT_POOL::OBJECT_ALREADY_DESTROYED" << std::endl;
+            return;
+        }
+        destroy_slot(slot);
+    }
+
+    // A null or stale handle is ignored
+    void destroy(const PoolHandle& handle) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        Slot* slot = get_live_slot(handle);
+        if (slot != nullptr) {
+            destroy_slot(*slot);
+        }
+    }
+
+    // The null handle for nullptr
+    PoolHandle get_handle(const T* object) {
+        if (object == nullptr) {
+            return PoolHandle();
+        }
+        const Slot* slot = reinterpret_cast<const Slot*>(object);
+        PoolHandle handle;
+        handle.index = slot->index;
+        handle.generation = slot->generation;
+        return handle;
+    }
+
+    // nullptr for a null handle or if the object was destroyed
+    T* get(const PoolHandle& handle) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        Slot* slot = get_live_slot(handle);
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(slot->storage);
+    }
+
+    template<typename Function>
+    void for_each(Function function) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (int i = 0; i < slabs.size(); i++) {
+            for (int j = 0; j < OBJECT_POOL_SLAB_SIZE; j++) {
+                if (slabs[i][j].alive) {
+                    function(reinterpret_cast<T*>(slabs[i][j].storage));
+                }
+            }
+        }
+    }
+
+    // Destroys every object, the slabs are kept and the handles to the objects become stale
+    void clear() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (int i = 0; i < slabs.size(); i++) {
+            for (int j = 0; j < OBJECT_POOL_SLAB_SIZE; j++) {
+                if (slabs[i][j].alive) {
+                    destroy_slot(slabs[i][j]);
+                }
+            }
+        }
+    }
+
+    int get_num_objects() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return num_objects;
+    }
+
+    int get_capacity() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return (int)slabs.size() * OBJECT_POOL_SLAB_SIZE;
+    }
+
+private:
+    // The storage goes first so a pointer to the object is a pointer to its slot
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t index;
+        uint32_t generation;
+        int next_free_slot;
+        bool alive;
+    };
+
+    Slot& get_slot(uint32_t index) {
+        return slabs[index / OBJECT_POOL_SLAB_SIZE][index % OBJECT_POOL_SLAB_SIZE];
+    }
+
+    void add_slab() {
+        Slot* slab = new Slot[OBJECT_POOL_SLAB_SIZE];
+        uint32_t first_index = (uint32_t)slabs.size() * OBJECT_POOL_SLAB_SIZE;
+        for (int i = 0; i < OBJECT_POOL_SLAB_SIZE; i++) {
+            slab[i].index = first_index + i;
+            slab[i].generation = 1;
+            slab[i].next_free_slot = (i + 1 < OBJECT_POOL_SLAB_SIZE) ? first_index + i + 1 : first_free_slot;
+            slab[i].alive = false;
+        }
+        slabs.push_back(slab);
+        first_free_slot = first_index;
+    }
+
+    Slot* get_live_slot(const PoolHandle& handle) {
+        if (handle.generation == 0 || handle.index >= slabs.size() * OBJECT_POOL_SLAB_SIZE) {
+            return nullptr;
+        }
+        Slot& slot = get_slot(handle.index);
+        if (!slot.alive || slot.generation != handle.generation) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    void destroy_slot(Slot& slot) {
+        reinterpret_cast<T*>(slot.storage)->~T();
+        slot.alive = false;
+        // the generation 0 is kept for the null handle
+        slot.generation++;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.next_free_slot = first_free_slot;
+        first_free_slot = slot.index;
+        num_objects--;
+    }
+
+    std::vector<Slot*> slabs;
+    int first_free_slot = -1;
+    int num_objects = 0;
+    std::mutex pool_mutex;
+};
@@ -1,10 +1,16 @@
 #include "opengl_utils.h"
 
+#include "cooked_assets.h"
+#include "texture_cache.h"
+#include "staging_ring.h"
+
 #define __STDC_LIB_EXT1__
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 #include <stb_image.h>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -279,38 +285,167 @@ void renderSphere()
 
 // utility function for loading a 2D texture from file
 unsigned int load_texture(const std::string& path, int& num_channels) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+    ImageData image;
+    load_image_data(path, image, true);
+    num_channels = image.num_channels;
+    return upload_image_data_to_texture(image);
+}
 
-    int width, height;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &num_channels, 0);
-    if (data) {
+bool load_image_data(const std::string& path, ImageData& image, bool flip_vertically) {
+    if (get_use_cooked_assets() && load_cooked_image_data(path, image, flip_vertically)) {
+        return true;
+    }
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
+    image.data = stbi_load(path.c_str(), &image.width, &image.height, &image.num_channels, 0);
+    if (!image.data) {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool load_image_data_from_memory(const unsigned char* buffer, int length_buffer, ImageData& image, bool flip_vertically) {
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
+    image.data = stbi_load_from_memory(buffer, length_buffer, &image.width, &image.height, &image.num_channels, 0);
+    if (!image.data) {
+        std::cout << "Embedded texture failed to load" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool load_hdr_image_data(const std::string& path, ImageData& image, bool flip_vertically) {
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
+    image.data_hdr = stbi_loadf(path.c_str(), &image.width, &image.height, &image.num_channels, 0);
+    if (!image.data_hdr) {
+        std::cout << "Failed to load HDR image." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// uploads a decoded LDR image to a new mipmapped 2D texture and frees the image data
+unsigned int upload_image_data_to_texture(ImageData& image, unsigned int texture_id) {
+    if (image.cache_key != 0) {
+        unsigned int textureID = TextureCache::get_instance()->acquire(image.cache_key);
+        image.cache_key = 0;
+        return textureID;
+    }
+    if (image.cooked_texture) {
+        unsigned int textureID = upload_ktx2_texture(*image.cooked_texture, true, texture_id);
+        free_image_data(image);
+        return textureID;
+    }
+
+    unsigned int textureID = texture_id;
+    if (textureID == 0) {
+        glGenTextures(1, &textureID);
+    }
+    else {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+    }
+
+    if (image.data || image.staging) {
         GLenum format;
-        if (num_channels == 1)
+        if (image.num_channels == 1)
             format = GL_RED;
-        else if (num_channels == 2)
+        else if (image.num_channels == 2)
             format = GL_RG;
-        else if (num_channels == 3)
+        else if (image.num_channels == 3)
             format = GL_RGB;
         else
             format = GL_RGBA;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        if (image.staging) {
+            // the pixels are read from the staging ring by the GPU, the call doesn't wait for a copy
+            StagingRing* staging_ring = StagingRing::get_instance();
+            staging_ring->bind();
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, (void*)image.staging->offset);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            staging_ring->unbind();
+            staging_ring->submit(*image.staging);
+            delete image.staging;
+            image.staging = nullptr;
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
+        }
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    free_image_data(image);
 
-        stbi_image_free(data);
+    return textureID;
+}
+
+void free_image_data(ImageData& image) {
+    if (image.data) {
+        stbi_image_free(image.data);
+        image.data = nullptr;
     }
-    else {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
+    if (image.data_hdr) {
+        stbi_image_free(image.data_hdr);
+        image.data_hdr = nullptr;
     }
+    delete image.cooked_texture;
+    image.cooked_texture = nullptr;
+    if (image.staging) {
+        StagingRing::get_instance()->discard(*image.staging);
+        delete image.staging;
+        image.staging = nullptr;
+    }
+}
 
-    return textureID;
+bool stage_image_data(ImageData& image) {
+    if (!image.data) {
+        return false;
+    }
+    // a few large images can't take the whole ring
+    size_t size = (size_t)image.width * image.height * image.num_channels;
+    StagingAllocation allocation;
+    if (size > STAGING_RING_SIZE / 4 || !StagingRing::get_instance()->allocate(size, allocation)) {
+        return false;
+    }
+    std::memcpy(allocation.data, image.data, size);
+    stbi_image_free(image.data);
+    image.data = nullptr;
+    image.staging = new StagingAllocation(allocation);
+    return true;
+}
+
+// Box filtered mip chain down to 1x1, the odd rows and columns are clamped to the edge
+void generate_mip_chain(const unsigned char* data, int width, int height, int num_channels, std::vector<std::vector<unsigned char>>& levels) {
+    levels.push_back(std::vector<unsigned char>(data, data + (size_t)width * height * num_channels));
+    while (width > 1 || height > 1) {
+        int level_width = std::max(width / 2, 1);
+        int level_height = std::max(height / 2, 1);
+        const std::vector<unsigned char>& source = levels.back();
+        std::vector<unsigned char> level((size_t)level_width * level_height * num_channels);
+        for (int y = 0; y < level_height; y++) {
+            int y0 = std::min(2 * y, height - 1);
+            int y1 = std::min(2 * y + 1, height - 1);
+            for (int x = 0; x < level_width; x++) {
+                int x0 = std::min(2 * x, width - 1);
+                int x1 = std::min(2 * x + 1, width - 1);
+                for (int c = 0; c < num_channels; c++) {
+                    int sum = source[((size_t)y0 * width + x0) * num_channels + c] + source[((size_t)y0 * width + x1) * num_channels + c] +
+                        source[((size_t)y1 * width + x0) * num_channels + c] + source[((size_t)y1 * width + x1) * num_channels + c];
+                    level[((size_t)y * level_width + x) * num_channels + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(std::move(level));
+        width = level_width;
+        height = level_height;
+    }
 }
 
 unsigned int load_hdr_texture(char const* path)
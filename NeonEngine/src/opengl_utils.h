@@ -2,6 +2,26 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+
+struct Ktx2Texture;
+struct StagingAllocation;
+
+// Decoded image in CPU memory, ready to be uploaded to a texture.
+// The decoding can be done in any thread, the upload must be done in the thread with the GL context.
+struct ImageData {
+    int width = 0;
+    int height = 0;
+    int num_channels = 0;
+    unsigned char* data = nullptr;
+    float* data_hdr = nullptr;
+    // Cooked texture with its mip chain, used instead of data when the engine runs with cooked assets
+    Ktx2Texture* cooked_texture = nullptr;
+    // Entry of the TextureCache holding the decoded image, 0 when the image isn't cached
+    uint64_t cache_key = 0;
+    // Pixels copied to the StagingRing by stage_image_data(), used instead of data
+    StagingAllocation* staging = nullptr;
+};
 
 unsigned int compile_shaders(const char* vertexShaderSource, const char* fragmentShaderSource);
 unsigned int create_and_set_vao(float* vertex_data, int size_vertex_data);
@@ -18,6 +38,20 @@ void renderSphere();
 // utility function for loading a 2D texture from file
 unsigned int load_texture(const std::string& path, int& num_channels);
 
+// image decoding (thread safe, the vertical flip is set per thread) and texture uploading (GL thread only)
+bool load_image_data(const std::string& path, ImageData& image, bool flip_vertically);
+bool load_image_data_from_memory(const unsigned char* buffer, int length_buffer, ImageData& image, bool flip_vertically);
+bool load_hdr_image_data(const std::string& path, ImageData& image, bool flip_vertically);
+// (for a cached image it returns the shared texture of the TextureCache)
+// (texture_id reuses an existing texture, which gets the image with all its mipmaps)
+unsigned int upload_image_data_to_texture(ImageData& image, unsigned int texture_id = 0);
+void free_image_data(ImageData& image);
+// copies the pixels of a decoded LDR image to the staging ring so the upload doesn't copy them (any thread),
+// returns false when the ring has no room and the image keeps its pixels
+bool stage_image_data(ImageData& image);
+// box filtered mip chain of an 8 bits image down to 1x1, the first level is a copy of the image
+void generate_mip_chain(const unsigned char* data, int width, int height, int num_channels, std::vector<std::vector<unsigned char>>& levels);
+
 unsigned int load_hdr_texture(char const* path);
 unsigned int load_hdr_file_to_cubemap(const std::vector<std::string>& paths_to_mipmap_files, int base_width, int base_height);
 void save_texture_to_png_file(unsigned int texture_id, int num_channels, int width, int height, const std::string& path_to_file);
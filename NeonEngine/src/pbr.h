@@ -2,6 +2,7 @@
 
 #include "opengl_utils.h"
 #include "shader.h"
+#include "cubemap.h"
 
 #include <glad/glad.h>
 #include <stb_image.h>
@@ -10,6 +11,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 unsigned int create_framebuffer_pbr() {
     unsigned int captureFBO;
@@ -26,37 +28,30 @@ unsigned int create_framebuffer_pbr() {
     return captureFBO;
 }
 
-unsigned int create_environment_map_from_equirectangular_map(const std::string& equirectangular_map, unsigned int captureFBO,
-                                                             int environment_map_width, int environment_map_height,
-                                                             const glm::mat4& captureProjection, const std::vector<glm::mat4>& captureViews,
-                                                             Shader* equirectangularToCubemapShader) {
-    // load the HDR equirectangular texture
-    stbi_set_flip_vertically_on_load(true);
-    int width, height, nrComponents;
-    float* data = stbi_loadf(equirectangular_map.c_str(), &width, &height, &nrComponents, 0);
+unsigned int create_environment_map_from_equirectangular_image(ImageData& equirectangular_image, unsigned int captureFBO,
+                                                               int environment_map_width, int environment_map_height,
+                                                               const glm::mat4& captureProjection, const std::vector<glm::mat4>& captureViews,
+                                                               Shader* equirectangularToCubemapShader) {
+    // upload the decoded HDR equirectangular texture
     GLenum format;
-    if (nrComponents == 3) {
+    if (equirectangular_image.num_channels == 3) {
         format = GL_RGB;
     }
-    else { // nrComponents == 4
+    else { // num_channels == 4
         format = GL_RGBA;
     }
-    unsigned int equirectangularTexture;
-    if (data) {
+    unsigned int equirectangularTexture = 0;
+    if (equirectangular_image.data_hdr) {
         glGenTextures(1, &equirectangularTexture);
         glBindTexture(GL_TEXTURE_2D, equirectangularTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, format, GL_FLOAT, data); // note how we specify the texture's data value to be float
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, equirectangular_image.width, equirectangular_image.height, 0, format, GL_FLOAT, equirectangular_image.data_hdr); // note how we specify the texture's data value to be float
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else {
-        std::cout << "Failed to load HDR image." << std::endl;
     }
+    free_image_data(equirectangular_image);
 
     unsigned int envCubemap;
     // set up cubemap to render to and attach to framebuffer
@@ -96,10 +91,22 @@ unsigned int create_environment_map_from_equirectangular_map(const std::string&
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteTextures(1, &equirectangularTexture);
 
     return envCubemap;
 }
 
+unsigned int create_environment_map_from_equirectangular_map(const std::string& equirectangular_map, unsigned int captureFBO,
+                                                             int environment_map_width, int environment_map_height,
+                                                             const glm::mat4& captureProjection, const std::vector<glm::mat4>& captureViews,
+                                                             Shader* equirectangularToCubemapShader) {
+    // load the HDR equirectangular texture
+    ImageData equirectangular_image;
+    load_hdr_image_data(equirectangular_map, equirectangular_image, true);
+    return create_environment_map_from_equirectangular_image(equirectangular_image, captureFBO, environment_map_width, environment_map_height,
+                                                             captureProjection, captureViews, equirectangularToCubemapShader);
+}
+
 unsigned int create_irradiance_map_from_environment_map(unsigned int captureFBO, unsigned int envCubemap, int environment_map_width, int irradiance_map_width, int irradiance_map_height,
                                                         const glm::mat4& captureProjection, const std::vector<glm::mat4>& captureViews,
                                                         Shader* irradianceShader) {
@@ -144,57 +151,53 @@ unsigned int create_irradiance_map_from_environment_map(unsigned int captureFBO,
     return irradianceMap;
 }
 
-unsigned int create_prefilter_map_from_environment_map(unsigned int captureFBO, unsigned int envCubemap, int environment_map_width,
-                                                       int prefilter_map_width, int prefilter_map_height,
-                                                       const glm::mat4& captureProjection, const std::vector<glm::mat4>& captureViews,
-                                                       Shader* prefilterShader) {
-    // create a pre-filter cubemap, and re-scale capture FBO to pre-filter scale
-    unsigned int prefilterMap;
-    glGenTextures(1, &prefilterMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-    for (unsigned int i = 0; i < 6; ++i)
+// Work groups of the prefilter compute shader, 64 texels of the 6 faces of one mip level each
+const int PREFILTER_WORK_GROUP_SIZE = 64;
+const int DEFAULT_PREFILTER_SAMPLE_COUNT = 1024;
+
+// Prefilters all the mip levels and faces of a prefilter map (RGBA16F) from an environment map in one dispatch
+void prefilter_environment_map(unsigned int prefilterMap, unsigned int envCubemap, int environment_map_width, int prefilter_map_width,
+                               Shader* prefilterShader, int sample_count = DEFAULT_PREFILTER_SAMPLE_COUNT) {
+    int num_work_groups = 0;
+    for (unsigned int mip = 0; mip < PREFILTER_MAP_MIP_LEVELS; ++mip)
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, prefilter_map_width, prefilter_map_height, 0, GL_RGB, GL_FLOAT, nullptr);
+        int mip_width = std::max(prefilter_map_width >> mip, 1);
+        num_work_groups += (6 * mip_width * mip_width + PREFILTER_WORK_GROUP_SIZE - 1) / PREFILTER_WORK_GROUP_SIZE;
+        glBindImageTexture(mip, prefilterMap, mip, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // be sure to set minification filter to mip_linear 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // generate mipmaps for the cubemap so OpenGL automatically allocates the required memory.
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
-    // run a quasi monte-carlo simulation on the environment lighting to create a prefilter (cube)map
+    // run a quasi monte-carlo simulation on the environment lighting, sampling its mips to reduce the noise
     prefilterShader->use();
     prefilterShader->setFloat("ENVIRONMENT_MAP_SIZE", (float)environment_map_width);
+    prefilterShader->setInt("PREFILTER_MAP_SIZE", prefilter_map_width);
+    glUniform1ui(glGetUniformLocation(prefilterShader->ID, "SAMPLE_COUNT"), (unsigned int)sample_count);
     prefilterShader->setInt("environmentMap", 0);
-    prefilterShader->setMat4("projection", captureProjection);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    unsigned int maxMipLevels = 5;
-    for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
+    glDispatchCompute(num_work_groups, 1, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    for (unsigned int mip = 0; mip < PREFILTER_MAP_MIP_LEVELS; ++mip)
     {
-        // resize framebuffer according to mip-level size
-        unsigned int mipWidth = static_cast<unsigned int>(prefilter_map_width * std::pow(0.5, mip));
-        unsigned int mipHeight = static_cast<unsigned int>(prefilter_map_height * std::pow(0.5, mip));
-        //glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-        //glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-        glViewport(0, 0, mipWidth, mipHeight);
-
-        float roughness = (float)mip / (float)(maxMipLevels - 1);
-        prefilterShader->setFloat("roughness", roughness);
-        for (unsigned int i = 0; i < 6; ++i)
-        {
-            prefilterShader->setMat4("view", captureViews[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
-
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            renderCube();
-        }
+        glBindImageTexture(mip, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+unsigned int create_prefilter_map_from_environment_map(unsigned int envCubemap, int environment_map_width, int prefilter_map_width,
+                                                       Shader* prefilterShader, int sample_count = DEFAULT_PREFILTER_SAMPLE_COUNT) {
+    // create a pre-filter cubemap with the storage of its mip levels, written as images by the compute shader
+    unsigned int prefilterMap;
+    glGenTextures(1, &prefilterMap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, PREFILTER_MAP_MIP_LEVELS, GL_RGBA16F, prefilter_map_width, prefilter_map_width);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // be sure to set minification filter to mip_linear 
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    prefilter_environment_map(prefilterMap, envCubemap, environment_map_width, prefilter_map_width, prefilterShader, sample_count);
 
     return prefilterMap;
 }
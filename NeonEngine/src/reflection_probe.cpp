@@ -0,0 +1,164 @@
+#include "reflection_probe.h"
+#include "rendering.h"
+#include "cubemap.h"
+#include "resource_registry.h"
+#include "frame_profiler.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+ReflectionProbes::ReflectionProbes(Rendering* rendering) {
+    this->rendering = rendering;
+    last_bake_time_ms = 0.0;
+
+    glGenFramebuffers(1, &capture_fbo);
+    glGenRenderbuffers(1, &capture_rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, capture_rbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH);
+    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, capture_rbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ResourceRegistry::get_instance()->record_renderbuffer(capture_rbo, "reflection_probes");
+}
+
+void ReflectionProbes::add_probe(const std::string& name, const glm::vec3& position, float radius, bool dynamic) {
+    remove_probe(name);
+
+    ReflectionProbe probe;
+    probe.name = name;
+    probe.position = position;
+    probe.radius = radius;
+    probe.dynamic = dynamic;
+
+    // the capture has a full mip chain for the filtered sampling of the prefilter
+    int num_levels = (int)std::log2(REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH) + 1;
+    glGenTextures(1, &probe.environment_texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, probe.environment_texture);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, num_levels, GL_RGBA16F, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glGenTextures(1, &probe.prefilter_texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, probe.prefilter_texture);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, PREFILTER_MAP_MIP_LEVELS, GL_RGBA16F, REFLECTION_PROBE_PREFILTER_MAP_WIDTH, REFLECTION_PROBE_PREFILTER_MAP_WIDTH);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    resource_registry->record_texture(ResourceCubemap, probe.environment_texture, "probe " + name);
+    resource_registry->record_texture(ResourceCubemap, probe.prefilter_texture, "probe " + name);
+
+    probes[name] = probe;
+}
+
+void ReflectionProbes::remove_probe(const std::string& name) {
+    auto it = probes.find(name);
+    if (it == probes.end()) {
+        return;
+    }
+    unsigned int texture_ids[2] = { it->second.environment_texture, it->second.prefilter_texture };
+    ResourceRegistry::get_instance()->release(ResourceCubemap, texture_ids[0]);
+    ResourceRegistry::get_instance()->release(ResourceCubemap, texture_ids[1]);
+    glDeleteTextures(2, texture_ids);
+    probes.erase(it);
+}
+
+void ReflectionProbes::mark_dirty(const std::string& name) {
+    auto it = probes.find(name);
+    if (it != probes.end()) {
+        // a bake in progress starts again from the new position
+        it->second.dirty = true;
+        it->second.next_bake_step = 0;
+    }
+}
+
+// The probe of the bake in progress, otherwise the next probe to bake after it
+ReflectionProbe* ReflectionProbes::get_probe_to_bake() {
+    auto current = probes.find(current_probe_name);
+    if (current != probes.end() && current->second.next_bake_step > 0) {
+        return &(current->second);
+    }
+    auto it = probes.upper_bound(current_probe_name);
+    for (int i = 0; i < probes.size(); i++, it++) {
+        if (it == probes.end()) {
+            it = probes.begin();
+        }
+        if (it->second.dirty) {
+            current_probe_name = it->first;
+            return &(it->second);
+        }
+    }
+    return nullptr;
+}
+
+void ReflectionProbes::bake_step(ReflectionProbe& probe) {
+    if (probe.next_bake_step < 6) {
+        rendering->capture_reflection_probe_face(probe, probe.next_bake_step, capture_fbo);
+        probe.next_bake_step++;
+        return;
+    }
+    rendering->prefilter_reflection_probe(probe);
+    probe.baked = true;
+    probe.next_bake_step = 0;
+    // the dynamic probes go back to the rotation
+    probe.dirty = probe.dynamic;
+}
+
+void ReflectionProbes::update() {
+    FrameProfiler* profiler = FrameProfiler::get_instance();
+    profiler->begin_scope("probe_bake");
+    for (int i = 0; i < REFLECTION_PROBE_BAKE_STEPS_PER_FRAME; i++) {
+        ReflectionProbe* probe = get_probe_to_bake();
+        if (probe == nullptr) {
+            break;
+        }
+        bake_step(*probe);
+    }
+    profiler->end_scope();
+
+    // the GPU times are resolved a few frames later
+    auto it = profiler->gpu_history.find("probe_bake");
+    if (it != profiler->gpu_history.end() && !it->second.empty()) {
+        last_bake_time_ms = it->second.back();
+    }
+}
+
+FrameVector<ReflectionProbe*> ReflectionProbes::get_nearest_probes(const glm::vec3& position, int max_probes) {
+    FrameVector<std::pair<float, ReflectionProbe*>> distances;
+    for (auto it = probes.begin(); it != probes.end(); it++) {
+        // distance to the sphere of influence, zero inside it
+        float distance = std::max(glm::length(it->second.position - position) - it->second.radius, 0.0f);
+        if (it->second.baked) {
+            distances.push_back({ distance, &(it->second) });
+        }
+    }
+    std::sort(distances.begin(), distances.end(), [](const std::pair<float, ReflectionProbe*>& a, const std::pair<float, ReflectionProbe*>& b) {
+        return a.first < b.first;
+    });
+
+    FrameVector<ReflectionProbe*> nearest_probes;
+    for (int i = 0; i < distances.size() && i < max_probes; i++) {
+        nearest_probes.push_back(distances[i].second);
+    }
+    return nearest_probes;
+}
+
+void ReflectionProbes::clean() {
+    for (auto it = probes.begin(); it != probes.end(); it++) {
+        unsigned int texture_ids[2] = { it->second.environment_texture, it->second.prefilter_texture };
+        ResourceRegistry::get_instance()->release(ResourceCubemap, texture_ids[0]);
+        ResourceRegistry::get_instance()->release(ResourceCubemap, texture_ids[1]);
+        glDeleteTextures(2, texture_ids);
+    }
+    probes.clear();
+    ResourceRegistry::get_instance()->release(ResourceRenderbuffer, capture_rbo);
+    glDeleteFramebuffers(1, &capture_fbo);
+    glDeleteRenderbuffers(1, &capture_rbo);
+}
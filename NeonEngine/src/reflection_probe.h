@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <map>
+#include <vector>
+
+#include "frame_arena.h"
+
+class Rendering;
+
+// Size of the faces of the scene captures of the probes and of their prefilter maps
+const int REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH = 128;
+const int REFLECTION_PROBE_PREFILTER_MAP_WIDTH = 64;
+const int REFLECTION_PROBE_PREFILTER_SAMPLE_COUNT = 256;
+// Probes nearest to the camera that the PBR shader blends (MAX_REFLECTION_PROBES in PBR.frag)
+const int MAX_BLENDED_REFLECTION_PROBES = 4;
+// Texture unit of the prefilter map of the first blended probe, after the ones of the materials
+const int REFLECTION_PROBE_TEXTURE_UNIT = 12;
+// A bake is the capture of the 6 faces, one step each, and the prefilter of the capture in a last step
+const int REFLECTION_PROBE_BAKE_STEPS = 7;
+// Bake steps of one frame. A step renders the whole scene or prefilters a cubemap, so the steps are counted instead of
+// timing the GL calls, which return before the GPU does the work
+const int REFLECTION_PROBE_BAKE_STEPS_PER_FRAME = 1;
+
+struct ReflectionProbe {
+    std::string name;
+    glm::vec3 position;
+    // The probe replaces the environment inside this radius, fading out towards it
+    float radius;
+    // Dynamic probes are baked again continuously, static ones when they are added or moved
+    bool dynamic;
+    unsigned int environment_texture = 0;
+    unsigned int prefilter_texture = 0;
+    // The prefilter map is only replaced at the end of a bake, so the shading never sees a partial capture
+    bool baked = false;
+    bool dirty = true;
+    int next_bake_step = 0;
+};
+
+// Local reflection probes: placeable cubemap captures of the scene that are prefiltered like the environment maps
+// of the HDRIs and replace the skybox in the specular IBL of the objects near them (interiors don't reflect open space).
+// The bakes are time sliced: update() runs REFLECTION_PROBE_BAKE_STEPS_PER_FRAME steps (one face or the prefilter) per frame,
+// moving round robin through the probes, so many probes can be baked again without a frame spike.
+class ReflectionProbes {
+public:
+    ReflectionProbes(Rendering* rendering);
+
+    // GL thread only
+    void add_probe(const std::string& name, const glm::vec3& position, float radius, bool dynamic);
+    void remove_probe(const std::string& name);
+    // Bakes the probe again, after it's moved
+    void mark_dirty(const std::string& name);
+    void update();
+    // Baked probes whose spheres of influence are nearest to the position, the list lives in the frame arena
+    FrameVector<ReflectionProbe*> get_nearest_probes(const glm::vec3& position, int max_probes);
+    void clean();
+
+    std::map<std::string, ReflectionProbe> probes;
+    // GPU time of the bake steps of the last frame resolved by the frame profiler
+    double last_bake_time_ms;
+
+private:
+    void bake_step(ReflectionProbe& probe);
+    ReflectionProbe* get_probe_to_bake();
+
+    Rendering* rendering;
+    unsigned int capture_fbo;
+    unsigned int capture_rbo;
+    // Probe of the bake in progress, the next ones are found round robin from it
+    std::string current_probe_name;
+};
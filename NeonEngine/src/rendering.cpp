@@ -15,6 +15,18 @@
 #include "disk_border.h"
 #include "cubemap.h"
 #include "pbr.h"
+#include "task_graph.h"
+#include "cooked_assets.h"
+#include "texture_cache.h"
+#include "ibl_cache.h"
+#include "hdri_loader.h"
+#include "reflection_probe.h"
+#include "frame_profiler.h"
+#include "trace_recorder.h"
+#include "resource_registry.h"
+#include "allocation_tracker.h"
+#include "frame_arena.h"
+#include "worker_pool.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -25,6 +37,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <filesystem>
+#include <memory>
+#include <set>
 
 Rendering* Rendering::instance = nullptr;
 std::mutex Rendering::rendering_mutex;
@@ -49,13 +63,20 @@ Rendering::Rendering() {
     outline_color = glm::vec3(255.0f/255.0f, 195.0f/255.0f, 7.0f/255.0f);
     screen_quad = nullptr;
     cubemap = nullptr;
+    hdri_loader = nullptr;
+    reflection_probes = nullptr;
+    prefetch_hdris = false;
+    use_fixed_animation_time = false;
+    fixed_animation_time_seconds = 0.0f;
     exposure = 1.0f;
-    loaded_materials["Default"] = nullptr;
+    loaded_materials["Default"] = PoolHandle();
     cubemap_texture_type = EnvironmentMap;
     cubemap_texture_mipmap_level = 0.0f;
     bloom_filter_radius = 0.005f;
     bloom_strength = 0.04f;
     bloom_activated = true;
+    use_irradiance_sh = true;
+    prefilter_sample_count = DEFAULT_PREFILTER_SAMPLE_COUNT;
     emission_strength = 8.0f;
 
     // PBR parameters
@@ -232,6 +253,8 @@ void Rendering::setup_framebuffer_and_textures() {
 
     // Bind to the default Framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    record_viewport_framebuffer_memory();
 }
 
 void Rendering::resize_textures() {
@@ -270,6 +293,30 @@ void Rendering::resize_textures() {
         glBindTexture(GL_TEXTURE_2D, bloom_textures[i].texture_id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, texture_size.x, texture_size.y, 0, GL_RGBA, GL_FLOAT, nullptr);
     }
+
+    record_viewport_framebuffer_memory();
+}
+
+// The sizes of the attachments of the viewport framebuffer and of the bloom mips change with the size of the viewport
+void Rendering::record_viewport_framebuffer_memory() {
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    unsigned int attachments[6] = { textureHDRColorbuffer, texture_id_colors, texture_id_colors_transform3d, texture_selected_color_buffer, textureLDRColorbuffer, textureHDRBrightColorbuffer };
+    for (int i = 0; i < 6; i++) {
+        resource_registry->record_texture(ResourceRenderTarget, attachments[i], "viewport_framebuffer");
+    }
+    resource_registry->record_renderbuffer(rboDepthStencil, "viewport_framebuffer");
+    for (int i = 0; i < bloom_textures.size(); i++) {
+        resource_registry->record_texture(ResourceRenderTarget, bloom_textures[i].texture_id, "bloom");
+    }
+}
+
+// Environment, irradiance and prefilter maps of a cubemap, they are released by HdriLoader::unload()
+void Rendering::record_cubemap_memory(const std::string& cubemap_name) {
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    const CubemapData& cubemap_data = cubemap->umap_name_to_cubemap_data[cubemap_name];
+    resource_registry->record_texture(ResourceCubemap, cubemap_data.environment_texture, "hdri " + cubemap_name);
+    resource_registry->record_texture(ResourceCubemap, cubemap_data.irradiance_texture, "hdri " + cubemap_name);
+    resource_registry->record_texture(ResourceCubemap, cubemap_data.prefilter_texture, "hdri " + cubemap_name);
 }
 
 void Rendering::set_viewport_shaders() {
@@ -278,7 +325,7 @@ void Rendering::set_viewport_shaders() {
     pbr_shader = new Shader("shaders/vertices_3d_model.vert", "shaders/PBR.frag");
     equirectangularToCubemapShader = new Shader("shaders/cubemap.vert", "shaders/equirectangular_to_cubemap.frag");
     irradianceShader = new Shader("shaders/cubemap.vert", "shaders/irradiance_convolution.frag");
-    prefilterShader = new Shader("shaders/cubemap.vert", "shaders/prefilter.frag");
+    prefilterShader = new Shader("shaders/prefilter.comp");
     brdfShader = new Shader("shaders/brdf.vert", "shaders/brdf.frag");
     selection_shader = new Shader("shaders/vertices_3d_model.vert", "shaders/paint_selected.frag");
     outline_shader = new Shader("shaders/vertices_quad.vert", "shaders/edge_outlining.frag");
@@ -289,35 +336,172 @@ void Rendering::set_viewport_shaders() {
 }
 
 void Rendering::load_cubemap(const std::string& cubemap_name, const std::vector<std::string>& cubemap_paths, bool is_hdri) {
-    auto begin_timer = std::chrono::high_resolution_clock::now();
-    unsigned int cubemap_texture;
-    if (!is_hdri) {
-        cubemap->add_cubemap_texture(cubemap_name, cubemap_paths, is_hdri);
-        cubemap_texture = cubemap->umap_name_to_cubemap_data[cubemap_name].environment_texture;
-    }
-    else {
-        cubemap_texture = create_environment_map_from_equirectangular_map(cubemap_paths[0], captureFBO,
-            ENVIRONMENT_MAP_WIDTH, ENVIRONMENT_MAP_HEIGHT, captureProjection, captureViews,
-            equirectangularToCubemapShader);
-        cubemap->add_cubemap_texture(cubemap_name, cubemap_texture, is_hdri);
+    if (is_hdri) {
+        ImageData equirectangular_image;
+        load_hdr_image_data(cubemap_paths[0], equirectangular_image, true);
+        load_hdri_cubemap(cubemap_name, equirectangular_image);
+        return;
     }
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+    cubemap->add_cubemap_texture(cubemap_name, cubemap_paths, is_hdri);
+    unsigned int cubemap_texture = cubemap->umap_name_to_cubemap_data[cubemap_name].environment_texture;
     cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_texture = create_irradiance_map_from_environment_map(captureFBO, cubemap_texture, ENVIRONMENT_MAP_WIDTH, IRRADIANCE_MAP_WIDTH, IRRADIANCE_MAP_HEIGHT, captureProjection, captureViews, irradianceShader);
-    cubemap->umap_name_to_cubemap_data[cubemap_name].prefilter_texture = create_prefilter_map_from_environment_map(captureFBO, cubemap_texture, ENVIRONMENT_MAP_WIDTH, PREFILTER_MAP_WIDTH, PREFILTER_MAP_HEIGHT, captureProjection, captureViews, prefilterShader);
+    cubemap->umap_name_to_cubemap_data[cubemap_name].prefilter_texture = create_prefilter_map_from_environment_map(cubemap_texture, ENVIRONMENT_MAP_WIDTH, PREFILTER_MAP_WIDTH, prefilterShader, prefilter_sample_count);
+    compute_irradiance_sh(cubemap_texture, cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_sh);
+    record_cubemap_memory(cubemap_name);
     auto end_timer = std::chrono::high_resolution_clock::now();
     double elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - begin_timer).count();
     std::cout << "CREATING PBR DATA IN: " << elapsed_time_seconds << " seconds" << std::endl;
 }
 
-void Rendering::set_viewport_data() {
+// Creates the environment, irradiance and prefilter maps from an already decoded equirectangular HDR image
+void Rendering::load_hdri_cubemap(const std::string& cubemap_name, ImageData& equirectangular_image) {
+    TRACE_SCOPE("ibl_precompute");
+    ALLOCATION_TAG(AllocAssets);
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+    unsigned int cubemap_texture = create_environment_map_from_equirectangular_image(equirectangular_image, captureFBO,
+        ENVIRONMENT_MAP_WIDTH, ENVIRONMENT_MAP_HEIGHT, captureProjection, captureViews,
+        equirectangularToCubemapShader);
+    cubemap->add_cubemap_texture(cubemap_name, cubemap_texture, true);
+    cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_texture = create_irradiance_map_from_environment_map(captureFBO, cubemap_texture, ENVIRONMENT_MAP_WIDTH, IRRADIANCE_MAP_WIDTH, IRRADIANCE_MAP_HEIGHT, captureProjection, captureViews, irradianceShader);
+    cubemap->umap_name_to_cubemap_data[cubemap_name].prefilter_texture = create_prefilter_map_from_environment_map(cubemap_texture, ENVIRONMENT_MAP_WIDTH, PREFILTER_MAP_WIDTH, prefilterShader, prefilter_sample_count);
+    compute_irradiance_sh(cubemap_texture, cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_sh);
+    record_cubemap_memory(cubemap_name);
+    auto end_timer = std::chrono::high_resolution_clock::now();
+    double elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - begin_timer).count();
+    std::cout << "CREATING PBR DATA OF " << cubemap_name << " IN: " << elapsed_time_seconds << " seconds" << std::endl;
+}
+
+// Bakes again the prefilter map and the spherical harmonics of a loaded cubemap from its environment map,
+// after the user changes the IBL settings
+void Rendering::rebake_ibl(const std::string& cubemap_name) {
+    TRACE_SCOPE("ibl_rebake");
+    ALLOCATION_TAG(AllocAssets);
+    auto it = cubemap->umap_name_to_cubemap_data.find(cubemap_name);
+    if (it == cubemap->umap_name_to_cubemap_data.end() || it->second.environment_texture == 0) {
+        return;
+    }
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+    // a new texture, the prefilter maps uploaded from cooked files or the IBL cache can't be written as images
+    ResourceRegistry::get_instance()->release(ResourceCubemap, it->second.prefilter_texture);
+    glDeleteTextures(1, &(it->second.prefilter_texture));
+    it->second.prefilter_texture = create_prefilter_map_from_environment_map(it->second.environment_texture, ENVIRONMENT_MAP_WIDTH, PREFILTER_MAP_WIDTH, prefilterShader, prefilter_sample_count);
+    compute_irradiance_sh(it->second.environment_texture, it->second.irradiance_sh);
+    record_cubemap_memory(cubemap_name);
+    auto end_timer = std::chrono::high_resolution_clock::now();
+    double elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - begin_timer).count();
+    std::cout << "REBAKING PBR DATA OF " << cubemap_name << " IN: " << elapsed_time_seconds << " seconds" << std::endl;
+}
+
+// Uploads the environment, irradiance and prefilter maps baked by the asset cooker or read from the IBL cache
+void Rendering::load_cooked_hdri_cubemap(const std::string& cubemap_name, CookedCubemapData& cubemap_data) {
+    TRACE_SCOPE("ibl_upload_cooked");
+    ALLOCATION_TAG(AllocAssets);
+    unsigned int cubemap_texture = upload_ktx2_texture(cubemap_data.environment_map, true);
+    cubemap->add_cubemap_texture(cubemap_name, cubemap_texture, true);
+    cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_texture = upload_ktx2_texture(cubemap_data.irradiance_map, false);
+    cubemap->umap_name_to_cubemap_data[cubemap_name].prefilter_texture = upload_ktx2_texture(cubemap_data.prefilter_map, false);
+    compute_irradiance_sh(cubemap_texture, cubemap->umap_name_to_cubemap_data[cubemap_name].irradiance_sh);
+    record_cubemap_memory(cubemap_name);
+}
+
+// Framebuffer used to render the IBL maps, BRDF LUT texture and the cubemaps container
+void Rendering::create_ibl_capture_data() {
     // Create PBR framebuffer
     captureFBO = create_framebuffer_pbr();
 
-    // BRDF LUT texture
-    brdfLUTTexture = create_brdf_lut_texture(captureFBO, BRDF_LUT_MAP_WIDTH, BRDF_LUT_MAP_HEIGHT, brdfShader);
+    // BRDF LUT texture, from the IBL cache when it was already computed
+    uint64_t brdf_lut_cache_key = compute_brdf_lut_cache_key(BRDF_LUT_MAP_WIDTH, BRDF_LUT_MAP_HEIGHT);
+    Ktx2Texture brdf_lut;
+    if (read_brdf_lut_cache(brdf_lut_cache_key, BRDF_LUT_MAP_WIDTH, BRDF_LUT_MAP_HEIGHT, brdf_lut)) {
+        brdfLUTTexture = upload_ktx2_texture(brdf_lut, false);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    else {
+        brdfLUTTexture = create_brdf_lut_texture(captureFBO, BRDF_LUT_MAP_WIDTH, BRDF_LUT_MAP_HEIGHT, brdfShader);
+        read_brdf_lut_texture(brdfLUTTexture, BRDF_LUT_MAP_WIDTH, BRDF_LUT_MAP_HEIGHT, brdf_lut);
+        if (!write_brdf_lut_cache(brdf_lut_cache_key, brdf_lut)) {
+            std::cout << "ERROR::IBL_CACHE:: Failed to write the BRDF LUT" << std::endl;
+        }
+    }
+
+    ResourceRegistry::get_instance()->record_texture(ResourceRenderTarget, brdfLUTTexture, "brdf_lut");
 
     // Cubemap
     cubemap = new Cubemap();
 
+    reflection_probes = new ReflectionProbes(this);
+}
+
+// Startup as a dependency graph: shader compilation, image decoding, IBL precomputation and model importing.
+// Decoding and importing run in the worker threads, everything that touches GL runs in the main thread.
+void Rendering::add_startup_tasks(TaskGraph& task_graph) {
+    int shaders_task = task_graph.add_task("Compile shaders", MainThreadTask, [this]() {
+        set_viewport_shaders();
+    });
+
+    std::vector<int> viewport_data_tasks = add_viewport_data_tasks(task_graph, shaders_task);
+
+    task_graph.add_task("Initialize game objects", MainThreadTask, [this]() {
+        initialize_game_objects();
+
+        std::cout << std::endl;
+        print_names_loaded_models();
+
+        std::cout << std::endl;
+        print_names_loaded_materials();
+
+        std::cout << std::endl;
+        print_names_loaded_textures();
+
+        std::cout << std::endl;
+        TextureCache::get_instance()->print_report();
+    }, viewport_data_tasks);
+}
+
+// Adds the tasks of a material made of the textures MATERIAL_TEXTURE_FILES of a directory.
+// Returns the ids of the upload tasks, after which the material is ready to be used.
+std::vector<int> Rendering::add_material_tasks(TaskGraph& task_graph, const std::string& material_name, const std::string& texture_name, const std::string& directory) {
+    const std::vector<std::pair<TextureType, std::string>>& texture_files = MATERIAL_TEXTURE_FILES;
+
+    Material* material = Material::pool.create(material_name);
+    material->format = FileFormat::Default;
+
+    std::vector<int> upload_tasks;
+    for (int i = 0; i < texture_files.size(); i++) {
+        Texture* texture = Texture::pool.create(texture_name);
+        texture->path = directory + "/" + texture_files[i].second;
+        texture->id = 0;
+        texture->num_channels = 0;
+        texture->types.insert(texture_files[i].first);
+        loaded_textures[texture->get_name()] = Texture::pool.get_handle(texture);
+        material->textures[texture_files[i].first] = texture;
+
+        // The decoded image is shared by the decode task and the upload task
+        std::shared_ptr<ImageData> image = std::make_shared<ImageData>();
+        int decode_task = task_graph.add_task("Decode " + texture->path, WorkerTask, [texture, image]() {
+            TextureCache::get_instance()->load_image(texture->path, *image, true);
+        });
+        upload_tasks.push_back(task_graph.add_task("Upload " + texture->path, MainThreadTask, [texture, image]() {
+            texture->num_channels = image->num_channels;
+            texture->id = upload_image_data_to_texture(*image);
+        }, { decode_task }));
+    }
+
+    loaded_materials[material->name] = Material::pool.get_handle(material);
+
+    return upload_tasks;
+}
+
+std::vector<int> Rendering::add_viewport_data_tasks(TaskGraph& task_graph, int shaders_task) {
+    std::vector<int> viewport_data_tasks;
+
+    int capture_task = task_graph.add_task("BRDF LUT", MainThreadTask, [this]() {
+        create_ibl_capture_data();
+    }, { shaders_task });
+    viewport_data_tasks.push_back(capture_task);
+
     /*
     std::vector<std::string> cubemap_ocean_with_sky = {
         "skyboxes/ocean_with_sky/right.jpg",
@@ -346,11 +530,41 @@ void Rendering::set_viewport_data() {
         "skyboxes/red_space/back.png" };
     load_cubemap("red_space", red_space, false);*/
 
+    // HDRIs: registered as metadata only, the HDRI loader creates their IBL maps the first time the skybox uses them.
+    // The maps of the default skybox are created while loading: read in a worker, then created in the main thread.
+    std::vector<std::pair<std::string, std::string>> hdris;
     for (const auto& entry : std::filesystem::directory_iterator("HDRIs")) {
         if (entry.is_regular_file()) {
-            load_cubemap(entry.path().stem().string(), { entry.path().string() }, true);
+            hdris.push_back({ entry.path().stem().string(), entry.path().string() });
         }
     }
+    int register_task = task_graph.add_task("Register HDRIs", MainThreadTask, [this, hdris]() {
+        hdri_loader = new HdriLoader(this);
+        for (int i = 0; i < hdris.size(); i++) {
+            hdri_loader->register_hdri(hdris[i].first, hdris[i].second);
+        }
+    }, { capture_task });
+    viewport_data_tasks.push_back(register_task);
+    for (int i = 0; i < hdris.size(); i++) {
+        if (hdris[i].first != DEFAULT_SKYBOX_CUBEMAP_NAME) {
+            continue;
+        }
+        std::shared_ptr<HdriLoadJob> job = std::make_shared<HdriLoadJob>();
+        job->name = hdris[i].first;
+        job->path = hdris[i].second;
+        job->map_sizes = { ENVIRONMENT_MAP_WIDTH, IRRADIANCE_MAP_WIDTH, PREFILTER_MAP_WIDTH };
+        job->prefilter_sample_count = prefilter_sample_count;
+        int read_task = task_graph.add_task("Read HDRI " + job->name, WorkerTask, [job]() {
+            HdriLoader::read(*job);
+        });
+        int finish_task = task_graph.add_task("IBL precompute " + job->name, MainThreadTask, [this, job]() {
+            hdri_loader->finish(*job);
+        }, { read_task, register_task });
+        viewport_data_tasks.push_back(finish_task);
+        task_graph.add_task("Write IBL cache " + job->name, WorkerTask, [job]() {
+            HdriLoader::write(*job);
+        }, { finish_task });
+    }
     /*
     for (const auto& entry : std::filesystem::directory_iterator("HDRIs/hdri_pack")) {
         if (entry.is_regular_file()) {
@@ -361,163 +575,71 @@ void Rendering::set_viewport_data() {
     // Materials:
 
     // Rusted Iron
-    Material* mat_rusted_iron = new Material("mat_rusted_iron");
-    mat_rusted_iron->format = FileFormat::Default;
-    
-    Texture* tex_albedo_rusted_iron = new Texture("tex_rusted_iron");
-    tex_albedo_rusted_iron->path = "materials/rusted_iron/albedo.png";
-    tex_albedo_rusted_iron->id = load_texture(tex_albedo_rusted_iron->path, tex_albedo_rusted_iron->num_channels);
-    tex_albedo_rusted_iron->types.insert(TexAlbedo);
-    loaded_textures[tex_albedo_rusted_iron->get_name()] = tex_albedo_rusted_iron;
-
-    Texture* tex_normal_rusted_iron = new Texture("tex_rusted_iron");
-    tex_normal_rusted_iron->path = "materials/rusted_iron/normal.png";
-    tex_normal_rusted_iron->id = load_texture(tex_normal_rusted_iron->path, tex_normal_rusted_iron->num_channels);
-    tex_normal_rusted_iron->types.insert(TexNormal);
-    loaded_textures[tex_normal_rusted_iron->get_name()] = tex_normal_rusted_iron;
-
-    Texture* tex_metalness_rusted_iron = new Texture("tex_rusted_iron");
-    tex_metalness_rusted_iron->path = "materials/rusted_iron/metallic.png";
-    tex_metalness_rusted_iron->id = load_texture(tex_metalness_rusted_iron->path, tex_metalness_rusted_iron->num_channels);
-    tex_metalness_rusted_iron->types.insert(TexMetalness);
-    loaded_textures[tex_metalness_rusted_iron->get_name()] = tex_metalness_rusted_iron;
-
-    Texture* tex_roughness_rusted_iron = new Texture("tex_rusted_iron");
-    tex_roughness_rusted_iron->path = "materials/rusted_iron/roughness.png";
-    tex_roughness_rusted_iron->id = load_texture(tex_roughness_rusted_iron->path, tex_roughness_rusted_iron->num_channels);
-    tex_roughness_rusted_iron->types.insert(TexRoughness);
-    loaded_textures[tex_roughness_rusted_iron->get_name()] = tex_roughness_rusted_iron;
-
-    Texture* tex_ambient_occlussion_rusted_iron = new Texture("tex_rusted_iron");
-    tex_ambient_occlussion_rusted_iron->path = "materials/rusted_iron/ao.png";
-    tex_ambient_occlussion_rusted_iron->id = load_texture(tex_ambient_occlussion_rusted_iron->path, tex_ambient_occlussion_rusted_iron->num_channels);
-    tex_ambient_occlussion_rusted_iron->types.insert(TexAmbientOcclusion);
-    loaded_textures[tex_ambient_occlussion_rusted_iron->get_name()] = tex_ambient_occlussion_rusted_iron;
-    
-    mat_rusted_iron->textures[TexAlbedo] = tex_albedo_rusted_iron;
-    mat_rusted_iron->textures[TexNormal] = tex_normal_rusted_iron;
-    mat_rusted_iron->textures[TexMetalness] = tex_metalness_rusted_iron;
-    mat_rusted_iron->textures[TexRoughness] = tex_roughness_rusted_iron;
-    mat_rusted_iron->textures[TexAmbientOcclusion] = tex_ambient_occlussion_rusted_iron;
-
-    loaded_materials[mat_rusted_iron->name] = mat_rusted_iron;
+    std::vector<int> rusted_iron_tasks = add_material_tasks(task_graph, "mat_rusted_iron", "tex_rusted_iron", "materials/rusted_iron");
+    viewport_data_tasks.insert(viewport_data_tasks.end(), rusted_iron_tasks.begin(), rusted_iron_tasks.end());
 
     // Gold
-    Material* mat_gold = new Material("mat_gold");
-    mat_gold->format = FileFormat::Default;
-
-    Texture* tex_albedo_gold = new Texture("tex_gold");
-    tex_albedo_gold->path = "materials/gold/albedo.png";
-    tex_albedo_gold->id = load_texture(tex_albedo_gold->path, tex_albedo_gold->num_channels);
-    tex_albedo_gold->types.insert(TexAlbedo);
-    loaded_textures[tex_albedo_gold->get_name()] = tex_albedo_gold;
-
-    Texture* tex_normal_gold = new Texture("tex_gold");
-    tex_normal_gold->path = "materials/gold/normal.png";
-    tex_normal_gold->id = load_texture(tex_normal_gold->path, tex_normal_gold->num_channels);
-    tex_normal_gold->types.insert(TexNormal);
-    loaded_textures[tex_normal_gold->get_name()] = tex_normal_gold;
-
-    Texture* tex_metalness_gold = new Texture("tex_gold");
-    tex_metalness_gold->path = "materials/gold/metallic.png";
-    tex_metalness_gold->id = load_texture(tex_metalness_gold->path, tex_metalness_gold->num_channels);
-    tex_metalness_gold->types.insert(TexMetalness);
-    loaded_textures[tex_metalness_gold->get_name()] = tex_metalness_gold;
-
-    Texture* tex_roughness_gold = new Texture("tex_gold");
-    tex_roughness_gold->path = "materials/gold/roughness.png";
-    tex_roughness_gold->id = load_texture(tex_roughness_gold->path, tex_roughness_gold->num_channels);
-    tex_roughness_gold->types.insert(TexRoughness);
-    loaded_textures[tex_roughness_gold->get_name()] = tex_roughness_gold;
-
-    Texture* tex_ambient_occlussion_gold = new Texture("tex_gold");
-    tex_ambient_occlussion_gold->path = "materials/gold/ao.png";
-    tex_ambient_occlussion_gold->id = load_texture(tex_ambient_occlussion_gold->path, tex_ambient_occlussion_gold->num_channels);
-    tex_ambient_occlussion_gold->types.insert(TexAmbientOcclusion);
-    loaded_textures[tex_ambient_occlussion_gold->get_name()] = tex_ambient_occlussion_gold;
-
-    mat_gold->textures[TexAlbedo] = tex_albedo_gold;
-    mat_gold->textures[TexNormal] = tex_normal_gold;
-    mat_gold->textures[TexMetalness] = tex_metalness_gold;
-    mat_gold->textures[TexRoughness] = tex_roughness_gold;
-    mat_gold->textures[TexAmbientOcclusion] = tex_ambient_occlussion_gold;
-
-    loaded_materials[mat_gold->name] = mat_gold;
-
-
-
-    // Screen Quad
-    screen_quad = new Quad();
-    
-    /*
-    // Lava Planet
-    Model* lava_planet = new Model("lava_planet", "models/lava_planet/lava_planet.gltf", false, false);
-    add_model_to_loaded_data(lava_planet);
-
-    // Sun
-    Model* sun = new Model("sun", "models/sun/sun.gltf", false, false);
-    add_model_to_loaded_data(sun);
-
-    // Space Station 1
-    Model* space_station1 = new Model("space_station1", "models/space_station1/space_station1.gltf", false, false);
-    add_model_to_loaded_data(space_station1);
+    std::vector<int> gold_tasks = add_material_tasks(task_graph, "mat_gold", "tex_gold", "materials/gold");
+    viewport_data_tasks.insert(viewport_data_tasks.end(), gold_tasks.begin(), gold_tasks.end());
 
-    // Space Station 2
-    Model* space_station2 = new Model("space_station2", "models/space_station2/space_station2.gltf", false, false);
-    add_model_to_loaded_data(space_station2);
-
-    // Vampire
-    Model* vampire = new Model("vampire", "models/vampire/vampire.gltf", false, false);
-    add_model_to_loaded_data(vampire);*/
-
-    // Knight
-    Model* knight = new Model("knight", "models/knight/knight.gltf", false, false);
-    add_model_to_loaded_data(knight);
-
-    // Mutant
-    Model* mutant = new Model("mutant", "models/mutant/mutant.gltf", false, false);
-    add_model_to_loaded_data(mutant);
-
-    // Android
-    Model* android = new Model("android", "models/android/android.gltf", false, false);
-    add_model_to_loaded_data(android);
 
 
+    // Models: the import (assimp and image decoding) runs in a worker, the upload in the main thread
+    std::vector<std::pair<std::string, std::string>> models = {
+        //{ "lava_planet", "models/lava_planet/lava_planet.gltf" },
+        //{ "sun", "models/sun/sun.gltf" },
+        //{ "space_station1", "models/space_station1/space_station1.gltf" },
+        //{ "space_station2", "models/space_station2/space_station2.gltf" },
+        //{ "vampire", "models/vampire/vampire.gltf" },
+        { "knight", "models/knight/knight.gltf" },
+        { "mutant", "models/mutant/mutant.gltf" },
+        { "android", "models/android/android.gltf" }
+    };
+    for (int i = 0; i < models.size(); i++) {
+        std::string model_name = models[i].first;
+        std::string model_path = models[i].second;
+        std::shared_ptr<Model*> model = std::make_shared<Model*>(nullptr);
+        int import_task = task_graph.add_task("Import model " + model_name, WorkerTask, [model, model_name, model_path]() {
+            *model = new Model(model_name, model_path, false, false, true);
+        });
+        viewport_data_tasks.push_back(task_graph.add_task("Upload model " + model_name, MainThreadTask, [this, model]() {
+            (*model)->upload_to_gpu();
+            add_model_to_loaded_data(*model);
+        }, { import_task }));
+    }
 
-    // Primitive shapes:
 
-    // Cylinder
-    BaseModel* cylinder = new Cylinder("cylinder", 1.0f, 1.0f, 1.0f, 36, 1, true, 3);
-    loaded_models[cylinder->name] = cylinder;
 
-    // Cone
-    BaseModel* cone = new Cylinder("cone", 1.0f, 0.0f, 1.0f, 36, 1, true, 3);
-    loaded_models[cone->name] = cone;
+    viewport_data_tasks.push_back(task_graph.add_task("Primitive shapes", MainThreadTask, [this]() {
+        // Screen Quad
+        screen_quad = new Quad();
 
-    // Cube
-    BaseModel* cube = new Cube("cube");
-    loaded_models[cube->name] = cube;
+        // Cylinder
+        BaseModel* cylinder = new Cylinder("cylinder", 1.0f, 1.0f, 1.0f, 36, 1, true, 3);
+        loaded_models[cylinder->name] = cylinder;
 
-    // Sphere
-    BaseModel* sphere = new Sphere("sphere", 1.0f, 360, 180);
-    loaded_models[sphere->name] = sphere;
+        // Cone
+        BaseModel* cone = new Cylinder("cone", 1.0f, 0.0f, 1.0f, 36, 1, true, 3);
+        loaded_models[cone->name] = cone;
 
-    // Disk border
-    BaseModel* disk_border = new DiskBorder("disk_border", 2.0f * M_PI);
-    loaded_models[disk_border->name] = disk_border;
+        // Cube
+        BaseModel* cube = new Cube("cube");
+        loaded_models[cube->name] = cube;
 
-    // Quarter of a disk border
-    BaseModel* quarter_disk_border = new DiskBorder("quarter_disk_border", M_PI / 2.0f, 1.0f, 1.3f);
-    loaded_models[quarter_disk_border->name] = quarter_disk_border;
+        // Sphere
+        BaseModel* sphere = new Sphere("sphere", 1.0f, 360, 180);
+        loaded_models[sphere->name] = sphere;
 
-    std::cout << std::endl;
-    print_names_loaded_models();
+        // Disk border
+        BaseModel* disk_border = new DiskBorder("disk_border", 2.0f * M_PI);
+        loaded_models[disk_border->name] = disk_border;
 
-    std::cout << std::endl;
-    print_names_loaded_materials();
+        // Quarter of a disk border
+        BaseModel* quarter_disk_border = new DiskBorder("quarter_disk_border", M_PI / 2.0f, 1.0f, 1.3f);
+        loaded_models[quarter_disk_border->name] = quarter_disk_border;
+    }));
 
-    std::cout << std::endl;
-    print_names_loaded_textures();
+    return viewport_data_tasks;
 }
 
 void Rendering::print_names_loaded_models() {
@@ -545,218 +667,219 @@ void Rendering::add_model_to_loaded_data(Model* model) {
     loaded_models[model->name] = model;
     for (auto it = model->loaded_materials.begin(); it != model->loaded_materials.end(); it++) {
         Material* material = it->second;
-        loaded_materials[material->name] = material;
+        loaded_materials[material->name] = Material::pool.get_handle(material);
     }
     for (auto it = model->loaded_textures.begin(); it != model->loaded_textures.end(); it++) {
         Texture* texture = it->second;
-        loaded_textures[texture->get_name()] = texture;
+        loaded_textures[texture->get_name()] = Texture::pool.get_handle(texture);
+    }
+}
+
+Material* Rendering::get_material(const std::string& name) {
+    auto it = loaded_materials.find(name);
+    if (it == loaded_materials.end()) {
+        return nullptr;
     }
+    return Material::pool.get(it->second);
 }
 
 void Rendering::initialize_game_objects() {
     /*
-    GameObject* lava_planet1 = new GameObject("lava_planet1", "lava_planet");
-    lava_planet1->position = glm::vec3(-30.0f, 30.0f, -15.0f);
-    lava_planet1->scale = glm::vec3(10.0f);
+    GameObject* lava_planet1 = GameObject::pool.create("lava_planet1", "lava_planet");
+    lava_planet1->position() = glm::vec3(-30.0f, 30.0f, -15.0f);
+    lava_planet1->scale() = glm::vec3(10.0f);
     lava_planet1->set_model_matrices_standard();
     game_objects[lava_planet1->name] = lava_planet1;
-    id_color_to_game_object[lava_planet1->id_color] = lava_planet1;
+    id_color_to_game_object[lava_planet1->id_color()] = lava_planet1;
 
-    GameObject* sun1 = new GameObject("sun1", "sun");
-    sun1->position = glm::vec3(20.0f, 40.0f, -30.0f);
-    sun1->metalness = 0.1;
-    sun1->roughness = 0.8;
+    GameObject* sun1 = GameObject::pool.create("sun1", "sun");
+    sun1->position() = glm::vec3(20.0f, 40.0f, -30.0f);
+    sun1->metalness() = 0.1;
+    sun1->roughness() = 0.8;
     sun1->set_model_matrices_standard();
     game_objects[sun1->name] = sun1;
-    id_color_to_game_object[sun1->id_color] = sun1;
+    id_color_to_game_object[sun1->id_color()] = sun1;
 
-    GameObject* space_station1_1 = new GameObject("space_station1_1", "space_station1");
-    space_station1_1->position = glm::vec3(-7.0f, 20.0f, -2.0f);
+    GameObject* space_station1_1 = GameObject::pool.create("space_station1_1", "space_station1");
+    space_station1_1->position() = glm::vec3(-7.0f, 20.0f, -2.0f);
     space_station1_1->set_model_matrices_standard();
     game_objects[space_station1_1->name] = space_station1_1;
-    id_color_to_game_object[space_station1_1->id_color] = space_station1_1;
+    id_color_to_game_object[space_station1_1->id_color()] = space_station1_1;
 
-    GameObject* space_station2_1 = new GameObject("space_station2_1", "space_station2");
-    space_station2_1->position = glm::vec3(30.0f, 15.0f, -15.0f);
-    space_station2_1->rotation = glm::angleAxis(glm::radians(60.0f), glm::normalize(glm::vec3(1.0f, 0.3f, 0.8f)));
-    space_station2_1->scale = glm::vec3(10.0f);
+    GameObject* space_station2_1 = GameObject::pool.create("space_station2_1", "space_station2");
+    space_station2_1->position() = glm::vec3(30.0f, 15.0f, -15.0f);
+    space_station2_1->rotation() = glm::angleAxis(glm::radians(60.0f), glm::normalize(glm::vec3(1.0f, 0.3f, 0.8f)));
+    space_station2_1->scale() = glm::vec3(10.0f);
     space_station2_1->set_model_matrices_standard();
     game_objects[space_station2_1->name] = space_station2_1;
-    id_color_to_game_object[space_station2_1->id_color] = space_station2_1;
+    id_color_to_game_object[space_station2_1->id_color()] = space_station2_1;
 
 
 
-    GameObject* vampire1 = new GameObject("vampire1", "vampire");
-    vampire1->position = glm::vec3(-7.0f, 0.0f, -2.0f);
-    vampire1->scale = glm::vec3(0.03f);
-    vampire1->animation_id = 0;
-    vampire1->metalness = 0.1;
-    vampire1->roughness = 0.5;
+    GameObject* vampire1 = GameObject::pool.create("vampire1", "vampire");
+    vampire1->position() = glm::vec3(-7.0f, 0.0f, -2.0f);
+    vampire1->scale() = glm::vec3(0.03f);
+    vampire1->animation_id() = 0;
+    vampire1->metalness() = 0.1;
+    vampire1->roughness() = 0.5;
     vampire1->set_model_matrices_standard();
     game_objects[vampire1->name] = vampire1;
-    id_color_to_game_object[vampire1->id_color] = vampire1;*/
+    id_color_to_game_object[vampire1->id_color()] = vampire1;*/
 
-    GameObject* knight1 = new GameObject("knight1", "knight");
-    knight1->position = glm::vec3(-2.0f, 0.0f, -2.0f);
-    knight1->scale = glm::vec3(0.03f);
-    knight1->animation_id = 10;
+    GameObject* knight1 = GameObject::pool.create("knight1", "knight");
+    knight1->position() = glm::vec3(-2.0f, 0.0f, -2.0f);
+    knight1->scale() = glm::vec3(0.03f);
+    knight1->animation_id() = 10;
     knight1->set_model_matrices_standard();
     game_objects[knight1->name] = knight1;
-    id_color_to_game_object[knight1->id_color] = knight1;
-
-    GameObject* mutant1 = new GameObject("mutant1", "mutant");
-    mutant1->position = glm::vec3(6.0f, 0.0f, -2.0f);
-    mutant1->scale = glm::vec3(0.03f);
-    mutant1->animation_id = 0;
-    mutant1->metalness = 0.1;
-    mutant1->roughness = 0.5;
+    id_color_to_game_object[knight1->id_color()] = knight1;
+
+    GameObject* mutant1 = GameObject::pool.create("mutant1", "mutant");
+    mutant1->position() = glm::vec3(6.0f, 0.0f, -2.0f);
+    mutant1->scale() = glm::vec3(0.03f);
+    mutant1->animation_id() = 0;
+    mutant1->metalness() = 0.1;
+    mutant1->roughness() = 0.5;
     mutant1->set_model_matrices_standard();
     game_objects[mutant1->name] = mutant1;
-    id_color_to_game_object[mutant1->id_color] = mutant1;
+    id_color_to_game_object[mutant1->id_color()] = mutant1;
 
-    GameObject* android1 = new GameObject("android1", "android");
-    android1->position = glm::vec3(2.0f, 0.0f, -2.0f);
-    android1->scale = glm::vec3(0.03f);
-    android1->animation_id = 0;
+    GameObject* android1 = GameObject::pool.create("android1", "android");
+    android1->position() = glm::vec3(2.0f, 0.0f, -2.0f);
+    android1->scale() = glm::vec3(0.03f);
+    android1->animation_id() = 0;
     android1->set_model_matrices_standard();
     game_objects[android1->name] = android1;
-    id_color_to_game_object[android1->id_color] = android1;
+    id_color_to_game_object[android1->id_color()] = android1;
 
-    GameObject* android2 = new GameObject("android2", "android");
-    android2->position = glm::vec3(0.0f, 0.0f, -2.0f);
-    android2->scale = glm::vec3(0.03f);
-    android2->animation_id = 0;
-    android2->material = loaded_materials["mat_gold"];
+    GameObject* android2 = GameObject::pool.create("android2", "android");
+    android2->position() = glm::vec3(0.0f, 0.0f, -2.0f);
+    android2->scale() = glm::vec3(0.03f);
+    android2->animation_id() = 0;
+    android2->material() = get_material("mat_gold");
     android2->set_model_matrices_standard();
     game_objects[android2->name] = android2;
-    id_color_to_game_object[android2->id_color] = android2;
+    id_color_to_game_object[android2->id_color()] = android2;
 
 
 
-    GameObject* cylinder1 = new GameObject("cylinder1", "cylinder");
-    cylinder1->position = glm::vec3(3.0f, 7.0f, -6.0f);
-    cylinder1->rotation = glm::angleAxis(glm::radians(45.0f), glm::normalize(glm::vec3(0.8f, 0.6f, 1.0f)));
-    cylinder1->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-    cylinder1->render_one_color = true;
+    GameObject* cylinder1 = GameObject::pool.create("cylinder1", "cylinder");
+    cylinder1->position() = glm::vec3(3.0f, 7.0f, -6.0f);
+    cylinder1->rotation() = glm::angleAxis(glm::radians(45.0f), glm::normalize(glm::vec3(0.8f, 0.6f, 1.0f)));
+    cylinder1->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+    cylinder1->render_one_color() = true;
     cylinder1->set_model_matrices_standard();
     game_objects[cylinder1->name] = cylinder1;
-    id_color_to_game_object[cylinder1->id_color] = cylinder1;
+    id_color_to_game_object[cylinder1->id_color()] = cylinder1;
 
-    GameObject* cone1 = new GameObject("cone1", "cone");
-    cone1->position = glm::vec3(-3.0f, 7.0f, -6.0f);
-    cone1->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-    cone1->render_one_color = true;
+    GameObject* cone1 = GameObject::pool.create("cone1", "cone");
+    cone1->position() = glm::vec3(-3.0f, 7.0f, -6.0f);
+    cone1->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+    cone1->render_one_color() = true;
     cone1->set_model_matrices_standard();
     game_objects[cone1->name] = cone1;
-    id_color_to_game_object[cone1->id_color] = cone1;
+    id_color_to_game_object[cone1->id_color()] = cone1;
 
-    GameObject* cylinder2 = new GameObject("cylinder2", "cylinder");
-    cylinder2->position = glm::vec3(-3.0f, -7.0f, -6.0f);
-    cylinder2->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-    cylinder2->render_one_color = true;
-    cylinder2->material = loaded_materials["mat_gold"];
+    GameObject* cylinder2 = GameObject::pool.create("cylinder2", "cylinder");
+    cylinder2->position() = glm::vec3(-3.0f, -7.0f, -6.0f);
+    cylinder2->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+    cylinder2->render_one_color() = true;
+    cylinder2->material() = get_material("mat_gold");
     cylinder2->set_model_matrices_standard();
     game_objects[cylinder2->name] = cylinder2;
-    id_color_to_game_object[cylinder2->id_color] = cylinder2;
+    id_color_to_game_object[cylinder2->id_color()] = cylinder2;
     
-    GameObject* cube1 = new GameObject("cube1", "cube");
-    cube1->position = glm::vec3(2.5f, -1.5f, -4.0f);
-    cube1->material = loaded_materials["mat_rusted_iron"];
+    GameObject* cube1 = GameObject::pool.create("cube1", "cube");
+    cube1->position() = glm::vec3(2.5f, -1.5f, -4.0f);
+    cube1->material() = get_material("mat_rusted_iron");
     cube1->set_model_matrices_standard();
     game_objects[cube1->name] = cube1;
-    id_color_to_game_object[cube1->id_color] = cube1;
+    id_color_to_game_object[cube1->id_color()] = cube1;
 
-    GameObject* disk_border1 = new GameObject("disk_border1", "disk_border");
-    disk_border1->position = glm::vec3(3.5f, 1.5f, -4.5f);
-    disk_border1->scale = glm::vec3(0.5f);
-    disk_border1->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-    disk_border1->render_one_color = true;
+    GameObject* disk_border1 = GameObject::pool.create("disk_border1", "disk_border");
+    disk_border1->position() = glm::vec3(3.5f, 1.5f, -4.5f);
+    disk_border1->scale() = glm::vec3(0.5f);
+    disk_border1->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+    disk_border1->render_one_color() = true;
     disk_border1->set_model_matrices_standard();
     game_objects[disk_border1->name] = disk_border1;
-    id_color_to_game_object[disk_border1->id_color] = disk_border1;
+    id_color_to_game_object[disk_border1->id_color()] = disk_border1;
     
 
-    Skybox* skybox = new Skybox("skybox");
+    GameObject* skybox = GameObject::pool.create("skybox", "");
     skybox->type = TypeSkybox;
-    skybox->cubemap_name = "earth_space";
+    skybox->cubemap_name = DEFAULT_SKYBOX_CUBEMAP_NAME;
+    skybox->rendered_in_scene() = 0; // drawn by the cubemap
     skybox->set_model_matrices_standard();
     game_objects[skybox->name] = skybox;
-    id_color_to_game_object[skybox->id_color] = skybox;
+    id_color_to_game_object[skybox->id_color()] = skybox;
+    displayed_cubemap_name = skybox->cubemap_name;
+    if (prefetch_hdris) {
+        hdri_loader->request_all();
+    }
 
 
-    PointLight* point_light1 = new PointLight("point_light1", "sphere");
-    point_light1->type = TypePointLight;
-    point_light1->position = glm::vec3(-10.0f, 10.0f, 10.0f);
-    point_light1->albedo = glm::vec3(170.0f/255.0f, 0.0f/255.0f, 255.0f/255.0f);
-    point_light1->intensity = 5.0f;
-    point_light1->render_only_ambient = true;
-    point_light1->render_one_color = true;
+    GameObject* point_light1 = GameObject::create_light("point_light1", "sphere", TypePointLight);
+    point_light1->position() = glm::vec3(-10.0f, 10.0f, 10.0f);
+    point_light1->albedo() = glm::vec3(170.0f/255.0f, 0.0f/255.0f, 255.0f/255.0f);
+    point_light1->intensity() = 5.0f;
+    point_light1->render_only_ambient() = true;
+    point_light1->render_one_color() = true;
     point_light1->set_model_matrices_standard();
     game_objects[point_light1->name] = point_light1;
-    point_lights[point_light1->name] = point_light1;
-    id_color_to_game_object[point_light1->id_color] = point_light1;
-
-    PointLight* point_light2 = new PointLight("point_light2", "sphere");
-    point_light2->type = TypePointLight;
-    point_light2->position = glm::vec3(10.0f, 10.0f, 10.0f);
-    point_light2->albedo = glm::vec3(76.0f/255.0f, 255.0f/255.0f, 0.0f/255.0f);
-    point_light2->intensity = 5.0f;
-    point_light2->render_only_ambient = true;
-    point_light2->render_one_color = true;
+    id_color_to_game_object[point_light1->id_color()] = point_light1;
+
+    GameObject* point_light2 = GameObject::create_light("point_light2", "sphere", TypePointLight);
+    point_light2->position() = glm::vec3(10.0f, 10.0f, 10.0f);
+    point_light2->albedo() = glm::vec3(76.0f/255.0f, 255.0f/255.0f, 0.0f/255.0f);
+    point_light2->intensity() = 5.0f;
+    point_light2->render_only_ambient() = true;
+    point_light2->render_one_color() = true;
     point_light2->set_model_matrices_standard();
     game_objects[point_light2->name] = point_light2;
-    point_lights[point_light2->name] = point_light2;
-    id_color_to_game_object[point_light2->id_color] = point_light2;
-
-    PointLight* point_light3 = new PointLight("point_light3", "sphere");
-    point_light3->type = TypePointLight;
-    point_light3->position = glm::vec3(-10.0f, -10.0f, 10.0f);
-    point_light3->albedo = glm::vec3(255.0f/255.0f, 98.0f/255.0f, 0.0f/255.0f);
-    point_light3->intensity = 25.0f;
-    point_light3->render_only_ambient = true;
-    point_light3->render_one_color = true;
+    id_color_to_game_object[point_light2->id_color()] = point_light2;
+
+    GameObject* point_light3 = GameObject::create_light("point_light3", "sphere", TypePointLight);
+    point_light3->position() = glm::vec3(-10.0f, -10.0f, 10.0f);
+    point_light3->albedo() = glm::vec3(255.0f/255.0f, 98.0f/255.0f, 0.0f/255.0f);
+    point_light3->intensity() = 25.0f;
+    point_light3->render_only_ambient() = true;
+    point_light3->render_one_color() = true;
     point_light3->set_model_matrices_standard();
     game_objects[point_light3->name] = point_light3;
-    point_lights[point_light3->name] = point_light3;
-    id_color_to_game_object[point_light3->id_color] = point_light3;
-
-    PointLight* point_light4 = new PointLight("point_light4", "sphere");
-    point_light4->type = TypePointLight;
-    point_light4->position = glm::vec3(10.0f, -10.0f, 10.0f);
-    point_light4->albedo = glm::vec3(255.0f/255.0f, 255.0f/255.0f, 255.0f/255.0f);
-    point_light4->intensity = 5.0f;
-    point_light4->render_only_ambient = true;
-    point_light4->render_one_color = true;
+    id_color_to_game_object[point_light3->id_color()] = point_light3;
+
+    GameObject* point_light4 = GameObject::create_light("point_light4", "sphere", TypePointLight);
+    point_light4->position() = glm::vec3(10.0f, -10.0f, 10.0f);
+    point_light4->albedo() = glm::vec3(255.0f/255.0f, 255.0f/255.0f, 255.0f/255.0f);
+    point_light4->intensity() = 5.0f;
+    point_light4->render_only_ambient() = true;
+    point_light4->render_one_color() = true;
     point_light4->set_model_matrices_standard();
     game_objects[point_light4->name] = point_light4;
-    point_lights[point_light4->name] = point_light4;
-    id_color_to_game_object[point_light4->id_color] = point_light4;
-
-    DirectionalLight* directional_light1 = new DirectionalLight("directional_light1", "sphere");
-    directional_light1->type = TypeDirectionalLight;
-    directional_light1->position = glm::vec3(-5.0f, 5.0f, -3.0f);
-    directional_light1->ambient = glm::vec3(0.3f);
-    directional_light1->albedo = glm::vec3(1.0f, 1.0f, 1.0f);
-    directional_light1->intensity = 1.0f;
-    directional_light1->specular = glm::vec3(0.9f);
-    directional_light1->direction = glm::vec3(3.0f, -4.0f, -3.0f);
+    id_color_to_game_object[point_light4->id_color()] = point_light4;
+
+    GameObject* directional_light1 = GameObject::create_light("directional_light1", "sphere", TypeDirectionalLight);
+    directional_light1->position() = glm::vec3(-5.0f, 5.0f, -3.0f);
+    directional_light1->ambient() = glm::vec3(0.3f);
+    directional_light1->albedo() = glm::vec3(1.0f, 1.0f, 1.0f);
+    directional_light1->intensity() = 1.0f;
+    directional_light1->specular() = glm::vec3(0.9f);
+    directional_light1->direction() = glm::vec3(3.0f, -4.0f, -3.0f);
     directional_light1->set_model_matrices_standard();
     game_objects[directional_light1->name] = directional_light1;
-    directional_lights[directional_light1->name] = directional_light1;
-    id_color_to_game_object[directional_light1->id_color] = directional_light1;
-
-    SpotLight* spot_light1 = new SpotLight("spot_light1", "sphere");
-    spot_light1->type = TypeSpotLight;
-    spot_light1->position = glm::vec3(-3.0f, 0.5f, 1.2f);
-    spot_light1->albedo = glm::vec3(1.0f, 1.0f, 1.0f);
-    spot_light1->ambient = glm::vec3(0.0f);
-    spot_light1->intensity = 300.0f;
-    spot_light1->specular = glm::vec3(1.0f);
-    spot_light1->direction = glm::normalize(glm::vec3(10.0f, 40.0f, -22.0f));
+    id_color_to_game_object[directional_light1->id_color()] = directional_light1;
+
+    GameObject* spot_light1 = GameObject::create_light("spot_light1", "sphere", TypeSpotLight);
+    spot_light1->position() = glm::vec3(-3.0f, 0.5f, 1.2f);
+    spot_light1->albedo() = glm::vec3(1.0f, 1.0f, 1.0f);
+    spot_light1->ambient() = glm::vec3(0.0f);
+    spot_light1->intensity() = 300.0f;
+    spot_light1->specular() = glm::vec3(1.0f);
+    spot_light1->direction() = glm::normalize(glm::vec3(10.0f, 40.0f, -22.0f));
     spot_light1->set_model_matrices_standard();
     game_objects[spot_light1->name] = spot_light1;
-    spot_lights[spot_light1->name] = spot_light1;
-    id_color_to_game_object[spot_light1->id_color] = spot_light1;
+    id_color_to_game_object[spot_light1->id_color()] = spot_light1;
 }
 
 void Rendering::set_pbr_shader() {    
@@ -786,11 +909,170 @@ void Rendering::set_pbr_shader() {
     */
 }
 
+// The skybox keeps showing the previous cubemap until the IBL maps of the selected HDRI are created
+void Rendering::update_displayed_cubemap() {
+    const std::string& cubemap_name = game_objects["skybox"]->cubemap_name;
+    hdri_loader->request(cubemap_name);
+    hdri_loader->update();
+    if (cubemap_name != displayed_cubemap_name && (!hdri_loader->is_registered(cubemap_name) || hdri_loader->get_state(cubemap_name) == HdriLoaded)) {
+        displayed_cubemap_name = cubemap_name;
+        if (!prefetch_hdris) {
+            hdri_loader->unload_all_except(displayed_cubemap_name);
+        }
+    }
+}
+
 void Rendering::set_time_before_rendering_loop() {
     this->time_before_rendering = std::chrono::system_clock::now();
 }
 
+float Rendering::get_animation_time_seconds() {
+    if (use_fixed_animation_time) {
+        return fixed_animation_time_seconds;
+    }
+    std::chrono::duration<float> elapsed_seconds = std::chrono::system_clock::now() - time_before_rendering;
+    return elapsed_seconds.count();
+}
+
+// Binds the IBL textures of the displayed cubemap and sets the lights of the scene
+void Rendering::set_lighting_uniforms(Shader* shader) {
+    ALLOCATION_TAG(AllocLighting);
+    FrameArena* frame_arena = FrameArena::get_instance();
+    // bind pre-computed IBL data
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap->umap_name_to_cubemap_data[displayed_cubemap_name].irradiance_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap->umap_name_to_cubemap_data[displayed_cubemap_name].prefilter_texture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+
+    shader->use();
+    shader->setInt("irradianceMap", 0);
+    shader->setInt("prefilterMap", 1);
+    shader->setInt("brdfLUT", 2);
+    shader->setInt("use_irradiance_sh", use_irradiance_sh);
+    if (use_irradiance_sh) {
+        for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+            shader->setVec3(frame_arena->format("irradiance_sh[%d]", i), cubemap->umap_name_to_cubemap_data[displayed_cubemap_name].irradiance_sh[i]);
+        }
+    }
+
+    shader->setFloat("emission_strength", emission_strength);
+
+    // the lights are gathered from the light components, their positions from their entities
+    EntityStore* entity_store = EntityStore::get_instance();
+    int idx_point_light = 0;
+    int idx_directional_light = 0;
+    int idx_spot_light = 0;
+    for (int i = 0; i < entity_store->get_num_lights(); i++) {
+        int entity_index = entity_store->light_entity_indices[i];
+        const glm::vec3& position = entity_store->positions[entity_index];
+        const glm::vec3& light_color = entity_store->light_colors[i];
+        if (entity_store->light_types[i] == LightPoint) {
+            shader->setVec3(frame_arena->format("pointLights[%d].position", idx_point_light), position);
+            shader->setVec3(frame_arena->format("pointLights[%d].ambient", idx_point_light), entity_store->light_ambients[i]);
+            shader->setVec3(frame_arena->format("pointLights[%d].light_color", idx_point_light), light_color);
+            shader->setFloat(frame_arena->format("pointLights[%d].intensity", idx_point_light), entity_store->light_intensities[i]);
+            shader->setVec3(frame_arena->format("pointLights[%d].specular", idx_point_light), entity_store->light_speculars[i]);
+            shader->setFloat(frame_arena->format("pointLights[%d].constant", idx_point_light), entity_store->light_constants[i]);
+            shader->setFloat(frame_arena->format("pointLights[%d].linear", idx_point_light), entity_store->light_linears[i]);
+            shader->setFloat(frame_arena->format("pointLights[%d].quadratic", idx_point_light), entity_store->light_quadratics[i]);
+            idx_point_light++;
+        }
+        else if (entity_store->light_types[i] == LightDirectional) {
+            shader->setVec3(frame_arena->format("directionalLights[%d].direction", idx_directional_light), entity_store->light_directions[i]);
+            shader->setVec3(frame_arena->format("directionalLights[%d].ambient", idx_directional_light), entity_store->light_ambients[i]);
+            shader->setVec3(frame_arena->format("directionalLights[%d].light_color", idx_directional_light), light_color);
+            shader->setFloat(frame_arena->format("directionalLights[%d].intensity", idx_directional_light), entity_store->light_intensities[i]);
+            shader->setVec3(frame_arena->format("directionalLights[%d].specular", idx_directional_light), entity_store->light_speculars[i]);
+            idx_directional_light++;
+        }
+        else { // LightSpot
+            shader->setVec3(frame_arena->format("spotLights[%d].position", idx_spot_light), position);
+            shader->setVec3(frame_arena->format("spotLights[%d].direction", idx_spot_light), entity_store->light_directions[i]);
+            shader->setVec3(frame_arena->format("spotLights[%d].ambient", idx_spot_light), entity_store->light_ambients[i]);
+            shader->setVec3(frame_arena->format("spotLights[%d].light_color", idx_spot_light), light_color);
+            shader->setFloat(frame_arena->format("spotLights[%d].intensity", idx_spot_light), entity_store->light_intensities[i]);
+            shader->setVec3(frame_arena->format("spotLights[%d].specular", idx_spot_light), entity_store->light_speculars[i]);
+            shader->setFloat(frame_arena->format("spotLights[%d].constant", idx_spot_light), entity_store->light_constants[i]);
+            shader->setFloat(frame_arena->format("spotLights[%d].linear", idx_spot_light), entity_store->light_linears[i]);
+            shader->setFloat(frame_arena->format("spotLights[%d].quadratic", idx_spot_light), entity_store->light_quadratics[i]);
+            shader->setFloat(frame_arena->format("spotLights[%d].inner_cut_off", idx_spot_light), glm::cos(glm::radians(entity_store->light_inner_cut_off_angles[i])));
+            shader->setFloat(frame_arena->format("spotLights[%d].outer_cut_off", idx_spot_light), glm::cos(glm::radians(entity_store->light_outer_cut_off_angles[i])));
+            idx_spot_light++;
+        }
+    }
+    shader->setInt("num_point_lights", idx_point_light);
+    shader->setInt("num_directional_lights", idx_directional_light);
+    shader->setInt("num_spot_lights", idx_spot_light);
+}
+
+// Renders the scene from a reflection probe into a face of its environment map. The captures are lit by the
+// displayed cubemap only, the probes don't reflect each other.
+void Rendering::capture_reflection_probe_face(ReflectionProbe& probe, int face, unsigned int capture_fbo) {
+    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, probe.environment_texture, 0);
+    unsigned int attachments[1] = { GL_COLOR_ATTACHMENT0 };
+    glDrawBuffers(1, attachments);
+    glViewport(0, 0, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    glm::mat4 probe_projection = glm::perspective(glm::radians(90.0f), 1.0f, near_camera_viewport, far_camera_viewport);
+    glm::mat4 probe_view = captureViews[face] * glm::translate(glm::mat4(1.0f), -probe.position);
+
+    Shader* lighting_shader = pbr_shader;
+    set_lighting_uniforms(lighting_shader);
+    lighting_shader->setInt("num_reflection_probes", 0);
+    lighting_shader->setMat4("view_projection", probe_projection * probe_view);
+    lighting_shader->setVec3("viewPos", probe.position);
+    lighting_shader->setInt("is_transform3d", 0);
+    EntityStore* entity_store = EntityStore::get_instance();
+    for (int i = 0; i < entity_store->get_num_entities(); i++) {
+        if (entity_store->rendered_in_scene[i]) {
+            if (entity_store->light_indices[i] == -1) {
+                lighting_shader->setFloat("intensity", 1.0);
+            }
+            else { // It is a light
+                lighting_shader->setFloat("intensity", entity_store->light_intensities[entity_store->light_indices[i]]);
+            }
+            GameObject::draw_entity(i, lighting_shader, false);
+        }
+    }
+
+    skybox_shader->use();
+    skybox_shader->setMat4("view_projection", probe_projection * captureViews[face]);
+    skybox_shader->setFloat("mipmap_level", 0.0f);
+    cubemap->draw(skybox_shader, displayed_cubemap_name, EnvironmentMap);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Prefilters a complete capture of a reflection probe
+void Rendering::prefilter_reflection_probe(ReflectionProbe& probe) {
+    glBindTexture(GL_TEXTURE_CUBE_MAP, probe.environment_texture);
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    prefilter_environment_map(probe.prefilter_texture, probe.environment_texture, REFLECTION_PROBE_ENVIRONMENT_MAP_WIDTH, REFLECTION_PROBE_PREFILTER_MAP_WIDTH,
+                              prefilterShader, REFLECTION_PROBE_PREFILTER_SAMPLE_COUNT);
+}
+
 void Rendering::render_viewport() {
+    ALLOCATION_TAG(AllocRendering);
+    FrameArena* frame_arena = FrameArena::get_instance();
+    FrameProfiler* profiler = FrameProfiler::get_instance();
+    profiler->begin_frame();
+    profiler->begin_scope("render_viewport");
+
+    // the probes capture the scene too
+    profiler->begin_scope("transforms");
+    EntityStore::get_instance()->update_transforms();
+    profiler->end_scope();
+
+    profiler->begin_scope("ibl_updates");
+    update_displayed_cubemap();
+    reflection_probes->update();
+    profiler->end_scope();
+
     int texture_viewport_width = user_interface->texture_viewport_width;
     int texture_viewport_height = user_interface->texture_viewport_height;
     glViewport(0, 0, texture_viewport_width, texture_viewport_height);
@@ -801,6 +1083,7 @@ void Rendering::render_viewport() {
     unsigned int attachments0[6] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5 };
     glDrawBuffers(6, attachments0);
 
+    profiler->begin_scope("lighting");
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
@@ -812,63 +1095,23 @@ void Rendering::render_viewport() {
     Shader* lighting_shader = pbr_shader;
     //Shader* lighting_shader = phong_shader;
 
-    // bind pre-computed IBL data
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap->umap_name_to_cubemap_data[((Skybox*)game_objects["skybox"])->cubemap_name].irradiance_texture);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap->umap_name_to_cubemap_data[((Skybox*)game_objects["skybox"])->cubemap_name].prefilter_texture);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-
-    lighting_shader->use();
-    lighting_shader->setInt("irradianceMap", 0);
-    lighting_shader->setInt("prefilterMap", 1);
-    lighting_shader->setInt("brdfLUT", 2);
+    set_lighting_uniforms(lighting_shader);
 
     lighting_shader->setMat4("view_projection", view_projection);
 
     lighting_shader->setVec3("viewPos", camera_viewport->Position);
 
-    lighting_shader->setInt("num_point_lights", point_lights.size());
-    lighting_shader->setInt("num_directional_lights", directional_lights.size());
-    lighting_shader->setInt("num_spot_lights", spot_lights.size());
-
-    lighting_shader->setFloat("emission_strength", emission_strength);
-
-    int idx_point_light = 0;
-    for (auto it = point_lights.begin(); it != point_lights.end(); it++, idx_point_light++) {
-        lighting_shader->setVec3("pointLights[" + std::to_string(idx_point_light) + "].position", it->second->position);
-        lighting_shader->setVec3("pointLights[" + std::to_string(idx_point_light) + "].ambient", it->second->ambient);
-        lighting_shader->setVec3("pointLights[" + std::to_string(idx_point_light) + "].light_color", it->second->albedo);
-        lighting_shader->setFloat("pointLights[" + std::to_string(idx_point_light) + "].intensity", it->second->intensity);
-        lighting_shader->setVec3("pointLights[" + std::to_string(idx_point_light) + "].specular", it->second->specular);
-        lighting_shader->setFloat("pointLights[" + std::to_string(idx_point_light) + "].constant", it->second->constant);
-        lighting_shader->setFloat("pointLights[" + std::to_string(idx_point_light) + "].linear", it->second->linear);
-        lighting_shader->setFloat("pointLights[" + std::to_string(idx_point_light) + "].quadratic", it->second->quadratic);
-    }
-
-    int idx_directional_light = 0;
-    for (auto it = directional_lights.begin(); it != directional_lights.end(); it++, idx_directional_light++) {
-        lighting_shader->setVec3("directionalLights[" + std::to_string(idx_directional_light) + "].direction", it->second->direction);
-        lighting_shader->setVec3("directionalLights[" + std::to_string(idx_directional_light) + "].ambient", it->second->ambient);
-        lighting_shader->setVec3("directionalLights[" + std::to_string(idx_directional_light) + "].light_color", it->second->albedo);
-        lighting_shader->setFloat("directionalLights[" + std::to_string(idx_directional_light) + "].intensity", it->second->intensity);
-        lighting_shader->setVec3("directionalLights[" + std::to_string(idx_directional_light) + "].specular", it->second->specular);
-    }
-
-    int idx_spot_light = 0;
-    for (auto it = spot_lights.begin(); it != spot_lights.end(); it++, idx_spot_light++) {
-        lighting_shader->setVec3("spotLights[" + std::to_string(idx_spot_light) + "].position", it->second->position);
-        lighting_shader->setVec3("spotLights[" + std::to_string(idx_spot_light) + "].direction", it->second->direction);
-        lighting_shader->setVec3("spotLights[" + std::to_string(idx_spot_light) + "].ambient", it->second->ambient);
-        lighting_shader->setVec3("spotLights[" + std::to_string(idx_spot_light) + "].light_color", it->second->albedo);
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].intensity", it->second->intensity);
-        lighting_shader->setVec3("spotLights[" + std::to_string(idx_spot_light) + "].specular", it->second->specular);
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].constant", it->second->constant);
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].linear", it->second->linear);
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].quadratic", it->second->quadratic);
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].inner_cut_off", it->second->get_inner_cut_off());
-        lighting_shader->setFloat("spotLights[" + std::to_string(idx_spot_light) + "].outer_cut_off", it->second->get_outer_cut_off());
+    // local reflection probes nearest to the camera
+    FrameVector<ReflectionProbe*> nearest_probes = reflection_probes->get_nearest_probes(camera_viewport->Position, MAX_BLENDED_REFLECTION_PROBES);
+    lighting_shader->setInt("num_reflection_probes", nearest_probes.size());
+    for (int i = 0; i < MAX_BLENDED_REFLECTION_PROBES; i++) {
+        lighting_shader->setInt(frame_arena->format("reflectionProbeMaps[%d]", i), REFLECTION_PROBE_TEXTURE_UNIT + i);
+        if (i < nearest_probes.size()) {
+            glActiveTexture(GL_TEXTURE0 + REFLECTION_PROBE_TEXTURE_UNIT + i);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, nearest_probes[i]->prefilter_texture);
+            lighting_shader->setVec3(frame_arena->format("reflectionProbePositions[%d]", i), nearest_probes[i]->position);
+            lighting_shader->setFloat(frame_arena->format("reflectionProbeRadii[%d]", i), nearest_probes[i]->radius);
+        }
     }
 
     // Render the game objects with the selected lighting shading and also render the unique Color IDs of each game object
@@ -876,43 +1119,54 @@ void Rendering::render_viewport() {
     unsigned int attachments1[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT5 };
     glDrawBuffers(4, attachments1);
     lighting_shader->setInt("is_transform3d", 0);
-    for (auto it = game_objects.begin(); it != game_objects.end(); it++) {
-        GameObject* game_object = it->second;
-        if (game_object->type != TypeSkybox) {
-            if (game_object->type == TypeBaseModel) {
+    EntityStore* entity_store = EntityStore::get_instance();
+    for (int i = 0; i < entity_store->get_num_entities(); i++) {
+        if (entity_store->rendered_in_scene[i]) {
+            if (entity_store->light_indices[i] == -1) {
                 lighting_shader->setFloat("intensity", 1.0);
             }
             else { // It is a light
-                lighting_shader->setFloat("intensity", ((Light*)game_object)->intensity);
+                lighting_shader->setFloat("intensity", entity_store->light_intensities[entity_store->light_indices[i]]);
             }
-            game_object->draw(lighting_shader, false);
+            GameObject::draw_entity(i, lighting_shader, false);
+            mark_textures_used(i, texture_viewport_height);
         }
     }
+    profiler->end_scope();
 
     // Draw skybox
+    profiler->begin_scope("skybox");
     unsigned int attachments_skybox[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT5 };
     glDrawBuffers(2, attachments_skybox);
     view_skybox = glm::mat4(glm::mat3(view)); // remove translation from the view matrix so it doesn't affect the skybox
     view_projection_skybox = projection * view_skybox;
     skybox_shader->use();
-    //skybox_shader->setInt("is_hdri", cubemap->umap_name_to_cubemap_data[((Skybox*)game_objects["skybox"])->cubemap_name].is_hdri);
+    //skybox_shader->setInt("is_hdri", cubemap->umap_name_to_cubemap_data[game_objects["skybox"]->cubemap_name].is_hdri);
     //skybox_shader->setFloat("exposure", exposure);
     skybox_shader->setMat4("view_projection", view_projection_skybox);
     skybox_shader->setFloat("mipmap_level", cubemap_texture_mipmap_level);
-    cubemap->draw(skybox_shader, ((Skybox*)game_objects["skybox"])->cubemap_name, cubemap_texture_type);
+    cubemap->draw(skybox_shader, displayed_cubemap_name, cubemap_texture_type);
+    profiler->end_scope();
 
     // Apply bloom to the rendered HDR bright color texture
     if (bloom_activated) {
+        profiler->begin_scope("bloom");
         unsigned int attachments_bloom[1] = { GL_COLOR_ATTACHMENT0 };
         glDrawBuffers(1, attachments_bloom);
         glBindFramebuffer(GL_FRAMEBUFFER, bloom_fbo);
+        profiler->begin_scope("bloom_downsample");
         bloom_downsampling(bloom_downsample_shader, textureHDRBrightColorbuffer, bloom_textures, texture_viewport_width, texture_viewport_height);
+        profiler->end_scope();
+        profiler->begin_scope("bloom_upsample");
         bloom_upsampling(bloom_upsample_shader, bloom_textures, bloom_filter_radius);
+        profiler->end_scope();
         glViewport(0, 0, texture_viewport_width, texture_viewport_height);
         glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        profiler->end_scope();
     }
 
     // Render only the last selected object (if it exists) to later outline the shape of this object
+    profiler->begin_scope("selection");
     unsigned int attachments3[1] = { GL_COLOR_ATTACHMENT3 };
     glDrawBuffers(1, attachments3);
     selection_shader->use();
@@ -920,8 +1174,10 @@ void Rendering::render_viewport() {
     if (last_selected_object != nullptr && last_selected_object->type != TypeSkybox) {
         last_selected_object->draw(selection_shader, true);
     }
+    profiler->end_scope();
 
     // Convert HDR color texture to LDR
+    profiler->begin_scope("tonemap");
     unsigned int attachments4[1] = { GL_COLOR_ATTACHMENT4 }; // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
     glDrawBuffers(1, attachments4);
     hdr_to_ldr_shader->use();
@@ -935,8 +1191,10 @@ void Rendering::render_viewport() {
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, bloom_textures[0].texture_id);
     screen_quad->draw(hdr_to_ldr_shader, false);
+    profiler->end_scope();
 
     // Draw border outlining the selected object (if it exists one)
+    profiler->begin_scope("outline");
     outline_shader->use();
     outline_shader->setVec2("pixel_size", glm::vec2(1.0f / user_interface->texture_viewport_width, 1.0f / user_interface->texture_viewport_height));
     outline_shader->setVec3("outline_color", outline_color);
@@ -944,8 +1202,10 @@ void Rendering::render_viewport() {
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_selected_color_buffer);
     screen_quad->draw(outline_shader, true);
+    profiler->end_scope();
 
     // Clear the depth buffer so the Transform3D is drawn over everything
+    profiler->begin_scope("gizmo");
     glClear(GL_DEPTH_BUFFER_BIT);
 
     // Draw 3D transforms if there is a selected object
@@ -957,8 +1217,46 @@ void Rendering::render_viewport() {
         transform3d->update_model_matrices(last_selected_object);
         transform3d->draw(lighting_shader);
     }
+    profiler->end_scope();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    profiler->begin_scope("texture_residency");
+    TextureCache::get_instance()->update_residency();
+    profiler->end_scope();
+
+    profiler->end_scope();
+    profiler->end_frame();
+}
+
+void Rendering::mark_textures_used(int entity_index, int viewport_height) {
+    EntityStore* entity_store = EntityStore::get_instance();
+    Model* model = dynamic_cast<Model*>(entity_store->render_models[entity_index]);
+    if (model == nullptr) {
+        return;
+    }
+    // Projected diameter of the bounding sphere of the model
+    const glm::vec3& scale = entity_store->scales[entity_index];
+    glm::vec3 center = glm::vec3(entity_store->models[entity_index] * glm::vec4((model->aabb_min + model->aabb_max) * 0.5f, 1.0f));
+    float radius = 0.5f * glm::length(model->aabb_max - model->aabb_min) * std::max(scale.x, std::max(scale.y, scale.z));
+    float distance = glm::length(center - camera_viewport->Position);
+    float screen_size = (float)viewport_height;
+    if (distance > radius) {
+        screen_size = radius / (distance * std::tan(glm::radians(camera_viewport->Zoom) * 0.5f)) * viewport_height;
+    }
+
+    TextureCache* texture_cache = TextureCache::get_instance();
+    Material* material = entity_store->materials[entity_index];
+    if (material != nullptr) {
+        for (auto it = material->textures.begin(); it != material->textures.end(); it++) {
+            texture_cache->mark_used(it->second->id, screen_size);
+        }
+    }
+    else {
+        for (auto it = model->loaded_textures.begin(); it != model->loaded_textures.end(); it++) {
+            texture_cache->mark_used(it->second->id, screen_size);
+        }
+    }
 }
 
 // Check mouse over viewport's models using Color Picking technique
@@ -1077,12 +1375,39 @@ void Rendering::clean() {
     delete bloom_downsample_shader;
     delete bloom_upsample_shader;
     delete hdr_to_ldr_shader;
+    // the textures of models and materials are shared through the texture cache, every Texture holds one reference
+    std::set<Texture*> textures;
+    for (auto it = loaded_materials.begin(); it != loaded_materials.end(); it++) {
+        Material* material = Material::pool.get(it->second);
+        if (material == nullptr) {
+            continue;
+        }
+        for (auto texture = material->textures.begin(); texture != material->textures.end(); texture++) {
+            textures.insert(texture->second);
+        }
+    }
+    for (auto it = textures.begin(); it != textures.end(); it++) {
+        TextureCache::get_instance()->release((*it)->id);
+    }
+    TextureCache::get_instance()->clean();
+    WorkerPool::get_instance()->clean();
+    if (hdri_loader != nullptr) {
+        hdri_loader->clean();
+        delete hdri_loader;
+    }
+    if (reflection_probes != nullptr) {
+        reflection_probes->clean();
+        delete reflection_probes;
+    }
+    FrameProfiler::get_instance()->clean();
     for (auto it = loaded_models.begin(); it != loaded_models.end(); it++) {
         delete it->second;
     }
     for (auto it = game_objects.begin(); it != game_objects.end(); it++) {
-        delete it->second;
+        GameObject::destroy(it->second);
     }
+    Material::pool.clear();
+    Texture::pool.clear();
     delete transform3d;
     delete camera_viewport;
     delete screen_quad;
@@ -1091,6 +1416,17 @@ void Rendering::clean() {
 }
 
 void Rendering::clean_viewport_framebuffer() {
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    unsigned int render_targets[7] = { textureHDRColorbuffer, texture_id_colors, texture_selected_color_buffer, textureLDRColorbuffer,
+        textureHDRBrightColorbuffer, texture_id_colors_transform3d, brdfLUTTexture };
+    for (int i = 0; i < 7; i++) {
+        resource_registry->release(ResourceRenderTarget, render_targets[i]);
+    }
+    resource_registry->release(ResourceRenderbuffer, rboDepthStencil);
+    for (int i = 0; i < bloom_textures.size(); i++) {
+        resource_registry->release(ResourceRenderTarget, bloom_textures[i].texture_id);
+    }
+
     // Clean main rendering
     glDeleteFramebuffers(1, &framebuffer);
     glDeleteTextures(1, &textureHDRColorbuffer);
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "bloom.h"
+#include "object_pool.h"
 
 #include <mutex>
 #include <vector>
+#include <string>
 #include <unordered_map>
 #include <map>
 #include <iostream>
@@ -21,17 +23,24 @@ class UserInterface;
 class NeonEngine;
 class Shape;
 class GameObject;
-class PointLight;
-class DirectionalLight;
-class SpotLight;
 class Transform3D;
 class Quad;
 class Cubemap;
 class Model;
 class Texture;
 class Material;
+class TaskGraph;
+class HdriLoader;
+class ReflectionProbes;
+struct ReflectionProbe;
+struct ImageData;
+struct CookedCubemapData;
 
-enum CubemapTextureType;
+enum CubemapTextureType : int;
+
+const std::string DEFAULT_SKYBOX_CUBEMAP_NAME = "earth_space";
+// Name of the scene created by initialize_game_objects(), the only one of the engine (reported by the benchmarks)
+const std::string DEFAULT_SCENE_NAME = "default";
 
 class Rendering {
 public:
@@ -45,22 +54,39 @@ public:
     void set_viewport_shaders();
     void add_model_to_loaded_data(Model* model);
     void load_cubemap(const std::string& cubemap_name, const std::vector<std::string>& cube_map_paths, bool is_hdri);
-    void set_viewport_data();
+    void load_hdri_cubemap(const std::string& cubemap_name, ImageData& equirectangular_image);
+    void load_cooked_hdri_cubemap(const std::string& cubemap_name, CookedCubemapData& cubemap_data);
+    void rebake_ibl(const std::string& cubemap_name);
+    void create_ibl_capture_data();
+    void add_startup_tasks(TaskGraph& task_graph);
+    std::vector<int> add_viewport_data_tasks(TaskGraph& task_graph, int shaders_task);
+    std::vector<int> add_material_tasks(TaskGraph& task_graph, const std::string& material_name, const std::string& texture_name, const std::string& directory);
     void initialize_game_objects();
     void set_pbr_shader();
     void set_time_before_rendering_loop();
+    float get_animation_time_seconds();
     void render_viewport();
+    void update_displayed_cubemap();
+    void set_lighting_uniforms(Shader* shader);
+    void record_viewport_framebuffer_memory();
+    void record_cubemap_memory(const std::string& cubemap_name);
+    void capture_reflection_probe_face(ReflectionProbe& probe, int face, unsigned int capture_fbo);
+    void prefilter_reflection_probe(ReflectionProbe& probe);
     void setup_framebuffer_and_textures();
     void resize_textures();
     void clean();
     void clean_viewport_framebuffer();
     GameObject* check_mouse_over_models();
+    // Records the textures used by an entity and its size on screen, for the residency of the texture cache
+    void mark_textures_used(int entity_index, int viewport_height);
     //std::string check_mouse_over_models2();
     GameObject* check_mouse_over_transform3d();
 
     void print_names_loaded_models();
     void print_names_loaded_materials();
     void print_names_loaded_textures();
+    // nullptr for "Default", an unknown name or a destroyed material
+    Material* get_material(const std::string& name);
 
     glm::mat4 view, projection;
     glm::mat4 view_projection;
@@ -74,6 +100,9 @@ public:
     unsigned int textureHDRBrightColorbuffer, texture_id_colors_transform3d, rboDepthStencil;
     unsigned int brdfLUTTexture;
     std::chrono::time_point<std::chrono::system_clock> time_before_rendering;
+    // With a fixed animation time (benchmarks) the animations don't depend on the real time between frames
+    bool use_fixed_animation_time;
+    float fixed_animation_time_seconds;
     Shader* phong_shader;
     Shader* pbr_shader;
     Shader* selection_shader;
@@ -87,6 +116,12 @@ public:
     Shader* bloom_upsample_shader;
     Shader* hdr_to_ldr_shader;
     Cubemap* cubemap;
+    HdriLoader* hdri_loader;
+    ReflectionProbes* reflection_probes;
+    // Cubemap drawn by the skybox and used for the IBL, the selected one once its maps are loaded
+    std::string displayed_cubemap_name;
+    // With prefetch the IBL maps of every HDRI are created in the background after loading and kept
+    bool prefetch_hdris;
     CubemapTextureType cubemap_texture_type;
     float emission_strength;
     float cubemap_texture_mipmap_level;
@@ -94,15 +129,18 @@ public:
     float bloom_filter_radius;
     float bloom_strength;
     bool bloom_activated;
+    // Diffuse IBL from the spherical harmonics of the environment instead of the irradiance map
+    bool use_irradiance_sh;
+    // Importance samples per texel of the prefilter maps
+    int prefilter_sample_count;
     std::vector<TextureAndSize> bloom_textures;
     std::unordered_map<glm::u8vec3, GameObject*> id_color_to_game_object;
     std::unordered_map<glm::u8vec3, GameObject*> id_color_to_game_object_transform3d;
     std::map<std::string, BaseModel*> loaded_models;
-    std::map<std::string, Texture*> loaded_textures;
-    std::map<std::string, Material*> loaded_materials;
-    std::map<std::string, PointLight*> point_lights;
-    std::map<std::string, DirectionalLight*> directional_lights;
-    std::map<std::string, SpotLight*> spot_lights;
+    // Handles to the pools, the materials and textures of a model are destroyed when its cooked data is reloaded.
+    // "Default" is the null handle of the material
+    std::map<std::string, PoolHandle> loaded_textures;
+    std::map<std::string, PoolHandle> loaded_materials;
     std::map<std::string, GameObject*> game_objects;
     Transform3D* transform3d;
     GameObject* last_selected_object;
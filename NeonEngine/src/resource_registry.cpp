@@ -0,0 +1,217 @@
+#include "resource_registry.h"
+#include "frame_arena.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+ResourceRegistry* ResourceRegistry::instance = nullptr;
+std::mutex ResourceRegistry::resource_registry_mutex;
+
+std::string resource_category_to_string(ResourceCategory category) {
+    switch (category) {
+    case ResourceTexture:
+        return "Textures";
+    case ResourceCubemap:
+        return "Cubemaps";
+    case ResourceRenderTarget:
+        return "Render targets";
+    case ResourceRenderbuffer:
+        return "Renderbuffers";
+    case ResourceMeshBuffer:
+        return "Mesh buffers";
+    case ResourceUploadBuffer:
+        return "Upload buffers";
+    case ResourceCpuVertexData:
+        return "CPU vertex data";
+    default:
+        return "Unknown";
+    }
+}
+
+bool is_gpu_resource_category(ResourceCategory category) {
+    return category != ResourceCpuVertexData;
+}
+
+size_t get_texture_memory_size(unsigned int texture) {
+    GLint target = 0;
+    glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+    size_t num_faces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+
+    size_t size = 0;
+    for (int level = 0; level < 16; level++) {
+        GLint width = 0;
+        GLint height = 0;
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_WIDTH, &width);
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_HEIGHT, &height);
+        if (width == 0 || height == 0) {
+            break;
+        }
+        GLint compressed = GL_FALSE;
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_COMPRESSED, &compressed);
+        if (compressed) {
+            GLint compressed_size = 0;
+            glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressed_size);
+            size += (size_t)compressed_size * num_faces;
+            continue;
+        }
+        // bits of every component of the internal format
+        GLenum size_parameters[6] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+        GLint bits_per_pixel = 0;
+        for (int i = 0; i < 6; i++) {
+            GLint bits = 0;
+            glGetTextureLevelParameteriv(texture, level, size_parameters[i], &bits);
+            bits_per_pixel += bits;
+        }
+        size += (size_t)width * height * bits_per_pixel / 8 * num_faces;
+    }
+    return size;
+}
+
+size_t get_renderbuffer_memory_size(unsigned int renderbuffer) {
+    GLint width = 0;
+    GLint height = 0;
+    glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_WIDTH, &width);
+    glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_HEIGHT, &height);
+    GLenum size_parameters[6] = { GL_RENDERBUFFER_RED_SIZE, GL_RENDERBUFFER_GREEN_SIZE, GL_RENDERBUFFER_BLUE_SIZE, GL_RENDERBUFFER_ALPHA_SIZE, GL_RENDERBUFFER_DEPTH_SIZE, GL_RENDERBUFFER_STENCIL_SIZE };
+    GLint bits_per_pixel = 0;
+    for (int i = 0; i < 6; i++) {
+        GLint bits = 0;
+        glGetNamedRenderbufferParameteriv(renderbuffer, size_parameters[i], &bits);
+        bits_per_pixel += bits;
+    }
+    return (size_t)width * height * bits_per_pixel / 8;
+}
+
+ResourceRegistry* ResourceRegistry::get_instance()
+{
+    std::lock_guard<std::mutex> lock(resource_registry_mutex);
+    if (instance == nullptr) {
+        instance = new ResourceRegistry();
+    }
+    return instance;
+}
+
+void ResourceRegistry::record(ResourceCategory category, uint64_t id, const std::string& owner, size_t size_in_bytes) {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    auto it = records.find({ category, id });
+    if (it != records.end()) {
+        category_totals[category] -= it->second.size_in_bytes;
+        it->second.owner = owner;
+        it->second.size_in_bytes = size_in_bytes;
+    }
+    else {
+        records[{ category, id }] = { category, owner, size_in_bytes };
+    }
+    category_totals[category] += size_in_bytes;
+}
+
+void ResourceRegistry::release(ResourceCategory category, uint64_t id) {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    auto it = records.find({ category, id });
+    if (it != records.end()) {
+        category_totals[category] -= it->second.size_in_bytes;
+        records.erase(it);
+    }
+}
+
+void ResourceRegistry::record_texture(ResourceCategory category, unsigned int texture, const std::string& owner) {
+    if (texture != 0) {
+        record(category, texture, owner, get_texture_memory_size(texture));
+    }
+}
+
+void ResourceRegistry::record_renderbuffer(unsigned int renderbuffer, const std::string& owner) {
+    if (renderbuffer != 0) {
+        record(ResourceRenderbuffer, renderbuffer, owner, get_renderbuffer_memory_size(renderbuffer));
+    }
+}
+
+size_t ResourceRegistry::get_total(ResourceCategory category) {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    return category_totals[category];
+}
+
+size_t ResourceRegistry::get_gpu_total() {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    size_t total = 0;
+    for (int i = 0; i < ResourceCategoryLast; i++) {
+        if (is_gpu_resource_category((ResourceCategory)i)) {
+            total += category_totals[i];
+        }
+    }
+    return total;
+}
+
+size_t ResourceRegistry::get_cpu_total() {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    size_t total = 0;
+    for (int i = 0; i < ResourceCategoryLast; i++) {
+        if (!is_gpu_resource_category((ResourceCategory)i)) {
+            total += category_totals[i];
+        }
+    }
+    return total;
+}
+
+void ResourceRegistry::get_top_consumers(int max_consumers, std::vector<ResourceRecord>& consumers) {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    // the records of the same owner are grouped by sorting them, the totals point to the owners of the records
+    FrameVector<const ResourceRecord*> sorted_records;
+    sorted_records.reserve(records.size());
+    for (auto it = records.begin(); it != records.end(); it++) {
+        sorted_records.push_back(&(it->second));
+    }
+    std::sort(sorted_records.begin(), sorted_records.end(), [](const ResourceRecord* a, const ResourceRecord* b) {
+        if (a->category != b->category) {
+            return a->category < b->category;
+        }
+        return a->owner < b->owner;
+    });
+
+    FrameVector<std::pair<size_t, const ResourceRecord*>> owner_totals;
+    for (int i = 0; i < sorted_records.size(); i++) {
+        if (i == 0 || sorted_records[i]->category != sorted_records[i - 1]->category || sorted_records[i]->owner != sorted_records[i - 1]->owner) {
+            owner_totals.push_back({ 0, sorted_records[i] });
+        }
+        owner_totals.back().first += sorted_records[i]->size_in_bytes;
+    }
+    std::sort(owner_totals.begin(), owner_totals.end(), [](const std::pair<size_t, const ResourceRecord*>& a, const std::pair<size_t, const ResourceRecord*>& b) {
+        return a.first > b.first;
+    });
+
+    consumers.resize(std::min((int)owner_totals.size(), max_consumers));
+    for (int i = 0; i < consumers.size(); i++) {
+        consumers[i].category = owner_totals[i].second->category;
+        consumers[i].owner.assign(owner_totals[i].second->owner);
+        consumers[i].size_in_bytes = owner_totals[i].first;
+    }
+}
+
+void ResourceRegistry::print_report(int max_consumers) {
+    const double megabyte = 1024.0 * 1024.0;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "MEMORY OF THE RESOURCES: GPU " << get_gpu_total() / megabyte << " MB, CPU " << get_cpu_total() / megabyte << " MB" << std::endl;
+    for (int i = 0; i < ResourceCategoryLast; i++) {
+        std::cout << "  " << std::left << std::setw(18) << resource_category_to_string((ResourceCategory)i) << std::right
+            << std::setw(10) << get_total((ResourceCategory)i) / megabyte << " MB" << std::endl;
+    }
+    std::cout << "TOP " << max_consumers << " CONSUMERS:" << std::endl;
+    std::vector<ResourceRecord> consumers;
+    get_top_consumers(max_consumers, consumers);
+    for (int i = 0; i < consumers.size(); i++) {
+        std::cout << "  " << std::setw(10) << consumers[i].size_in_bytes / megabyte << " MB  " << std::left << std::setw(18)
+            << resource_category_to_string(consumers[i].category) << std::right << consumers[i].owner << std::endl;
+    }
+    if (is_over_gpu_budget()) {
+        std::cout << "ERROR::RESOURCE_REGISTRY:: The GPU memory (" << get_gpu_total() / megabyte << " MB) is over the budget of "
+            << gpu_memory_budget / megabyte << " MB" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+bool ResourceRegistry::is_over_gpu_budget() {
+    return gpu_memory_budget != 0 && get_gpu_total() > gpu_memory_budget;
+}
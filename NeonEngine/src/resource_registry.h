@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+const int MEMORY_REPORT_TOP_CONSUMERS = 20;
+
+enum ResourceCategory {
+    ResourceTexture,        // textures of models and materials
+    ResourceCubemap,        // environment, irradiance and prefilter maps of the HDRIs and reflection probes
+    ResourceRenderTarget,   // texture attachments of the viewport framebuffer, bloom mips and BRDF LUT
+    ResourceRenderbuffer,   // depth-stencil renderbuffers of the viewport framebuffer and the reflection probes
+    ResourceMeshBuffer,     // vertex and index buffers
+    ResourceUploadBuffer,   // staging ring of the texture uploads
+    ResourceCpuVertexData,  // CPU copies of the vertices and indices of the meshes
+    ResourceCategoryLast
+};
+
+std::string resource_category_to_string(ResourceCategory category);
+bool is_gpu_resource_category(ResourceCategory category);
+
+struct ResourceRecord {
+    ResourceCategory category;
+    // Model, material, HDRI or pass that allocated the resource
+    std::string owner;
+    size_t size_in_bytes;
+};
+
+// GL thread only. Bytes of the allocated levels (and faces) of a texture, queried from GL
+size_t get_texture_memory_size(unsigned int texture);
+size_t get_renderbuffer_memory_size(unsigned int renderbuffer);
+
+// Process-wide record of the memory of the engine resources: every allocation is recorded with its category, owner and size
+// when it's created (or resized) and released when it's deleted. The allocations are identified by their category and an id,
+// the GL object of the GPU resources and the address of the owner object of the CPU ones.
+class ResourceRegistry {
+public:
+    static ResourceRegistry* get_instance();
+
+    ResourceRegistry(ResourceRegistry& other) = delete;
+    void operator=(const ResourceRegistry&) = delete;
+
+    // Any thread. Recording an id again updates its owner and size
+    void record(ResourceCategory category, uint64_t id, const std::string& owner, size_t size_in_bytes);
+    void release(ResourceCategory category, uint64_t id);
+    // GL thread only, the size is queried from GL
+    void record_texture(ResourceCategory category, unsigned int texture, const std::string& owner);
+    void record_renderbuffer(unsigned int renderbuffer, const std::string& owner);
+
+    size_t get_total(ResourceCategory category);
+    size_t get_gpu_total();
+    size_t get_cpu_total();
+    // Memory of every owner of every category, from the largest. Reuses the memory of consumers, GL thread only
+    void get_top_consumers(int max_consumers, std::vector<ResourceRecord>& consumers);
+    // Totals per category and top consumers
+    void print_report(int max_consumers);
+    bool is_over_gpu_budget();
+
+    // Budget in bytes of the GPU memory, 0 for no budget
+    size_t gpu_memory_budget = 0;
+
+private:
+    ResourceRegistry() {}
+
+    static ResourceRegistry* instance;
+    static std::mutex resource_registry_mutex;
+
+    std::map<std::pair<int, uint64_t>, ResourceRecord> records;
+    size_t category_totals[ResourceCategoryLast] = {};
+    std::mutex records_mutex;
+};
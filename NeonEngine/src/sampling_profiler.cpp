@@ -0,0 +1,219 @@
+#include "sampling_profiler.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+SamplingProfiler* SamplingProfiler::instance = nullptr;
+std::mutex SamplingProfiler::sampling_profiler_mutex;
+
+#ifdef __linux__
+// Written by the signal handler, which can't take locks or allocate
+static StackSample* samples = nullptr;
+static std::atomic<int> next_sample(0);
+static std::atomic<int> running_handlers(0);
+// Cleared by stop() before it waits for the running handlers, a handler that starts after that doesn't write its sample
+static std::atomic<bool> sampling(false);
+
+static int64_t get_thread_id() {
+    return (int64_t)syscall(SYS_gettid);
+}
+
+static void handle_sigprof(int signal_number, siginfo_t* info, void* context) {
+    // the handler is counted before it checks the flag, so stop() either waits for it or it sees the flag cleared
+    running_handlers++;
+    if (!sampling) {
+        running_handlers--;
+        return;
+    }
+    int saved_errno = errno;
+    int index = next_sample.fetch_add(1);
+    if (index < SAMPLING_PROFILER_MAX_SAMPLES) {
+        StackSample& sample = samples[index];
+        sample.thread_id = get_thread_id();
+        sample.num_frames = backtrace(sample.frames, SAMPLING_PROFILER_MAX_FRAMES);
+    }
+    running_handlers--;
+    errno = saved_errno;
+}
+#endif
+
+SamplingProfiler* SamplingProfiler::get_instance()
+{
+    std::lock_guard<std::mutex> lock(sampling_profiler_mutex);
+    if (instance == nullptr) {
+        instance = new SamplingProfiler();
+    }
+    return instance;
+}
+
+bool SamplingProfiler::is_supported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef __linux__
+bool SamplingProfiler::start(int rate_hz) {
+    stop();
+    if (samples == nullptr) {
+        samples = new StackSample[SAMPLING_PROFILER_MAX_SAMPLES];
+    }
+    next_sample = 0;
+    num_samples = 0;
+    sampling = true;
+    // the first call of backtrace() loads libgcc, which isn't safe inside the signal handler
+    void* frames[1];
+    backtrace(frames, 1);
+
+    struct sigaction action = {};
+    action.sa_sigaction = handle_sigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        std::cout << "ERROR::SAMPLING_PROFILER:: Failed to install the SIGPROF handler" << std::endl;
+        sampling = false;
+        return false;
+    }
+    int interval_us = 1000000 / std::clamp(rate_hz, 1, 10000);
+    itimerval timer;
+    timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_interval.tv_usec = interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        std::cout << "ERROR::SAMPLING_PROFILER:: Failed to start the profiling timer" << std::endl;
+        sampling = false;
+        signal(SIGPROF, SIG_IGN);
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+void SamplingProfiler::stop() {
+    if (!running) {
+        return;
+    }
+    itimerval timer = {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    // a signal still pending or a handler that hasn't counted itself yet finds the flag cleared,
+    // a handler that was already counted in another thread finishes its sample
+    sampling = false;
+    while (running_handlers > 0) {
+        std::this_thread::yield();
+    }
+    signal(SIGPROF, SIG_IGN);
+    num_samples = std::min(next_sample.load(), SAMPLING_PROFILER_MAX_SAMPLES);
+    if (next_sample > SAMPLING_PROFILER_MAX_SAMPLES) {
+        std::cout << "ERROR::SAMPLING_PROFILER:: " << next_sample - SAMPLING_PROFILER_MAX_SAMPLES << " samples were dropped, the profile has the first "
+            << SAMPLING_PROFILER_MAX_SAMPLES << std::endl;
+    }
+    running = false;
+}
+
+void SamplingProfiler::set_thread_name(const std::string& name) {
+    std::lock_guard<std::mutex> lock(thread_names_mutex);
+    thread_names[get_thread_id()] = name;
+}
+#else
+bool SamplingProfiler::start(int rate_hz) {
+    std::cout << "ERROR::SAMPLING_PROFILER:: The sampling profiler is only available on Linux" << std::endl;
+    return false;
+}
+
+void SamplingProfiler::stop() {
+    running = false;
+}
+
+void SamplingProfiler::set_thread_name(const std::string& name) {
+}
+#endif
+
+bool SamplingProfiler::is_running() {
+    return running;
+}
+
+int SamplingProfiler::get_num_samples() {
+    return num_samples;
+}
+
+bool SamplingProfiler::write_folded_stacks(const std::string& path) {
+    stop();
+    std::map<std::string, int> stack_counts;
+#ifdef __linux__
+    for (int i = 0; i < num_samples; i++) {
+        const StackSample& sample = samples[i];
+        std::string stack;
+        {
+            std::lock_guard<std::mutex> lock(thread_names_mutex);
+            auto it = thread_names.find(sample.thread_id);
+            stack = it != thread_names.end() ? it->second : "thread " + std::to_string(sample.thread_id);
+        }
+        // the two innermost frames are the signal handler and the signal trampoline, the return addresses of the
+        // callers are moved back into their call instructions
+        for (int j = sample.num_frames - 1; j >= 2; j--) {
+            stack += ";" + symbolize((char*)sample.frames[j] - (j > 2 ? 1 : 0));
+        }
+        stack_counts[stack]++;
+    }
+#endif
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::SAMPLING_PROFILER:: Failed to write the folded stacks to: " << path << std::endl;
+        return false;
+    }
+    for (auto it = stack_counts.begin(); it != stack_counts.end(); it++) {
+        file << it->first << " " << it->second << "\n";
+    }
+    std::cout << "SAMPLING PROFILER: " << num_samples << " SAMPLES (" << stack_counts.size() << " STACKS) WRITTEN TO: " << path << std::endl;
+    return true;
+}
+
+std::string SamplingProfiler::symbolize(void* address) {
+    auto it = symbols.find(address);
+    if (it != symbols.end()) {
+        return it->second;
+    }
+    std::string symbol = "??";
+#ifdef __linux__
+    Dl_info info;
+    if (dladdr(address, &info) != 0) {
+        if (info.dli_sname != nullptr) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            symbol = status == 0 ? demangled : info.dli_sname;
+            std::free(demangled);
+        }
+        else if (info.dli_fname != nullptr) {
+            // without a symbol the module and the offset in it, for addr2line
+            std::string module = info.dli_fname;
+            char offset[32];
+            std::snprintf(offset, sizeof(offset), "+0x%zx", (size_t)((char*)address - (char*)info.dli_fbase));
+            symbol = module.substr(module.find_last_of('/') + 1) + offset;
+        }
+    }
+#endif
+    // ';' separates the frames of the folded stacks
+    std::replace(symbol.begin(), symbol.end(), ';', ':');
+    symbols[address] = symbol;
+    return symbol;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+const int SAMPLING_PROFILER_DEFAULT_RATE_HZ = 1000;
+// Samples kept by a run, at the default rate about half a minute of CPU time of the process; the later samples are dropped
+const int SAMPLING_PROFILER_MAX_SAMPLES = 32768;
+const int SAMPLING_PROFILER_MAX_FRAMES = 48;
+
+// Call stack of the thread that was running when the timer of the profiler fired, from the innermost frame
+struct StackSample {
+    int64_t thread_id;
+    int num_frames;
+    void* frames[SAMPLING_PROFILER_MAX_FRAMES];
+};
+
+// In-process sampling profiler, Linux only: a SIGPROF timer fires at the given rate of CPU time of the process
+// and its handler records the call stack of the thread it interrupted into a preallocated array, so the busy threads get
+// the samples. stop() ends the sampling, the stacks are symbolized when they are written as folded stacks
+// ("thread;outer;...;inner count" per line) for flamegraph.pl, speedscope or similar.
+// The symbols come from the dynamic symbol table, the engine must be linked with -rdynamic to get the names of its own functions.
+// Main thread only, except set_thread_name()
+class SamplingProfiler {
+public:
+    static SamplingProfiler* get_instance();
+    static bool is_supported();
+
+    SamplingProfiler(SamplingProfiler& other) = delete;
+    void operator=(const SamplingProfiler&) = delete;
+
+    // Discards the samples of the previous run
+    bool start(int rate_hz);
+    void stop();
+    bool is_running();
+    int get_num_samples();
+    // Name of the calling thread in the folded stacks, the threads without name are "thread <id>"
+    void set_thread_name(const std::string& name);
+    bool write_folded_stacks(const std::string& path);
+
+private:
+    SamplingProfiler() {}
+
+    std::string symbolize(void* address);
+
+    static SamplingProfiler* instance;
+    static std::mutex sampling_profiler_mutex;
+
+    bool running = false;
+    int num_samples = 0;
+    std::map<int64_t, std::string> thread_names;
+    std::map<void*, std::string> symbols;
+    std::mutex thread_names_mutex;
+};
@@ -224,17 +224,17 @@ void Sphere::draw(Shader* shader, Material* draw_material, bool is_selected, boo
         int num_active_textures = 0;
         for (int type = TexAlbedo; type < TexLast; type++) {
             TextureType texture_type = (TextureType)type;
-            std::string str_texture_type = Texture::get_long_name_of_texture_type(texture_type);
+            const char* str_texture_type = Texture::get_long_name_of_texture_type(texture_type);
             if (draw_material->textures.find(texture_type) != draw_material->textures.end()) {
                 Texture* texture = draw_material->textures[texture_type];
                 glActiveTexture(GL_TEXTURE0 + OFFSET_TEXTURES + num_active_textures);
                 shader->setInt(str_texture_type, OFFSET_TEXTURES + num_active_textures);
-                shader->setInt("has_" + str_texture_type, true);
+                shader->setInt(Texture::get_has_name_of_texture_type(texture_type), true);
                 glBindTexture(GL_TEXTURE_2D, texture->id);
                 num_active_textures++;
             }
             else {
-                shader->setInt("has_" + str_texture_type, false);
+                shader->setInt(Texture::get_has_name_of_texture_type(texture_type), false);
             }
         }
     }
@@ -242,7 +242,7 @@ void Sphere::draw(Shader* shader, Material* draw_material, bool is_selected, boo
         shader->setInt("material_format", FileFormat::Default);
 
         for (int type = TexAlbedo; type < TexLast; type++) {
-            shader->setInt("has_" + Texture::get_long_name_of_texture_type((TextureType)type), false);
+            shader->setInt(Texture::get_has_name_of_texture_type((TextureType)type), false);
         }
     }
 
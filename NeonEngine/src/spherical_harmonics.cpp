@@ -0,0 +1,195 @@
+#include "spherical_harmonics.h"
+#include "worker_pool.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define NEON_SH_SSE2
+#endif
+
+// Direction of the center of texel (u, v) in [-1, 1] of a cube map face, see the table of the cube map faces of the GL spec
+static glm::vec3 get_cubemap_direction(int face, float u, float v) {
+    switch (face) {
+    case 0: return glm::vec3(1.0f, -v, -u);
+    case 1: return glm::vec3(-1.0f, -v, u);
+    case 2: return glm::vec3(u, 1.0f, v);
+    case 3: return glm::vec3(u, -1.0f, -v);
+    case 4: return glm::vec3(u, -v, 1.0f);
+    default: return glm::vec3(-u, -v, -1.0f);
+    }
+}
+
+static void evaluate_sh_basis(const glm::vec3& n, float basis[NUM_SH_COEFFICIENTS]) {
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f * n.y;
+    basis[2] = 0.488603f * n.z;
+    basis[3] = 0.488603f * n.x;
+    basis[4] = 1.092548f * n.x * n.y;
+    basis[5] = 1.092548f * n.y * n.z;
+    basis[6] = 0.315392f * (3.0f * n.z * n.z - 1.0f);
+    basis[7] = 1.092548f * n.x * n.z;
+    basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+}
+
+static void project_texel(const float* face_data, int face, int face_size, int x, int y, glm::vec3 sh[NUM_SH_COEFFICIENTS], float& total_weight) {
+    float basis[NUM_SH_COEFFICIENTS];
+    float u = 2.0f * (x + 0.5f) / face_size - 1.0f;
+    float v = 2.0f * (y + 0.5f) / face_size - 1.0f;
+    float distance_squared = 1.0f + u * u + v * v;
+    float weight = 1.0f / (distance_squared * std::sqrt(distance_squared));
+    evaluate_sh_basis(glm::normalize(get_cubemap_direction(face, u, v)), basis);
+    const float* texel = face_data + 3 * (y * face_size + x);
+    glm::vec3 radiance = glm::vec3(texel[0], texel[1], texel[2]) * weight;
+    for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+        sh[i] += radiance * basis[i];
+    }
+    total_weight += weight;
+}
+
+#ifdef NEON_SH_SSE2
+static float horizontal_sum(__m128 values) {
+    __m128 shuffled = _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(values, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+// 4 texels of a row at a time. The components of the directions are +-1, +-u and +-v (see get_cubemap_direction),
+// so their length is sqrt(1 + u^2 + v^2) on every face and the solid angle weight is the cube of its inverse
+static int project_texels_sse2(const float* face_data, int face, int face_size, int y, glm::vec3 sh[NUM_SH_COEFFICIENTS], float& total_weight) {
+    __m128 sums[NUM_SH_COEFFICIENTS][3];
+    for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+        sums[i][0] = sums[i][1] = sums[i][2] = _mm_setzero_ps();
+    }
+    __m128 weight_sum = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    float scale = 2.0f / face_size;
+    __m128 v = _mm_set1_ps(2.0f * (y + 0.5f) / face_size - 1.0f);
+    int x = 0;
+    for (; x + 4 <= face_size; x += 4) {
+        __m128 u = _mm_sub_ps(_mm_mul_ps(_mm_set_ps(x + 3.5f, x + 2.5f, x + 1.5f, x + 0.5f), _mm_set1_ps(scale)), one);
+        __m128 dx, dy, dz;
+        switch (face) {
+        case 0: dx = one; dy = _mm_sub_ps(zero, v); dz = _mm_sub_ps(zero, u); break;
+        case 1: dx = _mm_sub_ps(zero, one); dy = _mm_sub_ps(zero, v); dz = u; break;
+        case 2: dx = u; dy = one; dz = v; break;
+        case 3: dx = u; dy = _mm_sub_ps(zero, one); dz = _mm_sub_ps(zero, v); break;
+        case 4: dx = u; dy = _mm_sub_ps(zero, v); dz = one; break;
+        default: dx = _mm_sub_ps(zero, u); dy = _mm_sub_ps(zero, v); dz = _mm_sub_ps(zero, one); break;
+        }
+        __m128 distance_squared = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(u, u), _mm_mul_ps(v, v)));
+        __m128 inverse_length = _mm_div_ps(one, _mm_sqrt_ps(distance_squared));
+        __m128 weight = _mm_mul_ps(inverse_length, _mm_mul_ps(inverse_length, inverse_length));
+        __m128 nx = _mm_mul_ps(dx, inverse_length);
+        __m128 ny = _mm_mul_ps(dy, inverse_length);
+        __m128 nz = _mm_mul_ps(dz, inverse_length);
+
+        __m128 basis[NUM_SH_COEFFICIENTS];
+        basis[0] = _mm_set1_ps(0.282095f);
+        basis[1] = _mm_mul_ps(_mm_set1_ps(0.488603f), ny);
+        basis[2] = _mm_mul_ps(_mm_set1_ps(0.488603f), nz);
+        basis[3] = _mm_mul_ps(_mm_set1_ps(0.488603f), nx);
+        basis[4] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(nx, ny));
+        basis[5] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(ny, nz));
+        basis[6] = _mm_mul_ps(_mm_set1_ps(0.315392f), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(nz, nz)), one));
+        basis[7] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(nx, nz));
+        basis[8] = _mm_mul_ps(_mm_set1_ps(0.546274f), _mm_sub_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)));
+
+        const float* texels = face_data + 3 * (y * face_size + x);
+        __m128 radiance[3];
+        for (int c = 0; c < 3; c++) {
+            radiance[c] = _mm_mul_ps(_mm_set_ps(texels[9 + c], texels[6 + c], texels[3 + c], texels[c]), weight);
+        }
+        for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+            for (int c = 0; c < 3; c++) {
+                sums[i][c] = _mm_add_ps(sums[i][c], _mm_mul_ps(radiance[c], basis[i]));
+            }
+        }
+        weight_sum = _mm_add_ps(weight_sum, weight);
+    }
+
+    for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+        sh[i] += glm::vec3(horizontal_sum(sums[i][0]), horizontal_sum(sums[i][1]), horizontal_sum(sums[i][2]));
+    }
+    total_weight += horizontal_sum(weight_sum);
+    return x;
+}
+#endif
+
+// Radiance of a face weighted by the solid angle of its texels, with SSE2 on x86-64
+static void project_cubemap_face(const float* face_data, int face, int face_size, glm::vec3 sh[NUM_SH_COEFFICIENTS], float& total_weight) {
+    for (int y = 0; y < face_size; y++) {
+        int x = 0;
+#ifdef NEON_SH_SSE2
+        x = project_texels_sse2(face_data, face, face_size, y, sh, total_weight);
+#endif
+        for (; x < face_size; x++) {
+            project_texel(face_data, face, face_size, x, y, sh, total_weight);
+        }
+    }
+}
+
+void project_cubemap_to_irradiance_sh(const std::vector<float>& faces, int face_size, glm::vec3 sh[NUM_SH_COEFFICIENTS]) {
+    glm::vec3 face_sh[6][NUM_SH_COEFFICIENTS];
+    float face_weights[6];
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+            face_sh[face][i] = glm::vec3(0.0f);
+        }
+        face_weights[face] = 0.0f;
+    }
+    // a face per call, on the threads of the worker pool
+    WorkerPool::get_instance()->parallel_for(6, [&faces, face_size, &face_sh, &face_weights](int face) {
+        const float* face_data = faces.data() + 3 * face * face_size * face_size;
+        project_cubemap_face(face_data, face, face_size, face_sh[face], face_weights[face]);
+    });
+
+    float total_weight = 0.0f;
+    for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+        sh[i] = glm::vec3(0.0f);
+    }
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+            sh[i] += face_sh[face][i];
+        }
+        total_weight += face_weights[face];
+    }
+
+    // the weights add up to the solid angle of the sphere (4 PI), and the convolution with the cosine lobe scales
+    // the bands by PI, 2 PI / 3 and PI / 4, which are divided by PI
+    const float band_factors[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+    const float PI = 3.14159265359f;
+    for (int i = 0; i < NUM_SH_COEFFICIENTS; i++) {
+        int band = i == 0 ? 0 : (i < 4 ? 1 : 2);
+        sh[i] *= 4.0f * PI / total_weight * band_factors[band];
+    }
+}
+
+void compute_irradiance_sh(unsigned int cubemap_texture, glm::vec3 sh[NUM_SH_COEFFICIENTS]) {
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture);
+    int width = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &width);
+    // the smallest level that is at least SH_PROJECTION_FACE_SIZE, when the cubemap has its mipmaps
+    int level = 0;
+    while ((width >> (level + 1)) >= SH_PROJECTION_FACE_SIZE) {
+        level++;
+    }
+    int level_width = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, level, GL_TEXTURE_WIDTH, &level_width);
+    if (level_width == 0) {
+        level = 0;
+        level_width = width;
+    }
+
+    std::vector<float> faces(6 * 3 * level_width * level_width);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    for (int face = 0; face < 6; face++) {
+        glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_RGB, GL_FLOAT, faces.data() + 3 * face * level_width * level_width);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    project_cubemap_to_irradiance_sh(faces, level_width, sh);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Size of the faces of the environment map mip level projected to spherical harmonics
+const int SH_PROJECTION_FACE_SIZE = 32;
+const int NUM_SH_COEFFICIENTS = 9;
+
+// Projects a cubemap (6 RGB float faces of face_size x face_size, in the order of the GL cube map faces) into the
+// 9 coefficients of the spherical harmonics up to band 2 of its diffuse irradiance, already convolved with the cosine lobe
+// and divided by PI like the irradiance map: the irradiance in a direction N is the sum of sh[i] * Y_i(N).
+// The faces are projected in parallel on the worker pool, 4 texels at a time with SSE2 on x86-64.
+void project_cubemap_to_irradiance_sh(const std::vector<float>& faces, int face_size, glm::vec3 sh[NUM_SH_COEFFICIENTS]);
+
+// GL thread. Reads back a small mip level of an environment cubemap and projects it
+void compute_irradiance_sh(unsigned int cubemap_texture, glm::vec3 sh[NUM_SH_COEFFICIENTS]);
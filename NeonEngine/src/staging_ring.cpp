@@ -0,0 +1,160 @@
+#include "staging_ring.h"
+#include "resource_registry.h"
+
+#include <iostream>
+
+StagingRing* StagingRing::instance = nullptr;
+std::mutex StagingRing::staging_ring_mutex;
+
+StagingRing* StagingRing::get_instance()
+{
+    std::lock_guard<std::mutex> lock(staging_ring_mutex);
+    if (instance == nullptr) {
+        instance = new StagingRing();
+    }
+    return instance;
+}
+
+void StagingRing::initialize(size_t size) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+    void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (data == nullptr) {
+        std::cout << "ERROR::STAGING_RING:: Failed to map the staging buffer, the textures are uploaded from client memory" << std::endl;
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        return;
+    }
+
+    ResourceRegistry::get_instance()->record(ResourceUploadBuffer, buffer, "staging_ring", size);
+
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    mapped_data = (unsigned char*)data;
+    capacity = size;
+    head = 0;
+}
+
+void StagingRing::clean() {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    for (int i = 0; i < regions.size(); i++) {
+        if (regions[i].fence) {
+            glClientWaitSync(regions[i].fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(regions[i].fence);
+        }
+    }
+    regions.clear();
+    if (buffer != 0) {
+        ResourceRegistry::get_instance()->release(ResourceUploadBuffer, buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    mapped_data = nullptr;
+    capacity = 0;
+}
+
+bool StagingRing::is_initialized() {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    return mapped_data != nullptr;
+}
+
+bool StagingRing::allocate(size_t size, StagingAllocation& allocation) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    size = (size + STAGING_ALLOCATION_ALIGNMENT - 1) / STAGING_ALLOCATION_ALIGNMENT * STAGING_ALLOCATION_ALIGNMENT;
+    if (mapped_data == nullptr || size == 0 || size > capacity) {
+        return false;
+    }
+
+    size_t offset;
+    if (regions.empty()) {
+        offset = 0;
+    }
+    else {
+        // the free space is after the head and before the oldest region
+        size_t tail = regions.front().offset;
+        if (head > tail) {
+            if (head + size <= capacity) {
+                offset = head;
+            }
+            else if (size < tail) {
+                // the end of the ring is skipped with a region that is free as soon as the regions before it are
+                regions.push_back({ head, capacity - head, nullptr, true });
+                offset = 0;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (head + size < tail) {
+            offset = head;
+        }
+        else {
+            return false;
+        }
+    }
+
+    regions.push_back({ offset, size, nullptr, false });
+    head = offset + size;
+    allocation.data = mapped_data + offset;
+    allocation.offset = offset;
+    allocation.size = size;
+    return true;
+}
+
+void StagingRing::set_region_submitted(size_t offset, GLsync fence) {
+    for (int i = 0; i < regions.size(); i++) {
+        if (regions[i].offset == offset && !regions[i].submitted) {
+            regions[i].fence = fence;
+            regions[i].submitted = true;
+            return;
+        }
+    }
+    if (fence) {
+        glDeleteSync(fence);
+    }
+}
+
+void StagingRing::discard(const StagingAllocation& allocation) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    set_region_submitted(allocation.offset, nullptr);
+}
+
+void StagingRing::bind() {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+}
+
+void StagingRing::unbind() {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void StagingRing::submit(const StagingAllocation& allocation) {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    {
+        std::lock_guard<std::mutex> lock(regions_mutex);
+        set_region_submitted(allocation.offset, fence);
+    }
+    retire_completed_uploads();
+}
+
+void StagingRing::retire_completed_uploads() {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    while (!regions.empty() && regions.front().submitted) {
+        GLsync fence = regions.front().fence;
+        if (fence) {
+            GLenum result = glClientWaitSync(fence, 0, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+                return;
+            }
+            glDeleteSync(fence);
+        }
+        regions.pop_front();
+    }
+    if (regions.empty()) {
+        head = 0;
+    }
+}
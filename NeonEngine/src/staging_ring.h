@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <mutex>
+#include <cstddef>
+
+const size_t STAGING_RING_SIZE = 128 * 1024 * 1024;
+// Offsets of the allocations, a multiple of the size of any pixel
+const size_t STAGING_ALLOCATION_ALIGNMENT = 256;
+
+// Region of the staging ring with the pixels of one upload
+struct StagingAllocation {
+    unsigned char* data = nullptr;
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+struct StagingRegion {
+    size_t offset;
+    size_t size;
+    GLsync fence;
+    bool submitted;
+};
+
+// Persistently mapped pixel unpack buffer used as a ring of upload regions. Any thread can allocate a region and write
+// the pixels of a decoded image into it; the GL thread uploads them with glTexImage2D/glTexSubImage2D from the offset
+// of the region, which returns without copying the pixels, and submit() guards the region with a fence.
+// The regions are reused in order once the GPU has read them. When the ring is full allocate() fails and the caller
+// uploads from client memory instead.
+class StagingRing {
+public:
+    static StagingRing* get_instance();
+
+    StagingRing(StagingRing& other) = delete;
+    void operator=(const StagingRing&) = delete;
+
+    // GL thread only
+    void initialize(size_t size);
+    void clean();
+    bool is_initialized();
+
+    // Any thread
+    bool allocate(size_t size, StagingAllocation& allocation);
+    // Any thread. Frees a region that won't be uploaded
+    void discard(const StagingAllocation& allocation);
+
+    // GL thread only. The upload commands read the pixels from the offset of an allocation while the ring is bound
+    void bind();
+    void unbind();
+    // GL thread only. Called after the upload commands of an allocation
+    void submit(const StagingAllocation& allocation);
+    // GL thread only. Frees the regions whose uploads the GPU has finished
+    void retire_completed_uploads();
+
+private:
+    StagingRing() {}
+
+    void set_region_submitted(size_t offset, GLsync fence);
+
+    static StagingRing* instance;
+    static std::mutex staging_ring_mutex;
+
+    unsigned int buffer = 0;
+    unsigned char* mapped_data = nullptr;
+    size_t capacity = 0;
+    size_t head = 0;
+    std::deque<StagingRegion> regions;
+    std::mutex regions_mutex;
+};
@@ -0,0 +1,197 @@
+#include "task_graph.h"
+
+#include "neon_engine.h"
+#include "logger.h"
+#include "trace_recorder.h"
+
+#include <thread>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+TaskGraph::TaskGraph(int num_worker_threads) {
+    if (num_worker_threads <= 0) {
+        // Leave one hardware thread for the main thread, which executes the GL tasks
+        num_worker_threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    }
+    this->num_worker_threads = num_worker_threads;
+    num_finished_tasks = 0;
+    num_running_tasks = 0;
+    total_time_seconds = 0.0;
+}
+
+int TaskGraph::add_task(const std::string& name, TaskQueue queue, std::function<void()> function, const std::vector<int>& dependencies) {
+    int task_id = (int)tasks.size();
+
+    Task task;
+    task.name = name;
+    task.queue = queue;
+    task.function = function;
+    task.num_pending_dependencies = 0;
+    task.thread_index = -1;
+    task.start_time_seconds = 0.0;
+    task.elapsed_time_seconds = 0.0;
+    tasks.push_back(task);
+
+    for (int i = 0; i < dependencies.size(); i++) {
+        int dependency_id = dependencies[i];
+        if (dependency_id < 0 || dependency_id >= task_id) {
+            std::cout << "ERROR::TASK_GRAPH:: Task \"" << name << "\" depends on an invalid task id: " << dependency_id << std::endl;
+            continue;
+        }
+        tasks[dependency_id].dependents.push_back(task_id);
+        tasks[task_id].num_pending_dependencies++;
+    }
+
+    return task_id;
+}
+
+void TaskGraph::execute_task(int task_id, int thread_index) {
+    Task& task = tasks[task_id];
+
+    int64_t trace_begin_us = TraceRecorder::enabled ? TraceRecorder::now_us() : -1;
+    auto begin_timer = std::chrono::high_resolution_clock::now();
+    task.function();
+    auto end_timer = std::chrono::high_resolution_clock::now();
+    if (trace_begin_us >= 0) {
+        TraceRecorder::record(TraceRecorder::get_instance()->intern(task.name), "task", trace_begin_us, TraceRecorder::now_us() - trace_begin_us);
+    }
+
+    task.thread_index = thread_index;
+    task.start_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(begin_timer - start_time).count();
+    task.elapsed_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - begin_timer).count();
+
+    // Release the tasks that were only waiting for this one
+    std::lock_guard<std::mutex> lock(task_graph_mutex);
+    for (int i = 0; i < task.dependents.size(); i++) {
+        Task& dependent = tasks[task.dependents[i]];
+        dependent.num_pending_dependencies--;
+        if (dependent.num_pending_dependencies == 0) {
+            if (dependent.queue == WorkerTask) {
+                ready_worker_tasks.push_back(task.dependents[i]);
+            }
+            else {
+                ready_main_thread_tasks.push_back(task.dependents[i]);
+            }
+        }
+    }
+    num_running_tasks--;
+    num_finished_tasks++;
+    task_graph_condition.notify_all();
+}
+
+void TaskGraph::worker_loop(int thread_index) {
+    if (TraceRecorder::enabled) {
+        TraceRecorder::set_thread_name("worker " + std::to_string(thread_index));
+    }
+    while (true) {
+        int task_id;
+        {
+            std::unique_lock<std::mutex> lock(task_graph_mutex);
+            task_graph_condition.wait(lock, [this]() {
+                return !ready_worker_tasks.empty() || num_finished_tasks == tasks.size();
+            });
+            if (ready_worker_tasks.empty()) {
+                return;
+            }
+            task_id = ready_worker_tasks.front();
+            ready_worker_tasks.pop_front();
+            num_running_tasks++;
+        }
+        execute_task(task_id, thread_index);
+    }
+}
+
+void TaskGraph::run() {
+    start_time = std::chrono::high_resolution_clock::now();
+    num_finished_tasks = 0;
+    num_running_tasks = 0;
+
+    for (int i = 0; i < tasks.size(); i++) {
+        if (tasks[i].num_pending_dependencies == 0) {
+            if (tasks[i].queue == WorkerTask) {
+                ready_worker_tasks.push_back(i);
+            }
+            else {
+                ready_main_thread_tasks.push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::thread> worker_threads;
+    for (int i = 0; i < num_worker_threads; i++) {
+        worker_threads.push_back(std::thread(&TaskGraph::worker_loop, this, i + 1));
+    }
+
+    // The main thread (index 0) only executes the tasks that need the OpenGL context
+    while (true) {
+        int task_id;
+        {
+            std::unique_lock<std::mutex> lock(task_graph_mutex);
+            task_graph_condition.wait(lock, [this]() {
+                return !ready_main_thread_tasks.empty() || num_finished_tasks == tasks.size() ||
+                       (num_running_tasks == 0 && ready_worker_tasks.empty());
+            });
+            if (ready_main_thread_tasks.empty()) {
+                if (num_finished_tasks != tasks.size()) {
+                    // Nothing is running and nothing is ready, the remaining tasks can never be executed
+                    std::cout << "ERROR::TASK_GRAPH:: Cycle in the task dependencies, " << tasks.size() - num_finished_tasks << " tasks were not executed" << std::endl;
+                    num_finished_tasks = (int)tasks.size();
+                    task_graph_condition.notify_all();
+                }
+                break;
+            }
+            task_id = ready_main_thread_tasks.front();
+            ready_main_thread_tasks.pop_front();
+            num_running_tasks++;
+        }
+        execute_task(task_id, 0);
+    }
+
+    for (int i = 0; i < worker_threads.size(); i++) {
+        worker_threads[i].join();
+    }
+
+    auto end_timer = std::chrono::high_resolution_clock::now();
+    total_time_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end_timer - start_time).count();
+}
+
+void TaskGraph::print_timing_report() {
+    NeonEngine* neon_engine = NeonEngine::get_instance();
+
+    std::vector<int> order(tasks.size());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return tasks[a].start_time_seconds < tasks[b].start_time_seconds;
+    });
+
+    double main_thread_time_seconds = 0.0;
+    double worker_time_seconds = 0.0;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "STARTUP TIMING REPORT (" << tasks.size() << " tasks, " << num_worker_threads << " worker threads):" << std::endl;
+    report << std::left << std::setw(40) << "TASK" << std::setw(8) << "QUEUE" << std::setw(8) << "THREAD"
+           << std::right << std::setw(12) << "START (s)" << std::setw(12) << "TIME (s)" << std::endl;
+    for (int i = 0; i < order.size(); i++) {
+        Task& task = tasks[order[i]];
+        report << std::left << std::setw(40) << task.name << std::setw(8) << (task.queue == WorkerTask ? "worker" : "main")
+               << std::setw(8) << task.thread_index
+               << std::right << std::setw(12) << task.start_time_seconds << std::setw(12) << task.elapsed_time_seconds << std::endl;
+        if (task.queue == WorkerTask) {
+            worker_time_seconds += task.elapsed_time_seconds;
+        }
+        else {
+            main_thread_time_seconds += task.elapsed_time_seconds;
+        }
+    }
+    report << "Total time of the main thread tasks: " << main_thread_time_seconds << " seconds" << std::endl;
+    report << "Total time of the worker tasks: " << worker_time_seconds << " seconds" << std::endl;
+    report << "Sequential time: " << main_thread_time_seconds + worker_time_seconds << " seconds, elapsed time: " << total_time_seconds << " seconds" << std::endl;
+
+    std::cout << report.str();
+    neon_engine->logger->log(report.str());
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Worker tasks run on a pool of threads (file IO, image decoding, model importing),
+// main thread tasks run on the thread that owns the OpenGL context (every GL call)
+enum TaskQueue {
+    WorkerTask,
+    MainThreadTask
+};
+
+struct Task {
+    std::string name;
+    TaskQueue queue;
+    std::function<void()> function;
+    std::vector<int> dependents;
+    int num_pending_dependencies;
+
+    // Timing data, filled when the task is executed
+    int thread_index;
+    double start_time_seconds;
+    double elapsed_time_seconds;
+};
+
+// Dependency graph of tasks. CPU work is executed in parallel by the worker threads
+// while the GL work is serialized on the calling (main) thread.
+class TaskGraph {
+public:
+    TaskGraph(int num_worker_threads = 0);
+
+    // Returns the id of the task, which can be used as a dependency of later tasks
+    int add_task(const std::string& name, TaskQueue queue, std::function<void()> function, const std::vector<int>& dependencies = {});
+    void run();
+    void print_timing_report();
+
+    int num_worker_threads;
+    double total_time_seconds;
+
+private:
+    void worker_loop(int thread_index);
+    void execute_task(int task_id, int thread_index);
+
+    std::vector<Task> tasks;
+    std::deque<int> ready_worker_tasks;
+    std::deque<int> ready_main_thread_tasks;
+    int num_finished_tasks;
+    int num_running_tasks;
+    std::mutex task_graph_mutex;
+    std::condition_variable task_graph_condition;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
+};
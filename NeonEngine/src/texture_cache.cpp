@@ -0,0 +1,653 @@
+#include "texture_cache.h"
+#include "model_cache.h"
+#include "mapped_file.h"
+#include "cooked_assets.h"
+#include "ktx2.h"
+#include "staging_ring.h"
+#include "resource_registry.h"
+#include "allocation_tracker.h"
+#include "frame_arena.h"
+#include "worker_pool.h"
+
+#include <stb_image.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+TextureCache* TextureCache::instance = nullptr;
+std::mutex TextureCache::texture_cache_mutex;
+
+TextureCache* TextureCache::get_instance()
+{
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    if (instance == nullptr) {
+        instance = new TextureCache();
+    }
+    return instance;
+}
+
+bool TextureCache::load_image(const std::string& path, ImageData& image, bool flip_vertically, const TextureSampling& sampling) {
+    if (!enabled) {
+        return load_image_data(path, image, flip_vertically);
+    }
+    MappedFile file;
+    if (!file.open(path)) {
+        // the cooked texture can exist without its source, then the hash of its contents identifies the image
+        uint64_t cooked_hash = get_use_cooked_assets() ? get_file_content_hash(get_cooked_asset_path(path, COOKED_TEXTURE_EXTENSION)) : 0;
+        if (cooked_hash != 0) {
+            return load_encoded_image((const unsigned char*)&cooked_hash, sizeof(cooked_hash), path, path, image, flip_vertically, sampling);
+        }
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return false;
+    }
+    return load_encoded_image(file.data, (int)file.size, path, path, image, flip_vertically, sampling);
+}
+
+bool TextureCache::load_image_from_memory(const unsigned char* buffer, int length_buffer, const std::string& name, ImageData& image, bool flip_vertically, const TextureSampling& sampling) {
+    if (!enabled) {
+        return load_image_data_from_memory(buffer, length_buffer, image, flip_vertically);
+    }
+    return load_encoded_image(buffer, length_buffer, name, "", image, flip_vertically, sampling);
+}
+
+// The path is only used to find the cooked texture, the pixels of an embedded image are always decoded from the buffer
+bool TextureCache::load_encoded_image(const unsigned char* buffer, int length_buffer, const std::string& source, const std::string& path, ImageData& image, bool flip_vertically, const TextureSampling& sampling) {
+    ALLOCATION_TAG(AllocAssets);
+    bool use_cooked_texture = !path.empty() && get_use_cooked_assets();
+    uint64_t key = hash_bytes(buffer, length_buffer);
+    key = hash_bytes(&flip_vertically, sizeof(flip_vertically), key);
+    key = hash_bytes(&use_cooked_texture, sizeof(use_cooked_texture), key);
+    key = hash_bytes(&sampling, sizeof(sampling), key);
+    if (key == 0) {
+        key = 1;
+    }
+
+    bool decode_image;
+    bool stream_image;
+    {
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        TextureCacheEntry& entry = entries[key];
+        entry.sampling = sampling;
+        entry.num_requests++;
+        entry.num_pending_acquires++;
+        entry.sources.insert(source);
+        // the first request decodes the image, the others wait for it
+        decode_image = entry.num_requests == 1;
+        stream_image = streaming && !use_cooked_texture;
+        if (decode_image) {
+            entry.path = path;
+            entry.flip_vertically = flip_vertically;
+            entry.use_cooked_texture = use_cooked_texture;
+            entry.streamed = stream_image;
+            if (path.empty() && (memory_budget > 0 || entry.streamed)) {
+                entry.encoded_image.assign(buffer, buffer + length_buffer);
+            }
+        }
+    }
+
+    if (decode_image && stream_image) {
+        // only the header is read here, the pixels are decoded by a reload job
+        ImageData header;
+        size_t size_in_bytes = 0;
+        if (stbi_info_from_memory(buffer, length_buffer, &header.width, &header.height, &header.num_channels)) {
+            size_in_bytes = (size_t)header.width * header.height * header.num_channels * 4 / 3;
+        }
+        else {
+            std::cout << "Texture failed to load: " << source << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        TextureCacheEntry& entry = entries[key];
+        entry.image = header;
+        entry.size_in_bytes = size_in_bytes;
+        entry.decoded = true;
+        if (size_in_bytes > 0) {
+            request_reload(key, entry, 0);
+        }
+        entry_decoded.notify_all();
+    }
+    else if (decode_image) {
+        ImageData decoded_image;
+        if (!use_cooked_texture || !load_cooked_image_data(path, decoded_image, flip_vertically)) {
+            load_image_data_from_memory(buffer, length_buffer, decoded_image, flip_vertically);
+        }
+        size_t size_in_bytes = 0;
+        if (decoded_image.cooked_texture) {
+            for (int i = 0; i < decoded_image.cooked_texture->levels.size(); i++) {
+                size_in_bytes += decoded_image.cooked_texture->levels[i].size();
+            }
+        }
+        else if (decoded_image.data) {
+            // the mip chain adds a third of the size of the base level
+            size_in_bytes = (size_t)decoded_image.width * decoded_image.height * decoded_image.num_channels * 4 / 3;
+            stage_image_data(decoded_image);
+        }
+
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        TextureCacheEntry& entry = entries[key];
+        entry.image = decoded_image;
+        entry.size_in_bytes = size_in_bytes;
+        entry.decoded = true;
+        entry_decoded.notify_all();
+    }
+
+    std::unique_lock<std::mutex> lock(entries_mutex);
+    TextureCacheEntry& entry = entries[key];
+    entry_decoded.wait(lock, [&entry]() { return entry.decoded; });
+    image.width = entry.image.width;
+    image.height = entry.image.height;
+    image.num_channels = entry.image.num_channels;
+    image.cache_key = key;
+    return entry.size_in_bytes > 0;
+}
+
+unsigned int TextureCache::acquire(uint64_t key) {
+    std::unique_lock<std::mutex> lock(entries_mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        std::cout << "ERROR::TEXTURE_CACHE:: Texture not found in the cache" << std::endl;
+        return 0;
+    }
+    TextureCacheEntry& entry = it->second;
+    entry_decoded.wait(lock, [&entry]() { return entry.decoded; });
+    entry.num_pending_acquires--;
+
+    if (entry.texture_id == 0 && entry.streamed) {
+        // the levels are uploaded by update_residency() when the image is decoded
+        glGenTextures(1, &entry.texture_id);
+        entry.width = entry.image.width;
+        entry.height = entry.image.height;
+        entry.num_levels = (int)std::floor(std::log2(std::max(std::max(entry.width, entry.height), 1))) + 1;
+        entry.first_resident_level = entry.num_levels;
+        glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.sampling.min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampling.mag_filter);
+        texture_id_to_key[entry.texture_id] = key;
+    }
+    else if (entry.texture_id == 0) {
+        // the pixels aren't needed after the upload, a texture that is deleted and requested again is decoded again
+        ImageData image = entry.image;
+        entry.image.data = nullptr;
+        entry.image.cooked_texture = nullptr;
+        entry.image.staging = nullptr;
+        entry.width = image.width;
+        entry.height = image.height;
+        if (image.cooked_texture) {
+            entry.num_levels = (int)image.cooked_texture->levels.size();
+        }
+        else {
+            entry.num_levels = (int)std::floor(std::log2(std::max(std::max(image.width, image.height), 1))) + 1;
+        }
+        entry.texture_id = upload_image_data_to_texture(image);
+
+        glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.sampling.min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampling.mag_filter);
+        texture_id_to_key[entry.texture_id] = key;
+    }
+    entry.reference_count++;
+    record_resident_size(entry);
+    return entry.texture_id;
+}
+
+void TextureCache::release(unsigned int texture_id) {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    auto it = texture_id_to_key.find(texture_id);
+    if (it == texture_id_to_key.end()) {
+        return;
+    }
+    TextureCacheEntry& entry = entries[it->second];
+    entry.reference_count--;
+    // an entry with requests still waiting for their acquire() keeps its texture
+    if (entry.reference_count <= 0 && entry.num_pending_acquires == 0) {
+        ResourceRegistry::get_instance()->release(ResourceTexture, entry.texture_id);
+        glDeleteTextures(1, &entry.texture_id);
+        free_image_data(entry.image);
+        entries.erase(it->second);
+        texture_id_to_key.erase(it);
+    }
+}
+
+bool TextureCache::is_ready(unsigned int texture_id) {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    auto it = texture_id_to_key.find(texture_id);
+    if (it == texture_id_to_key.end()) {
+        return true;
+    }
+    const TextureCacheEntry& entry = entries[it->second];
+    return entry.first_resident_level < entry.num_levels;
+}
+
+void TextureCache::mark_used(unsigned int texture_id, float screen_size) {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    auto it = texture_id_to_key.find(texture_id);
+    if (it == texture_id_to_key.end()) {
+        return;
+    }
+    TextureCacheEntry& entry = entries[it->second];
+    if (entry.last_use_frame != frame) {
+        entry.last_use_frame = frame;
+        entry.max_screen_size = screen_size;
+    }
+    else {
+        entry.max_screen_size = std::max(entry.max_screen_size, screen_size);
+    }
+}
+
+// Level whose size matches the size on screen, and the smallest level for the textures that aren't used anymore
+int TextureCache::get_needed_first_level(const TextureCacheEntry& entry) {
+    if (entry.last_use_frame < 0 || frame - entry.last_use_frame > TEXTURE_EVICTION_FRAMES) {
+        return entry.num_levels - 1;
+    }
+    float texture_size = (float)std::max(entry.width, entry.height);
+    int level = (int)std::floor(std::log2(texture_size / std::max(entry.max_screen_size, 1.0f)));
+    return std::clamp(level, 0, entry.num_levels - 1);
+}
+
+// Every level has a quarter of the size of the previous one
+size_t TextureCache::get_resident_size(const TextureCacheEntry& entry, int first_level) {
+    return entry.size_in_bytes >> (2 * first_level);
+}
+
+// The streamed textures are recorded again every time their resident levels change
+void TextureCache::record_resident_size(const TextureCacheEntry& entry) {
+    std::string owner = entry.path;
+    if (owner.empty() && !entry.sources.empty()) {
+        owner = *entry.sources.begin();
+    }
+    ResourceRegistry::get_instance()->record(ResourceTexture, entry.texture_id, owner, get_resident_size(entry, entry.first_resident_level));
+}
+
+size_t TextureCache::get_resident_size() {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    size_t resident_size = 0;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        resident_size += get_resident_size(it->second, it->second.first_resident_level);
+    }
+    return resident_size;
+}
+
+// A streamed texture keeps in memory only the levels of its mip chain that aren't resident yet
+static bool has_mip_level(const TextureCacheEntry& entry, int level) {
+    return level >= 0 && level < entry.mip_levels.size() && !entry.mip_levels[level].empty();
+}
+
+static void release_mip_levels(TextureCacheEntry& entry, int first_level) {
+    for (int level = first_level; level < entry.mip_levels.size(); level++) {
+        entry.mip_levels[level].clear();
+        entry.mip_levels[level].shrink_to_fit();
+    }
+    if (first_level == 0) {
+        entry.mip_levels.clear();
+        entry.mip_levels.shrink_to_fit();
+    }
+}
+
+// Specifies without data the levels of the bound texture from first_level of the full chain. The BCn levels of the cooked
+// textures can't be specified by glTexImage2D, they are specified with their size in bytes (nullptr for uncompressed levels)
+static void specify_empty_levels(const TextureCacheEntry& entry, int first_level, int num_levels, GLint internal_format, const GLint* compressed_sizes) {
+    for (int i = 0; i < num_levels; i++) {
+        int level_width = std::max(entry.width >> (first_level + i), 1);
+        int level_height = std::max(entry.height >> (first_level + i), 1);
+        if (compressed_sizes != nullptr) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format, level_width, level_height, 0, compressed_sizes[i], nullptr);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, i, internal_format, level_width, level_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+}
+
+// Copies the kept levels to a temporary texture and back to the levels of the smaller chain, so the texture id stays the same
+void TextureCache::drop_top_levels(TextureCacheEntry& entry, int first_level) {
+    int num_dropped_levels = first_level - entry.first_resident_level;
+    int num_kept_levels = entry.num_levels - first_level;
+    if (num_dropped_levels <= 0 || num_kept_levels <= 0) {
+        return;
+    }
+    GLint internal_format;
+    GLint compressed;
+    glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+    // sizes in bytes of the kept levels, a chain has at most 16 levels
+    GLint compressed_sizes[16] = {};
+    if (compressed) {
+        for (int i = 0; i < num_kept_levels && i < 16; i++) {
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, num_dropped_levels + i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressed_sizes[i]);
+        }
+    }
+
+    unsigned int temporary_texture;
+    glGenTextures(1, &temporary_texture);
+    glBindTexture(GL_TEXTURE_2D, temporary_texture);
+    specify_empty_levels(entry, first_level, num_kept_levels, internal_format, compressed ? compressed_sizes : nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, num_kept_levels - 1);
+    for (int i = 0; i < num_kept_levels; i++) {
+        int level_width = std::max(entry.width >> (first_level + i), 1);
+        int level_height = std::max(entry.height >> (first_level + i), 1);
+        glCopyImageSubData(entry.texture_id, GL_TEXTURE_2D, num_dropped_levels + i, 0, 0, 0, temporary_texture, GL_TEXTURE_2D, i, 0, 0, 0, level_width, level_height, 1);
+    }
+
+    // specifying the levels again with smaller sizes frees the memory of the dropped ones
+    glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+    specify_empty_levels(entry, first_level, num_kept_levels, internal_format, compressed ? compressed_sizes : nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, num_kept_levels - 1);
+    for (int i = 0; i < num_kept_levels; i++) {
+        int level_width = std::max(entry.width >> (first_level + i), 1);
+        int level_height = std::max(entry.height >> (first_level + i), 1);
+        glCopyImageSubData(temporary_texture, GL_TEXTURE_2D, i, 0, 0, 0, entry.texture_id, GL_TEXTURE_2D, i, 0, 0, 0, level_width, level_height, 1);
+    }
+    glDeleteTextures(1, &temporary_texture);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    entry.first_resident_level = first_level;
+    record_resident_size(entry);
+}
+
+// Called with entries_mutex locked
+void TextureCache::request_reload(uint64_t key, TextureCacheEntry& entry, int first_level) {
+    entry.reloading = true;
+    entry.reload_first_level = first_level;
+    num_reload_jobs++;
+    WorkerPool::get_instance()->submit([this, key]() {
+        reload_image(key);
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        num_reload_jobs--;
+        reload_jobs_finished.notify_all();
+    });
+}
+
+// Reload job (worker pool): decodes again the image of a texture that needs its dropped levels, or the image of a streamed texture
+void TextureCache::reload_image(uint64_t key) {
+    std::unique_lock<std::mutex> lock(entries_mutex);
+    if (stop_reload_jobs) {
+        return;
+    }
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    std::string path = it->second.path;
+    std::vector<unsigned char> encoded_image = it->second.encoded_image;
+    bool flip_vertically = it->second.flip_vertically;
+    bool use_cooked_texture = it->second.use_cooked_texture;
+
+    lock.unlock();
+    ImageData image;
+    if (!path.empty()) {
+        if (!use_cooked_texture || !load_cooked_image_data(path, image, flip_vertically)) {
+            load_image_data(path, image, flip_vertically);
+        }
+    }
+    else if (!encoded_image.empty()) {
+        load_image_data_from_memory(encoded_image.data(), (int)encoded_image.size(), image, flip_vertically);
+    }
+    // the levels of a streamed image are uploaded one by one from its mip chain
+    std::vector<std::vector<unsigned char>> mip_levels;
+    if (streaming && image.data) {
+        generate_mip_chain(image.data, image.width, image.height, image.num_channels, mip_levels);
+    }
+    else {
+        stage_image_data(image);
+    }
+    lock.lock();
+
+    it = entries.find(key);
+    if (it == entries.end()) {
+        free_image_data(image);
+        return;
+    }
+    if (it->second.streamed && !mip_levels.empty()) {
+        free_image_data(image);
+        it->second.mip_levels = std::move(mip_levels);
+        // the levels still resident aren't kept in memory
+        if (it->second.first_resident_level < it->second.num_levels) {
+            release_mip_levels(it->second, it->second.first_resident_level);
+        }
+        it->second.reloading = false;
+    }
+    else {
+        it->second.image = image;
+        it->second.reloaded = true;
+    }
+}
+
+void TextureCache::upload_reloaded_image(TextureCacheEntry& entry) {
+    if (entry.image.data || entry.image.cooked_texture || entry.image.staging) {
+        upload_image_data_to_texture(entry.image, entry.texture_id);
+        glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampling.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.sampling.min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampling.mag_filter);
+        entry.first_resident_level = 0;
+        drop_top_levels(entry, entry.reload_first_level);
+    }
+    entry.reloading = false;
+    entry.reloaded = false;
+}
+
+// Uploads the levels of a streamed texture from first_level that aren't resident, from its mip chain in memory, and releases them
+// from memory. The resident levels are copied to a temporary texture and back after the texture is specified again with the
+// new levels, like in drop_top_levels(), so the texture id stays the same.
+void TextureCache::upload_mip_levels(TextureCacheEntry& entry, int first_level) {
+    GLenum format;
+    if (entry.image.num_channels == 1)
+        format = GL_RED;
+    else if (entry.image.num_channels == 2)
+        format = GL_RG;
+    else if (entry.image.num_channels == 3)
+        format = GL_RGB;
+    else
+        format = GL_RGBA;
+
+    // levels already resident, until the first upload first_resident_level is num_levels
+    int first_kept_level = std::min(entry.first_resident_level, entry.num_levels);
+    int num_kept_levels = entry.num_levels - first_kept_level;
+    unsigned int temporary_texture = 0;
+    if (num_kept_levels > 0) {
+        glGenTextures(1, &temporary_texture);
+        glBindTexture(GL_TEXTURE_2D, temporary_texture);
+        for (int i = 0; i < num_kept_levels; i++) {
+            int level_width = std::max(entry.width >> (first_kept_level + i), 1);
+            int level_height = std::max(entry.height >> (first_kept_level + i), 1);
+            glTexImage2D(GL_TEXTURE_2D, i, format, level_width, level_height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, num_kept_levels - 1);
+        for (int i = 0; i < num_kept_levels; i++) {
+            int level_width = std::max(entry.width >> (first_kept_level + i), 1);
+            int level_height = std::max(entry.height >> (first_kept_level + i), 1);
+            glCopyImageSubData(entry.texture_id, GL_TEXTURE_2D, i, 0, 0, 0, temporary_texture, GL_TEXTURE_2D, i, 0, 0, 0, level_width, level_height, 1);
+        }
+    }
+
+    // the levels go through the staging ring when it has room, so the driver doesn't copy them in this thread
+    StagingRing* staging_ring = StagingRing::get_instance();
+    glBindTexture(GL_TEXTURE_2D, entry.texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = first_level; level < entry.num_levels; level++) {
+        int level_width = std::max(entry.width >> level, 1);
+        int level_height = std::max(entry.height >> level, 1);
+        if (level >= first_kept_level || !has_mip_level(entry, level)) {
+            glTexImage2D(GL_TEXTURE_2D, level - first_level, format, level_width, level_height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+            continue;
+        }
+        StagingAllocation allocation;
+        if (staging_ring->allocate(entry.mip_levels[level].size(), allocation)) {
+            std::memcpy(allocation.data, entry.mip_levels[level].data(), entry.mip_levels[level].size());
+            staging_ring->bind();
+            glTexImage2D(GL_TEXTURE_2D, level - first_level, format, level_width, level_height, 0, format, GL_UNSIGNED_BYTE, (void*)allocation.offset);
+            staging_ring->unbind();
+            staging_ring->submit(allocation);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, level - first_level, format, level_width, level_height, 0, format, GL_UNSIGNED_BYTE, entry.mip_levels[level].data());
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.num_levels - 1 - first_level);
+    for (int i = 0; i < num_kept_levels; i++) {
+        int level_width = std::max(entry.width >> (first_kept_level + i), 1);
+        int level_height = std::max(entry.height >> (first_kept_level + i), 1);
+        glCopyImageSubData(temporary_texture, GL_TEXTURE_2D, i, 0, 0, 0, entry.texture_id, GL_TEXTURE_2D, first_kept_level - first_level + i, 0, 0, 0, level_width, level_height, 1);
+    }
+    if (temporary_texture != 0) {
+        glDeleteTextures(1, &temporary_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    entry.first_resident_level = first_level;
+    record_resident_size(entry);
+
+    // the uploaded levels are in the texture, only the finer ones stay in memory
+    release_mip_levels(entry, first_level);
+}
+
+// Uploads the first levels of the textures that were just decoded, and one more level of the textures that
+// need finer levels on screen (if they fit in the budget). Returns the resident size after the uploads.
+size_t TextureCache::stream_mip_levels() {
+    size_t resident_size = 0;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        resident_size += get_resident_size(it->second, it->second.first_resident_level);
+    }
+
+    size_t uploaded_bytes = 0;
+    for (auto it = entries.begin(); it != entries.end() && uploaded_bytes < STREAMING_UPLOAD_BYTES_PER_FRAME; it++) {
+        TextureCacheEntry& entry = it->second;
+        if (entry.mip_levels.empty() || entry.texture_id == 0) {
+            continue;
+        }
+        int first_level;
+        if (entry.first_resident_level >= entry.num_levels) {
+            int coarse_level = (int)std::floor(std::log2(std::max(std::max(entry.width, entry.height), 1) / (float)STREAMING_FIRST_LEVEL_SIZE));
+            first_level = std::clamp(coarse_level, 0, entry.num_levels - 1);
+        }
+        else if (get_needed_first_level(entry) < entry.first_resident_level) {
+            first_level = entry.first_resident_level - 1;
+        }
+        else {
+            continue;
+        }
+        // the levels dropped after their upload are reloaded by update_residency()
+        if (!has_mip_level(entry, first_level)) {
+            continue;
+        }
+        size_t new_resident_size = resident_size - get_resident_size(entry, entry.first_resident_level) + get_resident_size(entry, first_level);
+        bool is_first_upload = entry.first_resident_level >= entry.num_levels;
+        if (memory_budget > 0 && new_resident_size > memory_budget && !is_first_upload) {
+            continue;
+        }
+        uploaded_bytes += get_resident_size(entry, first_level);
+        resident_size = new_resident_size;
+        upload_mip_levels(entry, first_level);
+    }
+    return resident_size;
+}
+
+void TextureCache::update_residency() {
+    StagingRing::get_instance()->retire_completed_uploads();
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    int num_changes = 0;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        if (it->second.reloaded && num_changes < MAX_RESIDENCY_CHANGES_PER_FRAME) {
+            upload_reloaded_image(it->second);
+            num_changes++;
+        }
+    }
+    size_t resident_size = stream_mip_levels();
+
+    FrameVector<std::pair<uint64_t, TextureCacheEntry*>> resident_entries;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        TextureCacheEntry& entry = it->second;
+        if (entry.texture_id != 0 && !entry.reloading && entry.first_resident_level < entry.num_levels) {
+            resident_entries.push_back(std::make_pair(it->first, &entry));
+        }
+    }
+
+    if (memory_budget > 0 && resident_size > memory_budget) {
+        // least recently used first, each one down to the level it needs, and then one more level each while it's over the budget
+        std::sort(resident_entries.begin(), resident_entries.end(), [](const std::pair<uint64_t, TextureCacheEntry*>& a, const std::pair<uint64_t, TextureCacheEntry*>& b) {
+            return a.second->last_use_frame < b.second->last_use_frame;
+        });
+        for (int pass = 0; pass < 2 && resident_size > memory_budget; pass++) {
+            for (int i = 0; i < resident_entries.size() && resident_size > memory_budget && num_changes < MAX_RESIDENCY_CHANGES_PER_FRAME; i++) {
+                TextureCacheEntry& entry = *resident_entries[i].second;
+                int first_level = get_needed_first_level(entry);
+                if (pass == 1) {
+                    first_level = std::min(entry.first_resident_level + 1, entry.num_levels - 1);
+                }
+                if (first_level > entry.first_resident_level) {
+                    resident_size -= get_resident_size(entry, entry.first_resident_level) - get_resident_size(entry, first_level);
+                    drop_top_levels(entry, first_level);
+                    num_changes++;
+                }
+            }
+        }
+    }
+    else if (memory_budget > 0) {
+        // the largest textures on screen first, when the levels they need fit in the budget
+        std::sort(resident_entries.begin(), resident_entries.end(), [](const std::pair<uint64_t, TextureCacheEntry*>& a, const std::pair<uint64_t, TextureCacheEntry*>& b) {
+            return a.second->max_screen_size > b.second->max_screen_size;
+        });
+        for (int i = 0; i < resident_entries.size() && num_changes < MAX_RESIDENCY_CHANGES_PER_FRAME; i++) {
+            TextureCacheEntry& entry = *resident_entries[i].second;
+            int first_level = get_needed_first_level(entry);
+            // the textures with their next level in memory get their levels from stream_mip_levels()
+            if (entry.last_use_frame != frame || first_level >= entry.first_resident_level || has_mip_level(entry, entry.first_resident_level - 1)) {
+                continue;
+            }
+            size_t new_resident_size = resident_size - get_resident_size(entry, entry.first_resident_level) + get_resident_size(entry, first_level);
+            if (new_resident_size <= memory_budget) {
+                resident_size = new_resident_size;
+                request_reload(resident_entries[i].first, entry, first_level);
+                num_changes++;
+            }
+        }
+    }
+    frame++;
+}
+
+void TextureCache::clean() {
+    std::unique_lock<std::mutex> lock(entries_mutex);
+    stop_reload_jobs = true;
+    // the queued jobs return without decoding
+    reload_jobs_finished.wait(lock, [this]() { return num_reload_jobs == 0; });
+}
+
+void TextureCache::print_report() {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    int num_requests = 0;
+    int num_shared_textures = 0;
+    size_t saved_bytes = 0;
+    std::cout << "TEXTURE CACHE:" << std::endl;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        const TextureCacheEntry& entry = it->second;
+        num_requests += entry.num_requests;
+        if (entry.num_requests > 1) {
+            num_shared_textures++;
+            saved_bytes += entry.size_in_bytes * (entry.num_requests - 1);
+            std::cout << "Shared " << entry.num_requests << " times:";
+            for (auto source = entry.sources.begin(); source != entry.sources.end(); source++) {
+                std::cout << " " << *source;
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::cout << num_requests << " requests, " << entries.size() << " unique textures, " << num_shared_textures << " shared, "
+        << saved_bytes / (1024 * 1024) << " MB saved" << std::endl;
+    if (memory_budget > 0) {
+        size_t resident_size = 0;
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            resident_size += get_resident_size(it->second, it->second.first_resident_level);
+        }
+        std::cout << "Resident " << resident_size / (1024 * 1024) << " MB of a budget of " << memory_budget / (1024 * 1024) << " MB" << std::endl;
+    }
+}
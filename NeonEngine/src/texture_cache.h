@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+
+#include "opengl_utils.h"
+
+// Sampler state of a cached texture, two textures with the same image but different sampling aren't shared
+struct TextureSampling {
+    GLint wrap = GL_REPEAT;
+    GLint min_filter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint mag_filter = GL_LINEAR;
+};
+
+struct TextureCacheEntry {
+    bool decoded = false;
+    ImageData image;
+    TextureSampling sampling;
+    unsigned int texture_id = 0;
+    int reference_count = 0;
+    int num_requests = 0;
+    // requests whose image hasn't been acquired yet, the entry isn't removed until they are
+    int num_pending_acquires = 0;
+    size_t size_in_bytes = 0;
+    // Paths (or names of the embedded images) that resolved to this entry
+    std::set<std::string> sources;
+
+    // Residency: the texture keeps the levels from first_resident_level of its full mip chain
+    int width = 0;
+    int height = 0;
+    int num_levels = 1;
+    int first_resident_level = 0;
+    int last_use_frame = -1;
+    // Largest size in pixels on screen of the objects that used the texture in its last frame of use
+    float max_screen_size = 0.0f;
+    // A reload brings back the full mip chain and then keeps the levels from reload_first_level
+    bool reloading = false;
+    bool reloaded = false;
+    int reload_first_level = 0;
+    // Source to decode the image again: the file, or a copy of the bytes of an embedded image (only kept with a memory budget)
+    std::string path;
+    std::vector<unsigned char> encoded_image;
+    bool flip_vertically = false;
+    bool use_cooked_texture = false;
+
+    // Streaming: the image is decoded in the background and its mip chain is uploaded from the coarse levels
+    // to the finest level needed on screen. Until the first levels are uploaded first_resident_level is num_levels.
+    // mip_levels keeps the levels of the chain that aren't resident yet, each one is released once it's uploaded
+    bool streamed = false;
+    std::vector<std::vector<unsigned char>> mip_levels;
+};
+
+// Frames without use after which a texture is evicted (only its smallest level stays) when the memory is over the budget
+const int TEXTURE_EVICTION_FRAMES = 600;
+// Textures whose levels are dropped or reloaded in one frame
+const int MAX_RESIDENCY_CHANGES_PER_FRAME = 8;
+// Size of the first level uploaded of a streamed texture, and bytes of finer levels uploaded per frame
+const int STREAMING_FIRST_LEVEL_SIZE = 64;
+const size_t STREAMING_UPLOAD_BYTES_PER_FRAME = 16 * 1024 * 1024;
+
+// Process-wide cache of the LDR textures of models and materials, keyed by the hash of the encoded image bytes,
+// the vertical flip and the sampling. The same image referenced by several models (or by a model and a material)
+// is decoded once, in the first thread that requests it, and uploaded once, by the first acquire() in the GL thread.
+// The textures are reference counted: every acquire() must be paired with a release() of the texture id.
+// With a memory budget the cache also manages their residency: when the textures go over the budget, the unused ones
+// are evicted and the top mips that are finer than what is seen on screen are dropped (least recently used first),
+// and when there is room again the dropped levels are decoded by jobs of the worker pool and uploaded. Texture ids never change.
+// With streaming the source images (not the cooked ones, which already have their mipmaps) are decoded by those jobs too,
+// in parallel: their textures exist from the start and they get their levels progressively, see is_ready().
+class TextureCache {
+public:
+    static TextureCache* get_instance();
+
+    TextureCache(TextureCache& other) = delete;
+    void operator=(const TextureCache&) = delete;
+
+    // Decoding (any thread). On success the image has its size and number of channels and the key of the cache entry
+    // instead of the pixels, which stay in the cache until upload_image_data_to_texture() acquires the entry.
+    bool load_image(const std::string& path, ImageData& image, bool flip_vertically, const TextureSampling& sampling = TextureSampling());
+    bool load_image_from_memory(const unsigned char* buffer, int length_buffer, const std::string& name, ImageData& image, bool flip_vertically, const TextureSampling& sampling = TextureSampling());
+
+    // GL thread only. Returns the texture of an entry, uploading it the first time, and adds a reference to it
+    unsigned int acquire(uint64_t key);
+    // GL thread only. Removes a reference of a texture returned by acquire(), the texture is deleted with the last one
+    void release(unsigned int texture_id);
+
+    // False for a streamed texture that has no levels yet, the materials draw without it
+    bool is_ready(unsigned int texture_id);
+    // GL thread only. Records that a texture is drawn this frame on an object of screen_size pixels
+    void mark_used(unsigned int texture_id, float screen_size);
+    // GL thread only, once per frame. Drops, evicts and reloads the levels of the textures to stay under the budget
+    void update_residency();
+    size_t get_resident_size();
+    // Waits for the reload jobs, the queued ones don't decode
+    void clean();
+
+    // Prints the images that were requested more than once and the memory that the sharing saved
+    void print_report();
+
+    // With the cache disabled the images are decoded directly (the asset cooker needs the pixels of every image)
+    bool enabled = true;
+    // Budget in bytes of the memory of the cached textures, 0 for no budget (nothing is dropped or evicted). The streamed
+    // textures only get the levels needed on screen, with or without a budget
+    size_t memory_budget = 0;
+    bool streaming = true;
+
+private:
+    TextureCache() {}
+
+    bool load_encoded_image(const unsigned char* buffer, int length_buffer, const std::string& source, const std::string& path, ImageData& image, bool flip_vertically, const TextureSampling& sampling);
+    int get_needed_first_level(const TextureCacheEntry& entry);
+    size_t get_resident_size(const TextureCacheEntry& entry, int first_level);
+    void record_resident_size(const TextureCacheEntry& entry);
+    void drop_top_levels(TextureCacheEntry& entry, int first_level);
+    void request_reload(uint64_t key, TextureCacheEntry& entry, int first_level);
+    void upload_reloaded_image(TextureCacheEntry& entry);
+    void upload_mip_levels(TextureCacheEntry& entry, int first_level);
+    size_t stream_mip_levels();
+    void reload_image(uint64_t key);
+
+    static TextureCache* instance;
+    static std::mutex texture_cache_mutex;
+
+    std::map<uint64_t, TextureCacheEntry> entries;
+    std::map<unsigned int, uint64_t> texture_id_to_key;
+    std::mutex entries_mutex;
+    std::condition_variable entry_decoded;
+
+    int frame = 0;
+    int num_reload_jobs = 0;
+    std::condition_variable reload_jobs_finished;
+    bool stop_reload_jobs = false;
+};
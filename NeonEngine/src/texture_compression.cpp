@@ -0,0 +1,466 @@
+#include "texture_compression.h"
+
+#include "ktx2.h"
+
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+// Interpolation weights of the 4 bits indices of BC7
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+// Endpoint refinement passes of the BC1 and BC7 encoders
+const int NUM_REFINEMENT_ITERATIONS = 3;
+
+// Reads a 4x4 block as RGBA, gray images are expanded to RGB
+static void read_block(const unsigned char* data, int width, int height, int num_channels, int block_x, int block_y, unsigned char block[16][4]) {
+    for (int y = 0; y < 4; y++) {
+        int pixel_y = std::min(block_y * 4 + y, height - 1);
+        for (int x = 0; x < 4; x++) {
+            int pixel_x = std::min(block_x * 4 + x, width - 1);
+            const unsigned char* pixel = data + ((size_t)pixel_y * width + pixel_x) * num_channels;
+            unsigned char* texel = block[y * 4 + x];
+            if (num_channels <= 2) {
+                texel[0] = texel[1] = texel[2] = pixel[0];
+                texel[3] = num_channels == 2 ? pixel[1] : 255;
+            }
+            else {
+                texel[0] = pixel[0];
+                texel[1] = pixel[1];
+                texel[2] = pixel[2];
+                texel[3] = num_channels == 4 ? pixel[3] : 255;
+            }
+        }
+    }
+}
+
+static float clamp_color(float value) {
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+// Principal axis of the points, power iteration over their covariance matrix
+static void compute_principal_axis(const float points[16][4], int num_components, float mean[4], float axis[4]) {
+    for (int c = 0; c < 4; c++) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < num_components; c++) {
+            mean[c] += points[i][c] / 16.0f;
+        }
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int a = 0; a < num_components; a++) {
+            for (int b = 0; b < num_components; b++) {
+                covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+            }
+        }
+    }
+
+    // start from the component with the largest variance
+    int largest = 0;
+    for (int c = 1; c < num_components; c++) {
+        if (covariance[c][c] > covariance[largest][largest]) {
+            largest = c;
+        }
+    }
+    axis[largest] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next_axis[4] = {};
+        float max_component = 0.0f;
+        for (int a = 0; a < num_components; a++) {
+            for (int b = 0; b < num_components; b++) {
+                next_axis[a] += covariance[a][b] * axis[b];
+            }
+            max_component = std::max(max_component, std::abs(next_axis[a]));
+        }
+        if (max_component < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < num_components; c++) {
+            axis[c] = next_axis[c] / max_component;
+        }
+    }
+    float length = 0.0f;
+    for (int c = 0; c < num_components; c++) {
+        length += axis[c] * axis[c];
+    }
+    length = std::sqrt(length);
+    for (int c = 0; c < num_components; c++) {
+        axis[c] /= length;
+    }
+}
+
+// Endpoints at the extremes of the projection of the points on their principal axis
+static void compute_initial_endpoints(const float points[16][4], int num_components, float endpoint0[4], float endpoint1[4]) {
+    float mean[4], axis[4];
+    compute_principal_axis(points, num_components, mean, axis);
+    float min_t = 0.0f, max_t = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < num_components; c++) {
+            t += (points[i][c] - mean[c]) * axis[c];
+        }
+        min_t = std::min(min_t, t);
+        max_t = std::max(max_t, t);
+    }
+    for (int c = 0; c < 4; c++) {
+        endpoint0[c] = clamp_color(mean[c] + max_t * axis[c]);
+        endpoint1[c] = clamp_color(mean[c] + min_t * axis[c]);
+    }
+}
+
+// Least squares endpoints for points interpolated with the given weights (0 is endpoint0 and 1 is endpoint1)
+static bool fit_endpoints(const float points[16][4], const float weights[16], int num_components, float endpoint0[4], float endpoint1[4]) {
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float d0[4] = {}, d1[4] = {};
+    for (int i = 0; i < 16; i++) {
+        float w = weights[i];
+        a += (1.0f - w) * (1.0f - w);
+        b += (1.0f - w) * w;
+        c += w * w;
+        for (int k = 0; k < num_components; k++) {
+            d0[k] += (1.0f - w) * points[i][k];
+            d1[k] += w * points[i][k];
+        }
+    }
+    float determinant = a * c - b * b;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (int k = 0; k < num_components; k++) {
+        endpoint0[k] = clamp_color((c * d0[k] - b * d1[k]) / determinant);
+        endpoint1[k] = clamp_color((a * d1[k] - b * d0[k]) / determinant);
+    }
+    return true;
+}
+
+static uint16_t pack_565(const float color[4]) {
+    int r = (int)std::lround(color[0] * 31.0f / 255.0f);
+    int g = (int)std::lround(color[1] * 63.0f / 255.0f);
+    int b = (int)std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(uint16_t packed, int color[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Opaque BC1 block (4 colors mode), also the color part of BC3
+static void encode_bc1_block(const unsigned char block[16][4], unsigned char* output) {
+    // weight of color1 for each index of the 4 colors mode
+    const float INDEX_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    float points[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            points[i][c] = c < 3 ? block[i][c] : 0.0f;
+        }
+    }
+    float endpoint0[4], endpoint1[4];
+    compute_initial_endpoints(points, 3, endpoint0, endpoint1);
+
+    uint16_t best_color0 = 0, best_color1 = 0;
+    uint32_t best_indices = 0;
+    int best_error = INT_MAX;
+    for (int iteration = 0; iteration < NUM_REFINEMENT_ITERATIONS; iteration++) {
+        uint16_t color0 = pack_565(endpoint0);
+        uint16_t color1 = pack_565(endpoint1);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        uint32_t indices = 0;
+        int error = 0;
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            int best_index = 0;
+            int best_pixel_error = INT_MAX;
+            // with equal colors only the first entry is valid
+            int num_entries = color0 == color1 ? 1 : 4;
+            for (int j = 0; j < num_entries; j++) {
+                int pixel_error = 0;
+                for (int c = 0; c < 3; c++) {
+                    int difference = palette[j][c] - block[i][c];
+                    pixel_error += difference * difference;
+                }
+                if (pixel_error < best_pixel_error) {
+                    best_pixel_error = pixel_error;
+                    best_index = j;
+                }
+            }
+            indices |= (uint32_t)best_index << (2 * i);
+            weights[i] = INDEX_WEIGHTS[best_index];
+            error += best_pixel_error;
+        }
+        if (error < best_error) {
+            best_error = error;
+            best_color0 = color0;
+            best_color1 = color1;
+            best_indices = indices;
+        }
+        if (error == 0 || !fit_endpoints(points, weights, 3, endpoint0, endpoint1)) {
+            break;
+        }
+    }
+
+    output[0] = best_color0 & 0xFF;
+    output[1] = best_color0 >> 8;
+    output[2] = best_color1 & 0xFF;
+    output[3] = best_color1 >> 8;
+    for (int i = 0; i < 4; i++) {
+        output[4 + i] = (best_indices >> (8 * i)) & 0xFF;
+    }
+}
+
+// Single channel block with 8 interpolated values, used by BC4, BC5 and the alpha of BC3
+static void encode_bc4_block(const unsigned char values[16], unsigned char* output) {
+    int min_value = 255, max_value = 0;
+    for (int i = 0; i < 16; i++) {
+        min_value = std::min(min_value, (int)values[i]);
+        max_value = std::max(max_value, (int)values[i]);
+    }
+    int palette[8];
+    palette[0] = max_value;
+    palette[1] = min_value;
+    for (int i = 1; i < 7; i++) {
+        palette[i + 1] = ((7 - i) * max_value + i * min_value + 3) / 7;
+    }
+
+    uint64_t indices = 0;
+    if (max_value != min_value) {
+        for (int i = 0; i < 16; i++) {
+            int best_index = 0;
+            int best_error = INT_MAX;
+            for (int j = 0; j < 8; j++) {
+                int error = std::abs(palette[j] - values[i]);
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = j;
+                }
+            }
+            indices |= (uint64_t)best_index << (3 * i);
+        }
+    }
+
+    output[0] = (unsigned char)max_value;
+    output[1] = (unsigned char)min_value;
+    for (int i = 0; i < 6; i++) {
+        output[2 + i] = (indices >> (8 * i)) & 0xFF;
+    }
+}
+
+// 7 bits per channel and a p-bit (lowest bit of the 8 bits value) shared by the 4 channels of an endpoint
+static void quantize_bc7_endpoint(const float endpoint[4], int quantized[4], int& p_bit) {
+    float best_error = 1e30f;
+    for (int p = 0; p < 2; p++) {
+        int candidate[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            candidate[c] = std::min(std::max((int)std::lround((endpoint[c] - p) / 2.0f), 0), 127);
+            float difference = (float)((candidate[c] << 1) | p) - endpoint[c];
+            error += difference * difference;
+        }
+        if (error < best_error) {
+            best_error = error;
+            p_bit = p;
+            for (int c = 0; c < 4; c++) {
+                quantized[c] = candidate[c];
+            }
+        }
+    }
+}
+
+// Writes the bits of a block from the least significant bit of the first byte
+struct BlockBitWriter {
+    unsigned char* output;
+    int position;
+
+    void write(uint32_t value, int num_bits) {
+        for (int i = 0; i < num_bits; i++, position++) {
+            if ((value >> i) & 1) {
+                output[position / 8] |= 1 << (position % 8);
+            }
+        }
+    }
+};
+
+// BC7 mode 6: a single subset with RGBA endpoints and 16 interpolated colors
+static void encode_bc7_block(const unsigned char block[16][4], unsigned char* output) {
+    float points[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            points[i][c] = block[i][c];
+        }
+    }
+    float endpoint0[4], endpoint1[4];
+    compute_initial_endpoints(points, 4, endpoint0, endpoint1);
+
+    int best_endpoints[2][4] = {};
+    int best_p_bits[2] = {};
+    int best_indices[16] = {};
+    int best_error = INT_MAX;
+    for (int iteration = 0; iteration < NUM_REFINEMENT_ITERATIONS; iteration++) {
+        int quantized[2][4];
+        int p_bits[2];
+        quantize_bc7_endpoint(endpoint0, quantized[0], p_bits[0]);
+        quantize_bc7_endpoint(endpoint1, quantized[1], p_bits[1]);
+        int palette[16][4];
+        for (int c = 0; c < 4; c++) {
+            int value0 = (quantized[0][c] << 1) | p_bits[0];
+            int value1 = (quantized[1][c] << 1) | p_bits[1];
+            for (int j = 0; j < 16; j++) {
+                palette[j][c] = ((64 - BC7_WEIGHTS[j]) * value0 + BC7_WEIGHTS[j] * value1 + 32) >> 6;
+            }
+        }
+
+        int indices[16];
+        int error = 0;
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            int best_index = 0;
+            int best_pixel_error = INT_MAX;
+            for (int j = 0; j < 16; j++) {
+                int pixel_error = 0;
+                for (int c = 0; c < 4; c++) {
+                    int difference = palette[j][c] - block[i][c];
+                    pixel_error += difference * difference;
+                }
+                if (pixel_error < best_pixel_error) {
+                    best_pixel_error = pixel_error;
+                    best_index = j;
+                }
+            }
+            indices[i] = best_index;
+            weights[i] = BC7_WEIGHTS[best_index] / 64.0f;
+            error += best_pixel_error;
+        }
+        if (error < best_error) {
+            best_error = error;
+            for (int e = 0; e < 2; e++) {
+                best_p_bits[e] = p_bits[e];
+                for (int c = 0; c < 4; c++) {
+                    best_endpoints[e][c] = quantized[e][c];
+                }
+            }
+            for (int i = 0; i < 16; i++) {
+                best_indices[i] = indices[i];
+            }
+        }
+        if (error == 0 || !fit_endpoints(points, weights, 4, endpoint0, endpoint1)) {
+            break;
+        }
+    }
+
+    // the most significant bit of the first index is implicitly 0, the endpoints are swapped when it isn't
+    if (best_indices[0] & 8) {
+        for (int c = 0; c < 4; c++) {
+            std::swap(best_endpoints[0][c], best_endpoints[1][c]);
+        }
+        std::swap(best_p_bits[0], best_p_bits[1]);
+        for (int i = 0; i < 16; i++) {
+            best_indices[i] = 15 - best_indices[i];
+        }
+    }
+
+    std::fill(output, output + 16, 0);
+    BlockBitWriter writer = { output, 0 };
+    writer.write(1 << 6, 7); // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.write(best_endpoints[0][c], 7);
+        writer.write(best_endpoints[1][c], 7);
+    }
+    writer.write(best_p_bits[0], 1);
+    writer.write(best_p_bits[1], 1);
+    for (int i = 0; i < 16; i++) {
+        writer.write(best_indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+uint32_t choose_compressed_format(const unsigned char* data, int width, int height, int num_channels, bool is_normal_map, bool prefer_small_size) {
+    if (is_normal_map && num_channels >= 3) {
+        return KTX2_FORMAT_BC5_UNORM_BLOCK;
+    }
+    bool is_grayscale = true;
+    bool has_alpha = false;
+    size_t num_pixels = (size_t)width * height;
+    for (size_t i = 0; i < num_pixels; i++) {
+        const unsigned char* pixel = data + i * num_channels;
+        if (num_channels >= 3 && (pixel[0] != pixel[1] || pixel[0] != pixel[2])) {
+            is_grayscale = false;
+        }
+        if ((num_channels == 2 || num_channels == 4) && pixel[num_channels - 1] != 255) {
+            has_alpha = true;
+        }
+    }
+    if (is_grayscale && !has_alpha) {
+        return KTX2_FORMAT_BC4_UNORM_BLOCK;
+    }
+    if (prefer_small_size) {
+        return has_alpha ? KTX2_FORMAT_BC3_UNORM_BLOCK : KTX2_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+    return KTX2_FORMAT_BC7_UNORM_BLOCK;
+}
+
+bool compress_image(const unsigned char* data, int width, int height, int num_channels, uint32_t format, std::vector<unsigned char>& output) {
+    int bytes_per_block;
+    if (format == KTX2_FORMAT_BC1_RGB_UNORM_BLOCK || format == KTX2_FORMAT_BC4_UNORM_BLOCK) {
+        bytes_per_block = 8;
+    }
+    else if (format == KTX2_FORMAT_BC3_UNORM_BLOCK || format == KTX2_FORMAT_BC5_UNORM_BLOCK || format == KTX2_FORMAT_BC7_UNORM_BLOCK) {
+        bytes_per_block = 16;
+    }
+    else {
+        return false;
+    }
+
+    int num_blocks_x = (width + 3) / 4;
+    int num_blocks_y = (height + 3) / 4;
+    size_t offset = output.size();
+    output.resize(offset + (size_t)num_blocks_x * num_blocks_y * bytes_per_block);
+    unsigned char block[16][4];
+    unsigned char channel[16];
+    for (int block_y = 0; block_y < num_blocks_y; block_y++) {
+        for (int block_x = 0; block_x < num_blocks_x; block_x++) {
+            read_block(data, width, height, num_channels, block_x, block_y, block);
+            unsigned char* block_output = output.data() + offset;
+            offset += bytes_per_block;
+
+            if (format == KTX2_FORMAT_BC1_RGB_UNORM_BLOCK) {
+                encode_bc1_block(block, block_output);
+            }
+            else if (format == KTX2_FORMAT_BC3_UNORM_BLOCK) {
+                for (int i = 0; i < 16; i++) {
+                    channel[i] = block[i][3];
+                }
+                encode_bc4_block(channel, block_output);
+                encode_bc1_block(block, block_output + 8);
+            }
+            else if (format == KTX2_FORMAT_BC4_UNORM_BLOCK || format == KTX2_FORMAT_BC5_UNORM_BLOCK) {
+                int num_block_channels = format == KTX2_FORMAT_BC4_UNORM_BLOCK ? 1 : 2;
+                for (int c = 0; c < num_block_channels; c++) {
+                    for (int i = 0; i < 16; i++) {
+                        channel[i] = block[i][c];
+                    }
+                    encode_bc4_block(channel, block_output + 8 * c);
+                }
+            }
+            else {
+                encode_bc7_block(block, block_output);
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// CPU encoder of the BCn block compressed formats, used by the asset cooker to write compressed KTX2 textures.
+// The images have 1 (gray), 2 (gray, alpha), 3 (RGB) or 4 (RGBA) channels of 8 bits, like the ones decoded by stb_image.
+// BC4 stores the first channel, BC5 the first two channels of a RGB image (x and y of a normal map) and
+// BC1, BC3 and BC7 (mode 6 only) the color. Blocks crossing the right or bottom edge repeat the last row and column.
+
+// Format for an image: BC4 for single channel and grayscale images, BC5 for normal maps, and for color images
+// BC7 or, with prefer_small_size, BC1 (opaque) and BC3 (with alpha)
+uint32_t choose_compressed_format(const unsigned char* data, int width, int height, int num_channels, bool is_normal_map, bool prefer_small_size);
+// Appends the compressed blocks of an image to output, returns false for a format that isn't a BCn format
+bool compress_image(const unsigned char* data, int width, int height, int num_channels, uint32_t format, std::vector<unsigned char>& output);
@@ -0,0 +1,164 @@
+#include "trace_recorder.h"
+#include "sampling_profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+TraceRecorder* TraceRecorder::instance = nullptr;
+std::mutex TraceRecorder::trace_recorder_mutex;
+std::atomic<bool> TraceRecorder::enabled(false);
+
+// Returns the buffer of the thread when it exits
+struct ThreadBufferOwner {
+    TraceBuffer* buffer = nullptr;
+    ~ThreadBufferOwner() {
+        if (buffer != nullptr) {
+            TraceRecorder::get_instance()->release_buffer(buffer);
+        }
+    }
+};
+
+static thread_local ThreadBufferOwner thread_buffer;
+static const auto process_start_time = std::chrono::steady_clock::now();
+
+TraceRecorder* TraceRecorder::get_instance()
+{
+    std::lock_guard<std::mutex> lock(trace_recorder_mutex);
+    if (instance == nullptr) {
+        instance = new TraceRecorder();
+    }
+    return instance;
+}
+
+int64_t TraceRecorder::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - process_start_time).count();
+}
+
+void TraceRecorder::record(const char* name, const char* category, int64_t begin_us, int64_t duration_us) {
+    record(get_thread_buffer(), name, category, begin_us, duration_us);
+}
+
+void TraceRecorder::set_thread_name(const std::string& name) {
+    // a thread named before recording gets the buffer of an exited thread of the same name, on the same track
+    if (thread_buffer.buffer == nullptr) {
+        thread_buffer.buffer = get_instance()->acquire_buffer(name);
+    }
+    else {
+        TraceBuffer* buffer = thread_buffer.buffer;
+        std::lock_guard<std::mutex> lock(buffer->events_mutex);
+        buffer->name = name;
+        buffer->named = true;
+    }
+    SamplingProfiler::get_instance()->set_thread_name(name);
+}
+
+const char* TraceRecorder::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    return interned_names.insert(name).first->c_str();
+}
+
+TraceBuffer* TraceRecorder::create_track(const std::string& name) {
+    return add_buffer(name);
+}
+
+void TraceRecorder::record(TraceBuffer* buffer, const char* name, const char* category, int64_t begin_us, int64_t duration_us) {
+    std::lock_guard<std::mutex> lock(buffer->events_mutex);
+    // the ring is allocated with the first event, the threads that never record don't use memory
+    if (buffer->events.empty()) {
+        buffer->events.resize(TRACE_BUFFER_EVENTS);
+    }
+    buffer->events[buffer->num_recorded % TRACE_BUFFER_EVENTS] = { name, category, begin_us, duration_us };
+    buffer->num_recorded++;
+}
+
+TraceBuffer* TraceRecorder::get_thread_buffer() {
+    if (thread_buffer.buffer == nullptr) {
+        thread_buffer.buffer = get_instance()->acquire_buffer("");
+    }
+    return thread_buffer.buffer;
+}
+
+TraceBuffer* TraceRecorder::add_buffer(const std::string& name) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    return add_buffer_locked(name);
+}
+
+TraceBuffer* TraceRecorder::add_buffer_locked(const std::string& name) {
+    std::unique_ptr<TraceBuffer> buffer = std::make_unique<TraceBuffer>();
+    buffer->id = buffers.size() + 1;
+    buffer->name = name.empty() ? "thread " + std::to_string(buffer->id) : name;
+    buffer->named = !name.empty();
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+}
+
+TraceBuffer* TraceRecorder::acquire_buffer(const std::string& name) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    // the events of the exited thread stay on the track, under the same name
+    for (int i = (int)free_buffers.size() - 1; i >= 0; i--) {
+        TraceBuffer* buffer = free_buffers[i];
+        if (name.empty() ? !buffer->named : buffer->name == name) {
+            free_buffers.erase(free_buffers.begin() + i);
+            return buffer;
+        }
+    }
+    return add_buffer_locked(name);
+}
+
+void TraceRecorder::release_buffer(TraceBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    free_buffers.push_back(buffer);
+}
+
+static std::string escape_json(const std::string& text) {
+    std::string escaped;
+    for (int i = 0; i < text.size(); i++) {
+        if (text[i] == '"' || text[i] == '\\') {
+            escaped += '\\';
+        }
+        escaped += text[i];
+    }
+    return escaped;
+}
+
+bool TraceRecorder::write_trace(const std::string& path, double last_seconds) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::TRACE_RECORDER:: Couldn't write the trace " << path << std::endl;
+        return false;
+    }
+
+    int64_t first_begin_us = last_seconds > 0.0 ? now_us() - (int64_t)(last_seconds * 1000000.0) : 0;
+    int num_written_events = 0;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"NeonEngine\"}}";
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (int i = 0; i < buffers.size(); i++) {
+        TraceBuffer* buffer = buffers[i].get();
+        std::lock_guard<std::mutex> events_lock(buffer->events_mutex);
+        if (buffer->num_recorded == 0) {
+            continue;
+        }
+        file << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+            << ",\"args\":{\"name\":\"" << escape_json(buffer->name) << "\"}}";
+
+        // from the oldest event still in the ring
+        uint64_t num_events = std::min(buffer->num_recorded, (uint64_t)TRACE_BUFFER_EVENTS);
+        for (uint64_t j = buffer->num_recorded - num_events; j < buffer->num_recorded; j++) {
+            const TraceEvent& event = buffer->events[j % TRACE_BUFFER_EVENTS];
+            if (event.begin_us < first_begin_us) {
+                continue;
+            }
+            file << "," << std::endl << "{\"name\":\"" << escape_json(event.name) << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":"
+                << event.begin_us << ",\"dur\":" << event.duration_us << ",\"pid\":1,\"tid\":" << buffer->id << "}";
+            num_written_events++;
+        }
+    }
+    file << std::endl << "]}" << std::endl;
+
+    std::cout << "WROTE " << num_written_events << " TRACE EVENTS IN: " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Events kept per thread, the oldest ones are overwritten
+const int TRACE_BUFFER_EVENTS = 32 * 1024;
+// Seconds written by default when the trace is saved on demand
+const int TRACE_DUMP_SECONDS = 10;
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    int64_t begin_us;
+    int64_t duration_us;
+};
+
+// Ring of the events of one thread (or of the GPU), only written by that thread. The buffer of a thread that exits is
+// reused by the next thread of the same name (or the next unnamed one), so the transient threads don't add a buffer
+// (and a track) each
+struct TraceBuffer {
+    int id;
+    std::string name;
+    // Named by set_thread_name() or create_track(), otherwise "thread <id>"
+    bool named = false;
+    std::vector<TraceEvent> events;
+    uint64_t num_recorded = 0;
+    // Only contended while the trace is written
+    std::mutex events_mutex;
+};
+
+// Records timed scopes of every thread for the Chrome trace viewer (chrome://tracing) or Perfetto. Every thread writes
+// its events into its own ring, so recording takes no global lock, and write_trace() dumps them as trace event JSON.
+// While it's disabled a scope only checks the enabled flag.
+class TraceRecorder {
+public:
+    static TraceRecorder* get_instance();
+
+    TraceRecorder(TraceRecorder& other) = delete;
+    void operator=(const TraceRecorder&) = delete;
+
+    static std::atomic<bool> enabled;
+
+    // Microseconds since the start of the process
+    static int64_t now_us();
+    // Any thread. The name must outlive the recorder (a literal, or the result of intern())
+    static void record(const char* name, const char* category, int64_t begin_us, int64_t duration_us);
+    // Also names the thread in the sampling profiler
+    static void set_thread_name(const std::string& name);
+
+    // Copy of a name built at runtime that lives as long as the recorder
+    const char* intern(const std::string& name);
+    // Buffer of events that aren't recorded by a thread, e.g. the passes executed by the GPU
+    TraceBuffer* create_track(const std::string& name);
+    static void record(TraceBuffer* buffer, const char* name, const char* category, int64_t begin_us, int64_t duration_us);
+
+    // Writes the events of the last_seconds seconds (every recorded event if it's 0)
+    bool write_trace(const std::string& path, double last_seconds = 0.0);
+
+private:
+    TraceRecorder() {}
+
+    static TraceBuffer* get_thread_buffer();
+    TraceBuffer* add_buffer(const std::string& name);
+    TraceBuffer* add_buffer_locked(const std::string& name);
+    // The buffer of an exited thread of the same name (or unnamed, for ""), otherwise a new one
+    TraceBuffer* acquire_buffer(const std::string& name);
+    void release_buffer(TraceBuffer* buffer);
+    friend struct ThreadBufferOwner;
+
+    static TraceRecorder* instance;
+    static std::mutex trace_recorder_mutex;
+
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    // Buffers of the threads that exited
+    std::vector<TraceBuffer*> free_buffers;
+    std::set<std::string> interned_names;
+    std::mutex buffers_mutex;
+};
+
+// Records the time from its construction to the end of the block
+struct TraceScope {
+    TraceScope(const char* name, const char* category = "cpu") : name(name), category(category), begin_us(-1) {
+        if (TraceRecorder::enabled.load(std::memory_order_relaxed)) {
+            begin_us = TraceRecorder::now_us();
+        }
+    }
+    ~TraceScope() {
+        if (begin_us >= 0) {
+            TraceRecorder::record(name, category, begin_us, TraceRecorder::now_us() - begin_us);
+        }
+    }
+
+    const char* name;
+    const char* category;
+    int64_t begin_us;
+};
+
+#define TRACE_CONCATENATE_DETAIL(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_DETAIL(a, b)
+// e.g. TRACE_SCOPE("swap_buffers"); with a literal name
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(trace_scope_, __LINE__)(name)
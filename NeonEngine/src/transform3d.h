@@ -28,56 +28,56 @@ public:
         this->scale_transform3d = scale_transform3d;
 
         // Translation game objects
-        GameObject* z_arrow_body_translation = new GameObject("z_arrow_body_translation", "cylinder");
-        z_arrow_body_translation->position = glm::vec3(0.0f, 0.0f, 1.5f);
-        z_arrow_body_translation->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        z_arrow_body_translation->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-        z_arrow_body_translation->render_only_ambient = true;
-        z_arrow_body_translation->render_one_color = true;
+        GameObject* z_arrow_body_translation = GameObject::pool.create("z_arrow_body_translation", "cylinder");
+        z_arrow_body_translation->position() = glm::vec3(0.0f, 0.0f, 1.5f);
+        z_arrow_body_translation->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        z_arrow_body_translation->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+        z_arrow_body_translation->render_only_ambient() = true;
+        z_arrow_body_translation->render_one_color() = true;
         z_arrow_body_translation->set_model_matrices_standard();
 
-        GameObject* z_arrow_head_translation = new GameObject("z_arrow_head_translation", "cone");
-        z_arrow_head_translation->position = glm::vec3(0.0f, 0.0f, 3.0f);
-        z_arrow_head_translation->scale = glm::vec3(0.3f, 0.3f, 0.6f);
-        z_arrow_head_translation->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-        z_arrow_head_translation->render_only_ambient = true;
-        z_arrow_head_translation->render_one_color = true;
+        GameObject* z_arrow_head_translation = GameObject::pool.create("z_arrow_head_translation", "cone");
+        z_arrow_head_translation->position() = glm::vec3(0.0f, 0.0f, 3.0f);
+        z_arrow_head_translation->scale() = glm::vec3(0.3f, 0.3f, 0.6f);
+        z_arrow_head_translation->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+        z_arrow_head_translation->render_only_ambient() = true;
+        z_arrow_head_translation->render_one_color() = true;
         z_arrow_head_translation->set_model_matrices_standard();
         
-        GameObject* y_arrow_body_translation = new GameObject("y_arrow_body_translation", "cylinder");
-        y_arrow_body_translation->position = glm::vec3(0.0f, 1.5f, 0.0f);
-        y_arrow_body_translation->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        y_arrow_body_translation->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        y_arrow_body_translation->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-        y_arrow_body_translation->render_only_ambient = true;
-        y_arrow_body_translation->render_one_color = true;
+        GameObject* y_arrow_body_translation = GameObject::pool.create("y_arrow_body_translation", "cylinder");
+        y_arrow_body_translation->position() = glm::vec3(0.0f, 1.5f, 0.0f);
+        y_arrow_body_translation->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        y_arrow_body_translation->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        y_arrow_body_translation->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+        y_arrow_body_translation->render_only_ambient() = true;
+        y_arrow_body_translation->render_one_color() = true;
         y_arrow_body_translation->set_model_matrices_standard();
         
-        GameObject* y_arrow_head_translation = new GameObject("y_arrow_head_translation", "cone");
-        y_arrow_head_translation->position = glm::vec3(0.0f, 3.0f, 0.0f);
-        y_arrow_head_translation->rotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        y_arrow_head_translation->scale = glm::vec3(0.3f, 0.3f, 0.6f);
-        y_arrow_head_translation->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-        y_arrow_head_translation->render_only_ambient = true;
-        y_arrow_head_translation->render_one_color = true;
+        GameObject* y_arrow_head_translation = GameObject::pool.create("y_arrow_head_translation", "cone");
+        y_arrow_head_translation->position() = glm::vec3(0.0f, 3.0f, 0.0f);
+        y_arrow_head_translation->rotation() = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        y_arrow_head_translation->scale() = glm::vec3(0.3f, 0.3f, 0.6f);
+        y_arrow_head_translation->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+        y_arrow_head_translation->render_only_ambient() = true;
+        y_arrow_head_translation->render_one_color() = true;
         y_arrow_head_translation->set_model_matrices_standard();
         
-        GameObject* x_arrow_body_translation = new GameObject("x_arrow_body_translation", "cylinder");
-        x_arrow_body_translation->position = glm::vec3(1.5f, 0.0f, 0.0f);
-        x_arrow_body_translation->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        x_arrow_body_translation->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        x_arrow_body_translation->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-        x_arrow_body_translation->render_only_ambient = true;
-        x_arrow_body_translation->render_one_color = true;
+        GameObject* x_arrow_body_translation = GameObject::pool.create("x_arrow_body_translation", "cylinder");
+        x_arrow_body_translation->position() = glm::vec3(1.5f, 0.0f, 0.0f);
+        x_arrow_body_translation->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        x_arrow_body_translation->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        x_arrow_body_translation->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+        x_arrow_body_translation->render_only_ambient() = true;
+        x_arrow_body_translation->render_one_color() = true;
         x_arrow_body_translation->set_model_matrices_standard();
         
-        GameObject* x_arrow_head_translation = new GameObject("x_arrow_head_translation", "cone");
-        x_arrow_head_translation->position = glm::vec3(3.0f, 0.0f, 0.0f);
-        x_arrow_head_translation->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        x_arrow_head_translation->scale = glm::vec3(0.3f, 0.3f, 0.6f);
-        x_arrow_head_translation->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-        x_arrow_head_translation->render_only_ambient = true;
-        x_arrow_head_translation->render_one_color = true;
+        GameObject* x_arrow_head_translation = GameObject::pool.create("x_arrow_head_translation", "cone");
+        x_arrow_head_translation->position() = glm::vec3(3.0f, 0.0f, 0.0f);
+        x_arrow_head_translation->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        x_arrow_head_translation->scale() = glm::vec3(0.3f, 0.3f, 0.6f);
+        x_arrow_head_translation->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+        x_arrow_head_translation->render_only_ambient() = true;
+        x_arrow_head_translation->render_one_color() = true;
         x_arrow_head_translation->set_model_matrices_standard();
 
 
@@ -91,30 +91,30 @@ public:
 
 
         // Rotation game objects
-        GameObject* z_quarter_disk_rotation = new GameObject("z_quarter_disk_rotation", "quarter_disk_border");
-        z_quarter_disk_rotation->position = glm::vec3(0.0f, 0.0f, 0.0f);
-        z_quarter_disk_rotation->scale = glm::vec3(2.0f);
-        z_quarter_disk_rotation->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-        z_quarter_disk_rotation->render_only_ambient = true;
-        z_quarter_disk_rotation->render_one_color = true;
+        GameObject* z_quarter_disk_rotation = GameObject::pool.create("z_quarter_disk_rotation", "quarter_disk_border");
+        z_quarter_disk_rotation->position() = glm::vec3(0.0f, 0.0f, 0.0f);
+        z_quarter_disk_rotation->scale() = glm::vec3(2.0f);
+        z_quarter_disk_rotation->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+        z_quarter_disk_rotation->render_only_ambient() = true;
+        z_quarter_disk_rotation->render_one_color() = true;
         z_quarter_disk_rotation->set_model_matrices_standard();
         
-        GameObject* y_quarter_disk_rotation = new GameObject("y_quarter_disk_rotation", "quarter_disk_border");
-        y_quarter_disk_rotation->position = glm::vec3(0.0f, 0.0f, 0.0f);
-        y_quarter_disk_rotation->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        y_quarter_disk_rotation->scale = glm::vec3(2.0f);
-        y_quarter_disk_rotation->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-        y_quarter_disk_rotation->render_only_ambient = true;
-        y_quarter_disk_rotation->render_one_color = true;
+        GameObject* y_quarter_disk_rotation = GameObject::pool.create("y_quarter_disk_rotation", "quarter_disk_border");
+        y_quarter_disk_rotation->position() = glm::vec3(0.0f, 0.0f, 0.0f);
+        y_quarter_disk_rotation->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        y_quarter_disk_rotation->scale() = glm::vec3(2.0f);
+        y_quarter_disk_rotation->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+        y_quarter_disk_rotation->render_only_ambient() = true;
+        y_quarter_disk_rotation->render_one_color() = true;
         y_quarter_disk_rotation->set_model_matrices_standard();
         
-        GameObject* x_quarter_disk_rotation = new GameObject("x_quarter_disk_rotation", "quarter_disk_border");
-        x_quarter_disk_rotation->position = glm::vec3(0.0f, 0.0f, 0.0f);
-        x_quarter_disk_rotation->rotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        x_quarter_disk_rotation->scale = glm::vec3(2.0f);
-        x_quarter_disk_rotation->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-        x_quarter_disk_rotation->render_only_ambient = true;
-        x_quarter_disk_rotation->render_one_color = true;
+        GameObject* x_quarter_disk_rotation = GameObject::pool.create("x_quarter_disk_rotation", "quarter_disk_border");
+        x_quarter_disk_rotation->position() = glm::vec3(0.0f, 0.0f, 0.0f);
+        x_quarter_disk_rotation->rotation() = glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        x_quarter_disk_rotation->scale() = glm::vec3(2.0f);
+        x_quarter_disk_rotation->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+        x_quarter_disk_rotation->render_only_ambient() = true;
+        x_quarter_disk_rotation->render_one_color() = true;
         x_quarter_disk_rotation->set_model_matrices_standard();
 
 
@@ -125,64 +125,64 @@ public:
 
 
         // Scaling game objects
-        GameObject* z_arrow_body_scaling = new GameObject("z_arrow_body_scaling", "cylinder");
-        z_arrow_body_scaling->position = glm::vec3(0.0f, 0.0f, 1.5f);
-        z_arrow_body_scaling->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        z_arrow_body_scaling->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-        z_arrow_body_scaling->render_only_ambient = true;
-        z_arrow_body_scaling->render_one_color = true;
+        GameObject* z_arrow_body_scaling = GameObject::pool.create("z_arrow_body_scaling", "cylinder");
+        z_arrow_body_scaling->position() = glm::vec3(0.0f, 0.0f, 1.5f);
+        z_arrow_body_scaling->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        z_arrow_body_scaling->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+        z_arrow_body_scaling->render_only_ambient() = true;
+        z_arrow_body_scaling->render_one_color() = true;
         z_arrow_body_scaling->set_model_matrices_standard();
 
-        GameObject* z_arrow_head_scaling = new GameObject("z_arrow_head_scaling", "cube");
-        z_arrow_head_scaling->position = glm::vec3(0.0f, 0.0f, 3.0f);
-        z_arrow_head_scaling->scale = glm::vec3(0.6f, 0.6f, 0.6f);
-        z_arrow_head_scaling->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-        z_arrow_head_scaling->render_only_ambient = true;
-        z_arrow_head_scaling->render_one_color = true;
+        GameObject* z_arrow_head_scaling = GameObject::pool.create("z_arrow_head_scaling", "cube");
+        z_arrow_head_scaling->position() = glm::vec3(0.0f, 0.0f, 3.0f);
+        z_arrow_head_scaling->scale() = glm::vec3(0.6f, 0.6f, 0.6f);
+        z_arrow_head_scaling->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+        z_arrow_head_scaling->render_only_ambient() = true;
+        z_arrow_head_scaling->render_one_color() = true;
         z_arrow_head_scaling->set_model_matrices_standard();
         
-        GameObject* y_arrow_body_scaling = new GameObject("y_arrow_body_scaling", "cylinder");
-        y_arrow_body_scaling->position = glm::vec3(0.0f, 1.5f, 0.0f);
-        y_arrow_body_scaling->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        y_arrow_body_scaling->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        y_arrow_body_scaling->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-        y_arrow_body_scaling->render_only_ambient = true;
-        y_arrow_body_scaling->render_one_color = true;
+        GameObject* y_arrow_body_scaling = GameObject::pool.create("y_arrow_body_scaling", "cylinder");
+        y_arrow_body_scaling->position() = glm::vec3(0.0f, 1.5f, 0.0f);
+        y_arrow_body_scaling->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        y_arrow_body_scaling->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        y_arrow_body_scaling->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+        y_arrow_body_scaling->render_only_ambient() = true;
+        y_arrow_body_scaling->render_one_color() = true;
         y_arrow_body_scaling->set_model_matrices_standard();
         
-        GameObject* y_arrow_head_scaling = new GameObject("y_arrow_head_scaling", "cube");
-        y_arrow_head_scaling->position = glm::vec3(0.0f, 3.0f, 0.0f);
-        y_arrow_head_scaling->rotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        y_arrow_head_scaling->scale = glm::vec3(0.6f, 0.6f, 0.6f);
-        y_arrow_head_scaling->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-        y_arrow_head_scaling->render_only_ambient = true;
-        y_arrow_head_scaling->render_one_color = true;
+        GameObject* y_arrow_head_scaling = GameObject::pool.create("y_arrow_head_scaling", "cube");
+        y_arrow_head_scaling->position() = glm::vec3(0.0f, 3.0f, 0.0f);
+        y_arrow_head_scaling->rotation() = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        y_arrow_head_scaling->scale() = glm::vec3(0.6f, 0.6f, 0.6f);
+        y_arrow_head_scaling->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+        y_arrow_head_scaling->render_only_ambient() = true;
+        y_arrow_head_scaling->render_one_color() = true;
         y_arrow_head_scaling->set_model_matrices_standard();
         
-        GameObject* x_arrow_body_scaling = new GameObject("x_arrow_body_scaling", "cylinder");
-        x_arrow_body_scaling->position = glm::vec3(1.5f, 0.0f, 0.0f);
-        x_arrow_body_scaling->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        x_arrow_body_scaling->scale = glm::vec3(0.1f, 0.1f, 3.0f);
-        x_arrow_body_scaling->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-        x_arrow_body_scaling->render_only_ambient = true;
-        x_arrow_body_scaling->render_one_color = true;
+        GameObject* x_arrow_body_scaling = GameObject::pool.create("x_arrow_body_scaling", "cylinder");
+        x_arrow_body_scaling->position() = glm::vec3(1.5f, 0.0f, 0.0f);
+        x_arrow_body_scaling->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        x_arrow_body_scaling->scale() = glm::vec3(0.1f, 0.1f, 3.0f);
+        x_arrow_body_scaling->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+        x_arrow_body_scaling->render_only_ambient() = true;
+        x_arrow_body_scaling->render_one_color() = true;
         x_arrow_body_scaling->set_model_matrices_standard();
         
-        GameObject* x_arrow_head_scaling = new GameObject("x_arrow_head_scaling", "cube");
-        x_arrow_head_scaling->position = glm::vec3(3.0f, 0.0f, 0.0f);
-        x_arrow_head_scaling->rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        x_arrow_head_scaling->scale = glm::vec3(0.6f, 0.6f, 0.6f);
-        x_arrow_head_scaling->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-        x_arrow_head_scaling->render_only_ambient = true;
-        x_arrow_head_scaling->render_one_color = true;
+        GameObject* x_arrow_head_scaling = GameObject::pool.create("x_arrow_head_scaling", "cube");
+        x_arrow_head_scaling->position() = glm::vec3(3.0f, 0.0f, 0.0f);
+        x_arrow_head_scaling->rotation() = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        x_arrow_head_scaling->scale() = glm::vec3(0.6f, 0.6f, 0.6f);
+        x_arrow_head_scaling->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+        x_arrow_head_scaling->render_only_ambient() = true;
+        x_arrow_head_scaling->render_one_color() = true;
         x_arrow_head_scaling->set_model_matrices_standard();
         
-        GameObject* cube_center_scaling = new GameObject("cube_center_scaling", "cube");
-        cube_center_scaling->position = glm::vec3(0.0f, 0.0f, 0.0f);
-        cube_center_scaling->scale = glm::vec3(0.8f, 0.8f, 0.8f);
-        cube_center_scaling->albedo = glm::vec3(1.0f, 1.0f, 1.0f);
-        cube_center_scaling->render_only_ambient = true;
-        cube_center_scaling->render_one_color = true;
+        GameObject* cube_center_scaling = GameObject::pool.create("cube_center_scaling", "cube");
+        cube_center_scaling->position() = glm::vec3(0.0f, 0.0f, 0.0f);
+        cube_center_scaling->scale() = glm::vec3(0.8f, 0.8f, 0.8f);
+        cube_center_scaling->albedo() = glm::vec3(1.0f, 1.0f, 1.0f);
+        cube_center_scaling->render_only_ambient() = true;
+        cube_center_scaling->render_one_color() = true;
         cube_center_scaling->set_model_matrices_standard();
 
 
@@ -197,27 +197,31 @@ public:
         scaling_game_objects[y_arrow_head_scaling->name] = y_arrow_head_scaling;
 
 
+        // the gizmo is drawn by draw(), not with the scene
         Rendering* rendering = Rendering::get_instance();
         for (auto it = translation_game_objects.begin(); it != translation_game_objects.end(); it++) {
-            rendering->id_color_to_game_object_transform3d[it->second->id_color] = it->second;
+            rendering->id_color_to_game_object_transform3d[it->second->id_color()] = it->second;
+            it->second->rendered_in_scene() = 0;
         }
         for (auto it = rotation_game_objects.begin(); it != rotation_game_objects.end(); it++) {
-            rendering->id_color_to_game_object_transform3d[it->second->id_color] = it->second;
+            rendering->id_color_to_game_object_transform3d[it->second->id_color()] = it->second;
+            it->second->rendered_in_scene() = 0;
         }
         for (auto it = scaling_game_objects.begin(); it != scaling_game_objects.end(); it++) {
-            rendering->id_color_to_game_object_transform3d[it->second->id_color] = it->second;
+            rendering->id_color_to_game_object_transform3d[it->second->id_color()] = it->second;
+            it->second->rendered_in_scene() = 0;
         }
     }
 
     ~Transform3D() {
         for (auto it = translation_game_objects.begin(); it != translation_game_objects.end(); it++) {
-            delete it->second;
+            GameObject::destroy(it->second);
         }
         for (auto it = rotation_game_objects.begin(); it != rotation_game_objects.end(); it++) {
-            delete it->second;
+            GameObject::destroy(it->second);
         }
         for (auto it = scaling_game_objects.begin(); it != scaling_game_objects.end(); it++) {
-            delete it->second;
+            GameObject::destroy(it->second);
         }
     }
 
@@ -232,8 +236,8 @@ public:
             std::cout << "Error: No game object selected available to transform" << std::endl;
             return;
         }
-        glm::mat4 model_view_projection = rendering->view_projection * rendering->last_selected_object->model;
-        float lenght_camera_to_game_object = glm::length(rendering->camera_viewport->Position - rendering->last_selected_object->position);
+        glm::mat4 model_view_projection = rendering->view_projection * rendering->last_selected_object->model();
+        float lenght_camera_to_game_object = glm::length(rendering->camera_viewport->Position - rendering->last_selected_object->position());
 
         if (type == TRANSLATION) {
             glm::vec4 axis;
@@ -249,9 +253,9 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            glm::vec4 direction = rendering->last_selected_object->model * axis;
+            glm::vec4 direction = rendering->last_selected_object->model() * axis;
             glm::vec3 norm_direction = glm::normalize(glm::vec3(direction));
-            rendering->last_selected_object->position += norm_direction * delta_transformation * lenght_camera_to_game_object * VELOCITY_TRANSLATION;
+            rendering->last_selected_object->position() += norm_direction * delta_transformation * lenght_camera_to_game_object * VELOCITY_TRANSLATION;
             rendering->last_selected_object->set_model_matrices_standard();
         }
         else if (type == ROTATION) {
@@ -268,8 +272,8 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            glm::vec3 rotated_axis = rendering->last_selected_object->rotation * glm::vec3(axis);
-            rendering->last_selected_object->rotation = glm::angleAxis(delta_transformation * VELOCITY_ROTATION, rotated_axis) * rendering->last_selected_object->rotation;
+            glm::vec3 rotated_axis = rendering->last_selected_object->rotation() * glm::vec3(axis);
+            rendering->last_selected_object->rotation() = glm::angleAxis(delta_transformation * VELOCITY_ROTATION, rotated_axis) * rendering->last_selected_object->rotation();
             rendering->last_selected_object->set_model_matrices_standard();
         }
         else { // SCALING
@@ -289,7 +293,7 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            rendering->last_selected_object->scale += glm::vec3(axis) * delta_transformation * lenght_camera_to_game_object * VELOCITY_SCALING;
+            rendering->last_selected_object->scale() += glm::vec3(axis) * delta_transformation * lenght_camera_to_game_object * VELOCITY_SCALING;
             rendering->last_selected_object->set_model_matrices_standard();
         }
     }
@@ -306,8 +310,8 @@ public:
             std::cout << "Error: No game object selected available to transform" << std::endl;
             return;
         }
-        glm::mat4 model_view_projection = rendering->view_projection * rendering->last_selected_object->model;
-        float lenght_camera_to_game_object = glm::length(rendering->camera_viewport->Position - rendering->last_selected_object->position);
+        glm::mat4 model_view_projection = rendering->view_projection * rendering->last_selected_object->model();
+        float lenght_camera_to_game_object = glm::length(rendering->camera_viewport->Position - rendering->last_selected_object->position());
 
         if (type == TRANSLATION) {
             glm::vec4 axis;
@@ -323,9 +327,9 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            glm::vec4 direction = rendering->last_selected_object->model * axis;
+            glm::vec4 direction = rendering->last_selected_object->model() * axis;
             glm::vec3 norm_direction = glm::normalize(glm::vec3(direction));
-            rendering->last_selected_object->position += norm_direction * delta_transformation * lenght_camera_to_game_object * VELOCITY_TRANSLATION;
+            rendering->last_selected_object->position() += norm_direction * delta_transformation * lenght_camera_to_game_object * VELOCITY_TRANSLATION;
             rendering->last_selected_object->set_model_matrices_standard();
         }
         else if (type == ROTATION) {
@@ -342,8 +346,8 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            glm::vec3 rotated_axis = rendering->last_selected_object->rotation * glm::vec3(axis);
-            rendering->last_selected_object->rotation = glm::angleAxis(delta_transformation * VELOCITY_ROTATION, rotated_axis) * rendering->last_selected_object->rotation;
+            glm::vec3 rotated_axis = rendering->last_selected_object->rotation() * glm::vec3(axis);
+            rendering->last_selected_object->rotation() = glm::angleAxis(delta_transformation * VELOCITY_ROTATION, rotated_axis) * rendering->last_selected_object->rotation();
             rendering->last_selected_object->set_model_matrices_standard();
         }
         else { // SCALING
@@ -363,7 +367,7 @@ public:
             glm::vec2 arrow(model_view_projection * axis);
             arrow = glm::normalize(arrow);
             float delta_transformation = glm::dot(arrow, transform_vector);
-            rendering->last_selected_object->scale += glm::vec3(axis) * delta_transformation * lenght_camera_to_game_object * VELOCITY_SCALING;
+            rendering->last_selected_object->scale() += glm::vec3(axis) * delta_transformation * lenght_camera_to_game_object * VELOCITY_SCALING;
             rendering->last_selected_object->set_model_matrices_standard();
         }
     }
@@ -375,98 +379,98 @@ public:
         if (type == TRANSLATION) {
             if (game_object->name == "x_arrow_body_translation" || game_object->name == "x_arrow_head_translation") {
                 if (active) {
-                    translation_game_objects["x_arrow_body_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    translation_game_objects["x_arrow_head_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["x_arrow_body_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["x_arrow_head_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    translation_game_objects["x_arrow_body_translation"]->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-                    translation_game_objects["x_arrow_head_translation"]->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
+                    translation_game_objects["x_arrow_body_translation"]->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+                    translation_game_objects["x_arrow_head_translation"]->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
                 }
             }
             else if (game_object->name == "y_arrow_body_translation" || game_object->name == "y_arrow_head_translation") {
                 if (active) {
-                    translation_game_objects["y_arrow_body_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    translation_game_objects["y_arrow_head_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["y_arrow_body_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["y_arrow_head_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    translation_game_objects["y_arrow_body_translation"]->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-                    translation_game_objects["y_arrow_head_translation"]->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
+                    translation_game_objects["y_arrow_body_translation"]->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+                    translation_game_objects["y_arrow_head_translation"]->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
                 }
             }
             else if (game_object->name == "z_arrow_body_translation" || game_object->name == "z_arrow_head_translation") {
                 if (active) {
-                    translation_game_objects["z_arrow_body_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    translation_game_objects["z_arrow_head_translation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["z_arrow_body_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    translation_game_objects["z_arrow_head_translation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    translation_game_objects["z_arrow_body_translation"]->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-                    translation_game_objects["z_arrow_head_translation"]->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
+                    translation_game_objects["z_arrow_body_translation"]->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+                    translation_game_objects["z_arrow_head_translation"]->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
                 }
             }
         }
         else if (type == ROTATION) {
             if (game_object->name == "x_quarter_disk_rotation") {
                 if (active) {
-                    rotation_game_objects["x_quarter_disk_rotation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    rotation_game_objects["x_quarter_disk_rotation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    rotation_game_objects["x_quarter_disk_rotation"]->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
+                    rotation_game_objects["x_quarter_disk_rotation"]->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
                 }
             }
             else if (game_object->name == "y_quarter_disk_rotation") {
                 if (active) {
-                    rotation_game_objects["y_quarter_disk_rotation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    rotation_game_objects["y_quarter_disk_rotation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    rotation_game_objects["y_quarter_disk_rotation"]->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
+                    rotation_game_objects["y_quarter_disk_rotation"]->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
                 }
             }
             else if (game_object->name == "z_quarter_disk_rotation") {
                 if (active) {
-                    rotation_game_objects["z_quarter_disk_rotation"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    rotation_game_objects["z_quarter_disk_rotation"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    rotation_game_objects["z_quarter_disk_rotation"]->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
+                    rotation_game_objects["z_quarter_disk_rotation"]->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
                 }
             }
         }
         else { // SCALING
             if (game_object->name == "x_arrow_body_scaling" || game_object->name == "x_arrow_head_scaling") {
                 if (active) {
-                    scaling_game_objects["x_arrow_body_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    scaling_game_objects["x_arrow_head_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["x_arrow_body_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["x_arrow_head_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    scaling_game_objects["x_arrow_body_scaling"]->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
-                    scaling_game_objects["x_arrow_head_scaling"]->albedo = glm::vec3(1.0f, 0.0f, 0.0f);
+                    scaling_game_objects["x_arrow_body_scaling"]->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
+                    scaling_game_objects["x_arrow_head_scaling"]->albedo() = glm::vec3(1.0f, 0.0f, 0.0f);
                 }
             }
             else if (game_object->name == "y_arrow_body_scaling" || game_object->name == "y_arrow_head_scaling") {
                 if (active) {
-                    scaling_game_objects["y_arrow_body_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    scaling_game_objects["y_arrow_head_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["y_arrow_body_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["y_arrow_head_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    scaling_game_objects["y_arrow_body_scaling"]->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
-                    scaling_game_objects["y_arrow_head_scaling"]->albedo = glm::vec3(0.0f, 1.0f, 0.0f);
+                    scaling_game_objects["y_arrow_body_scaling"]->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
+                    scaling_game_objects["y_arrow_head_scaling"]->albedo() = glm::vec3(0.0f, 1.0f, 0.0f);
                 }
             }
             else if (game_object->name == "z_arrow_body_scaling" || game_object->name == "z_arrow_head_scaling") {
                 if (active) {
-                    scaling_game_objects["z_arrow_body_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
-                    scaling_game_objects["z_arrow_head_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["z_arrow_body_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["z_arrow_head_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    scaling_game_objects["z_arrow_body_scaling"]->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
-                    scaling_game_objects["z_arrow_head_scaling"]->albedo = glm::vec3(0.0f, 0.0f, 1.0f);
+                    scaling_game_objects["z_arrow_body_scaling"]->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
+                    scaling_game_objects["z_arrow_head_scaling"]->albedo() = glm::vec3(0.0f, 0.0f, 1.0f);
                 }
             }
             else { // (game_object->name == "cube_center_scaling")
                 if (active) {
-                    scaling_game_objects["cube_center_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 0.0f);
+                    scaling_game_objects["cube_center_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 0.0f);
                 }
                 else {
-                    scaling_game_objects["cube_center_scaling"]->albedo = glm::vec3(1.0f, 1.0f, 1.0f);
+                    scaling_game_objects["cube_center_scaling"]->albedo() = glm::vec3(1.0f, 1.0f, 1.0f);
                 }
             }
         }
@@ -486,17 +490,17 @@ public:
         }
         for (auto it = transformation_game_objects->begin(); it != transformation_game_objects->end(); it++) {
             GameObject* game_object = it->second;
-            glm::mat4& model = game_object->model;
-            glm::vec3& position = game_object->position;
-            glm::quat& rotation = game_object->rotation;
-            glm::vec3& scale = game_object->scale;
-            glm::mat4& model_inv = game_object->model_inv;
-            glm::mat3& model_normals = game_object->model_normals;
-            float distance_camera_to_parent_object = glm::length(rendering->camera_viewport->Position - parent->position);
+            glm::mat4& model = game_object->model();
+            glm::vec3& position = game_object->position();
+            glm::quat& rotation = game_object->rotation();
+            glm::vec3& scale = game_object->scale();
+            glm::mat4& model_inv = game_object->model_inv();
+            glm::mat3& model_normals = game_object->model_normals();
+            float distance_camera_to_parent_object = glm::length(rendering->camera_viewport->Position - parent->position());
 
             model = glm::mat4(1.0f);
-            model = glm::translate(model, parent->position);
-            model *= glm::mat4_cast(parent->rotation);
+            model = glm::translate(model, parent->position());
+            model *= glm::mat4_cast(parent->rotation());
 
             model = glm::translate(model, position * distance_camera_to_parent_object * scale_transform3d);
             model *= glm::mat4_cast(rotation);
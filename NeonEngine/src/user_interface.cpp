@@ -7,6 +7,15 @@
 #include "model.h"
 #include "logger.h"
 #include "cubemap.h"
+#include "reflection_probe.h"
+#include "camera.h"
+#include "frame_profiler.h"
+#include "trace_recorder.h"
+#include "gl_counters.h"
+#include "resource_registry.h"
+#include "sampling_profiler.h"
+#include "allocation_tracker.h"
+#include "frame_arena.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -17,6 +26,10 @@
 #include <mutex>
 #include <iostream>
 #include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <cfloat>
 
 UserInterface* UserInterface::instance = nullptr;
 std::mutex UserInterface::user_interface_mutex;
@@ -38,6 +51,8 @@ UserInterface::UserInterface() {
     texture_viewport_reduce_height_px = 30;
     first_time_viewport_fbo = true;
     passed_time_seconds = 0.0f;
+    trace_dump_seconds = TRACE_DUMP_SECONDS;
+    sampling_rate_hz = SAMPLING_PROFILER_DEFAULT_RATE_HZ;
     frames_per_second_ui = 0.0f;
     rendered_texture = 0;
     displayed_rendering = DisplayedColors;
@@ -198,6 +213,8 @@ void UserInterface::update_displayed_texture() {
 }
 
 void UserInterface::render_app() {
+    ALLOCATION_TAG(AllocUI);
+    FrameArena* frame_arena = FrameArena::get_instance();
     update_fps_ui();
 
     static bool opt_fullscreen = true;
@@ -348,6 +365,15 @@ void UserInterface::render_app() {
             ImGui::DragFloat("##BloomStrength", &(rendering->bloom_strength), 0.001f, 0.0f, std::numeric_limits<float>::max());
         }
 
+        // Row: Irradiance from spherical harmonics
+        ImGui::TableNextRow();
+
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("Irradiance from SH");
+
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Checkbox("##IrradianceFromSH", &(rendering->use_irradiance_sh));
+
         // Row 4: Emission Strength
         ImGui::TableNextRow();
 
@@ -361,11 +387,42 @@ void UserInterface::render_app() {
 
         ImGui::EndTable();
     }
+
+    // Reflection probes: placed at the camera, static ones are baked again when they are moved
+    if (ImGui::CollapsingHeader("Reflection Probes", ImGuiTreeNodeFlags_DefaultOpen)) {
+        static int num_added_probes = 0;
+        if (ImGui::Button("Add probe at camera")) {
+            num_added_probes++;
+            rendering->reflection_probes->add_probe("probe" + std::to_string(num_added_probes), rendering->camera_viewport->Position, 10.0f, false);
+        }
+        ImGui::Text("Bake GPU time: %f ms", rendering->reflection_probes->last_bake_time_ms);
+
+        std::string removed_probe_name;
+        for (auto it = rendering->reflection_probes->probes.begin(); it != rendering->reflection_probes->probes.end(); it++) {
+            ReflectionProbe& probe = it->second;
+            if (ImGui::TreeNode(probe.name.c_str())) {
+                if (ImGui::DragFloat3(frame_arena->format("Position##%s", probe.name.c_str()), &(probe.position[0]), 0.1f)) {
+                    rendering->reflection_probes->mark_dirty(probe.name);
+                }
+                ImGui::DragFloat(frame_arena->format("Radius##%s", probe.name.c_str()), &(probe.radius), 0.1f, 0.1f, std::numeric_limits<float>::max());
+                if (ImGui::Checkbox(frame_arena->format("Dynamic##%s", probe.name.c_str()), &(probe.dynamic))) {
+                    rendering->reflection_probes->mark_dirty(probe.name);
+                }
+                if (ImGui::Button(frame_arena->format("Remove##%s", probe.name.c_str()))) {
+                    removed_probe_name = probe.name;
+                }
+                ImGui::TreePop();
+            }
+        }
+        if (removed_probe_name != "") {
+            rendering->reflection_probes->remove_probe(removed_probe_name);
+        }
+    }
     ImGui::End();
 
     ////////////////////////////////////// DETAILS WINDOW //////////////////////////////////////
     ImGui::Begin("Details");
-    ImGui::Text(std::string("FPS: " + std::to_string(frames_per_second_ui)).c_str());
+    ImGui::Text("FPS: %f", frames_per_second_ui);
 
     show_game_object_ui(rendering->last_selected_object);
 
@@ -392,7 +449,7 @@ void UserInterface::render_app() {
 
         for (auto it = rendering->game_objects.begin(); it != rendering->game_objects.end(); it++)
         {
-            std::string game_object_type = game_object_type_to_string(it->second->type);
+            const char* game_object_type = game_object_type_to_string(it->second->type);
 
             ImGui::TableNextRow();
 
@@ -403,14 +460,14 @@ void UserInterface::render_app() {
 
             int new_selected_row = 0;
             ImGui::TableSetColumnIndex(0);
-            std::string id0 = "row" + std::to_string(ImGui::TableGetRowIndex()) + "col" + std::to_string(ImGui::TableGetColumnIndex());
-            if (ImGui::Selectable(std::string(it->first + "##" + id0).c_str(), is_row_selected, ImGuiSelectableFlags_SpanAllColumns)) {
+            const char* label0 = frame_arena->format("%s##row%dcol%d", it->first.c_str(), ImGui::TableGetRowIndex(), ImGui::TableGetColumnIndex());
+            if (ImGui::Selectable(label0, is_row_selected, ImGuiSelectableFlags_SpanAllColumns)) {
                 new_selected_row = ImGui::TableGetRowIndex();
             }
 
             ImGui::TableSetColumnIndex(1);
-            std::string id1 = "row" + std::to_string(ImGui::TableGetRowIndex()) + "col" + std::to_string(ImGui::TableGetColumnIndex());
-            if (ImGui::Selectable(std::string(game_object_type + "##" + id1).c_str(), is_row_selected, ImGuiSelectableFlags_SpanAllColumns)) {
+            const char* label1 = frame_arena->format("%s##row%dcol%d", game_object_type, ImGui::TableGetRowIndex(), ImGui::TableGetColumnIndex());
+            if (ImGui::Selectable(label1, is_row_selected, ImGuiSelectableFlags_SpanAllColumns)) {
                 new_selected_row = ImGui::TableGetRowIndex();
             }
 
@@ -435,7 +492,18 @@ void UserInterface::render_app() {
 
     ///////////////////////////////////// LOGGER WINDOW /////////////////////////////////////
     ImGui::Begin("Logger");
-    ImGui::Text(neon_engine->logger->get_data().c_str());
+    neon_engine->logger->copy_data(logger_text);
+    ImGui::TextUnformatted(logger_text.c_str(), logger_text.c_str() + logger_text.size());
+    ImGui::End();
+
+    //////////////////////////////////// PROFILER WINDOW ////////////////////////////////////
+    ImGui::Begin("Profiler");
+    show_profiler_ui();
+    ImGui::End();
+
+    ///////////////////////////////////// MEMORY WINDOW /////////////////////////////////////
+    ImGui::Begin("Memory");
+    show_memory_ui();
     ImGui::End();
 
     ImGui::End();
@@ -454,7 +522,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
             ImGui::TableSetColumnIndex(1);
             ImGui::PushItemWidth(-1);
             char buffer[100];
-            strcpy_s(buffer, game_object->name.c_str());
+            snprintf(buffer, sizeof(buffer), "%s", game_object->name.c_str());
             ImGui::InputText("##GameObjectName", buffer, sizeof(buffer));
             if (ImGui::IsItemEdited()) {
                 rendering->game_objects.erase(game_object->name);
@@ -480,7 +548,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
 
                     ImGui::TableSetColumnIndex(1);
                     ImGui::PushItemWidth(-1);
-                    ImGui::DragFloat3("##Position", &(game_object->position.x), 0.01f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
+                    ImGui::DragFloat3("##Position", &(game_object->position().x), 0.01f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
                     if (ImGui::IsItemEdited()) {
                         update_model_matrices = true;
                     }
@@ -492,7 +560,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::Text("Rotation");
 
                     ImGui::TableSetColumnIndex(1);
-                    glm::vec3 euler_rotation = glm::degrees(glm::eulerAngles(game_object->rotation));
+                    glm::vec3 euler_rotation = glm::degrees(glm::eulerAngles(game_object->rotation()));
                     ImGui::DragFloat3("##Rotation", &(euler_rotation.x), 0.5f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
                     if (euler_rotation.y >= 90.0f) {
                         euler_rotation.y = 89.999;
@@ -501,7 +569,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                         euler_rotation.y = -89.999;
                     }
                     if (ImGui::IsItemEdited()) {
-                        game_object->rotation = glm::quat(glm::radians(euler_rotation));
+                        game_object->rotation() = glm::quat(glm::radians(euler_rotation));
                         update_model_matrices = true;
                     }
 
@@ -512,7 +580,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::Text("Scale");
 
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::DragFloat3("##Scale", &(game_object->scale.x), 0.01f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
+                    ImGui::DragFloat3("##Scale", &(game_object->scale().x), 0.01f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
                     if (ImGui::IsItemEdited()) {
                         update_model_matrices = true;
                     }
@@ -534,20 +602,24 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::Text("Material Type");
                     ImGui::TableSetColumnIndex(1);
                     ImGui::PushItemWidth(-1);
-                    std::string material_preview_value;
-                    if (game_object->material == nullptr) {
+                    const char* material_preview_value;
+                    if (game_object->material() == nullptr) {
                         material_preview_value = "Default";
                     }
                     else {
-                        material_preview_value = game_object->material->name;
+                        material_preview_value = game_object->material()->name.c_str();
                     }
-                    if (ImGui::BeginCombo("##Material type", material_preview_value.c_str()))
+                    if (ImGui::BeginCombo("##Material type", material_preview_value))
                     {
                         for (auto it = rendering->loaded_materials.begin(); it != rendering->loaded_materials.end(); it++) {
-                            const bool is_selected = (game_object->material == it->second);
+                            Material* material = Material::pool.get(it->second);
+                            if (material == nullptr && it->second != PoolHandle()) { // destroyed with the cooked data of its model
+                                continue;
+                            }
+                            const bool is_selected = (game_object->material() == material);
 
                             if (ImGui::Selectable(it->first.c_str(), is_selected)) {
-                                game_object->material = it->second;
+                                game_object->material() = material;
                             }
 
                             // Set the initial focus when opening the combo (scrolling + keyboard navigation focus)
@@ -562,25 +634,25 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::TableSetColumnIndex(0);
                     ImGui::Text("Albedo");
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::ColorEdit3("##Albedo", &(game_object->albedo.x));
+                    ImGui::ColorEdit3("##Albedo", &(game_object->albedo().x));
 
                     ImGui::TableNextRow();
                     ImGui::TableSetColumnIndex(0);
                     ImGui::Text("Metalness");
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::SliderFloat("##Metalness", &game_object->metalness, 0.0f, 1.0f);
+                    ImGui::SliderFloat("##Metalness", &game_object->metalness(), 0.0f, 1.0f);
 
                     ImGui::TableNextRow();
                     ImGui::TableSetColumnIndex(0);
                     ImGui::Text("Roughness");
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::SliderFloat("##Roughness", &game_object->roughness, 0.0f, 1.0f);
+                    ImGui::SliderFloat("##Roughness", &game_object->roughness(), 0.0f, 1.0f);
 
                     ImGui::TableNextRow();
                     ImGui::TableSetColumnIndex(0);
                     ImGui::Text("Emission");
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::ColorEdit3("##Emission", &(game_object->emission.x));
+                    ImGui::ColorEdit3("##Emission", &(game_object->emission().x));
 
                     ImGui::PopItemWidth();
 
@@ -603,8 +675,8 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             const bool is_selected = (game_object->model_name == it->first);
 
                             if (ImGui::Selectable(it->first.c_str(), is_selected)) {
-                                game_object->model_name = it->first;
-                                game_object->animation_id = -1;
+                                game_object->set_model(it->first);
+                                game_object->animation_id() = -1;
                             }
 
                             // Set the initial focus when opening the combo (scrolling + keyboard navigation focus)
@@ -617,7 +689,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
 
                     Model* model = dynamic_cast<Model*>(rendering->loaded_models[game_object->model_name]);
                     if (model) {
-                        std::string file_format;
+                        const char* file_format;
                         if (model->format == FileFormat::glTF) {
                             file_format = "glTF";
                         }
@@ -631,34 +703,34 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                         ImGui::TableSetColumnIndex(0);
                         ImGui::Text("File format");
                         ImGui::TableSetColumnIndex(1);
-                        ImGui::Text(file_format.c_str());
+                        ImGui::Text(file_format);
 
-                        std::string no_animation("No Animation");
-                        std::string animation_preview_value;
-                        if (game_object->animation_id == -1) {
+                        const char* no_animation = "No Animation";
+                        const char* animation_preview_value;
+                        if (game_object->animation_id() == -1) {
                             animation_preview_value = no_animation;
                         }
                         else {
-                            animation_preview_value = model->animations[game_object->animation_id].name;
+                            animation_preview_value = model->animations[game_object->animation_id()].name.c_str();
                         }
 
                         ImGui::TableNextRow();
                         ImGui::TableSetColumnIndex(0);
                         ImGui::Text("Animation type");
                         ImGui::TableSetColumnIndex(1);
-                        if (ImGui::BeginCombo("##AnimationType", animation_preview_value.c_str())) {
-                            const bool is_selected = (game_object->animation_id == -1);
-                            if (ImGui::Selectable(no_animation.c_str(), is_selected)) {
-                                game_object->animation_id = -1;
+                        if (ImGui::BeginCombo("##AnimationType", animation_preview_value)) {
+                            const bool is_selected = (game_object->animation_id() == -1);
+                            if (ImGui::Selectable(no_animation, is_selected)) {
+                                game_object->animation_id() = -1;
                             }
                             if (is_selected) {
                                 ImGui::SetItemDefaultFocus();
                             }
                             for (int i = 0; i < model->animations.size(); i++) {
-                                const bool is_selected = (game_object->animation_id == i);
+                                const bool is_selected = (game_object->animation_id() == i);
 
                                 if (ImGui::Selectable(model->animations[i].name.c_str(), is_selected)) {
-                                    game_object->animation_id = i;
+                                    game_object->animation_id() = i;
                                 }
 
                                 // Set the initial focus when opening the combo (scrolling + keyboard navigation focus)
@@ -676,11 +748,9 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
             }
 
             // Light information
-            if (game_object->type == TypePointLight || game_object->type == TypeDirectionalLight || game_object->type == TypeSpotLight) {
+            if (game_object->light_index() != -1) {
                 if (ImGui::CollapsingHeader("Light", ImGuiTreeNodeFlags_DefaultOpen)) {
                     if (ImGui::BeginTable("LightTable", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
-                        Light* light = (Light*)game_object;
-
                         // Row 1: Intensity of the light
                         ImGui::TableNextRow();
 
@@ -689,12 +759,10 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
 
                         ImGui::TableSetColumnIndex(1);
                         ImGui::PushItemWidth(-1);
-                        ImGui::DragFloat("##LightIntensity", &(light->intensity), 0.5f, 0.0f, std::numeric_limits<float>::max());
+                        ImGui::DragFloat("##LightIntensity", &(game_object->intensity()), 0.5f, 0.0f, std::numeric_limits<float>::max());
 
                         // If it is a point light
                         if (game_object->type == TypePointLight) {
-                            PointLight* point_light = (PointLight*)light;
-
                             // Row: Constant term of attenuation
                             ImGui::TableNextRow();
 
@@ -702,7 +770,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Constant Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationConstantTerm", &(point_light->constant), 0.01f, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationConstantTerm", &(game_object->constant()), 0.01f, 0.0f, std::numeric_limits<float>::max());
 
                             // Row: Linear term of attenuation
                             ImGui::TableNextRow();
@@ -711,7 +779,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Linear Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationLinearTerm", &(point_light->linear), 0.001f, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationLinearTerm", &(game_object->linear()), 0.001f, 0.0f, std::numeric_limits<float>::max());
 
                             // Row: Quadratic term of attenuation
                             ImGui::TableNextRow();
@@ -720,12 +788,10 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Quadratic Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationQuadraticTerm", &(point_light->quadratic), 0.001, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationQuadraticTerm", &(game_object->quadratic()), 0.001, 0.0f, std::numeric_limits<float>::max());
                         }
                         // If it is a spot light
                         else if (game_object->type == TypeSpotLight) {
-                            SpotLight* spot_light = (SpotLight*)light;
-
                             // Row: Constant term of attenuation
                             ImGui::TableNextRow();
 
@@ -733,7 +799,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Constant Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationConstantTerm", &(spot_light->constant), 0.01f, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationConstantTerm", &(game_object->constant()), 0.01f, 0.0f, std::numeric_limits<float>::max());
 
                             // Row: Linear term of attenuation
                             ImGui::TableNextRow();
@@ -742,7 +808,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Linear Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationLinearTerm", &(spot_light->linear), 0.001f, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationLinearTerm", &(game_object->linear()), 0.001f, 0.0f, std::numeric_limits<float>::max());
 
                             // Row: Quadratic term of attenuation
                             ImGui::TableNextRow();
@@ -751,7 +817,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Attenuation Quadratic Term");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##AttenuationQuadraticTerm", &(spot_light->quadratic), 0.001f, 0.0f, std::numeric_limits<float>::max());
+                            ImGui::DragFloat("##AttenuationQuadraticTerm", &(game_object->quadratic()), 0.001f, 0.0f, std::numeric_limits<float>::max());
 
                             // Row: Inner cut off angle
                             ImGui::TableNextRow();
@@ -760,7 +826,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Inner cut off angle");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##InnerCutOffAngle", &(spot_light->inner_cut_off_angle), 0.5f, 0.0f, 360.0f);
+                            ImGui::DragFloat("##InnerCutOffAngle", &(game_object->inner_cut_off_angle()), 0.5f, 0.0f, 360.0f);
 
                             // Row: Outer cut off angle
                             ImGui::TableNextRow();
@@ -769,7 +835,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Outer cut off angle");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat("##OuterCutOffAngle", &(spot_light->outer_cut_off_angle), 0.5f, 0.0f, 360.0f);
+                            ImGui::DragFloat("##OuterCutOffAngle", &(game_object->outer_cut_off_angle()), 0.5f, 0.0f, 360.0f);
 
                             // Row: Light direction
                             ImGui::TableNextRow();
@@ -778,12 +844,10 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Light Direction");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat3("##LightDirection", &(spot_light->direction.x), 0.1f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
+                            ImGui::DragFloat3("##LightDirection", &(game_object->direction().x), 0.1f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
                         }
                         // If it is a directional light
                         else if (game_object->type == TypeDirectionalLight) {
-                            DirectionalLight* directional_light = (DirectionalLight*)light;
-
                             // Row: Light direction
                             ImGui::TableNextRow();
 
@@ -791,7 +855,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                             ImGui::Text("Light Direction");
 
                             ImGui::TableSetColumnIndex(1);
-                            ImGui::DragFloat3("##LightDirection", &(directional_light->direction.x), 0.1f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
+                            ImGui::DragFloat3("##LightDirection", &(game_object->direction().x), 0.1f, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
                         }
 
                         ImGui::PopItemWidth();
@@ -812,13 +876,13 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
 
                     ImGui::TableSetColumnIndex(1);
                     ImGui::PushItemWidth(-1);
-                    if (ImGui::BeginCombo("##SkyboxName", ((Skybox*)game_object)->cubemap_name.c_str()))
+                    if (ImGui::BeginCombo("##SkyboxName", game_object->cubemap_name.c_str()))
                     {
                         for (auto it = rendering->cubemap->umap_name_to_cubemap_data.begin(); it != rendering->cubemap->umap_name_to_cubemap_data.end(); it++) {
-                            const bool is_selected = (((Skybox*)game_object)->cubemap_name == it->first);
+                            const bool is_selected = (game_object->cubemap_name == it->first);
 
                             if (ImGui::Selectable(it->first.c_str(), is_selected)) {
-                                ((Skybox*)game_object)->cubemap_name = it->first;
+                                game_object->cubemap_name = it->first;
                             }
                             if (is_selected) {
                                 ImGui::SetItemDefaultFocus();
@@ -834,7 +898,7 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::Text("Is HDRI");
 
                     ImGui::TableSetColumnIndex(1);
-                    ImGui::Checkbox("##IsHDRI", &(rendering->cubemap->umap_name_to_cubemap_data[((Skybox*)game_object)->cubemap_name].is_hdri));
+                    ImGui::Checkbox("##IsHDRI", &(rendering->cubemap->umap_name_to_cubemap_data[game_object->cubemap_name].is_hdri));
 
                     // Row: Cubemap texture type
                     ImGui::TableNextRow();
@@ -867,6 +931,19 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
                     ImGui::TableSetColumnIndex(1);
                     ImGui::SliderFloat("##CubemapTextureMipmapLevel", &(rendering->cubemap_texture_mipmap_level), 0.0f, 4.0f);
 
+                    // Row: Prefilter samples, the IBL of the displayed cubemap is baked again when they change
+                    ImGui::TableNextRow();
+
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("Prefilter samples");
+
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::SliderInt("##PrefilterSamples", &(rendering->prefilter_sample_count), 16, 4096);
+                    // the bake takes a while, it runs once the slider is released
+                    if (ImGui::IsItemDeactivatedAfterEdit()) {
+                        rendering->rebake_ibl(rendering->displayed_cubemap_name);
+                    }
+
                     ImGui::PopItemWidth();
 
                     ImGui::EndTable();
@@ -876,6 +953,218 @@ void UserInterface::show_game_object_ui(GameObject* game_object) {
     }
 }
 
+// Timeline of the passes of the last resolved frame (GPU and CPU) and their times with the history of the GPU times
+void UserInterface::show_profiler_ui() {
+    FrameProfiler* profiler = FrameProfiler::get_instance();
+    ImGui::Checkbox("Enabled", &profiler->enabled);
+
+    // Chrome trace of the last seconds, for chrome://tracing or ui.perfetto.dev
+    bool trace_enabled = TraceRecorder::enabled;
+    if (ImGui::Checkbox("Record trace", &trace_enabled)) {
+        TraceRecorder::enabled = trace_enabled;
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+    ImGui::InputInt("seconds", &trace_dump_seconds);
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace")) {
+        TraceRecorder::get_instance()->write_trace("trace.json", std::max(trace_dump_seconds, 1));
+    }
+
+    // Call stacks of the whole process, for flame graphs
+    if (SamplingProfiler::is_supported()) {
+        SamplingProfiler* sampling_profiler = SamplingProfiler::get_instance();
+        bool sampling = sampling_profiler->is_running();
+        if (ImGui::Checkbox("Sample stacks", &sampling)) {
+            if (sampling) {
+                sampling_profiler->start(sampling_rate_hz);
+            }
+            else {
+                sampling_profiler->write_folded_stacks("profile.folded");
+            }
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80.0f);
+        ImGui::InputInt("Hz", &sampling_rate_hz);
+        if (!sampling && sampling_profiler->get_num_samples() > 0) {
+            ImGui::SameLine();
+            ImGui::Text("%d samples in profile.folded", sampling_profiler->get_num_samples());
+        }
+    }
+
+    bool count_gl_calls = are_gl_counters_installed();
+    if (ImGui::Checkbox("Count GL calls", &count_gl_calls)) {
+        if (count_gl_calls) {
+            install_gl_counters();
+        }
+        else {
+            uninstall_gl_counters();
+        }
+    }
+    if (count_gl_calls) {
+        const GLCounters& frame_counters = profiler->get_frame_gl_counters();
+        ImGui::Text("Draw calls: %llu, triangles: %llu, dispatches: %llu", frame_counters.draw_calls, frame_counters.triangles, frame_counters.dispatches);
+        ImGui::Text("Binds: %llu programs, %llu textures, %llu vertex arrays, %llu framebuffers", frame_counters.program_binds, frame_counters.texture_binds,
+            frame_counters.vertex_array_binds, frame_counters.framebuffer_binds);
+        ImGui::Text("Uploads: %llu uniforms, %llu buffers (%llu bytes), %llu textures", frame_counters.uniform_uploads, frame_counters.buffer_uploads,
+            frame_counters.buffer_upload_bytes, frame_counters.texture_uploads);
+    }
+    bool track_allocations = is_allocation_tracking_enabled();
+    if (ImGui::Checkbox("Track allocations", &track_allocations)) {
+        set_allocation_tracking(track_allocations);
+    }
+    if (track_allocations) {
+        AllocationCounters frame_allocations = profiler->get_frame_allocations();
+        ImGui::Text("Allocations: %llu (%llu bytes) per frame", frame_allocations.count, frame_allocations.bytes);
+        FrameArena* frame_arena = FrameArena::get_instance();
+        ImGui::Text("Frame arena: %zu bytes used, %zu peak, %zu capacity", frame_arena->get_used_size(), frame_arena->get_peak_size(), frame_arena->get_capacity());
+        for (int i = 0; i < AllocTagLast; i++) {
+            const AllocationCounters& tag_allocations = profiler->get_frame_allocations((AllocationTag)i);
+            if (tag_allocations.count > 0) {
+                ImGui::Text("  %s: %llu (%llu bytes)", allocation_tag_to_string((AllocationTag)i).c_str(), tag_allocations.count, tag_allocations.bytes);
+            }
+        }
+    }
+    const std::vector<PassTiming>& pass_timings = profiler->get_pass_timings();
+    if (pass_timings.empty()) {
+        return;
+    }
+
+    double frame_gpu_ms = 0.0;
+    double frame_cpu_ms = 0.0;
+    int max_depth = 0;
+    for (int i = 0; i < pass_timings.size(); i++) {
+        frame_gpu_ms = std::max(frame_gpu_ms, pass_timings[i].gpu_begin_ms + pass_timings[i].gpu_ms);
+        frame_cpu_ms = std::max(frame_cpu_ms, pass_timings[i].cpu_begin_ms + pass_timings[i].cpu_ms);
+        max_depth = std::max(max_depth, pass_timings[i].depth);
+    }
+    ImGui::Text("Frame: GPU %.3f ms, CPU %.3f ms", frame_gpu_ms, frame_cpu_ms);
+
+    // one row per depth of the scopes, the GPU timeline over the CPU one, both with the scale of the longest
+    const float row_height = 18.0f;
+    float timeline_width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    double timeline_ms = std::max(std::max(frame_gpu_ms, frame_cpu_ms), 0.001);
+    for (int timeline = 0; timeline < 2; timeline++) {
+        bool is_gpu = timeline == 0;
+        ImGui::Text(is_gpu ? "GPU" : "CPU");
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        for (int i = 0; i < pass_timings.size(); i++) {
+            const PassTiming& timing = pass_timings[i];
+            double begin_ms = is_gpu ? timing.gpu_begin_ms : timing.cpu_begin_ms;
+            double duration_ms = is_gpu ? timing.gpu_ms : timing.cpu_ms;
+            ImVec2 min(origin.x + (float)(begin_ms / timeline_ms) * timeline_width, origin.y + timing.depth * row_height);
+            ImVec2 max(min.x + std::max((float)(duration_ms / timeline_ms) * timeline_width, 1.0f), min.y + row_height - 2.0f);
+            ImU32 color = ImColor::HSV((float)(std::hash<std::string>{}(timing.name) % 360) / 360.0f, 0.6f, 0.8f);
+            draw_list->AddRectFilled(min, max, color);
+            draw_list->PushClipRect(min, max, true);
+            draw_list->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), timing.name.c_str());
+            draw_list->PopClipRect();
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s: %.3f ms", timing.name.c_str(), duration_ms);
+            }
+        }
+        ImGui::Dummy(ImVec2(timeline_width, (max_depth + 1) * row_height));
+    }
+
+    int num_columns = 4 + (count_gl_calls ? 5 : 0) + (track_allocations ? 1 : 0);
+    if (ImGui::BeginTable("ProfilerTable", num_columns, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        if (count_gl_calls) {
+            ImGui::TableSetupColumn("Draws");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("Programs");
+            ImGui::TableSetupColumn("Textures");
+            ImGui::TableSetupColumn("Uniforms");
+        }
+        if (track_allocations) {
+            ImGui::TableSetupColumn("Allocations");
+        }
+        ImGui::TableSetupColumn("GPU history");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < pass_timings.size(); i++) {
+            const PassTiming& timing = pass_timings[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Indent(timing.depth * 10.0f + 1.0f);
+            ImGui::Text(timing.name.c_str());
+            ImGui::Unindent(timing.depth * 10.0f + 1.0f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.cpu_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.gpu_ms);
+            if (count_gl_calls) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.gl_counters.draw_calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.gl_counters.triangles);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.gl_counters.program_binds);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.gl_counters.texture_binds);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.gl_counters.uniform_uploads);
+            }
+            if (track_allocations) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", timing.allocations.count);
+            }
+            ImGui::TableNextColumn();
+            const std::deque<float>& gpu_times = profiler->gpu_history[timing.name];
+            FrameVector<float> history(gpu_times.begin(), gpu_times.end());
+            ImGui::PushID(i);
+            ImGui::PlotLines("##GpuHistory", history.data(), history.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, row_height));
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+}
+
+void UserInterface::show_memory_ui() {
+    ResourceRegistry* resource_registry = ResourceRegistry::get_instance();
+    const float megabyte = 1024.0f * 1024.0f;
+    float gpu_total_mb = resource_registry->get_gpu_total() / megabyte;
+    ImGui::Text("GPU: %.2f MB, CPU: %.2f MB", gpu_total_mb, resource_registry->get_cpu_total() / megabyte);
+    if (resource_registry->gpu_memory_budget != 0) {
+        float gpu_budget_mb = resource_registry->gpu_memory_budget / megabyte;
+        const char* overlay = FrameArena::get_instance()->format("%d / %d MB", (int)gpu_total_mb, (int)gpu_budget_mb);
+        ImGui::ProgressBar(gpu_total_mb / gpu_budget_mb, ImVec2(-1.0f, 0.0f), overlay);
+    }
+    for (int i = 0; i < ResourceCategoryLast; i++) {
+        ResourceCategory category = (ResourceCategory)i;
+        ImGui::Text("%s (%s): %.2f MB", resource_category_to_string(category).c_str(), is_gpu_resource_category(category) ? "GPU" : "CPU",
+            resource_registry->get_total(category) / megabyte);
+    }
+
+    EntityStore* entity_store = EntityStore::get_instance();
+    ImGui::Text("Entities: %d, lights: %d", entity_store->get_num_entities(), entity_store->get_num_lights());
+    ImGui::Text("Pools (objects / slots): game objects %d / %d, materials %d / %d, textures %d / %d",
+        GameObject::pool.get_num_objects(), GameObject::pool.get_capacity(),
+        Material::pool.get_num_objects(), Material::pool.get_capacity(), Texture::pool.get_num_objects(), Texture::pool.get_capacity());
+
+    ImGui::Text("Top consumers");
+    resource_registry->get_top_consumers(MEMORY_REPORT_TOP_CONSUMERS, memory_consumers);
+    const std::vector<ResourceRecord>& consumers = memory_consumers;
+    if (ImGui::BeginTable("MemoryTable", 3, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Owner");
+        ImGui::TableSetupColumn("Category");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < consumers.size(); i++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(consumers[i].owner.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(resource_category_to_string(consumers[i].category).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", consumers[i].size_in_bytes / megabyte);
+        }
+        ImGui::EndTable();
+    }
+}
+
 void UserInterface::clean_imgui() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
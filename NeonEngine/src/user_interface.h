@@ -1,9 +1,12 @@
 #pragma once
 
 #include "imgui_extension.h"
+#include "resource_registry.h"
 
 #include <imgui.h>
 #include <mutex>
+#include <string>
+#include <vector>
 
 class NeonEngine;
 class Input;
@@ -36,6 +39,8 @@ public:
     void update_fps_ui();
     void check_if_viewport_window_resized();
     void show_game_object_ui(GameObject* game_object);
+    void show_profiler_ui();
+    void show_memory_ui();
     void update_displayed_texture();
     void render_app();
     void clean_imgui();
@@ -59,6 +64,10 @@ private:
 
     float passed_time_seconds;
     float frames_per_second_ui;
+    int trace_dump_seconds;
+    int sampling_rate_hz;
+    std::string logger_text;
+    std::vector<ResourceRecord> memory_consumers;
     NeonEngine* neon_engine;
     Input* input;
     Rendering* rendering;
@@ -0,0 +1,126 @@
+#include "worker_pool.h"
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+
+WorkerPool* WorkerPool::instance = nullptr;
+std::mutex WorkerPool::worker_pool_mutex;
+
+WorkerPool* WorkerPool::get_instance()
+{
+    std::lock_guard<std::mutex> lock(worker_pool_mutex);
+    if (instance == nullptr) {
+        instance = new WorkerPool();
+    }
+    return instance;
+}
+
+void WorkerPool::start_threads() {
+    // leave one hardware thread for the GL thread
+    int num_threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    for (int i = 0; i < num_threads; i++) {
+        threads.push_back(std::thread(&WorkerPool::worker_loop, this, i + 1));
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        if (!stop_threads) {
+            if (threads.empty()) {
+                start_threads();
+            }
+            jobs.push_back(std::move(job));
+            jobs_available.notify_one();
+            return;
+        }
+    }
+    // after clean() the jobs run on the calling thread
+    job();
+}
+
+int WorkerPool::get_num_threads() {
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    if (stop_threads) {
+        return 0;
+    }
+    if (threads.empty()) {
+        start_threads();
+    }
+    return (int)threads.size();
+}
+
+// The state is shared with the jobs, a job that starts after every index was taken returns without using the function
+struct ParallelForState {
+    std::function<void(int)> function;
+    int count;
+    std::atomic<int> next_index;
+    int num_finished = 0;
+    std::mutex finished_mutex;
+    std::condition_variable all_finished;
+
+    void run() {
+        int num_run = 0;
+        for (int i = next_index.fetch_add(1); i < count; i = next_index.fetch_add(1)) {
+            function(i);
+            num_run++;
+        }
+        if (num_run > 0) {
+            std::lock_guard<std::mutex> lock(finished_mutex);
+            num_finished += num_run;
+            if (num_finished == count) {
+                all_finished.notify_all();
+            }
+        }
+    }
+};
+
+void WorkerPool::parallel_for(int count, const std::function<void(int)>& function) {
+    if (count <= 0) {
+        return;
+    }
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->function = function;
+    state->count = count;
+    state->next_index = 0;
+    // the calling thread runs one of the indices too, so a job of the pool can call parallel_for
+    int num_jobs = std::min(count - 1, get_num_threads());
+    for (int i = 0; i < num_jobs; i++) {
+        submit([state]() { state->run(); });
+    }
+    state->run();
+    std::unique_lock<std::mutex> lock(state->finished_mutex);
+    state->all_finished.wait(lock, [&state]() { return state->num_finished == state->count; });
+}
+
+void WorkerPool::worker_loop(int thread_index) {
+    TraceRecorder::set_thread_name("pool worker " + std::to_string(thread_index));
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_available.wait(lock, [this]() { return stop_threads || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void WorkerPool::clean() {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        stop_threads = true;
+        jobs_available.notify_all();
+    }
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    threads.clear();
+}
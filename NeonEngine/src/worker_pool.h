@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Long-lived worker threads for the CPU work split at runtime (the SH projections, the decoding of the streamed textures).
+// Unlike a TaskGraph, which starts its threads on every run(), the threads are started once, with the first job.
+// Any thread
+class WorkerPool {
+public:
+    static WorkerPool* get_instance();
+
+    WorkerPool(WorkerPool& other) = delete;
+    void operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> job);
+    // Calls function(i) for i in [0, count) on the workers and on the calling thread, returns when every call returned
+    void parallel_for(int count, const std::function<void(int)>& function);
+    int get_num_threads();
+    // Waits for the submitted jobs and joins the threads
+    void clean();
+
+private:
+    WorkerPool() {}
+
+    void start_threads();
+    void worker_loop(int thread_index);
+
+    static WorkerPool* instance;
+    static std::mutex worker_pool_mutex;
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_available;
+    bool stop_threads = false;
+};